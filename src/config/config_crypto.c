@@ -38,6 +38,11 @@ PROVIDE_REQUIRING_SYMBOL();
 REQUIRE_OBJECT ( oid_rsa );
 #endif
 
+/* ECDSA */
+#if defined ( CRYPTO_PUBKEY_ECDSA )
+REQUIRE_OBJECT ( oid_ecdsa );
+#endif
+
 /* MD4 */
 #if defined ( CRYPTO_DIGEST_MD4 )
 REQUIRE_OBJECT ( oid_md4 );
@@ -138,6 +143,31 @@ REQUIRE_OBJECT ( rsa_sha384 );
 REQUIRE_OBJECT ( rsa_sha512 );
 #endif
 
+/* ECDSA and SHA-1 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA1 )
+REQUIRE_OBJECT ( ecdsa_sha1 );
+#endif
+
+/* ECDSA and SHA-224 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA224 )
+REQUIRE_OBJECT ( ecdsa_sha224 );
+#endif
+
+/* ECDSA and SHA-256 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( ecdsa_sha256 );
+#endif
+
+/* ECDSA and SHA-384 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA384 )
+REQUIRE_OBJECT ( ecdsa_sha384 );
+#endif
+
+/* ECDSA and SHA-512 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA512 )
+REQUIRE_OBJECT ( ecdsa_sha512 );
+#endif
+
 /* RSA, AES-CBC, and SHA-1 */
 #if defined ( CRYPTO_EXCHANGE_PUBKEY ) && defined ( CRYPTO_PUBKEY_RSA ) && \
     defined ( CRYPTO_CIPHER_AES_CBC ) && defined ( CRYPTO_DIGEST_SHA1 )
@@ -215,3 +245,15 @@ REQUIRE_OBJECT ( ecdhe_rsa_aes_gcm_sha256 );
     defined ( CRYPTO_CIPHER_AES_GCM ) && defined ( CRYPTO_DIGEST_SHA384 )
 REQUIRE_OBJECT ( ecdhe_rsa_aes_gcm_sha384 );
 #endif
+
+/* ECDHE, ECDSA, AES-GCM, and SHA-256 */
+#if defined ( CRYPTO_EXCHANGE_ECDHE ) && defined ( CRYPTO_PUBKEY_ECDSA ) && \
+    defined ( CRYPTO_CIPHER_AES_GCM ) && defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( ecdhe_ecdsa_aes_gcm_sha256 );
+#endif
+
+/* ECDHE, ECDSA, AES-GCM, and SHA-384 */
+#if defined ( CRYPTO_EXCHANGE_ECDHE ) && defined ( CRYPTO_PUBKEY_ECDSA ) && \
+    defined ( CRYPTO_CIPHER_AES_GCM ) && defined ( CRYPTO_DIGEST_SHA384 )
+REQUIRE_OBJECT ( ecdhe_ecdsa_aes_gcm_sha384 );
+#endif
@@ -46,6 +46,9 @@ REQUIRE_OBJECT ( httpntlm );
 #ifdef HTTP_ENC_PEERDIST
 REQUIRE_OBJECT ( peerdist );
 #endif
+#ifdef HTTP_ENC_PEERSERV
+REQUIRE_OBJECT ( peerserv );
+#endif
 #ifdef HTTP_HACK_GCE
 REQUIRE_OBJECT ( httpgce );
 #endif
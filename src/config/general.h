@@ -81,6 +81,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define HTTP_AUTH_DIGEST	/* Digest authentication */
 //#define HTTP_AUTH_NTLM	/* NTLM authentication */
 //#define HTTP_ENC_PEERDIST	/* PeerDist content encoding */
+//#define HTTP_ENC_PEERSERV	/* PeerDist content serving */
 //#define HTTP_HACK_GCE		/* Google Compute Engine hacks */
 
 /*
@@ -218,6 +219,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef	GDBSERIAL		/* Remote GDB debugging over serial */
 #undef	GDBUDP			/* Remote GDB debugging over UDP
 				 * (both may be set) */
+//#define BOOT_TRACE		/* Boot phase timeline tracing */
 //#define EFI_DOWNGRADE_UX	/* Downgrade UEFI user experience */
 #define	TIVOLI_VMM_WORKAROUND	/* Work around the Tivoli VMM's garbling of SSE
 				 * registers when iPXE traps to it due to
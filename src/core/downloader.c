@@ -34,7 +34,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/umalloc.h>
 #include <ipxe/image.h>
 #include <ipxe/xferbuf.h>
+#include <ipxe/inflate.h>
 #include <ipxe/downloader.h>
+#include <ipxe/trace.h>
 
 /** @file
  *
@@ -56,8 +58,48 @@ struct downloader {
 	struct image *image;
 	/** Data transfer buffer */
 	struct xfer_buffer buffer;
+	/** Streaming decompressor (if extracting) */
+	struct inflater *inflater;
 };
 
+/**
+ * Allocate streaming decompressor (when not present)
+ *
+ * @ret inflater	Streaming decompressor, or NULL on failure
+ */
+__weak struct inflater * alloc_inflater ( void ) {
+	return NULL;
+}
+
+/**
+ * Receive downloaded data (when streaming decompression is not present)
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+__weak int inflater_deliver ( struct inflater *inflater __unused,
+			      struct xfer_buffer *xferbuf __unused,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta __unused ) {
+	free_iob ( iobuf );
+	return -ENOTSUP;
+}
+
+/**
+ * Complete download (when streaming decompression is not present)
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @ret rc		Return status code
+ */
+__weak int inflater_finish ( struct inflater *inflater __unused,
+			     struct xfer_buffer *xferbuf __unused ) {
+	return -ENOTSUP;
+}
+
 /**
  * Free downloader object
  *
@@ -68,6 +110,7 @@ static void downloader_free ( struct refcnt *refcnt ) {
 		container_of ( refcnt, struct downloader, refcnt );
 
 	xferbuf_free ( &downloader->buffer );
+	free ( downloader->inflater );
 	image_put ( downloader->image );
 	free ( downloader );
 }
@@ -82,7 +125,12 @@ static void downloader_finished ( struct downloader *downloader, int rc ) {
 	struct xfer_buffer *buffer = &downloader->buffer;
 	struct image *image = downloader->image;
 
-	/* Log download status */
+	/* Complete decompression, if applicable */
+	if ( ( rc == 0 ) && downloader->inflater )
+		rc = inflater_finish ( downloader->inflater, buffer );
+
+	/* Record and log download status */
+	trace ( "download.done", rc );
 	if ( rc == 0 ) {
 		syslog ( LOG_NOTICE, "Downloaded \"%s\"\n", image->name );
 	} else {
@@ -152,9 +200,16 @@ static int downloader_deliver ( struct downloader *downloader,
 				struct xfer_metadata *meta ) {
 	int rc;
 
-	/* Add data to buffer */
-	if ( ( rc = xferbuf_deliver ( &downloader->buffer, iob_disown ( iobuf ),
-				      meta ) ) != 0 )
+	/* Add data to buffer, decompressing if applicable */
+	if ( downloader->inflater ) {
+		rc = inflater_deliver ( downloader->inflater,
+					&downloader->buffer,
+					iob_disown ( iobuf ), meta );
+	} else {
+		rc = xferbuf_deliver ( &downloader->buffer,
+				       iob_disown ( iobuf ), meta );
+	}
+	if ( rc != 0 )
 		goto err_deliver;
 
 	return 0;
@@ -173,6 +228,10 @@ static int downloader_deliver ( struct downloader *downloader,
 static struct xfer_buffer *
 downloader_buffer ( struct downloader *downloader ) {
 
+	/* Direct access is not possible when decompressing */
+	if ( downloader->inflater )
+		return NULL;
+
 	/* Provide direct access to underlying data transfer buffer */
 	return &downloader->buffer;
 }
@@ -254,12 +313,16 @@ static struct interface_descriptor downloader_job_desc =
  *
  * @v job		Job control interface
  * @v image		Image to fill with downloaded file
+ * @v flags		Download flags
  * @ret rc		Return status code
  *
  * Instantiates a downloader object to download the content of the
- * specified image from its URI.
+ * specified image from its URI.  If @c DOWNLOAD_EXTRACT is specified,
+ * then gzip or zlib compressed content will be decompressed as it is
+ * received.
  */
-int create_downloader ( struct interface *job, struct image *image ) {
+int create_downloader ( struct interface *job, struct image *image,
+			unsigned int flags ) {
 	struct downloader *downloader;
 	int rc;
 
@@ -275,7 +338,19 @@ int create_downloader ( struct interface *job, struct image *image ) {
 	downloader->image = image_get ( image );
 	xferbuf_umalloc_init ( &downloader->buffer );
 
+	/* Allocate streaming decompressor, if applicable */
+	if ( flags & DOWNLOAD_EXTRACT ) {
+		downloader->inflater = alloc_inflater();
+		if ( ! downloader->inflater ) {
+			DBGC ( downloader, "DOWNLOADER %p cannot extract %s\n",
+			       downloader, image->name );
+			rc = -ENOTSUP;
+			goto err;
+		}
+	}
+
 	/* Instantiate child objects and attach to our interfaces */
+	trace ( "download.start", 0 );
 	if ( ( rc = xfer_open_uri ( &downloader->xfer, image->uri ) ) != 0 )
 		goto err;
 
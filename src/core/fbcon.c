@@ -33,6 +33,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <errno.h>
 #include <assert.h>
 #include <byteswap.h>
+#include <stdlib.h>
 #include <ipxe/ansiesc.h>
 #include <ipxe/image.h>
 #include <ipxe/pixbuf.h>
@@ -142,6 +143,200 @@ static void fbcon_clear ( struct fbcon *fbcon, unsigned int ypos ) {
 	}
 }
 
+/**
+ * Mark character as dirty
+ *
+ * @v fbcon		Frame buffer console
+ * @v xpos		X position
+ * @v ypos		Y position
+ */
+static inline void fbcon_dirty ( struct fbcon *fbcon, unsigned int xpos,
+				 unsigned int ypos ) {
+	struct fbcon_dirty *dirty;
+
+	/* Do nothing unless shadow frame buffer is in use */
+	if ( ! fbcon->dirty )
+		return;
+
+	/* Extend dirty range */
+	dirty = &fbcon->dirty[ypos];
+	if ( ! dirty->end ) {
+		dirty->start = xpos;
+		dirty->end = ( xpos + 1 );
+	} else if ( xpos < dirty->start ) {
+		dirty->start = xpos;
+	} else if ( xpos >= dirty->end ) {
+		dirty->end = ( xpos + 1 );
+	}
+}
+
+/**
+ * Copy dirty characters from shadow frame buffer to real frame buffer
+ *
+ * @v fbcon		Frame buffer console
+ */
+static void fbcon_flush ( struct fbcon *fbcon ) {
+	struct fbcon_dirty *dirty;
+	size_t offset;
+	size_t len;
+	unsigned int ypos;
+	unsigned int row;
+
+	/* Do nothing unless shadow frame buffer is in use */
+	if ( ! fbcon->dirty )
+		return;
+
+	/* Copy each dirty range, one pixel row at a time */
+	for ( ypos = 0 ; ypos < fbcon->character.height ; ypos++ ) {
+		dirty = &fbcon->dirty[ypos];
+		if ( ! dirty->end )
+			continue;
+		offset = ( fbcon->indent +
+			   ( ypos * fbcon->character.stride ) +
+			   ( dirty->start * fbcon->character.len ) );
+		len = ( ( dirty->end - dirty->start ) * fbcon->character.len );
+		for ( row = 0 ; row < fbcon->font->height ; row++ ) {
+			memcpy ( ( fbcon->start + offset ),
+				 ( fbcon->shadow + offset ), len );
+			offset += fbcon->pixel->stride;
+		}
+		dirty->end = 0;
+	}
+}
+
+/** Define expanded glyph row fragment mask */
+#define FBCON_MASK( fragment ) {			\
+	( ( (fragment) & 0x8 ) ? 0xffffffffUL : 0 ),	\
+	( ( (fragment) & 0x4 ) ? 0xffffffffUL : 0 ),	\
+	( ( (fragment) & 0x2 ) ? 0xffffffffUL : 0 ),	\
+	( ( (fragment) & 0x1 ) ? 0xffffffffUL : 0 ) }
+
+/** Expanded glyph row fragment masks */
+static const uint32_t fbcon_masks[16][FBCON_EXPANDED_PIXELS] = {
+	FBCON_MASK ( 0x0 ), FBCON_MASK ( 0x1 ), FBCON_MASK ( 0x2 ),
+	FBCON_MASK ( 0x3 ), FBCON_MASK ( 0x4 ), FBCON_MASK ( 0x5 ),
+	FBCON_MASK ( 0x6 ), FBCON_MASK ( 0x7 ), FBCON_MASK ( 0x8 ),
+	FBCON_MASK ( 0x9 ), FBCON_MASK ( 0xa ), FBCON_MASK ( 0xb ),
+	FBCON_MASK ( 0xc ), FBCON_MASK ( 0xd ), FBCON_MASK ( 0xe ),
+	FBCON_MASK ( 0xf ),
+};
+
+/**
+ * Get expanded glyph row fragments for a colour pair
+ *
+ * @v fbcon		Frame buffer console
+ * @v foreground	Foreground raw colour
+ * @v background	Background raw colour
+ * @ret expanded	Expanded glyph row fragments
+ */
+static struct fbcon_expanded * fbcon_expand ( struct fbcon *fbcon,
+					      uint32_t foreground,
+					      uint32_t background ) {
+	struct fbcon_expanded *expanded;
+	unsigned int fragment;
+	unsigned int i;
+
+	/* Use cached expansion, if available */
+	for ( i = 0 ; i < FBCON_EXPANDED_CACHE ; i++ ) {
+		expanded = &fbcon->expanded[i];
+		if ( ( expanded->foreground == foreground ) &&
+		     ( expanded->background == background ) )
+			return expanded;
+	}
+
+	/* Replace a cache entry */
+	expanded = &fbcon->expanded[fbcon->expanded_next++];
+	fbcon->expanded_next %= FBCON_EXPANDED_CACHE;
+	expanded->foreground = foreground;
+	expanded->background = background;
+	for ( fragment = 0 ; fragment < 16 ; fragment++ ) {
+		for ( i = 0 ; i < FBCON_EXPANDED_PIXELS ; i++ ) {
+			expanded->pixels[fragment][i] =
+				( ( foreground & fbcon_masks[fragment][i] ) |
+				  ( background & ~fbcon_masks[fragment][i] ) );
+		}
+	}
+	return expanded;
+}
+
+/**
+ * Draw expanded glyph row fragment over existing pixels
+ *
+ * @v pixels		Pixels
+ * @v colour		Foreground raw colour
+ * @v fragment		Glyph row fragment
+ */
+static inline void fbcon_overlay ( uint32_t *pixels, uint32_t colour,
+				   unsigned int fragment ) {
+	const uint32_t *mask = fbcon_masks[fragment];
+	unsigned int i;
+
+	for ( i = 0 ; i < FBCON_EXPANDED_PIXELS ; i++ ) {
+		pixels[i] = ( ( pixels[i] & ~mask[i] ) |
+			      ( colour & mask[i] ) );
+	}
+}
+
+/**
+ * Draw character rows using expanded glyph row fragments
+ *
+ * @v fbcon		Frame buffer console
+ * @v cell		Text cell
+ * @v glyph		Character glyph
+ * @v offset		Offset to first pixel of character
+ */
+static void fbcon_draw_expanded ( struct fbcon *fbcon,
+				  struct fbcon_text_cell *cell,
+				  const uint8_t *glyph, size_t offset ) {
+	struct fbcon_expanded *expanded;
+	uint32_t *pixels;
+	unsigned int row;
+	uint8_t bitmask;
+
+	/* Sanity check */
+	static_assert ( FBCON_CHAR_WIDTH ==
+			( ( 2 * FBCON_EXPANDED_PIXELS ) + 1 ) );
+
+	/* Draw character rows */
+	if ( cell->background == FBCON_TRANSPARENT ) {
+
+		/* Overlay foreground on background picture (or black) */
+		for ( row = 0 ; row < fbcon->font->height ; row++ ) {
+			pixels = ( fbcon->draw + offset );
+			if ( fbcon->picture.start ) {
+				memcpy ( pixels, ( fbcon->picture.start +
+						   offset ),
+					 fbcon->character.len );
+			} else {
+				memset ( pixels, 0, fbcon->character.len );
+			}
+			bitmask = glyph[row];
+			fbcon_overlay ( &pixels[0], cell->foreground,
+					( bitmask >> 4 ) );
+			fbcon_overlay ( &pixels[FBCON_EXPANDED_PIXELS],
+					cell->foreground, ( bitmask & 0xf ) );
+			offset += fbcon->pixel->stride;
+		}
+
+	} else {
+
+		/* Copy expanded fragments */
+		expanded = fbcon_expand ( fbcon, cell->foreground,
+					  cell->background );
+		for ( row = 0 ; row < fbcon->font->height ; row++ ) {
+			pixels = ( fbcon->draw + offset );
+			bitmask = glyph[row];
+			memcpy ( &pixels[0], expanded->pixels[ bitmask >> 4 ],
+				 sizeof ( expanded->pixels[0] ) );
+			memcpy ( &pixels[FBCON_EXPANDED_PIXELS],
+				 expanded->pixels[ bitmask & 0xf ],
+				 sizeof ( expanded->pixels[0] ) );
+			pixels[ 2 * FBCON_EXPANDED_PIXELS ] = cell->background;
+			offset += fbcon->pixel->stride;
+		}
+	}
+}
+
 /**
  * Draw character at specified position
  *
@@ -172,6 +367,12 @@ static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 	pixel_len = fbcon->pixel->len;
 	skip_len = ( fbcon->pixel->stride - fbcon->character.len );
 
+	/* Use expanded glyph row fragments, if possible */
+	if ( fbcon->expandable ) {
+		fbcon_draw_expanded ( fbcon, cell, glyph, offset );
+		goto done;
+	}
+
 	/* Check for transparent background colour */
 	transparent = ( cell->background == FBCON_TRANSPARENT );
 
@@ -181,11 +382,11 @@ static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 		/* Draw background picture, if applicable */
 		if ( transparent ) {
 			if ( fbcon->picture.start ) {
-				memcpy ( ( fbcon->start + offset ),
+				memcpy ( ( fbcon->draw + offset ),
 					 ( fbcon->picture.start + offset ),
 					 fbcon->character.len );
 			} else {
-				memset ( ( fbcon->start + offset ), 0,
+				memset ( ( fbcon->draw + offset ), 0,
 					 fbcon->character.len );
 			}
 		}
@@ -200,12 +401,16 @@ static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 			} else {
 				continue;
 			}
-			memcpy ( ( fbcon->start + offset ), src, pixel_len );
+			memcpy ( ( fbcon->draw + offset ), src, pixel_len );
 		}
 
 		/* Move to next row */
 		offset += skip_len;
 	}
+
+ done:
+	/* Mark character as dirty */
+	fbcon_dirty ( fbcon, xpos, ypos );
 }
 
 /**
@@ -241,16 +446,33 @@ static void fbcon_scroll ( struct fbcon *fbcon ) {
 	unsigned int character;
 	uint32_t foreground;
 	uint32_t background;
+	size_t offset;
+	int moved;
 
 	/* Sanity check */
 	assert ( fbcon->ypos == fbcon->character.height );
 
+	/* Scroll up shadow frame buffer contents, if possible.  This
+	 * is not possible when a background picture is present, since
+	 * the picture itself must not scroll.
+	 */
+	moved = ( fbcon->shadow && ( ! fbcon->picture.start ) );
+	if ( moved ) {
+		offset = ( fbcon->margin.top * fbcon->pixel->stride );
+		memmove ( ( fbcon->draw + offset ),
+			  ( fbcon->draw + offset + fbcon->character.stride ),
+			  ( ( fbcon->character.height - 1 ) *
+			    fbcon->character.stride ) );
+	}
+
 	/* Scroll up character array */
 	new = fbcon_cell ( fbcon, 0, 0 );
 	old = fbcon_cell ( fbcon, 0, 1 );
 	for ( ypos = 0 ; ypos < ( fbcon->character.height - 1 ) ; ypos++ ) {
 		for ( xpos = 0 ; xpos < fbcon->character.width ; xpos++ ) {
-			/* Redraw character (if changed) */
+			/* Redraw character (if changed and not
+			 * already moved), or mark as dirty.
+			 */
 			character = old->character;
 			foreground = old->foreground;
 			background = old->background;
@@ -260,7 +482,11 @@ static void fbcon_scroll ( struct fbcon *fbcon ) {
 				new->character = character;
 				new->foreground = foreground;
 				new->background = background;
-				fbcon_draw ( fbcon, new, xpos, ypos );
+				if ( moved ) {
+					fbcon_dirty ( fbcon, xpos, ypos );
+				} else {
+					fbcon_draw ( fbcon, new, xpos, ypos );
+				}
 			}
 			new++;
 			old++;
@@ -463,12 +689,12 @@ void fbcon_putchar ( struct fbcon *fbcon, int character ) {
 	/* Intercept ANSI escape sequences */
 	character = ansiesc_process ( &fbcon->ctx, character );
 	if ( character < 0 )
-		return;
+		goto flush;
 
 	/* Accumulate Unicode characters */
 	character = utf8_accumulate ( &fbcon->utf8, character );
 	if ( character == 0 )
-		return;
+		goto flush;
 
 	/* Handle control characters */
 	switch ( character ) {
@@ -513,6 +739,10 @@ void fbcon_putchar ( struct fbcon *fbcon, int character ) {
 
 	/* Show cursor */
 	fbcon_draw_cursor ( fbcon, fbcon->show_cursor );
+
+ flush:
+	/* Copy any changes to the real frame buffer */
+	fbcon_flush ( fbcon );
 }
 
 /**
@@ -668,6 +898,12 @@ int fbcon_init ( struct fbcon *fbcon, void *start,
 	fbcon->indent = ( ( fbcon->margin.top * pixel->stride ) +
 			  ( fbcon->margin.left * pixel->len ) );
 
+	/* Use expanded glyph row fragments for 32-bit aligned pixels */
+	fbcon->expandable = ( ( pixel->len == sizeof ( uint32_t ) ) &&
+			      ( ( pixel->stride % sizeof ( uint32_t ) ) == 0 ) &&
+			      ( ( virt_to_phys ( start ) %
+				  sizeof ( uint32_t ) ) == 0 ) );
+
 	/* Derive character geometry from pixel geometry */
 	fbcon->character.width = ( width / FBCON_CHAR_WIDTH );
 	fbcon->character.height = ( height / font->height );
@@ -695,8 +931,27 @@ int fbcon_init ( struct fbcon *fbcon, void *start,
 	}
 	fbcon_clear ( fbcon, 0 );
 
+	/* Allocate shadow frame buffer.  This is an optimisation
+	 * only; if allocation fails then we draw directly to the real
+	 * frame buffer.
+	 */
+	fbcon->shadow = umalloc ( fbcon->len );
+	fbcon->dirty = zalloc ( fbcon->character.height *
+				sizeof ( fbcon->dirty[0] ) );
+	if ( ! ( fbcon->shadow && fbcon->dirty ) ) {
+		DBGC ( fbcon, "FBCON %p could not allocate shadow frame "
+		       "buffer\n", fbcon );
+		ufree ( fbcon->shadow );
+		fbcon->shadow = NULL;
+		free ( fbcon->dirty );
+		fbcon->dirty = NULL;
+	}
+	fbcon->draw = ( fbcon->shadow ? fbcon->shadow : fbcon->start );
+
 	/* Set framebuffer to all black (including margins) */
 	memset ( fbcon->start, 0, fbcon->len );
+	if ( fbcon->shadow )
+		memset ( fbcon->shadow, 0, fbcon->len );
 
 	/* Generate pixel buffer from background image, if applicable */
 	if ( config->pixbuf &&
@@ -704,8 +959,13 @@ int fbcon_init ( struct fbcon *fbcon, void *start,
 		goto err_picture;
 
 	/* Draw background picture (including margins), if applicable */
-	if ( fbcon->picture.start )
+	if ( fbcon->picture.start ) {
 		memcpy ( fbcon->start, fbcon->picture.start, fbcon->len );
+		if ( fbcon->shadow ) {
+			memcpy ( fbcon->shadow, fbcon->picture.start,
+				 fbcon->len );
+		}
+	}
 
 	/* Update console width and height */
 	console_set_size ( fbcon->character.width, fbcon->character.height );
@@ -714,6 +974,8 @@ int fbcon_init ( struct fbcon *fbcon, void *start,
 
 	ufree ( fbcon->picture.start );
  err_picture:
+	free ( fbcon->dirty );
+	ufree ( fbcon->shadow );
 	ufree ( fbcon->text.cells );
  err_text:
  err_margin:
@@ -727,6 +989,8 @@ int fbcon_init ( struct fbcon *fbcon, void *start,
  */
 void fbcon_fini ( struct fbcon *fbcon ) {
 
+	free ( fbcon->dirty );
+	ufree ( fbcon->shadow );
 	ufree ( fbcon->text.cells );
 	ufree ( fbcon->picture.start );
 }
@@ -37,6 +37,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/umalloc.h>
 #include <ipxe/uri.h>
 #include <ipxe/image.h>
+#include <ipxe/trace.h>
 
 /** @file
  *
@@ -449,6 +450,8 @@ int image_exec ( struct image *image ) {
 
 	/* Record boot attempt */
 	syslog ( LOG_NOTICE, "Executing \"%s\"\n", image->name );
+	trace ( "exec", 0 );
+	trace_flush();
 
 	/* Temporarily unregister the image during its execution */
 	unregister_image ( image );
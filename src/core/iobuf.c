@@ -113,6 +113,8 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
 	iobuf->head = data;
 	iobuf->data = iobuf->tail = ( data + headroom );
 	iobuf->end = ( data + len );
+	iobuf->csum = IOB_CSUM_NONE;
+	iobuf->gso = IOB_GSO_NONE;
 
 	return iobuf;
 }
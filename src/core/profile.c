@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
 #include <limits.h>
 #include <assert.h>
@@ -40,6 +41,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * these statistics need not be completely accurate; it is sufficient
  * to give a rough approximation.
  *
+ * The profiler also records the minimum and maximum sample values,
+ * and maintains a log-linear histogram from which approximate
+ * percentiles may be obtained.
+ *
  * The algorithm for updating the mean and variance estimators is from
  * The Art of Computer Programming (via Wikipedia), with adjustments
  * to avoid the use of floating-point instructions.
@@ -48,6 +53,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Accumulated time excluded from profiling */
 unsigned long profile_excluded;
 
+/** List of dynamically registered profilers */
+LIST_HEAD ( profilers );
+
 /**
  * Format a hex fraction (for debugging)
  *
@@ -101,6 +109,49 @@ static inline unsigned int profile_accvar_shift ( struct profiler *profiler ) {
 		 - profiler->accvar_msb );
 }
 
+/**
+ * Identify histogram bucket for a sample value
+ *
+ * @v sample		Sample value
+ * @ret bucket		Histogram bucket
+ */
+static unsigned int profile_bucket ( unsigned long sample ) {
+	unsigned int msb;
+	unsigned int bucket;
+
+	/* Small values each have their own bucket */
+	if ( sample < PROFILE_SUB_BUCKETS )
+		return sample;
+
+	/* Identify power of two, and linear sub-bucket within it */
+	msb = ( flsl ( sample ) - 1 );
+	bucket = ( ( ( msb - PROFILE_SUB_BUCKETS_LOG2 + 1 ) *
+		     PROFILE_SUB_BUCKETS ) +
+		   ( ( sample >> ( msb - PROFILE_SUB_BUCKETS_LOG2 ) ) &
+		     ( PROFILE_SUB_BUCKETS - 1 ) ) );
+	if ( bucket >= PROFILE_BUCKETS )
+		bucket = ( PROFILE_BUCKETS - 1 );
+	return bucket;
+}
+
+/**
+ * Get lowest sample value within histogram bucket
+ *
+ * @v bucket		Histogram bucket
+ * @ret sample		Lowest sample value
+ */
+static unsigned long profile_bucket_min ( unsigned int bucket ) {
+	unsigned int octave = ( bucket / PROFILE_SUB_BUCKETS );
+	unsigned int sub = ( bucket % PROFILE_SUB_BUCKETS );
+
+	/* Small values each have their own bucket */
+	if ( ! octave )
+		return bucket;
+
+	return ( ( ( unsigned long ) ( PROFILE_SUB_BUCKETS + sub ) )
+		 << ( octave - 1 ) );
+}
+
 /**
  * Update profiler with a new sample
  *
@@ -117,12 +168,23 @@ void profile_update ( struct profiler *profiler, unsigned long sample ) {
 	unsigned int accvar_delta_shift;
 	unsigned int accvar_delta_msb;
 	unsigned int accvar_shift;
+	unsigned int bucket;
 
 	/* Our scaling logic assumes that sample values never overflow
 	 * a signed long (i.e. that the high bit is always zero).
 	 */
 	assert ( ( ( signed ) sample ) >= 0 );
 
+	/* Update minimum and maximum sample values */
+	if ( ( ! profiler->count ) || ( sample < profiler->min ) )
+		profiler->min = sample;
+	if ( ( ! profiler->count ) || ( sample > profiler->max ) )
+		profiler->max = sample;
+
+	/* Update histogram */
+	bucket = profile_bucket ( sample );
+	profiler->hist[bucket]++;
+
 	/* Update sample count, limiting to avoid signed overflow */
 	if ( profiler->count < INT_MAX )
 		profiler->count++;
@@ -276,3 +338,98 @@ unsigned long profile_stddev ( struct profiler *profiler ) {
 
 	return isqrt ( profile_variance ( profiler ) );
 }
+
+/**
+ * Get approximate sample percentile
+ *
+ * @v profiler		Profiler
+ * @v percent		Percentile
+ * @ret value		Approximate sample value at percentile
+ *
+ * The value is interpolated linearly within the histogram bucket
+ * containing the requested percentile, with the bucket bounds first
+ * clamped to the observed range of sample values.
+ */
+unsigned long profile_percentile ( struct profiler *profiler,
+				   unsigned int percent ) {
+	unsigned long long threshold;
+	unsigned long long total = 0;
+	unsigned long long rank;
+	unsigned long low;
+	unsigned long high;
+	unsigned int count;
+	unsigned int bucket;
+
+	/* Percentile is zero if no samples exist */
+	if ( ! profiler->count )
+		return 0;
+
+	/* Calculate number of samples lying at or below percentile */
+	threshold = ( ( ( ( unsigned long long ) profiler->count ) * percent
+			+ 99 ) / 100 );
+	if ( ! threshold )
+		threshold = 1;
+
+	/* Find bucket containing percentile */
+	for ( bucket = 0 ; bucket < ( PROFILE_BUCKETS - 1 ) ; bucket++ ) {
+		if ( ( total + profiler->hist[bucket] ) >= threshold )
+			break;
+		total += profiler->hist[bucket];
+	}
+	count = profiler->hist[bucket];
+	if ( ! count )
+		return profiler->max;
+
+	/* Calculate bucket bounds, clamped to observed range */
+	low = profile_bucket_min ( bucket );
+	if ( low < profiler->min )
+		low = profiler->min;
+	high = ( ( bucket < ( PROFILE_BUCKETS - 1 ) ) ?
+		 ( profile_bucket_min ( bucket + 1 ) - 1 ) : profiler->max );
+	if ( high > profiler->max )
+		high = profiler->max;
+
+	/* Interpolate within bucket */
+	rank = ( threshold - total );
+	return ( low + ( ( ( ( high - low + 1ULL ) * rank ) - 1 ) / count ) );
+}
+
+/**
+ * Format profiling statistics in machine-readable form
+ *
+ * @v profiler		Profiler
+ * @v buf		Buffer
+ * @v len		Length of buffer
+ * @ret len		Length of formatted statistics
+ *
+ * The statistics are formatted as a single line of space-separated
+ * fields: name, sample count, minimum, median, 90th percentile, 99th
+ * percentile, maximum, mean, and standard deviation.
+ */
+int profile_format ( struct profiler *profiler, char *buf, size_t len ) {
+
+	return snprintf ( buf, len, "%s %d %ld %ld %ld %ld %ld %ld %ld",
+			  profiler->name, profiler->count, profiler->min,
+			  profile_percentile ( profiler, 50 ),
+			  profile_percentile ( profiler, 90 ),
+			  profile_percentile ( profiler, 99 ),
+			  profiler->max, profile_mean ( profiler ),
+			  profile_stddev ( profiler ) );
+}
+
+/**
+ * Reset profiler
+ *
+ * @v profiler		Profiler
+ */
+void profile_reset ( struct profiler *profiler ) {
+
+	profiler->count = 0;
+	profiler->mean = 0;
+	profiler->mean_msb = 0;
+	profiler->accvar = 0;
+	profiler->accvar_msb = 0;
+	profiler->min = 0;
+	profiler->max = 0;
+	memset ( profiler->hist, 0, sizeof ( profiler->hist ) );
+}
@@ -82,6 +82,30 @@ LIST_HEAD ( san_devices );
 /** Number of times to retry commands */
 static unsigned long san_retries = SAN_DEFAULT_RETRIES;
 
+/** Multipath policy for newly created SAN devices */
+static unsigned int san_policy = SAN_POLICY_FAILOVER;
+
+/** SAN multipath policy names */
+static const char *san_policy_names[] = {
+	[SAN_POLICY_FAILOVER] = "failover",
+	[SAN_POLICY_ROUND_ROBIN] = "round-robin",
+	[SAN_POLICY_LEAST_OUTSTANDING] = "least-outstanding",
+};
+
+/**
+ * Get SAN multipath policy name
+ *
+ * @v policy		Multipath policy
+ * @ret name		Policy name
+ */
+const char * san_policy_name ( unsigned int policy ) {
+
+	if ( policy >= ( sizeof ( san_policy_names ) /
+			 sizeof ( san_policy_names[0] ) ) )
+		return "<UNKNOWN>";
+	return san_policy_names[policy];
+}
+
 /**
  * Find SAN device by drive number
  *
@@ -125,6 +149,8 @@ static void sandev_free ( struct refcnt *refcnt ) {
 	unsigned int i;
 
 	assert ( ! timer_running ( &sandev->timer ) );
+	for ( i = 0 ; i < SAN_MAX_FRAGMENTS ; i++ )
+		assert ( ! timer_running ( &sandev->frag[i].timer ) );
 	assert ( ! sandev->active );
 	assert ( list_empty ( &sandev->opened ) );
 	for ( i = 0 ; i < sandev->paths ; i++ ) {
@@ -134,6 +160,44 @@ static void sandev_free ( struct refcnt *refcnt ) {
 	free ( sandev );
 }
 
+/**
+ * Record start of SAN path command
+ *
+ * @v sanpath		SAN path
+ * @ret started		Start time (in ticks)
+ */
+static unsigned long sanpath_started ( struct san_path *sanpath ) {
+
+	/* Update statistics */
+	sanpath->stats.outstanding++;
+
+	return currticks();
+}
+
+/**
+ * Record completion of SAN path command
+ *
+ * @v sanpath		SAN path
+ * @v started		Start time (in ticks)
+ * @v rc		Command status
+ */
+static void sanpath_completed ( struct san_path *sanpath,
+				unsigned long started, int rc ) {
+	unsigned long elapsed = ( currticks() - started );
+
+	/* Update statistics */
+	assert ( sanpath->stats.outstanding > 0 );
+	sanpath->stats.outstanding--;
+	if ( rc != 0 ) {
+		sanpath->stats.errors++;
+		return;
+	}
+	sanpath->stats.commands++;
+	sanpath->stats.ticks += elapsed;
+	if ( elapsed > sanpath->stats.max_ticks )
+		sanpath->stats.max_ticks = elapsed;
+}
+
 /**
  * Close SAN device command
  *
@@ -189,6 +253,51 @@ static void sandev_command_expired ( struct retry_timer *timer,
 	sandev_command_close ( sandev, -ETIMEDOUT );
 }
 
+/**
+ * Close SAN device read/write fragment
+ *
+ * @v frag		SAN device read/write fragment
+ * @v rc		Reason for close
+ */
+static void sanfrag_close ( struct san_fragment *frag, int rc ) {
+
+	/* Stop timer */
+	stop_timer ( &frag->timer );
+
+	/* Restart interface */
+	intf_restart ( &frag->command, rc );
+
+	/* Record fragment status */
+	frag->rc = rc;
+
+	/* Update path statistics */
+	if ( frag->sanpath ) {
+		sanpath_completed ( frag->sanpath, frag->started, rc );
+		frag->sanpath = NULL;
+	}
+}
+
+/** SAN device read/write fragment command interface operations */
+static struct interface_operation sanfrag_command_op[] = {
+	INTF_OP ( intf_close, struct san_fragment *, sanfrag_close ),
+};
+
+/** SAN device read/write fragment command interface descriptor */
+static struct interface_descriptor sanfrag_command_desc =
+	INTF_DESC ( struct san_fragment, command, sanfrag_command_op );
+
+/**
+ * Handle SAN device read/write fragment timeout
+ *
+ * @v retry		Retry timer
+ */
+static void sanfrag_expired ( struct retry_timer *timer, int over __unused ) {
+	struct san_fragment *frag =
+		container_of ( timer, struct san_fragment, timer );
+
+	sanfrag_close ( frag, -ETIMEDOUT );
+}
+
 /**
  * Open SAN path
  *
@@ -239,6 +348,8 @@ static int sanpath_open ( struct san_path *sanpath ) {
  */
 static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	struct san_device *sandev = sanpath->sandev;
+	struct san_fragment *frag;
+	unsigned int i;
 
 	/* Record status */
 	sanpath->path_rc = rc;
@@ -258,6 +369,25 @@ static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	} else {
 		intf_restart ( &sanpath->block, rc );
 	}
+
+	/* Close any fragments using this path */
+	for ( i = 0 ; i < SAN_MAX_FRAGMENTS ; i++ ) {
+		frag = &sandev->frag[i];
+		if ( frag->sanpath == sanpath )
+			sanfrag_close ( frag, rc );
+	}
+
+	/* Fail over to another available path, if any */
+	if ( ! sandev->active ) {
+		list_for_each_entry ( sanpath, &sandev->opened, list ) {
+			if ( sanpath->path_rc != 0 )
+				continue;
+			DBGC ( sandev->drive, "SAN %#02x.%d is active\n",
+			       sandev->drive, sanpath->index );
+			sandev->active = sanpath;
+			break;
+		}
+	}
 }
 
 /**
@@ -305,6 +435,10 @@ static void sanpath_step ( struct san_path *sanpath ) {
 	if ( sanpath == sandev->active )
 		return;
 
+	/* Ignore if we are already an available path */
+	if ( sanpath->path_rc == 0 )
+		return;
+
 	/* Wait until path has become available */
 	if ( ! xfer_window ( &sanpath->block ) )
 		return;
@@ -312,11 +446,16 @@ static void sanpath_step ( struct san_path *sanpath ) {
 	/* Record status */
 	sanpath->path_rc = 0;
 
-	/* Mark as active path or close as applicable */
+	/* Mark as active path, leave open for load balancing, or
+	 * close as applicable.
+	 */
 	if ( ! sandev->active ) {
 		DBGC ( sandev->drive, "SAN %#02x.%d is active\n",
 		       sandev->drive, sanpath->index );
 		sandev->active = sanpath;
+	} else if ( sandev->policy != SAN_POLICY_FAILOVER ) {
+		DBGC ( sandev->drive, "SAN %#02x.%d is available for load "
+		       "balancing\n", sandev->drive, sanpath->index );
 	} else {
 		DBGC ( sandev->drive, "SAN %#02x.%d is available\n",
 		       sandev->drive, sanpath->index );
@@ -511,6 +650,8 @@ sandev_command ( struct san_device *sandev,
 		 int ( * command ) ( struct san_device *sandev,
 				     const union san_command_params *params ),
 		 const union san_command_params *params ) {
+	struct san_path *sanpath;
+	unsigned long started;
 	unsigned int retries = 0;
 	int rc;
 
@@ -538,7 +679,10 @@ sandev_command ( struct san_device *sandev,
 		}
 
 		/* Initiate command */
+		sanpath = sandev->active;
+		started = sanpath_started ( sanpath );
 		if ( ( rc = command ( sandev, params ) ) != 0 ) {
+			sanpath_completed ( sanpath, started, rc );
 			retries++;
 			continue;
 		}
@@ -551,7 +695,9 @@ sandev_command ( struct san_device *sandev,
 			step();
 
 		/* Check command status */
-		if ( ( rc = sandev->command_rc ) != 0 ) {
+		rc = sandev->command_rc;
+		sanpath_completed ( sanpath, started, rc );
+		if ( rc != 0 ) {
 			retries++;
 			continue;
 		}
@@ -584,6 +730,96 @@ int sandev_reset ( struct san_device *sandev ) {
 	return 0;
 }
 
+/**
+ * Initiate SAN device read/write fragment
+ *
+ * @v frag		SAN device read/write fragment
+ * @v sanpath		SAN path
+ * @v block_rw		Block read/write method
+ * @ret rc		Return status code
+ */
+static int sanfrag_rw ( struct san_fragment *frag, struct san_path *sanpath,
+			int ( * block_rw ) ( struct interface *control,
+					     struct interface *data,
+					     uint64_t lba, unsigned int count,
+					     void *buffer, size_t len ) ) {
+	struct san_device *sandev = frag->sandev;
+	size_t len = ( frag->count * sandev->capacity.blksize );
+	int rc;
+
+	/* Sanity check */
+	assert ( frag->sanpath == NULL );
+	assert ( ! timer_running ( &frag->timer ) );
+
+	/* Record path, and continue round-robin distribution from the
+	 * following path.
+	 */
+	frag->sanpath = sanpath;
+	frag->started = sanpath_started ( sanpath );
+	sandev->next = ( ( sanpath->index + 1 ) % sandev->paths );
+
+	/* Start expiry timer.  Do this before initiating the command,
+	 * since the command may complete immediately.
+	 */
+	frag->rc = -EINPROGRESS;
+	start_timer_fixed ( &frag->timer, SAN_COMMAND_TIMEOUT );
+
+	/* Initiate read/write command */
+	if ( ( rc = block_rw ( &sanpath->block, &frag->command, frag->lba,
+			       frag->count, frag->buffer, len ) ) != 0 ) {
+		DBGC ( sandev->drive, "SAN %#02x.%d could not initiate "
+		       "read/write fragment: %s\n", sandev->drive,
+		       sanpath->index, strerror ( rc ) );
+		sanfrag_close ( frag, rc );
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Select SAN path for a concurrent read/write fragment
+ *
+ * @v sandev		SAN device
+ * @ret sanpath		SAN path, or NULL if no path can accept a fragment
+ */
+static struct san_path * sandev_rw_path ( struct san_device *sandev ) {
+	struct san_path *sanpath;
+	struct san_path *best = NULL;
+	unsigned int score;
+	unsigned int best_score = 0;
+
+	/* Do nothing if device needs to be reopened */
+	if ( sandev_needs_reopen ( sandev ) )
+		return NULL;
+
+	/* Use only the active path unless load balancing */
+	if ( sandev->policy == SAN_POLICY_FAILOVER ) {
+		sanpath = sandev->active;
+		return ( xfer_window ( &sanpath->block ) ? sanpath : NULL );
+	}
+
+	/* Select best available path according to policy */
+	list_for_each_entry ( sanpath, &sandev->opened, list ) {
+		if ( sanpath->path_rc != 0 )
+			continue;
+		if ( ! xfer_window ( &sanpath->block ) )
+			continue;
+		if ( sandev->policy == SAN_POLICY_LEAST_OUTSTANDING ) {
+			score = sanpath->stats.outstanding;
+		} else {
+			score = ( ( sanpath->index + sandev->paths -
+				    sandev->next ) % sandev->paths );
+		}
+		if ( ( ! best ) || ( score < best_score ) ) {
+			best = sanpath;
+			best_score = score;
+		}
+	}
+
+	return best;
+}
+
 /**
  * Read from or write to SAN device
  *
@@ -593,6 +829,13 @@ int sandev_reset ( struct san_device *sandev ) {
  * @v buffer		Data buffer
  * @v block_rw		Block read/write method
  * @ret rc		Return status code
+ *
+ * The request is split into fragments of at most the device's
+ * maximum transfer size.  As many fragments as the available paths'
+ * flow control windows permit (up to SAN_MAX_FRAGMENTS) are issued
+ * concurrently, and fragments are completed in order.  A failed
+ * fragment is retried individually via sandev_command(), which will
+ * reopen the device if necessary.
  */
 static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 		       unsigned int count, void *buffer,
@@ -601,37 +844,116 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 					    uint64_t lba, unsigned int count,
 					    void *buffer, size_t len ) ) {
 	union san_command_params params;
+	struct san_fragment *frag;
+	struct san_path *sanpath;
+	unsigned int max_count = sandev->capacity.max_count;
 	unsigned int remaining;
+	unsigned int frag_count;
+	unsigned int prod = 0;
+	unsigned int cons = 0;
 	size_t frag_len;
 	int rc;
 
 	/* Initialise command parameters */
 	params.rw.block_rw = block_rw;
-	params.rw.buffer = buffer;
-	params.rw.lba = ( lba << sandev->blksize_shift );
-	params.rw.count = sandev->capacity.max_count;
+	lba <<= sandev->blksize_shift;
 	remaining = ( count << sandev->blksize_shift );
 
+	/* Unquiesce system */
+	unquiesce();
+
 	/* Read/write fragments */
-	while ( remaining ) {
+	do {
 
-		/* Determine fragment length */
-		if ( params.rw.count > remaining )
-			params.rw.count = remaining;
+		/* Issue as many concurrent fragments as possible */
+		while ( remaining &&
+			( ( prod - cons ) < SAN_MAX_FRAGMENTS ) &&
+			( ( sanpath = sandev_rw_path ( sandev ) ) != NULL ) ) {
 
-		/* Execute command */
-		if ( ( rc = sandev_command ( sandev, sandev_command_rw,
-					     &params ) ) != 0 )
-			return rc;
+			/* Initiate fragment (deferring any failure
+			 * until the fragment is completed)
+			 */
+			frag_count = ( ( max_count < remaining ) ?
+				       max_count : remaining );
+			frag = &sandev->frag[ prod++ % SAN_MAX_FRAGMENTS ];
+			frag->lba = lba;
+			frag->count = frag_count;
+			frag->buffer = buffer;
+			sanfrag_rw ( frag, sanpath, block_rw );
+
+			/* Move to next fragment */
+			frag_len = ( sandev->capacity.blksize * frag_count );
+			buffer += frag_len;
+			lba += frag_count;
+			remaining -= frag_count;
+		}
 
-		/* Move to next fragment */
-		frag_len = ( sandev->capacity.blksize * params.rw.count );
-		params.rw.buffer += frag_len;
-		params.rw.lba += params.rw.count;
-		remaining -= params.rw.count;
-	}
+		/* Complete fragments in order */
+		while ( prod != cons ) {
+
+			/* Stop at first incomplete fragment */
+			frag = &sandev->frag[ cons % SAN_MAX_FRAGMENTS ];
+			if ( timer_running ( &frag->timer ) )
+				break;
+
+			/* Retry failed fragment individually */
+			if ( frag->rc != 0 ) {
+				DBGC ( sandev->drive, "SAN %#02x retrying "
+				       "fragment %#llx+%#x: %s\n",
+				       sandev->drive,
+				       ( ( unsigned long long ) frag->lba ),
+				       frag->count, strerror ( frag->rc ) );
+				params.rw.lba = frag->lba;
+				params.rw.count = frag->count;
+				params.rw.buffer = frag->buffer;
+				if ( ( rc = sandev_command ( sandev,
+							     sandev_command_rw,
+							     &params ) ) != 0 )
+					goto err_rw;
+			}
+
+			/* Mark fragment as idle */
+			frag->count = 0;
+			cons++;
+		}
+
+		/* Wait for any outstanding fragments */
+		if ( prod != cons ) {
+			step();
+			continue;
+		}
+
+		/* If no fragments could be issued concurrently (e.g.
+		 * because the device needs to be reopened), then
+		 * execute the next fragment individually.
+		 */
+		if ( remaining && ! sandev_rw_path ( sandev ) ) {
+			frag_count = ( ( max_count < remaining ) ?
+				       max_count : remaining );
+			params.rw.lba = lba;
+			params.rw.count = frag_count;
+			params.rw.buffer = buffer;
+			if ( ( rc = sandev_command ( sandev, sandev_command_rw,
+						     &params ) ) != 0 )
+				return rc;
+			frag_len = ( sandev->capacity.blksize * frag_count );
+			buffer += frag_len;
+			lba += frag_count;
+			remaining -= frag_count;
+		}
+
+	} while ( remaining || ( prod != cons ) );
 
 	return 0;
+
+ err_rw:
+	/* Abort any outstanding fragments */
+	for ( ; cons != prod ; cons++ ) {
+		frag = &sandev->frag[ cons % SAN_MAX_FRAGMENTS ];
+		sanfrag_close ( frag, rc );
+		frag->count = 0;
+	}
+	return rc;
 }
 
 /**
@@ -837,6 +1159,7 @@ struct san_device * alloc_sandev ( struct uri **uris, unsigned int count,
 				   size_t priv_size ) {
 	struct san_device *sandev;
 	struct san_path *sanpath;
+	struct san_fragment *frag;
 	size_t size;
 	unsigned int i;
 
@@ -848,8 +1171,16 @@ struct san_device * alloc_sandev ( struct uri **uris, unsigned int count,
 	ref_init ( &sandev->refcnt, sandev_free );
 	intf_init ( &sandev->command, &sandev_command_desc, &sandev->refcnt );
 	timer_init ( &sandev->timer, sandev_command_expired, &sandev->refcnt );
+	for ( i = 0 ; i < SAN_MAX_FRAGMENTS ; i++ ) {
+		frag = &sandev->frag[i];
+		frag->sandev = sandev;
+		intf_init ( &frag->command, &sanfrag_command_desc,
+			    &sandev->refcnt );
+		timer_init ( &frag->timer, sanfrag_expired, &sandev->refcnt );
+	}
 	sandev->priv = ( ( ( void * ) sandev ) + size );
 	sandev->paths = count;
+	sandev->policy = san_policy;
 	INIT_LIST_HEAD ( &sandev->opened );
 	INIT_LIST_HEAD ( &sandev->closed );
 	for ( i = 0 ; i < count ; i++ ) {
@@ -989,12 +1320,22 @@ const struct setting san_retries_setting __setting ( SETTING_SANBOOT_EXTRA,
 	.type = &setting_type_int8,
 };
 
+/** The "san-policy" setting */
+const struct setting san_policy_setting __setting ( SETTING_SANBOOT_EXTRA,
+						    san-policy ) = {
+	.name = "san-policy",
+	.description = "SAN multipath policy",
+	.type = &setting_type_string,
+};
+
 /**
  * Apply SAN boot settings
  *
  * @ret rc		Return status code
  */
 static int sandev_apply ( void ) {
+	char *name;
+	unsigned int i;
 
 	/* Apply "san-retries" setting */
 	if ( fetch_uint_setting ( NULL, &san_retries_setting,
@@ -1002,6 +1343,22 @@ static int sandev_apply ( void ) {
 		san_retries = SAN_DEFAULT_RETRIES;
 	}
 
+	/* Apply "san-policy" setting */
+	san_policy = SAN_POLICY_FAILOVER;
+	fetch_string_setting_copy ( NULL, &san_policy_setting, &name );
+	if ( name ) {
+		for ( i = 0 ; i < ( sizeof ( san_policy_names ) /
+				    sizeof ( san_policy_names[0] ) ) ; i++ ) {
+			if ( strcmp ( name, san_policy_names[i] ) == 0 )
+				san_policy = i;
+		}
+		if ( strcmp ( name, san_policy_names[san_policy] ) != 0 ) {
+			DBGC ( &san_policy, "SAN unknown multipath policy "
+			       "\"%s\"\n", name );
+		}
+	}
+	free ( name );
+
 	return 0;
 }
 
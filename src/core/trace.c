@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Boot phase timeline tracing
+ *
+ * Trace events are recorded into a fixed-size ring and exported in a
+ * compact text format, one line per event:
+ *
+ *     trace <version> <events> <dropped> <ticks per second>
+ *     trace <name> <ticks> <clocks> <rc>
+ *
+ * where <ticks> is the system timer offset from the first recorded
+ * event, and <clocks> is the profiler clock delta from the preceding
+ * event.  The profiler clock is architecture-specific (and may be
+ * only 32 bits wide), and so is suitable only for measuring the
+ * duration of individual phases.
+ *
+ * The trace is exported each time an image is executed.  Exported
+ * events are discarded, so that each export contains only the events
+ * recorded since the previous export.  Events are not recorded while
+ * the trace is being uploaded, since the upload itself would
+ * otherwise generate DNS, TCP, TLS and download events.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+#include <ipxe/vsprintf.h>
+#include <ipxe/timer.h>
+#include <ipxe/profile.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/xfer.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/uri.h>
+#include <ipxe/http.h>
+#include <ipxe/monojob.h>
+#include <ipxe/settings.h>
+#include <ipxe/trace.h>
+
+/** Trace export format version */
+#define TRACE_VERSION 1
+
+/** Trace event ring */
+static struct trace_event trace_events[TRACE_EVENTS];
+
+/** Number of trace events recorded since the last export */
+static unsigned int trace_count;
+
+/** System timer ticks at first recorded event */
+static unsigned long trace_epoch;
+
+/** Trace recording has started */
+static int trace_started;
+
+/** Trace recording is suspended */
+static int trace_suspended;
+
+/** Trace export URI setting */
+const struct setting trace_uri_setting __setting ( SETTING_MISC, trace-uri ) = {
+	.name = "trace-uri",
+	.description = "Boot trace upload URI",
+	.type = &setting_type_string,
+};
+
+/**
+ * Record trace event
+ *
+ * @v name		Event name (must be a static string)
+ * @v rc		Status code
+ */
+void trace_record ( const char *name, int rc ) {
+	struct trace_event *event;
+	unsigned long ticks;
+
+	/* Do nothing while recording is suspended */
+	if ( trace_suspended )
+		return;
+
+	/* Record epoch on first event */
+	ticks = currticks();
+	if ( ! trace_started ) {
+		trace_epoch = ticks;
+		trace_started = 1;
+	}
+
+	/* Overwrite oldest event if ring is full */
+	event = &trace_events[ trace_count++ % TRACE_EVENTS ];
+	event->name = name;
+	event->ticks = ticks;
+	event->timestamp = profile_timestamp();
+	event->rc = rc;
+}
+
+/**
+ * Format trace events
+ *
+ * @v buf		Buffer
+ * @v len		Length of buffer
+ * @ret len		Length of formatted trace
+ */
+size_t trace_format ( char *buf, size_t len ) {
+	struct trace_event *prev;
+	struct trace_event *event;
+	unsigned int dropped;
+	unsigned int count;
+	unsigned int i;
+	size_t used;
+
+	/* Identify retained events */
+	count = trace_count;
+	dropped = 0;
+	if ( count > TRACE_EVENTS ) {
+		dropped = ( count - TRACE_EVENTS );
+		count = TRACE_EVENTS;
+	}
+
+	/* Format header */
+	used = ssnprintf ( buf, len, "trace %d %u %u %d\n", TRACE_VERSION,
+			   count, dropped, TICKS_PER_SEC );
+
+	/* Format events */
+	prev = &trace_events[ dropped % TRACE_EVENTS ];
+	for ( i = 0 ; i < count ; i++ ) {
+		event = &trace_events[ ( dropped + i ) % TRACE_EVENTS ];
+		used += ssnprintf ( ( buf + used ), ( len - used ),
+				    "trace %s %lu %lu %d\n", event->name,
+				    ( event->ticks - trace_epoch ),
+				    ( event->timestamp - prev->timestamp ),
+				    event->rc );
+		prev = event;
+	}
+
+	return used;
+}
+
+/** A trace upload */
+struct trace_upload {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Job control interface */
+	struct interface job;
+	/** Data transfer interface */
+	struct interface xfer;
+};
+
+/**
+ * Close trace upload
+ *
+ * @v upload		Trace upload
+ * @v rc		Reason for close
+ */
+static void trace_upload_close ( struct trace_upload *upload, int rc ) {
+
+	/* Shut down interfaces */
+	intf_shutdown ( &upload->xfer, rc );
+	intf_shutdown ( &upload->job, rc );
+}
+
+/**
+ * Receive trace upload response
+ *
+ * @v upload		Trace upload
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int trace_upload_deliver ( struct trace_upload *upload __unused,
+				  struct io_buffer *iobuf,
+				  struct xfer_metadata *meta __unused ) {
+
+	/* Discard response body */
+	free_iob ( iobuf );
+	return 0;
+}
+
+/** Trace upload data transfer interface operations */
+static struct interface_operation trace_upload_xfer_operations[] = {
+	INTF_OP ( xfer_deliver, struct trace_upload *, trace_upload_deliver ),
+	INTF_OP ( intf_close, struct trace_upload *, trace_upload_close ),
+};
+
+/** Trace upload data transfer interface descriptor */
+static struct interface_descriptor trace_upload_xfer_desc =
+	INTF_DESC ( struct trace_upload, xfer, trace_upload_xfer_operations );
+
+/** Trace upload job control interface operations */
+static struct interface_operation trace_upload_job_operations[] = {
+	INTF_OP ( intf_close, struct trace_upload *, trace_upload_close ),
+};
+
+/** Trace upload job control interface descriptor */
+static struct interface_descriptor trace_upload_job_desc =
+	INTF_DESC ( struct trace_upload, job, trace_upload_job_operations );
+
+/**
+ * Upload trace via HTTP POST
+ *
+ * @v uri_string	URI string
+ * @v data		Formatted trace
+ * @v len		Length of formatted trace
+ * @ret rc		Return status code
+ */
+static int trace_upload ( const char *uri_string, const void *data,
+			  size_t len ) {
+	struct http_request_content content;
+	struct trace_upload *upload;
+	struct uri *uri;
+	int rc;
+
+	/* Parse URI */
+	uri = parse_uri ( uri_string );
+	if ( ! uri ) {
+		rc = -ENOMEM;
+		goto err_uri;
+	}
+
+	/* Allocate and initialise structure */
+	upload = zalloc ( sizeof ( *upload ) );
+	if ( ! upload ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	ref_init ( &upload->refcnt, NULL );
+	intf_init ( &upload->job, &trace_upload_job_desc, &upload->refcnt );
+	intf_init ( &upload->xfer, &trace_upload_xfer_desc, &upload->refcnt );
+
+	/* Construct POST request content (copied by HTTP core) */
+	memset ( &content, 0, sizeof ( content ) );
+	content.type = "text/plain";
+	content.data = data;
+	content.len = len;
+
+	/* Initiate HTTP POST */
+	if ( ( rc = http_open ( &upload->xfer, &http_post, uri, NULL,
+				&content ) ) != 0 ) {
+		DBGC ( upload, "TRACE %p could not open %s: %s\n",
+		       upload, uri_string, strerror ( rc ) );
+		goto err_open;
+	}
+
+	/* Attach to parent interface, mortalise self, and wait */
+	intf_plug_plug ( &upload->job, &monojob );
+	ref_put ( &upload->refcnt );
+	uri_put ( uri );
+	return monojob_wait ( NULL, TRACE_UPLOAD_TIMEOUT );
+
+ err_open:
+	trace_upload_close ( upload, rc );
+	ref_put ( &upload->refcnt );
+ err_alloc:
+	uri_put ( uri );
+ err_uri:
+	return rc;
+}
+
+/**
+ * Export trace events
+ *
+ * Trace events are written to the system log, and uploaded via HTTP
+ * POST if a trace URI is configured.  Exported events are then
+ * discarded.  Events are retained if the upload fails, so that they
+ * may be included in a subsequent export.
+ */
+void trace_export ( void ) {
+	char *uri_string;
+	char *buf;
+	size_t len;
+	int rc = 0;
+
+	/* Do nothing if there are no new events */
+	if ( ! trace_count )
+		return;
+
+	/* Format trace */
+	len = trace_format ( NULL, 0 );
+	buf = malloc ( len + 1 /* NUL */ );
+	if ( ! buf )
+		return;
+	trace_format ( buf, ( len + 1 /* NUL */ ) );
+
+	/* Write to system log */
+	log_printf ( "%s", buf );
+
+	/* Upload trace, if applicable */
+	fetch_string_setting_copy ( NULL, &trace_uri_setting, &uri_string );
+	if ( uri_string ) {
+		trace_suspended = 1;
+		if ( ( rc = trace_upload ( uri_string, buf, len ) ) != 0 ) {
+			DBG ( "TRACE could not upload to %s: %s\n",
+			      uri_string, strerror ( rc ) );
+		}
+		trace_suspended = 0;
+		free ( uri_string );
+	}
+
+	/* Discard exported events */
+	if ( rc == 0 )
+		trace_count = 0;
+
+	free ( buf );
+}
@@ -83,7 +83,7 @@ void xferbuf_free ( struct xfer_buffer *xferbuf ) {
  * @v len		Required minimum size
  * @ret rc		Return status code
  */
-static int xferbuf_ensure_size ( struct xfer_buffer *xferbuf, size_t len ) {
+int xferbuf_ensure_size ( struct xfer_buffer *xferbuf, size_t len ) {
 	int rc;
 
 	/* If buffer is already large enough, do nothing */
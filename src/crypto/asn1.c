@@ -646,6 +646,48 @@ int asn1_signature_algorithm ( const struct asn1_cursor *cursor,
 	return 0;
 }
 
+/**
+ * Parse ASN.1 OID-identified elliptic curve algorithm
+ *
+ * @v cursor		ASN.1 object cursor (positioned at a bare OID)
+ * @ret algorithm	Algorithm
+ * @ret rc		Return status code
+ *
+ * Elliptic curves are identified within algorithm parameters (such
+ * as the id-ecPublicKey namedCurve parameter) by a bare OID, rather
+ * than by an AlgorithmIdentifier sequence.
+ */
+int asn1_curve_algorithm ( const struct asn1_cursor *cursor,
+			   struct asn1_algorithm **algorithm ) {
+	struct asn1_cursor contents;
+
+	/* Enter curve identifier */
+	memcpy ( &contents, cursor, sizeof ( contents ) );
+	if ( asn1_enter ( &contents, ASN1_OID ) != 0 ) {
+		DBGC ( cursor, "ASN1 %p cannot locate curve OID:\n", cursor );
+		DBGC_HDA ( cursor, 0, cursor->data, cursor->len );
+		return -EINVAL_ASN1_ALGORITHM;
+	}
+
+	/* Identify algorithm */
+	*algorithm = asn1_find_algorithm ( &contents );
+	if ( ! *algorithm ) {
+		DBGC ( cursor, "ASN1 %p unrecognised curve:\n", cursor );
+		DBGC_HDA ( cursor, 0, cursor->data, cursor->len );
+		return -ENOTSUP_ALGORITHM;
+	}
+
+	/* Check algorithm has an elliptic curve */
+	if ( ! (*algorithm)->curve ) {
+		DBGC ( cursor, "ASN1 %p algorithm %s is not an elliptic curve "
+		       "algorithm:\n", cursor, (*algorithm)->name );
+		DBGC_HDA ( cursor, 0, cursor->data, cursor->len );
+		return -ENOTTY_ALGORITHM;
+	}
+
+	return 0;
+}
+
 /**
  * Check ASN.1 OID-identified algorithm
  *
@@ -0,0 +1,539 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Elliptic Curve Digital Signature Algorithm (ECDSA)
+ *
+ * ECDSA is documented in FIPS 186-5 and (for use within X.509
+ * certificates) in RFC 5480.  Only signature verification is
+ * supported.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/asn1.h>
+#include <ipxe/crypto.h>
+#include <ipxe/bigint.h>
+#include <ipxe/ecdsa.h>
+
+/* Disambiguate the various error causes */
+#define EACCES_VERIFY \
+	__einfo_error ( EINFO_EACCES_VERIFY )
+#define EINFO_EACCES_VERIFY \
+	__einfo_uniqify ( EINFO_EACCES, 0x01, "ECDSA signature incorrect" )
+#define EINVAL_POINT \
+	__einfo_error ( EINFO_EINVAL_POINT )
+#define EINFO_EINVAL_POINT \
+	__einfo_uniqify ( EINFO_EINVAL, 0x01, "Invalid public key point" )
+#define EINVAL_SIGNATURE \
+	__einfo_error ( EINFO_EINVAL_SIGNATURE )
+#define EINFO_EINVAL_SIGNATURE \
+	__einfo_uniqify ( EINFO_EINVAL, 0x02, "Invalid signature encoding" )
+#define ENOTSUP_CURVE \
+	__einfo_error ( EINFO_ENOTSUP_CURVE )
+#define EINFO_ENOTSUP_CURVE \
+	__einfo_uniqify ( EINFO_ENOTSUP, 0x01, "Unsupported curve" )
+
+/**
+ * Calculate maximum length of an ECDSA signature
+ *
+ * @v keysize		Scalar size
+ * @ret len		Maximum length of DER-encoded signature
+ *
+ * The signature is a SEQUENCE containing two INTEGERs, each of which
+ * may require a leading zero byte.  For all supported curves, the
+ * sequence length fits within a two-byte long-form length.
+ */
+#define ECDSA_MAX_LEN( keysize ) \
+	( 3 /* SEQUENCE */ + ( 2 * ( 2 /* INTEGER */ + 1 + (keysize) ) ) )
+
+/** An ECDSA context */
+struct ecdsa_context {
+	/** Elliptic curve */
+	struct elliptic_curve *curve;
+	/** Public curve point */
+	const void *public;
+	/** Signature value "r" */
+	struct asn1_cursor r;
+	/** Signature value "s" */
+	struct asn1_cursor s;
+};
+
+/**
+ * Parse ECDSA public key
+ *
+ * @v context		ECDSA context
+ * @v raw		ASN.1 cursor
+ * @ret rc		Return status code
+ */
+static int ecdsa_parse_key ( struct ecdsa_context *context,
+			     const struct asn1_cursor *raw ) {
+	struct asn1_algorithm *algorithm;
+	struct elliptic_curve *curve;
+	struct asn1_bit_string bits;
+	struct asn1_cursor cursor;
+	struct asn1_cursor params;
+	const uint8_t *format;
+	int rc;
+
+	/* Enter subjectPublicKeyInfo */
+	memcpy ( &cursor, raw, sizeof ( cursor ) );
+	asn1_enter ( &cursor, ASN1_SEQUENCE );
+
+	/* Check algorithm */
+	if ( ( rc = asn1_check_algorithm ( &cursor,
+					   &ec_public_key_algorithm ) ) != 0 ) {
+		DBGC ( context, "ECDSA %p not an EC public key:\n", context );
+		DBGC_HDA ( context, 0, raw->data, raw->len );
+		return rc;
+	}
+
+	/* Identify named curve */
+	memcpy ( &params, &cursor, sizeof ( params ) );
+	asn1_enter ( &params, ASN1_SEQUENCE );
+	asn1_skip ( &params, ASN1_OID );
+	if ( ( rc = asn1_curve_algorithm ( &params, &algorithm ) ) != 0 ) {
+		DBGC ( context, "ECDSA %p unsupported named curve:\n",
+		       context );
+		DBGC_HDA ( context, 0, raw->data, raw->len );
+		return rc;
+	}
+	curve = algorithm->curve;
+	if ( ! ( curve->order && curve->add ) ) {
+		DBGC ( context, "ECDSA %p curve %s cannot be used for "
+		       "signatures\n", context, curve->name );
+		return -ENOTSUP_CURVE;
+	}
+	asn1_skip_any ( &cursor );
+
+	/* Parse subjectPublicKey */
+	if ( ( rc = asn1_integral_bit_string ( &cursor, &bits ) ) != 0 )
+		return rc;
+
+	/* Check that point is in uncompressed format */
+	format = bits.data;
+	if ( ( bits.len != ( 1 /* format */ + curve->pointsize ) ) ||
+	     ( *format != ECDSA_UNCOMPRESSED ) ) {
+		DBGC ( context, "ECDSA %p unsupported %s public key point:\n",
+		       context, curve->name );
+		DBGC_HDA ( context, 0, bits.data, bits.len );
+		return -EINVAL_POINT;
+	}
+
+	/* Record curve and public point */
+	context->curve = curve;
+	context->public = ( format + 1 );
+
+	return 0;
+}
+
+/**
+ * Parse ECDSA signature integer
+ *
+ * @v context		ECDSA context
+ * @v integer		Integer to fill in
+ * @v raw		ASN.1 cursor
+ * @ret rc		Return status code
+ */
+static int ecdsa_parse_integer ( struct ecdsa_context *context,
+				 struct asn1_cursor *integer,
+				 const struct asn1_cursor *raw ) {
+	const uint8_t *first;
+
+	/* Enter integer */
+	memcpy ( integer, raw, sizeof ( *integer ) );
+	if ( asn1_enter ( integer, ASN1_INTEGER ) != 0 )
+		return -EINVAL_SIGNATURE;
+	first = integer->data;
+
+	/* Reject empty and negative integers */
+	if ( ( ! integer->len ) || ( *first & 0x80 ) )
+		return -EINVAL_SIGNATURE;
+
+	/* Skip initial sign byte if applicable */
+	if ( ( integer->len > 1 ) && ( *first == 0x00 ) ) {
+		integer->data++;
+		integer->len--;
+	}
+
+	/* Reject integers wider than the curve order */
+	if ( integer->len > context->curve->keysize )
+		return -EINVAL_SIGNATURE;
+
+	return 0;
+}
+
+/**
+ * Parse ECDSA signature
+ *
+ * @v context		ECDSA context
+ * @v signature		Signature
+ * @v signature_len	Signature length
+ * @ret rc		Return status code
+ */
+static int ecdsa_parse_signature ( struct ecdsa_context *context,
+				   const void *signature,
+				   size_t signature_len ) {
+	struct asn1_cursor cursor;
+	int rc;
+
+	/* Enter Ecdsa-Sig-Value */
+	cursor.data = signature;
+	cursor.len = signature_len;
+	if ( ( rc = asn1_enter ( &cursor, ASN1_SEQUENCE ) ) != 0 )
+		goto err;
+
+	/* Extract "r" */
+	if ( ( rc = ecdsa_parse_integer ( context, &context->r,
+					  &cursor ) ) != 0 )
+		goto err;
+	asn1_skip_any ( &cursor );
+
+	/* Extract "s" */
+	if ( ( rc = ecdsa_parse_integer ( context, &context->s,
+					  &cursor ) ) != 0 )
+		goto err;
+
+	return 0;
+
+ err:
+	DBGC ( context, "ECDSA %p invalid signature:\n", context );
+	DBGC_HDA ( context, 0, signature, signature_len );
+	return rc;
+}
+
+/**
+ * Multiply big integers modulo the curve order
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier0	Element 0 of big integer to be multiplied (< order)
+ * @v order0		Element 0 of big integer curve order
+ * @v square0		Element 0 of big integer R^2 modulo order
+ * @v result0		Element 0 of big integer to hold result
+ * @v size		Number of elements
+ *
+ * The multiplicand must be less than R (i.e. must fit within the big
+ * integer representation), and the multiplier must be fully reduced.
+ */
+static void ecdsa_multiply_raw ( const bigint_element_t *multiplicand0,
+				 const bigint_element_t *multiplier0,
+				 const bigint_element_t *order0,
+				 const bigint_element_t *square0,
+				 bigint_element_t *result0,
+				 unsigned int size ) {
+	const bigint_t ( size ) __attribute__ (( may_alias ))
+		*multiplicand = ( ( const void * ) multiplicand0 );
+	const bigint_t ( size ) __attribute__ (( may_alias ))
+		*multiplier = ( ( const void * ) multiplier0 );
+	const bigint_t ( size ) __attribute__ (( may_alias ))
+		*order = ( ( const void * ) order0 );
+	const bigint_t ( size ) __attribute__ (( may_alias ))
+		*square = ( ( const void * ) square0 );
+	bigint_t ( size ) __attribute__ (( may_alias ))
+		*result = ( ( void * ) result0 );
+	bigint_t ( size * 2 ) product;
+
+	/* Calculate (a*b/R) mod N */
+	bigint_multiply ( multiplicand, multiplier, &product );
+	bigint_montgomery ( order, &product, result );
+
+	/* Multiply by R^2 to obtain (a*b) mod N */
+	bigint_multiply ( result, square, &product );
+	bigint_montgomery ( order, &product, result );
+}
+
+/**
+ * Multiply big integers modulo the curve order
+ *
+ * @v multiplicand	Big integer to be multiplied
+ * @v multiplier	Big integer to be multiplied (< order)
+ * @v order		Big integer curve order
+ * @v square		Big integer R^2 modulo order
+ * @v result		Big integer to hold result
+ */
+#define ecdsa_multiply( multiplicand, multiplier, order, square,	\
+			result ) do {					\
+	unsigned int size = bigint_size (order);			\
+	ecdsa_multiply_raw ( (multiplicand)->element,			\
+			     (multiplier)->element, (order)->element,	\
+			     (square)->element, (result)->element,	\
+			     size );					\
+	} while ( 0 )
+
+/**
+ * Verify ECDSA signature values
+ *
+ * @v context		ECDSA context
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @ret rc		Return status code
+ */
+static int ecdsa_verify_values ( struct ecdsa_context *context,
+				 struct digest_algorithm *digest,
+				 const void *value ) {
+	struct elliptic_curve *curve = context->curve;
+	size_t keysize = curve->keysize;
+	size_t pointsize = curve->pointsize;
+	unsigned int size = bigint_required_size ( keysize );
+	bigint_t ( size ) *modulus;
+	size_t tmp_len = bigint_mod_exp_tmp_len ( modulus );
+	static const uint8_t two_raw[] = { 2 };
+	struct {
+		bigint_t ( size ) order;
+		bigint_t ( size ) fermat;
+		bigint_t ( size ) square;
+		bigint_t ( size ) r;
+		bigint_t ( size ) s;
+		bigint_t ( size ) e;
+		bigint_t ( size ) w;
+		bigint_t ( size ) u;
+		uint8_t tmp[tmp_len];
+	} temp;
+	struct {
+		uint8_t u1[keysize];
+		uint8_t u2[keysize];
+		uint8_t p1[pointsize];
+		uint8_t p2[pointsize];
+	} raw;
+	size_t len;
+	int rc;
+
+	/* Initialise curve order and derived constants */
+	bigint_init ( &temp.order, curve->order, keysize );
+	bigint_reduce ( &temp.order, &temp.square );
+	bigint_copy ( &temp.order, &temp.fermat );
+	bigint_init ( &temp.u, two_raw, sizeof ( two_raw ) );
+	bigint_subtract ( &temp.u, &temp.fermat );
+
+	/* Initialise and check signature values (0 < r,s < N) */
+	bigint_init ( &temp.r, context->r.data, context->r.len );
+	bigint_init ( &temp.s, context->s.data, context->s.len );
+	if ( bigint_is_zero ( &temp.r ) ||
+	     bigint_is_geq ( &temp.r, &temp.order ) ||
+	     bigint_is_zero ( &temp.s ) ||
+	     bigint_is_geq ( &temp.s, &temp.order ) ) {
+		DBGC ( context, "ECDSA %p signature value out of range\n",
+		       context );
+		return -EACCES_VERIFY;
+	}
+
+	/* Construct "e" from the leftmost bits of the digest value
+	 *
+	 * All supported curves have an order with a length that is an
+	 * exact number of bytes, so no bit shifting is required.
+	 */
+	len = digest->digestsize;
+	if ( len > keysize )
+		len = keysize;
+	bigint_init ( &temp.e, value, len );
+	DBGC2 ( context, "ECDSA %p e = %s\n",
+		context, bigint_ntoa ( &temp.e ) );
+
+	/* Calculate w = s^-1 mod N (via Fermat's little theorem) */
+	bigint_mod_exp ( &temp.s, &temp.order, &temp.fermat, &temp.w,
+			 temp.tmp );
+
+	/* Calculate u1 = e*w mod N */
+	ecdsa_multiply ( &temp.e, &temp.w, &temp.order, &temp.square,
+			 &temp.u );
+	bigint_done ( &temp.u, raw.u1, keysize );
+
+	/* Calculate u2 = r*w mod N */
+	ecdsa_multiply ( &temp.r, &temp.w, &temp.order, &temp.square,
+			 &temp.u );
+	bigint_done ( &temp.u, raw.u2, keysize );
+
+	/* Calculate u1*G + u2*Q */
+	if ( ( rc = elliptic_multiply ( curve, NULL, raw.u1, raw.p1 ) ) != 0 )
+		goto err_invalid;
+	if ( ( rc = elliptic_multiply ( curve, context->public, raw.u2,
+					raw.p2 ) ) != 0 )
+		goto err_invalid;
+	if ( ( rc = elliptic_add ( curve, raw.p1, raw.p2, raw.p1 ) ) != 0 )
+		goto err_invalid;
+
+	/* Check that x co-ordinate is congruent to r modulo N */
+	bigint_init ( &temp.u, raw.p1, keysize );
+	if ( bigint_is_geq ( &temp.u, &temp.order ) )
+		bigint_subtract ( &temp.order, &temp.u );
+	bigint_subtract ( &temp.r, &temp.u );
+	if ( ! bigint_is_zero ( &temp.u ) ) {
+		DBGC ( context, "ECDSA %p signature verification failed\n",
+		       context );
+		return -EACCES_VERIFY;
+	}
+
+	return 0;
+
+ err_invalid:
+	DBGC ( context, "ECDSA %p could not calculate verification point: "
+	       "%s\n", context, strerror ( rc ) );
+	return -EACCES_VERIFY;
+}
+
+/**
+ * Calculate ECDSA maximum output length
+ *
+ * @v key		Key
+ * @ret max_len		Maximum output length
+ */
+static size_t ecdsa_max_len ( const struct asn1_cursor *key ) {
+	struct ecdsa_context context;
+	int rc;
+
+	/* Parse public key */
+	if ( ( rc = ecdsa_parse_key ( &context, key ) ) != 0 ) {
+		/* Return a zero maximum length on error */
+		return 0;
+	}
+
+	return ECDSA_MAX_LEN ( context.curve->keysize );
+}
+
+/**
+ * Encrypt using ECDSA
+ *
+ * @v key		Key
+ * @v plaintext		Plaintext
+ * @v plaintext_len	Length of plaintext
+ * @v ciphertext	Ciphertext
+ * @ret ciphertext_len	Length of ciphertext, or negative error
+ */
+static int ecdsa_encrypt ( const struct asn1_cursor *key __unused,
+			   const void *plaintext __unused,
+			   size_t plaintext_len __unused,
+			   void *ciphertext __unused ) {
+
+	/* ECDSA is a signature-only algorithm */
+	return -ENOTSUP;
+}
+
+/**
+ * Decrypt using ECDSA
+ *
+ * @v key		Key
+ * @v ciphertext	Ciphertext
+ * @v ciphertext_len	Ciphertext length
+ * @v plaintext		Plaintext
+ * @ret plaintext_len	Plaintext length, or negative error
+ */
+static int ecdsa_decrypt ( const struct asn1_cursor *key __unused,
+			   const void *ciphertext __unused,
+			   size_t ciphertext_len __unused,
+			   void *plaintext __unused ) {
+
+	/* ECDSA is a signature-only algorithm */
+	return -ENOTSUP;
+}
+
+/**
+ * Sign digest value using ECDSA
+ *
+ * @v key		Key
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @ret signature_len	Signature length, or negative error
+ */
+static int ecdsa_sign ( const struct asn1_cursor *key __unused,
+			struct digest_algorithm *digest __unused,
+			const void *value __unused,
+			void *signature __unused ) {
+
+	/* ECDSA private keys are not supported */
+	return -ENOTSUP;
+}
+
+/**
+ * Verify signed digest value using ECDSA
+ *
+ * @v key		Key
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @v signature_len	Signature length
+ * @ret rc		Return status code
+ */
+static int ecdsa_verify ( const struct asn1_cursor *key,
+			  struct digest_algorithm *digest, const void *value,
+			  const void *signature, size_t signature_len ) {
+	struct ecdsa_context context;
+	int rc;
+
+	DBGC ( &context, "ECDSA %p verifying %s digest:\n",
+	       &context, digest->name );
+	DBGC_HDA ( &context, 0, value, digest->digestsize );
+	DBGC_HDA ( &context, 0, signature, signature_len );
+
+	/* Parse public key */
+	if ( ( rc = ecdsa_parse_key ( &context, key ) ) != 0 )
+		return rc;
+
+	/* Parse signature */
+	if ( ( rc = ecdsa_parse_signature ( &context, signature,
+					    signature_len ) ) != 0 )
+		return rc;
+
+	/* Verify signature */
+	if ( ( rc = ecdsa_verify_values ( &context, digest, value ) ) != 0 )
+		return rc;
+
+	DBGC ( &context, "ECDSA %p %s signature verified successfully\n",
+	       &context, context.curve->name );
+	return 0;
+}
+
+/**
+ * Check for matching ECDSA public/private key pair
+ *
+ * @v private_key	Private key
+ * @v public_key	Public key
+ * @ret rc		Return status code
+ */
+static int ecdsa_match ( const struct asn1_cursor *private_key __unused,
+			 const struct asn1_cursor *public_key __unused ) {
+
+	/* ECDSA private keys are not supported */
+	return -ENOTSUP;
+}
+
+/** ECDSA public-key algorithm */
+struct pubkey_algorithm ecdsa_algorithm = {
+	.name		= "ecdsa",
+	.max_len	= ecdsa_max_len,
+	.encrypt	= ecdsa_encrypt,
+	.decrypt	= ecdsa_decrypt,
+	.sign		= ecdsa_sign,
+	.verify		= ecdsa_verify,
+	.match		= ecdsa_match,
+};
+
+/* Drag in objects via ecdsa_algorithm */
+REQUIRING_SYMBOL ( ecdsa_algorithm );
+
+/* Drag in crypto configuration */
+REQUIRE_OBJECT ( config_crypto );
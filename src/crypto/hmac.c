@@ -69,7 +69,7 @@ void hmac_init ( struct digest_algorithm *digest, void *ctx, const void *key,
 		digest_final ( digest, hctx->ctx, hctx->pad );
 	}
 	for ( i = 0 ; i < sizeof ( hctx->pad ) ; i++ ) {
-		hctx->pad[i] ^= 0x36;
+		hctx->pad[i] ^= HMAC_IPAD;
 	}
 
 	/* Start inner hash */
@@ -90,7 +90,7 @@ void hmac_final ( struct digest_algorithm *digest, void *ctx, void *hmac ) {
 
 	/* Construct output pad from input pad */
 	for ( i = 0 ; i < sizeof ( hctx->pad ) ; i++ ) {
-		hctx->pad[i] ^= 0x6a;
+		hctx->pad[i] ^= ( HMAC_IPAD ^ HMAC_OPAD );
 	}
 
 	/* Finish inner hash */
@@ -62,6 +62,14 @@ static const uint8_t p256_base[ P256_LEN * 2 ] = {
 	0xce, 0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5
 };
 
+/** P-256 base point order */
+static const uint8_t p256_order[P256_LEN] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17,
+	0x9e, 0x84, 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51
+};
+
 /** P-256 elliptic curve */
 WEIERSTRASS_CURVE ( p256, p256_curve, P256_LEN,
-		    p256_prime, p256_a, p256_b, p256_base );
+		    p256_prime, p256_a, p256_b, p256_base,
+		    p256_order );
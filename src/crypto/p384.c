@@ -71,6 +71,16 @@ static const uint8_t p384_base[ P384_LEN * 2 ] = {
 	0x7a, 0x43, 0x1d, 0x7c, 0x90, 0xea, 0x0e, 0x5f
 };
 
+/** P-384 base point order */
+static const uint8_t p384_order[P384_LEN] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xc7, 0x63, 0x4d, 0x81, 0xf4, 0x37, 0x2d, 0xdf, 0x58,
+	0x1a, 0x0d, 0xb2, 0x48, 0xb0, 0xa7, 0x7a, 0xec, 0xec, 0x19, 0x6a,
+	0xcc, 0xc5, 0x29, 0x73
+};
+
 /** P-384 elliptic curve */
 WEIERSTRASS_CURVE ( p384, p384_curve, P384_LEN,
-		    p384_prime, p384_a, p384_b, p384_base );
+		    p384_prime, p384_a, p384_b, p384_base,
+		    p384_order );
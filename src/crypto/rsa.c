@@ -67,6 +67,55 @@ struct rsa_context {
 	bigint_element_t *output0;
 	/** Temporary working space for modular exponentiation */
 	void *tmp;
+
+	/** Allocated memory for CRT parameters */
+	void *crt;
+	/** CRT parameter size (or zero if CRT is not in use) */
+	unsigned int crt_size;
+	/** Public exponent (for verifying CRT results) */
+	bigint_element_t *public0;
+	/** Public exponent size */
+	unsigned int public_size;
+	/** First prime factor "p" */
+	bigint_element_t *prime1_0;
+	/** Second prime factor "q" */
+	bigint_element_t *prime2_0;
+	/** First CRT exponent "dP" */
+	bigint_element_t *exponent1_0;
+	/** Second CRT exponent "dQ" */
+	bigint_element_t *exponent2_0;
+	/** CRT coefficient "qInv" */
+	bigint_element_t *coefficient0;
+	/** Montgomery constant for first prime factor (R^2 mod p) */
+	bigint_element_t *square1_0;
+	/** Montgomery constant for second prime factor (R^2 mod q) */
+	bigint_element_t *square2_0;
+	/** Double-size CRT working space */
+	bigint_element_t *product0;
+	/** CRT working space */
+	bigint_element_t *reduced0;
+	/** First partial result */
+	bigint_element_t *m1_0;
+	/** Second partial result */
+	bigint_element_t *m2_0;
+	/** Verification result */
+	bigint_element_t *check0;
+};
+
+/** RSA Chinese Remainder Theorem private key components */
+struct rsa_crt_params {
+	/** Public exponent "e" */
+	struct asn1_cursor public;
+	/** First prime factor "p" */
+	struct asn1_cursor prime1;
+	/** Second prime factor "q" */
+	struct asn1_cursor prime2;
+	/** First CRT exponent "dP" */
+	struct asn1_cursor exponent1;
+	/** Second CRT exponent "dQ" */
+	struct asn1_cursor exponent2;
+	/** CRT coefficient "qInv" */
+	struct asn1_cursor coefficient;
 };
 
 /**
@@ -93,6 +142,7 @@ rsa_find_prefix ( struct digest_algorithm *digest ) {
  */
 static inline void rsa_free ( struct rsa_context *context ) {
 
+	free ( context->crt );
 	free ( context->dynamic );
 }
 
@@ -137,6 +187,84 @@ static int rsa_alloc ( struct rsa_context *context, size_t modulus_len,
 	return 0;
 }
 
+/**
+ * Allocate RSA dynamic storage for CRT parameters
+ *
+ * @v context		RSA context
+ * @v crt		CRT parameters
+ * @ret rc		Return status code
+ */
+static int rsa_alloc_crt ( struct rsa_context *context,
+			   const struct rsa_crt_params *crt ) {
+	size_t prime_len = ( ( crt->prime1.len > crt->prime2.len ) ?
+			     crt->prime1.len : crt->prime2.len );
+	unsigned int crt_size = bigint_required_size ( prime_len );
+	unsigned int public_size = bigint_required_size ( crt->public.len );
+	unsigned int size = context->size;
+	struct {
+		bigint_t ( public_size ) public;
+		bigint_t ( crt_size ) prime1;
+		bigint_t ( crt_size ) prime2;
+		bigint_t ( crt_size ) exponent1;
+		bigint_t ( crt_size ) exponent2;
+		bigint_t ( crt_size ) coefficient;
+		bigint_t ( crt_size ) square1;
+		bigint_t ( crt_size ) square2;
+		bigint_t ( crt_size * 2 ) product;
+		bigint_t ( crt_size ) reduced;
+		bigint_t ( crt_size ) m1;
+		bigint_t ( crt_size ) m2;
+		bigint_t ( size ) check;
+	} __attribute__ (( packed )) *dynamic;
+
+	/* The double-size working space must be able to hold the
+	 * input, and the exponentiation working space (sized for the
+	 * full modulus) must suffice for the half-size exponentiations.
+	 */
+	if ( ( crt_size * 2 ) < size )
+		return -ERANGE;
+
+	/* Allocate dynamic storage */
+	dynamic = malloc ( sizeof ( *dynamic ) );
+	if ( ! dynamic )
+		return -ENOMEM;
+
+	/* Assign dynamic storage */
+	context->crt = dynamic;
+	context->crt_size = crt_size;
+	context->public0 = &dynamic->public.element[0];
+	context->public_size = public_size;
+	context->prime1_0 = &dynamic->prime1.element[0];
+	context->prime2_0 = &dynamic->prime2.element[0];
+	context->exponent1_0 = &dynamic->exponent1.element[0];
+	context->exponent2_0 = &dynamic->exponent2.element[0];
+	context->coefficient0 = &dynamic->coefficient.element[0];
+	context->square1_0 = &dynamic->square1.element[0];
+	context->square2_0 = &dynamic->square2.element[0];
+	context->product0 = &dynamic->product.element[0];
+	context->reduced0 = &dynamic->reduced.element[0];
+	context->m1_0 = &dynamic->m1.element[0];
+	context->m2_0 = &dynamic->m2.element[0];
+	context->check0 = &dynamic->check.element[0];
+
+	/* Construct big integers */
+	bigint_init ( &dynamic->public, crt->public.data, crt->public.len );
+	bigint_init ( &dynamic->prime1, crt->prime1.data, crt->prime1.len );
+	bigint_init ( &dynamic->prime2, crt->prime2.data, crt->prime2.len );
+	bigint_init ( &dynamic->exponent1, crt->exponent1.data,
+		      crt->exponent1.len );
+	bigint_init ( &dynamic->exponent2, crt->exponent2.data,
+		      crt->exponent2.len );
+	bigint_init ( &dynamic->coefficient, crt->coefficient.data,
+		      crt->coefficient.len );
+
+	/* Precalculate Montgomery constants */
+	bigint_reduce ( &dynamic->prime1, &dynamic->square1 );
+	bigint_reduce ( &dynamic->prime2, &dynamic->square2 );
+
+	return 0;
+}
+
 /**
  * Parse RSA integer
  *
@@ -165,17 +293,76 @@ static int rsa_parse_integer ( struct asn1_cursor *integer,
 	return 0;
 }
 
+/**
+ * Parse RSA CRT private key components
+ *
+ * @v crt		CRT parameters to fill in
+ * @v public		Public exponent
+ * @v raw		ASN.1 cursor (positioned at privateExponent)
+ * @ret rc		Return status code
+ */
+static int rsa_parse_crt ( struct rsa_crt_params *crt,
+			   const struct asn1_cursor *public,
+			   const struct asn1_cursor *raw ) {
+	struct asn1_cursor cursor;
+	int rc;
+
+	/* Record public exponent */
+	memcpy ( &crt->public, public, sizeof ( crt->public ) );
+
+	/* Skip privateExponent */
+	memcpy ( &cursor, raw, sizeof ( cursor ) );
+	asn1_skip_any ( &cursor );
+
+	/* Extract prime1 */
+	if ( ( rc = rsa_parse_integer ( &crt->prime1, &cursor ) ) != 0 )
+		return rc;
+	asn1_skip_any ( &cursor );
+
+	/* Extract prime2 */
+	if ( ( rc = rsa_parse_integer ( &crt->prime2, &cursor ) ) != 0 )
+		return rc;
+	asn1_skip_any ( &cursor );
+
+	/* Extract exponent1 */
+	if ( ( rc = rsa_parse_integer ( &crt->exponent1, &cursor ) ) != 0 )
+		return rc;
+	asn1_skip_any ( &cursor );
+
+	/* Extract exponent2 */
+	if ( ( rc = rsa_parse_integer ( &crt->exponent2, &cursor ) ) != 0 )
+		return rc;
+	asn1_skip_any ( &cursor );
+
+	/* Extract coefficient */
+	if ( ( rc = rsa_parse_integer ( &crt->coefficient, &cursor ) ) != 0 )
+		return rc;
+	asn1_skip_any ( &cursor );
+
+	/* Reject multi-prime keys (with otherPrimeInfos) */
+	if ( cursor.len )
+		return -ENOTSUP;
+
+	return 0;
+}
+
 /**
  * Parse RSA modulus and exponent
  *
  * @v modulus		Modulus to fill in
  * @v exponent		Exponent to fill in
+ * @v crt		CRT parameters to fill in, or NULL
  * @v raw		ASN.1 cursor
  * @ret rc		Return status code
+ *
+ * The CRT parameters will be zeroed unless the key is a private key
+ * containing a complete (two-prime) set of CRT components.
  */
 static int rsa_parse_mod_exp ( struct asn1_cursor *modulus,
 			       struct asn1_cursor *exponent,
+			       struct rsa_crt_params *crt,
 			       const struct asn1_cursor *raw ) {
+	struct asn1_cursor public;
 	struct asn1_bit_string bits;
 	struct asn1_cursor cursor;
 	int is_private;
@@ -234,14 +421,26 @@ static int rsa_parse_mod_exp ( struct asn1_cursor *modulus,
 		return rc;
 	asn1_skip_any ( &cursor );
 
-	/* Skip public exponent, if applicable */
-	if ( is_private )
+	/* Record and skip public exponent, if applicable */
+	if ( is_private ) {
+		if ( rsa_parse_integer ( &public, &cursor ) != 0 )
+			public.len = 0;
 		asn1_skip ( &cursor, ASN1_INTEGER );
+	}
 
 	/* Extract publicExponent/privateExponent */
 	if ( ( rc = rsa_parse_integer ( exponent, &cursor ) ) != 0 )
 		return rc;
 
+	/* Extract CRT parameters, if applicable */
+	if ( crt ) {
+		memset ( crt, 0, sizeof ( *crt ) );
+		if ( is_private && public.len &&
+		     ( rsa_parse_crt ( crt, &public, &cursor ) != 0 ) ) {
+			memset ( crt, 0, sizeof ( *crt ) );
+		}
+	}
+
 	return 0;
 }
 
@@ -256,13 +455,15 @@ static int rsa_init ( struct rsa_context *context,
 		      const struct asn1_cursor *key ) {
 	struct asn1_cursor modulus;
 	struct asn1_cursor exponent;
+	struct rsa_crt_params crt;
 	int rc;
 
 	/* Initialise context */
 	memset ( context, 0, sizeof ( *context ) );
 
 	/* Parse modulus and exponent */
-	if ( ( rc = rsa_parse_mod_exp ( &modulus, &exponent, key ) ) != 0 ){
+	if ( ( rc = rsa_parse_mod_exp ( &modulus, &exponent, &crt,
+					key ) ) != 0 ) {
 		DBGC ( context, "RSA %p invalid modulus/exponent:\n", context );
 		DBGC_HDA ( context, 0, key->data, key->len );
 		goto err_parse;
@@ -283,6 +484,14 @@ static int rsa_init ( struct rsa_context *context,
 	bigint_init ( ( ( bigint_t ( context->exponent_size ) * )
 			context->exponent0 ), exponent.data, exponent.len );
 
+	/* Allocate and construct CRT parameters, if available */
+	if ( crt.prime1.len &&
+	     ( ( rc = rsa_alloc_crt ( context, &crt ) ) != 0 ) ) {
+		DBGC ( context, "RSA %p could not use CRT: %s\n",
+		       context, strerror ( rc ) );
+		/* Continue without CRT */
+	}
+
 	return 0;
 
 	rsa_free ( context );
@@ -303,7 +512,8 @@ static size_t rsa_max_len ( const struct asn1_cursor *key ) {
 	int rc;
 
 	/* Parse moduli and exponents */
-	if ( ( rc = rsa_parse_mod_exp ( &modulus, &exponent, key ) ) != 0 ) {
+	if ( ( rc = rsa_parse_mod_exp ( &modulus, &exponent, NULL,
+					key ) ) != 0 ) {
 		/* Return a zero maximum length on error */
 		return 0;
 	}
@@ -312,6 +522,138 @@ static size_t rsa_max_len ( const struct asn1_cursor *key ) {
 	return modulus.len;
 }
 
+/**
+ * Reduce big integer modulo a CRT prime factor
+ *
+ * @v value0		Element 0 of big integer to reduce
+ * @v size		Number of elements in value
+ * @v prime0		Element 0 of prime factor
+ * @v square0		Element 0 of Montgomery constant (R^2 mod prime)
+ * @v product0		Element 0 of double-size working space
+ * @v result0		Element 0 of big integer to hold result
+ * @v crt_size		Number of elements in prime factor and result
+ *
+ * The value must be less than the prime factor multiplied by R.
+ */
+static void rsa_crt_reduce_raw ( const bigint_element_t *value0,
+				 unsigned int size,
+				 const bigint_element_t *prime0,
+				 const bigint_element_t *square0,
+				 bigint_element_t *product0,
+				 bigint_element_t *result0,
+				 unsigned int crt_size ) {
+	const bigint_t ( size ) __attribute__ (( may_alias )) *value =
+		( ( const void * ) value0 );
+	const bigint_t ( crt_size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) prime0 );
+	const bigint_t ( crt_size ) __attribute__ (( may_alias )) *square =
+		( ( const void * ) square0 );
+	bigint_t ( crt_size * 2 ) __attribute__ (( may_alias )) *product =
+		( ( void * ) product0 );
+	bigint_t ( crt_size ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+
+	/* Calculate xR^-1 mod p */
+	bigint_grow ( value, product );
+	bigint_montgomery ( prime, product, result );
+
+	/* Multiply by R^2 mod p to obtain x mod p */
+	bigint_multiply ( result, square, product );
+	bigint_montgomery ( prime, product, result );
+}
+
+/**
+ * Reduce big integer modulo a CRT prime factor
+ *
+ * @v value		Big integer to reduce
+ * @v prime		Prime factor
+ * @v square		Montgomery constant (R^2 mod prime)
+ * @v product		Double-size working space
+ * @v result		Big integer to hold result
+ */
+#define rsa_crt_reduce( value, prime, square, product, result )		\
+	rsa_crt_reduce_raw ( (value)->element, bigint_size (value),	\
+			     (prime)->element, (square)->element,	\
+			     (product)->element, (result)->element,	\
+			     bigint_size (prime) )
+
+/**
+ * Perform RSA private-key cipher operation using CRT
+ *
+ * @v context		RSA context
+ * @ret rc		Return status code
+ *
+ * The input must already have been placed in the input buffer.  On
+ * success, the result will be placed in the output buffer.
+ */
+static int rsa_cipher_crt ( struct rsa_context *context ) {
+	unsigned int size = context->size;
+	unsigned int crt_size = context->crt_size;
+	bigint_t ( size ) *input = ( ( void * ) context->input0 );
+	bigint_t ( size ) *output = ( ( void * ) context->output0 );
+	bigint_t ( size ) *modulus = ( ( void * ) context->modulus0 );
+	bigint_t ( size ) *check = ( ( void * ) context->check0 );
+	bigint_t ( context->public_size ) *public =
+		( ( void * ) context->public0 );
+	bigint_t ( crt_size ) *prime1 = ( ( void * ) context->prime1_0 );
+	bigint_t ( crt_size ) *prime2 = ( ( void * ) context->prime2_0 );
+	bigint_t ( crt_size ) *exponent1 = ( ( void * ) context->exponent1_0 );
+	bigint_t ( crt_size ) *exponent2 = ( ( void * ) context->exponent2_0 );
+	bigint_t ( crt_size ) *coefficient =
+		( ( void * ) context->coefficient0 );
+	bigint_t ( crt_size ) *square1 = ( ( void * ) context->square1_0 );
+	bigint_t ( crt_size ) *square2 = ( ( void * ) context->square2_0 );
+	bigint_t ( crt_size * 2 ) *product = ( ( void * ) context->product0 );
+	bigint_t ( crt_size ) *reduced = ( ( void * ) context->reduced0 );
+	bigint_t ( crt_size ) *m1 = ( ( void * ) context->m1_0 );
+	bigint_t ( crt_size ) *m2 = ( ( void * ) context->m2_0 );
+	int underflow;
+
+	/* Reductions modulo each prime factor require that the input
+	 * be less than the modulus.
+	 */
+	if ( bigint_is_geq ( input, modulus ) )
+		return -ERANGE;
+
+	/* Calculate m1 = c^dP mod p */
+	rsa_crt_reduce ( input, prime1, square1, product, reduced );
+	bigint_mod_exp ( reduced, prime1, exponent1, m1, context->tmp );
+
+	/* Calculate m2 = c^dQ mod q */
+	rsa_crt_reduce ( input, prime2, square2, product, reduced );
+	bigint_mod_exp ( reduced, prime2, exponent2, m2, context->tmp );
+
+	/* Calculate (m1 - m2) mod p, without branching on the result */
+	rsa_crt_reduce ( m2, prime1, square1, product, reduced );
+	underflow = bigint_subtract ( reduced, m1 );
+	bigint_copy ( m1, reduced );
+	bigint_add ( prime1, reduced );
+	bigint_swap ( m1, reduced, underflow );
+
+	/* Calculate h = qInv * (m1 - m2) mod p */
+	bigint_multiply ( coefficient, m1, product );
+	bigint_montgomery ( prime1, product, reduced );
+	bigint_multiply ( reduced, square1, product );
+	bigint_montgomery ( prime1, product, m1 );
+
+	/* Calculate m = m2 + h * q (which cannot exceed the modulus) */
+	bigint_multiply ( m1, prime2, product );
+	bigint_shrink ( product, output );
+	bigint_grow ( m2, check );
+	bigint_add ( check, output );
+
+	/* Verify result using the public exponent, to avoid leaking
+	 * the prime factors in the event of a computational fault.
+	 */
+	bigint_mod_exp ( output, modulus, public, check, context->tmp );
+	if ( memcmp ( check, input, sizeof ( *check ) ) != 0 ) {
+		DBGC ( context, "RSA %p CRT verification failed\n", context );
+		return -EIO;
+	}
+
+	return 0;
+}
+
 /**
  * Perform RSA cipher operation
  *
@@ -330,8 +672,11 @@ static void rsa_cipher ( struct rsa_context *context,
 	/* Initialise big integer */
 	bigint_init ( input, in, context->max_len );
 
-	/* Perform modular exponentiation */
-	bigint_mod_exp ( input, modulus, exponent, output, context->tmp );
+	/* Perform modular exponentiation, using CRT if possible */
+	if ( ! ( context->crt_size && ( rsa_cipher_crt ( context ) == 0 ) ) ) {
+		bigint_mod_exp ( input, modulus, exponent, output,
+				 context->tmp );
+	}
 
 	/* Copy out result */
 	bigint_done ( output, out, context->max_len );
@@ -682,10 +1027,10 @@ static int rsa_match ( const struct asn1_cursor *private_key,
 
 	/* Parse moduli and exponents */
 	if ( ( rc = rsa_parse_mod_exp ( &private_modulus, &private_exponent,
-					private_key ) ) != 0 )
+					NULL, private_key ) ) != 0 )
 		return rc;
 	if ( ( rc = rsa_parse_mod_exp ( &public_modulus, &public_exponent,
-					public_key ) ) != 0 )
+					NULL, public_key ) ) != 0 )
 		return rc;
 
 	/* Compare moduli */
@@ -209,14 +209,21 @@ static void sha1_update ( void *ctx, const void *data, size_t len ) {
 	struct sha1_context *context = ctx;
 	const uint8_t *byte = data;
 	size_t offset;
+	size_t frag_len;
 
-	/* Accumulate data a byte at a time, performing the digest
-	 * whenever we fill the data buffer
+	/* Accumulate data as many bytes at a time as will fit into
+	 * the data buffer, performing the digest whenever we fill the
+	 * data buffer
 	 */
-	while ( len-- ) {
+	while ( len ) {
 		offset = ( context->len % sizeof ( context->ddd.dd.data ) );
-		context->ddd.dd.data.byte[offset] = *(byte++);
-		context->len++;
+		frag_len = ( sizeof ( context->ddd.dd.data ) - offset );
+		if ( frag_len > len )
+			frag_len = len;
+		memcpy ( &context->ddd.dd.data.byte[offset], byte, frag_len );
+		context->len += frag_len;
+		byte += frag_len;
+		len -= frag_len;
 		if ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 )
 			sha1_digest ( context );
 	}
@@ -230,23 +237,31 @@ static void sha1_update ( void *ctx, const void *data, size_t len ) {
  */
 static void sha1_final ( void *ctx, void *out ) {
 	struct sha1_context *context = ctx;
+	union sha1_block *data = &context->ddd.dd.data;
 	uint64_t len_bits;
-	uint8_t pad;
+	size_t offset;
 
 	/* Record length before pre-processing */
 	len_bits = cpu_to_be64 ( ( ( uint64_t ) context->len ) * 8 );
 
-	/* Pad with a single "1" bit followed by as many "0" bits as required */
-	pad = 0x80;
-	do {
-		sha1_update ( ctx, &pad, sizeof ( pad ) );
-		pad = 0x00;
-	} while ( ( context->len % sizeof ( context->ddd.dd.data ) ) !=
-		  offsetof ( typeof ( context->ddd.dd.data ), final.len ) );
+	/* Pad with a single "1" bit followed by as many "0" bits as
+	 * required, digesting an additional block if there is no
+	 * space remaining for the length
+	 */
+	offset = ( context->len % sizeof ( *data ) );
+	data->byte[offset] = 0x80;
+	memset ( &data->byte[ offset + 1 ], 0,
+		 ( sizeof ( *data ) - offset - 1 ) );
+	context->len += ( sizeof ( *data ) - offset );
+	if ( offset >= offsetof ( typeof ( *data ), final.len ) ) {
+		sha1_digest ( context );
+		memset ( data, 0, sizeof ( *data ) );
+		context->len += sizeof ( *data );
+	}
 
-	/* Append length (in bits) */
-	sha1_update ( ctx, &len_bits, sizeof ( len_bits ) );
-	assert ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 );
+	/* Append length (in bits) and digest final block */
+	data->final.len = len_bits;
+	sha1_digest ( context );
 
 	/* Copy out final digest */
 	memcpy ( out, &context->ddd.dd.digest,
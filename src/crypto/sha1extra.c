@@ -20,6 +20,7 @@
 FILE_LICENCE ( GPL2_OR_LATER );
 
 #include <string.h>
+#include <assert.h>
 #include <ipxe/crypto.h>
 #include <ipxe/sha1.h>
 #include <ipxe/hmac.h>
@@ -83,8 +84,8 @@ void prf_sha1 ( const void *key, size_t key_len, const char *label,
 /**
  * PBKDF2 key derivation function inner block operation
  *
- * @v passphrase	Passphrase from which to derive key
- * @v pass_len		Length of passphrase
+ * @v inner		Precomputed HMAC-SHA1 inner hash state
+ * @v outer		Precomputed HMAC-SHA1 outer hash state
  * @v salt		Salt to include in key
  * @v salt_len		Length of salt
  * @v iterations	Number of iterations of SHA1 to perform
@@ -92,15 +93,21 @@ void prf_sha1 ( const void *key, size_t key_len, const char *label,
  * @ret block		SHA1_SIZE bytes of PBKDF2 data
  *
  * The operation of this function is described in RFC 2898.
+ *
+ * The HMAC inner and outer pads depend only upon the passphrase, so
+ * the hash states following each pad are calculated once by the
+ * caller and copied for each iteration.  Each iteration then
+ * requires only a single SHA1 block digest for each of the inner and
+ * outer hashes.
  */
-static void pbkdf2_sha1_f ( const void *passphrase, size_t pass_len,
+static void pbkdf2_sha1_f ( const struct sha1_context *inner,
+			    const struct sha1_context *outer,
 			    const void *salt, size_t salt_len,
 			    int iterations, u32 blocknr, u8 *block )
 {
-	u8 pass[pass_len];	/* modifiable passphrase */
+	struct sha1_context ctx;	/* working SHA1 context */
 	u8 in[salt_len + 4];	/* input buffer to first round */
 	u8 last[SHA1_DIGEST_SIZE]; /* output of round N, input of N+1 */
-	u8 ctx[SHA1_CTX_SIZE + SHA1_BLOCK_SIZE];
 	u8 *next_in = in;	/* changed to `last' after first round */
 	int next_size = sizeof ( in );
 	int i;
@@ -108,15 +115,18 @@ static void pbkdf2_sha1_f ( const void *passphrase, size_t pass_len,
 
 	blocknr = htonl ( blocknr );
 
-	memcpy ( pass, passphrase, pass_len );
 	memcpy ( in, salt, salt_len );
 	memcpy ( in + salt_len, &blocknr, 4 );
 	memset ( block, 0, sizeof ( last ) );
 
 	for ( i = 0; i < iterations; i++ ) {
-		hmac_init ( &sha1_algorithm, ctx, pass, pass_len );
-		hmac_update ( &sha1_algorithm, ctx, next_in, next_size );
-		hmac_final ( &sha1_algorithm, ctx, last );
+		memcpy ( &ctx, inner, sizeof ( ctx ) );
+		digest_update ( &sha1_algorithm, &ctx, next_in, next_size );
+		digest_final ( &sha1_algorithm, &ctx, last );
+
+		memcpy ( &ctx, outer, sizeof ( ctx ) );
+		digest_update ( &sha1_algorithm, &ctx, last, sizeof ( last ) );
+		digest_final ( &sha1_algorithm, &ctx, last );
 
 		for ( j = 0; j < sizeof ( last ); j++ ) {
 			block[j] ^= last[j];
@@ -125,6 +135,9 @@ static void pbkdf2_sha1_f ( const void *passphrase, size_t pass_len,
 		next_in = last;
 		next_size = sizeof ( last );
 	}
+
+	/* Erase working state (from which the key may be derivable) */
+	memset ( &ctx, 0, sizeof ( ctx ) );
 }
 
 /**
@@ -151,10 +164,30 @@ void pbkdf2_sha1 ( const void *passphrase, size_t pass_len,
 {
 	u32 blocks = ( key_len + SHA1_DIGEST_SIZE - 1 ) / SHA1_DIGEST_SIZE;
 	u32 blk;
+	struct digest_algorithm *digest = &sha1_algorithm;
 	u8 buf[SHA1_DIGEST_SIZE];
+	u8 ctx[ hmac_ctxsize ( digest ) ];
+	hmac_context_t ( digest ) *hctx = ( ( void * ) ctx );
+	struct sha1_context inner;
+	struct sha1_context outer;
+	unsigned int i;
+
+	/* Calculate inner hash state following the input pad */
+	hmac_init ( digest, hctx, passphrase, pass_len );
+	assert ( sizeof ( hctx->ctx ) == sizeof ( inner ) );
+	memcpy ( &inner, hctx->ctx, sizeof ( inner ) );
+
+	/* Calculate outer hash state following the output pad */
+	for ( i = 0; i < sizeof ( hctx->pad ); i++ ) {
+		hctx->pad[i] ^= ( HMAC_IPAD ^ HMAC_OPAD );
+	}
+	digest_init ( digest, &outer );
+	digest_update ( digest, &outer, hctx->pad,
+			sizeof ( hctx->pad ) );
+	memset ( ctx, 0, sizeof ( ctx ) );
 
 	for ( blk = 1; blk <= blocks; blk++ ) {
-		pbkdf2_sha1_f ( passphrase, pass_len, salt, salt_len,
+		pbkdf2_sha1_f ( &inner, &outer, salt, salt_len,
 				iterations, blk, buf );
 		if ( key_len <= sizeof ( buf ) ) {
 			memcpy ( key, buf, key_len );
@@ -165,4 +198,9 @@ void pbkdf2_sha1 ( const void *passphrase, size_t pass_len,
 		key_len -= sizeof ( buf );
 		key += sizeof ( buf );
 	}
+
+	/* Erase precomputed states and intermediate output */
+	memset ( &inner, 0, sizeof ( inner ) );
+	memset ( &outer, 0, sizeof ( outer ) );
+	memset ( buf, 0, sizeof ( buf ) );
 }
@@ -42,8 +42,16 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * The algorithm is encoded using a bytecode representation, since
  * this substantially reduces the code size compared to direct
  * implementation of the big integer operations.
+ *
+ * Multiplication of an arbitrary point uses a Montgomery ladder.
+ * Multiplication of the generator point (as used when generating an
+ * ephemeral key) instead uses a fixed-base comb, with a table of
+ * precomputed generator multiples constructed when the curve is
+ * first used.
  */
 
+#include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <ipxe/weierstrass.h>
 
@@ -759,108 +767,359 @@ static int weierstrass_verify_raw ( const struct weierstrass_curve *curve,
 	} )
 
 /**
- * Multiply curve point by scalar
+ * Convert affine point to projective co-ordinates in Montgomery form
  *
  * @v curve		Weierstrass curve
- * @v base		Base point (or NULL to use generator)
- * @v scalar		Scalar multiple
- * @v result		Result point to fill in
+ * @v data		Raw affine point
+ * @v point0		Element 0 of point (x,y,z) to fill in
  * @ret rc		Return status code
  */
-int weierstrass_multiply ( struct weierstrass_curve *curve, const void *base,
-			   const void *scalar, void *result ) {
+static int weierstrass_import_raw ( const struct weierstrass_curve *curve,
+				    const void *data,
+				    bigint_element_t *point0 ) {
 	unsigned int size = curve->size;
 	size_t len = curve->len;
 	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
 		( ( const void * ) curve->prime[0] );
-	const bigint_t ( size ) __attribute__ (( may_alias )) *prime2 =
-		( ( const void * ) curve->prime[WEIERSTRASS_2N] );
-	const bigint_t ( size ) __attribute__ (( may_alias )) *fermat =
-		( ( const void * ) curve->fermat );
 	const bigint_t ( size ) __attribute__ (( may_alias )) *square =
 		( ( const void * ) curve->square );
 	const bigint_t ( size ) __attribute__ (( may_alias )) *one =
 		( ( const void * ) curve->one );
-	struct {
-		union {
-			weierstrass_t ( size ) result;
-			bigint_t ( size * 2 ) product_in;
-		};
-		union {
-			weierstrass_t ( size ) multiple;
-			bigint_t ( size * 2 ) product_out;
-		};
-		bigint_t ( bigint_required_size ( len ) ) scalar;
-	} temp;
+	weierstrass_t ( size ) __attribute__ (( may_alias ))
+		*point = ( ( void * ) point0 );
+	bigint_t ( size * 2 ) product;
 	size_t offset;
 	unsigned int i;
+
+	/* Convert input to projective coordinates in Montgomery form */
+	DBGC ( curve, "WEIERSTRASS %s point (", curve->name );
+	for ( i = 0, offset = 0 ; i < WEIERSTRASS_AXES ; i++, offset += len ) {
+		bigint_init ( &point->axis[i], ( data + offset ), len );
+		DBGC ( curve, "%s%s", ( i ? "," : "" ),
+		       bigint_ntoa ( &point->axis[i] ) );
+		bigint_multiply ( &point->axis[i], square, &product );
+		bigint_montgomery_relaxed ( prime, &product,
+					    &point->axis[i] );
+	}
+	bigint_copy ( one, &point->z );
+	DBGC ( curve, ")\n" );
+
+	/* Verify point is on curve */
+	return weierstrass_verify ( curve, point );
+}
+
+/**
+ * Convert affine point to projective co-ordinates in Montgomery form
+ *
+ * @v curve		Weierstrass curve
+ * @v data		Raw affine point
+ * @v point		Point (x,y,z) to fill in
+ * @ret rc		Return status code
+ */
+#define weierstrass_import( curve, data, point ) ( {			\
+	weierstrass_import_raw ( (curve), (data), (point)->all.element ); \
+	} )
+
+/**
+ * Initialise fixed-base comb table
+ *
+ * @v curve		Weierstrass curve
+ *
+ * Entry j of the comb table is the sum of the points (2^(i*d))G for
+ * each bit i that is set in j, where d is the spacing between comb
+ * teeth.
+ */
+static void weierstrass_init_comb ( struct weierstrass_curve *curve ) {
+	unsigned int size = curve->size;
+	unsigned int spacing = ( ( curve->len * 8 ) / WEIERSTRASS_COMB_TEETH );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *one =
+		( ( const void * ) curve->one );
+	weierstrass_t ( size ) __attribute__ (( may_alias ))
+		*comb = ( ( void * ) curve->comb );
+	weierstrass_t ( size ) tooth[WEIERSTRASS_COMB_TEETH];
+	unsigned int tooth_bit;
+	unsigned int i;
+	unsigned int j;
 	int rc;
 
-	/* Initialise curve, if not already done
-	 *
-	 * The least significant element of the field prime must be
+	/* Construct (2^(i*d))G for each tooth i */
+	rc = weierstrass_import ( curve, curve->base, &tooth[0] );
+	assert ( rc == 0 );
+	for ( i = 1 ; i < WEIERSTRASS_COMB_TEETH ; i++ ) {
+		memcpy ( &tooth[i], &tooth[ i - 1 ], sizeof ( tooth[i] ) );
+		for ( j = 0 ; j < spacing ; j++ )
+			weierstrass_add ( curve, &tooth[i], &tooth[i],
+					  &tooth[i] );
+	}
+
+	/* Construct identity element (the point at infinity) */
+	memset ( &comb[0], 0, sizeof ( comb[0] ) );
+	bigint_copy ( one, &comb[0].y );
+
+	/* Construct remaining entries from the lowest set bit */
+	for ( j = 1 ; j < WEIERSTRASS_COMB_ENTRIES ; j++ ) {
+		tooth_bit = ( ffs ( j ) - 1 );
+		weierstrass_add ( curve, &comb[ j & ( j - 1 ) ],
+				  &tooth[tooth_bit], &comb[j] );
+	}
+	DBGC ( curve, "WEIERSTRASS %s constructed %d-entry comb table\n",
+	       curve->name, WEIERSTRASS_COMB_ENTRIES );
+}
+
+/**
+ * Initialise curve, if not already done
+ *
+ * @v curve		Weierstrass curve
+ */
+static void weierstrass_init_once ( struct weierstrass_curve *curve ) {
+	unsigned int size = curve->size;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime2 =
+		( ( const void * ) curve->prime[WEIERSTRASS_2N] );
+
+	/* The least significant element of the field prime must be
 	 * odd, and so the least significant element of the
 	 * (initialised) first multiple of the field prime must be
 	 * non-zero.
 	 */
-	if ( ! prime2->element[0] )
+	if ( ! prime2->element[0] ) {
 		weierstrass_init ( curve );
+		weierstrass_init_comb ( curve );
+	}
+}
+
+/**
+ * Convert projective point in Montgomery form to affine co-ordinates
+ *
+ * @v curve		Weierstrass curve
+ * @v point0		Element 0 of point (x,y,z) to convert (will be clobbered)
+ * @v data		Raw affine point to fill in
+ * @ret rc		Return status code
+ */
+static int weierstrass_export_raw ( const struct weierstrass_curve *curve,
+				    bigint_element_t *point0, void *data ) {
+	unsigned int size = curve->size;
+	size_t len = curve->len;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) curve->prime[0] );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *fermat =
+		( ( const void * ) curve->fermat );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *one =
+		( ( const void * ) curve->one );
+	weierstrass_t ( size ) __attribute__ (( may_alias ))
+		*point = ( ( void * ) point0 );
+	struct {
+		bigint_t ( size ) inverse;
+		bigint_t ( size * 2 ) product;
+	} temp;
+	size_t offset;
+	unsigned int i;
 
-	/* Use generator if applicable */
-	if ( ! base )
-		base = curve->base;
+	/* Invert Z co-ordinate (via Fermat's little theorem) */
+	bigint_copy ( one, &temp.inverse );
+	bigint_ladder ( &temp.inverse, &point->z, fermat,
+			bigint_mod_exp_ladder, prime, &temp.product );
 
-	/* Convert input to projective coordinates in Montgomery form */
-	DBGC ( curve, "WEIERSTRASS %s base (", curve->name );
+	/* Convert back to affine co-ordinates */
+	DBGC ( curve, "WEIERSTRASS %s result (", curve->name );
 	for ( i = 0, offset = 0 ; i < WEIERSTRASS_AXES ; i++, offset += len ) {
-		bigint_init ( &temp.multiple.axis[i], ( base + offset ), len );
+		bigint_multiply ( &point->axis[i], &temp.inverse,
+				  &temp.product );
+		bigint_montgomery_relaxed ( prime, &temp.product,
+					    &point->axis[i] );
+		bigint_grow ( &point->axis[i], &temp.product );
+		bigint_montgomery ( prime, &temp.product, &point->axis[i] );
 		DBGC ( curve, "%s%s", ( i ? "," : "" ),
-		       bigint_ntoa ( &temp.multiple.axis[i] ) );
-		bigint_multiply ( &temp.multiple.axis[i], square,
-				  &temp.product_in );
-		bigint_montgomery_relaxed ( prime, &temp.product_in,
-					    &temp.multiple.axis[i] );
+		       bigint_ntoa ( &point->axis[i] ) );
+		bigint_done ( &point->axis[i], ( data + offset ), len );
 	}
-	bigint_copy ( one, &temp.multiple.z );
 	DBGC ( curve, ")\n" );
 
-	/* Verify point is on curve */
-	if ( ( rc = weierstrass_verify ( curve, &temp.multiple ) ) != 0 )
-		return rc;
+	/* Fail if result is the point at infinity
+	 *
+	 * The inverse is fully reduced, and so will be zero if and
+	 * only if the Z co-ordinate was zero modulo the field prime.
+	 */
+	if ( bigint_is_zero ( &temp.inverse ) ) {
+		DBGC ( curve, "WEIERSTRASS %s result is the point at "
+		       "infinity\n", curve->name );
+		return -EINVAL;
+	}
 
-	/* Construct identity element (the point at infinity) */
-	memset ( &temp.result, 0, sizeof ( temp.result ) );
-	bigint_copy ( one, &temp.result.y );
+	return 0;
+}
+
+/**
+ * Convert projective point in Montgomery form to affine co-ordinates
+ *
+ * @v curve		Weierstrass curve
+ * @v point		Point (x,y,z) to convert (will be clobbered)
+ * @v data		Raw affine point to fill in
+ * @ret rc		Return status code
+ */
+#define weierstrass_export( curve, point, data ) ( {			\
+	weierstrass_export_raw ( (curve), (point)->all.element, (data) ); \
+	} )
+
+/**
+ * Multiply generator point by scalar using fixed-base comb
+ *
+ * @v curve		Weierstrass curve
+ * @v scalar0		Element 0 of big integer scalar multiple
+ * @v result0		Element 0 of point (x,y,z) to hold result
+ *
+ * The table entry for each column is selected by scanning the whole
+ * table, so that the memory access pattern does not depend upon the
+ * value of the scalar.
+ */
+static void weierstrass_comb_raw ( const struct weierstrass_curve *curve,
+				   const bigint_element_t *scalar0,
+				   bigint_element_t *result0 ) {
+	unsigned int size = curve->size;
+	unsigned int spacing = ( ( curve->len * 8 ) / WEIERSTRASS_COMB_TEETH );
+	const bigint_t ( bigint_required_size ( curve->len ) )
+		__attribute__ (( may_alias ))
+		*scalar = ( ( const void * ) scalar0 );
+	const weierstrass_t ( size ) __attribute__ (( may_alias ))
+		*comb = ( ( const void * ) curve->comb );
+	weierstrass_t ( size ) __attribute__ (( may_alias ))
+		*result = ( ( void * ) result0 );
+	struct {
+		weierstrass_t ( size ) selected;
+		weierstrass_t ( size ) candidate;
+	} temp;
+	unsigned int column;
+	unsigned int index;
+	unsigned int i;
+
+	/* Start with identity element (the point at infinity) */
+	memcpy ( result, &comb[0], sizeof ( *result ) );
+
+	/* Process each column of the comb, most significant first */
+	for ( column = spacing ; column-- ; ) {
+
+		/* Double running total */
+		weierstrass_add ( curve, result, result, result );
+
+		/* Construct table index from the bits under each tooth */
+		index = 0;
+		for ( i = 0 ; i < WEIERSTRASS_COMB_TEETH ; i++ ) {
+			index |= ( bigint_bit_is_set ( scalar,
+						       ( column +
+							 ( i * spacing ) ) )
+				   << i );
+		}
+
+		/* Select table entry in constant time */
+		for ( i = 0 ; i < WEIERSTRASS_COMB_ENTRIES ; i++ ) {
+			bigint_copy ( &comb[i].all, &temp.candidate.all );
+			bigint_swap ( &temp.selected.all, &temp.candidate.all,
+				      ( i == index ) );
+		}
+
+		/* Add selected entry to running total */
+		weierstrass_add ( curve, result, &temp.selected, result );
+	}
+}
+
+/**
+ * Multiply generator point by scalar using fixed-base comb
+ *
+ * @v curve		Weierstrass curve
+ * @v scalar		Big integer scalar multiple
+ * @v result		Point (x,y,z) to hold result
+ */
+#define weierstrass_comb( curve, scalar, result ) do {			\
+	weierstrass_comb_raw ( (curve), (scalar)->element,		\
+			       (result)->all.element );			\
+	} while ( 0 )
+
+/**
+ * Multiply curve point by scalar
+ *
+ * @v curve		Weierstrass curve
+ * @v base		Base point (or NULL to use generator)
+ * @v scalar		Scalar multiple
+ * @v result		Result point to fill in
+ * @ret rc		Return status code
+ */
+int weierstrass_multiply ( struct weierstrass_curve *curve, const void *base,
+			   const void *scalar, void *result ) {
+	unsigned int size = curve->size;
+	size_t len = curve->len;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *one =
+		( ( const void * ) curve->one );
+	struct {
+		weierstrass_t ( size ) result;
+		weierstrass_t ( size ) multiple;
+		bigint_t ( bigint_required_size ( len ) ) scalar;
+	} temp;
+	int rc;
+
+	/* Initialise curve, if not already done */
+	weierstrass_init_once ( curve );
 
 	/* Initialise scalar */
 	bigint_init ( &temp.scalar, scalar, len );
 	DBGC ( curve, "WEIERSTRASS %s scalar %s\n",
 	       curve->name, bigint_ntoa ( &temp.scalar ) );
 
+	/* Use fixed-base comb for the generator point */
+	if ( ! base ) {
+		weierstrass_comb ( curve, &temp.scalar, &temp.result );
+		return weierstrass_export ( curve, &temp.result, result );
+	}
+
+	/* Convert input to projective coordinates in Montgomery form */
+	if ( ( rc = weierstrass_import ( curve, base, &temp.multiple ) ) != 0 )
+		return rc;
+
+	/* Construct identity element (the point at infinity) */
+	memset ( &temp.result, 0, sizeof ( temp.result ) );
+	bigint_copy ( one, &temp.result.y );
+
 	/* Perform multiplication via Montgomery ladder */
 	bigint_ladder ( &temp.result.all, &temp.multiple.all, &temp.scalar,
 			weierstrass_add_ladder, curve, NULL );
 
-	/* Invert result Z co-ordinate (via Fermat's little theorem) */
-	bigint_copy ( one, &temp.multiple.z );
-	bigint_ladder ( &temp.multiple.z, &temp.result.z, fermat,
-			bigint_mod_exp_ladder, prime, &temp.product_out );
-
 	/* Convert result back to affine co-ordinates */
-	DBGC ( curve, "WEIERSTRASS %s result (", curve->name );
-	for ( i = 0, offset = 0 ; i < WEIERSTRASS_AXES ; i++, offset += len ) {
-		bigint_multiply ( &temp.result.axis[i], &temp.multiple.z,
-				  &temp.product_out );
-		bigint_montgomery_relaxed ( prime, &temp.product_out,
-					    &temp.result.axis[i] );
-		bigint_grow ( &temp.result.axis[i], &temp.product_out );
-		bigint_montgomery ( prime, &temp.product_out,
-				    &temp.result.axis[i] );
-		DBGC ( curve, "%s%s", ( i ? "," : "" ),
-		       bigint_ntoa ( &temp.result.axis[i] ) );
-		bigint_done ( &temp.result.axis[i], ( result + offset ), len );
-	}
-	DBGC ( curve, ")\n" );
+	return weierstrass_export ( curve, &temp.result, result );
+}
 
-	return 0;
+/**
+ * Add curve points (as a one-off operation)
+ *
+ * @v curve		Weierstrass curve
+ * @v addend		Curve point to add
+ * @v augend		Curve point to add
+ * @v result		Curve point to hold result
+ * @ret rc		Return status code
+ *
+ * The inputs must be distinct points (or the same point) on the
+ * curve, and neither may be the point at infinity.  The operation
+ * fails if the result is the point at infinity.
+ */
+int weierstrass_add_once ( struct weierstrass_curve *curve,
+			   const void *addend, const void *augend,
+			   void *result ) {
+	unsigned int size = curve->size;
+	struct {
+		weierstrass_t ( size ) addend;
+		weierstrass_t ( size ) augend;
+	} temp;
+	int rc;
+
+	/* Initialise curve, if not already done */
+	weierstrass_init_once ( curve );
+
+	/* Convert inputs to projective coordinates in Montgomery form */
+	if ( ( rc = weierstrass_import ( curve, addend, &temp.addend ) ) != 0 )
+		return rc;
+	if ( ( rc = weierstrass_import ( curve, augend, &temp.augend ) ) != 0 )
+		return rc;
+
+	/* Add curve points */
+	weierstrass_add ( curve, &temp.augend, &temp.addend, &temp.augend );
+
+	/* Convert result back to affine co-ordinates */
+	return weierstrass_export ( curve, &temp.augend, result );
 }
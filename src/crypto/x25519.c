@@ -54,6 +54,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * The implementation is constant-time (provided that the underlying
  * big integer operations are also constant-time).
+ *
+ * Multiplication of the generator point (as used when generating an
+ * ephemeral key) is performed on the birationally equivalent twisted
+ * Edwards curve used by Ed25519, which has a complete addition law
+ * and so allows the use of a fixed-base comb with a table of
+ * precomputed generator multiples.
  */
 
 #include <stdint.h>
@@ -271,6 +277,56 @@ struct x25519_step {
 	struct x25519_projective x_n1;
 };
 
+/**
+ * A twisted Edwards curve point in extended coordinates
+ *
+ * The Montgomery curve used in X25519 is birationally equivalent to
+ * the twisted Edwards curve
+ *
+ *   -x^2 + y^2 = 1 + d * x^2 * y^2
+ *
+ * with d = -121665/121666, via the mapping u = (1 + y) / (1 - y).
+ *
+ * A point (x,y) is represented using extended coordinates
+ * (X:Y:Z:T) where x = X/Z, y = Y/Z, and x * y = T/Z.
+ */
+struct x25519_extended {
+	/** X coordinate */
+	union x25519_quad257 X;
+	/** Y coordinate */
+	union x25519_quad257 Y;
+	/** Z coordinate */
+	union x25519_quad257 Z;
+	/** T coordinate */
+	union x25519_quad257 T;
+};
+
+/**
+ * A twisted Edwards curve point in cached coordinates
+ *
+ * A point (X:Y:Z:T) is cached as (Y-X,Y+X,2*d*T,2*Z), since these are
+ * the values consumed by the point addition formula.
+ */
+struct x25519_cached {
+	/** Y - X */
+	union x25519_oct258 YmX;
+	/** Y + X */
+	union x25519_oct258 YpX;
+	/** 2 * d * T */
+	union x25519_quad257 T2d;
+	/** 2 * Z */
+	union x25519_oct258 Z2;
+};
+
+/** Number of teeth in the fixed-base comb */
+#define X25519_COMB_TEETH 4
+
+/** Number of entries in the fixed-base comb table */
+#define X25519_COMB_ENTRIES ( 1 << X25519_COMB_TEETH )
+
+/** Spacing between teeth in the fixed-base comb (in bits) */
+#define X25519_COMB_SPACING ( 256 / X25519_COMB_TEETH )
+
 /** Constant p=2^255-19 (the finite field prime) */
 static const uint8_t x25519_p_raw[] = {
 	0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
@@ -306,6 +362,36 @@ static struct x25519_value x25519_generator = {
 	.raw = { 9, }
 };
 
+/** Constant 2d (used in twisted Edwards curve point addition) */
+static const uint8_t x25519_2d_raw[] = {
+	0x24, 0x06, 0xd9, 0xdc, 0x56, 0xdf, 0xfc, 0xe7,
+	0x19, 0x8e, 0x80, 0xf2, 0xee, 0xf3, 0xd1, 0x30,
+	0x00, 0xe0, 0x14, 0x9a, 0x82, 0x83, 0xb1, 0x56,
+	0xeb, 0xd6, 0x9b, 0x94, 0x26, 0xb2, 0xf1, 0x59
+};
+
+/** Constant 2d (used in twisted Edwards curve point addition) */
+static union x25519_oct258 x25519_2d;
+
+/** Twisted Edwards curve x coordinate of the group generator */
+static const uint8_t x25519_edwards_x_raw[] = {
+	0x21, 0x69, 0x36, 0xd3, 0xcd, 0x6e, 0x53, 0xfe,
+	0xc0, 0xa4, 0xe2, 0x31, 0xfd, 0xd6, 0xdc, 0x5c,
+	0x69, 0x2c, 0xc7, 0x60, 0x95, 0x25, 0xa7, 0xb2,
+	0xc9, 0x56, 0x2d, 0x60, 0x8f, 0x25, 0xd5, 0x1a
+};
+
+/** Twisted Edwards curve y coordinate of the group generator (4/5) */
+static const uint8_t x25519_edwards_y_raw[] = {
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x58
+};
+
+/** Fixed-base comb table (constructed on first use) */
+static struct x25519_cached x25519_comb_table[X25519_COMB_ENTRIES];
+
 /**
  * Initialise constants
  *
@@ -330,6 +416,10 @@ static void x25519_init_constants ( void ) {
 	/* Construct constant 121665 */
 	bigint_init ( &x25519_121665.value, x25519_121665_raw,
 		      sizeof ( x25519_121665_raw ) );
+
+	/* Construct constant 2d */
+	bigint_init ( &x25519_2d.value, x25519_2d_raw,
+		      sizeof ( x25519_2d_raw ) );
 }
 
 /** Initialisation function */
@@ -765,6 +855,210 @@ static void x25519_ladder ( const union x25519_quad257 *base,
 	x25519_reduce ( result );
 }
 
+/**
+ * Construct twisted Edwards curve identity element
+ *
+ * @v point		Point to fill in
+ */
+static void x25519_identity ( struct x25519_extended *point ) {
+	static const uint8_t zero[] = { 0 };
+	static const uint8_t one[] = { 1 };
+
+	/* Identity element is (0,1) */
+	bigint_init ( &point->X.value, zero, sizeof ( zero ) );
+	bigint_init ( &point->Y.value, one, sizeof ( one ) );
+	bigint_init ( &point->Z.value, one, sizeof ( one ) );
+	bigint_init ( &point->T.value, zero, sizeof ( zero ) );
+}
+
+/**
+ * Convert twisted Edwards curve point to cached coordinates
+ *
+ * @v point		Point in extended coordinates
+ * @v cached		Point in cached coordinates to fill in
+ */
+static void x25519_cache ( const struct x25519_extended *point,
+			   struct x25519_cached *cached ) {
+	struct x25519_cached tmp;
+
+	/* Calculate cached coordinates */
+	x25519_subtract ( &point->Y, &point->X, &tmp.YmX );
+	x25519_add ( &point->Y, &point->X, &tmp.YpX );
+	x25519_multiply ( &point->T.oct258, &x25519_2d, &tmp.T2d );
+	x25519_add ( &point->Z, &point->Z, &tmp.Z2 );
+	memcpy ( cached, &tmp, sizeof ( *cached ) );
+}
+
+/**
+ * Add twisted Edwards curve points
+ *
+ * @v point		Point to add (and to hold result)
+ * @v addend		Point to add (in cached coordinates)
+ *
+ * This uses the unified "add-2008-hwcd-3" addition formula, which is
+ * complete for this curve and so may also be used for doubling, and
+ * for adding the identity element.
+ */
+static void x25519_edwards_add ( struct x25519_extended *point,
+				 const struct x25519_cached *addend ) {
+	union x25519_oct258 v1;
+	union x25519_oct258 v2;
+	union x25519_quad257 a;
+	union x25519_quad257 b;
+	union x25519_quad257 c;
+	union x25519_quad257 d;
+	union x25519_oct258 e;
+	union x25519_oct258 f;
+	union x25519_oct258 g;
+	union x25519_oct258 h;
+
+	/* a = (Y1 - X1) * (Y2 - X2) */
+	x25519_subtract ( &point->Y, &point->X, &v1 );
+	x25519_multiply ( &v1, &addend->YmX, &a );
+
+	/* b = (Y1 + X1) * (Y2 + X2) */
+	x25519_add ( &point->Y, &point->X, &v2 );
+	x25519_multiply ( &v2, &addend->YpX, &b );
+
+	/* c = T1 * 2 * d * T2 */
+	x25519_multiply ( &point->T.oct258, &addend->T2d.oct258, &c );
+
+	/* d = Z1 * 2 * Z2 */
+	x25519_multiply ( &point->Z.oct258, &addend->Z2, &d );
+
+	/* e = b - a, f = d - c, g = d + c, h = b + a */
+	x25519_subtract ( &b, &a, &e );
+	x25519_subtract ( &d, &c, &f );
+	x25519_add ( &d, &c, &g );
+	x25519_add ( &b, &a, &h );
+
+	/* X3 = e * f, Y3 = g * h, T3 = e * h, Z3 = f * g */
+	x25519_multiply ( &e, &f, &point->X );
+	x25519_multiply ( &g, &h, &point->Y );
+	x25519_multiply ( &e, &h, &point->T );
+	x25519_multiply ( &f, &g, &point->Z );
+}
+
+/**
+ * Double twisted Edwards curve point
+ *
+ * @v point		Point to double (and to hold result)
+ */
+static void x25519_edwards_double ( struct x25519_extended *point ) {
+	struct x25519_cached cached;
+
+	/* Add point to itself */
+	x25519_cache ( point, &cached );
+	x25519_edwards_add ( point, &cached );
+}
+
+/**
+ * Construct fixed-base comb table
+ *
+ * Entry j of the comb table is the sum of the points (2^(64*i))G for
+ * each bit i that is set in j.
+ */
+static void x25519_comb_init ( void ) {
+	static const uint8_t one[] = { 1 };
+	struct x25519_cached teeth[X25519_COMB_TEETH];
+	struct x25519_extended point;
+	unsigned int i;
+	unsigned int j;
+
+	/* Construct (2^(64*i))G for each tooth i */
+	bigint_init ( &point.X.value, x25519_edwards_x_raw,
+		      sizeof ( x25519_edwards_x_raw ) );
+	bigint_init ( &point.Y.value, x25519_edwards_y_raw,
+		      sizeof ( x25519_edwards_y_raw ) );
+	bigint_init ( &point.Z.value, one, sizeof ( one ) );
+	x25519_multiply ( &point.X.oct258, &point.Y.oct258, &point.T );
+	for ( i = 0 ; i < X25519_COMB_TEETH ; i++ ) {
+		if ( i ) {
+			for ( j = 0 ; j < X25519_COMB_SPACING ; j++ )
+				x25519_edwards_double ( &point );
+		}
+		x25519_cache ( &point, &teeth[i] );
+	}
+
+	/* Construct each table entry */
+	for ( j = 0 ; j < X25519_COMB_ENTRIES ; j++ ) {
+		x25519_identity ( &point );
+		for ( i = 0 ; i < X25519_COMB_TEETH ; i++ ) {
+			if ( j & ( 1 << i ) )
+				x25519_edwards_add ( &point, &teeth[i] );
+		}
+		x25519_cache ( &point, &x25519_comb_table[j] );
+	}
+}
+
+/**
+ * Multiply X25519 group generator using fixed-base comb
+ *
+ * @v scalar		Scalar multiple (clamped, in little-endian order)
+ * @v result		Point to hold result
+ *
+ * The table entry for each column is selected by scanning the whole
+ * table, so that the memory access pattern does not depend upon the
+ * value of the scalar.
+ */
+static void x25519_comb ( const struct x25519_value *scalar,
+			  union x25519_quad257 *result ) {
+	struct x25519_extended point;
+	struct x25519_cached selected;
+	struct x25519_cached candidate;
+	union x25519_oct258 numerator;
+	union x25519_oct258 denominator;
+	union x25519_quad257 inverse;
+	unsigned int column;
+	unsigned int index;
+	unsigned int bit;
+	unsigned int i;
+
+	/* Construct comb table, if not already done */
+	if ( bigint_is_zero ( &x25519_comb_table[0].Z2.value ) )
+		x25519_comb_init();
+
+	/* Process each column of the comb, most significant first */
+	x25519_identity ( &point );
+	for ( column = X25519_COMB_SPACING ; column-- ; ) {
+
+		/* Double running total */
+		x25519_edwards_double ( &point );
+
+		/* Construct table index from the bits under each tooth */
+		index = 0;
+		for ( i = 0 ; i < X25519_COMB_TEETH ; i++ ) {
+			bit = ( column + ( i * X25519_COMB_SPACING ) );
+			index |= ( ( ( scalar->raw[ bit / 8 ] >> ( bit % 8 ) )
+				     & 1 ) << i );
+		}
+
+		/* Select table entry in constant time */
+		for ( i = 0 ; i < X25519_COMB_ENTRIES ; i++ ) {
+			memcpy ( &candidate, &x25519_comb_table[i],
+				 sizeof ( candidate ) );
+			bigint_swap ( &selected.YmX.value,
+				      &candidate.YmX.value, ( i == index ) );
+			bigint_swap ( &selected.YpX.value,
+				      &candidate.YpX.value, ( i == index ) );
+			bigint_swap ( &selected.T2d.value,
+				      &candidate.T2d.value, ( i == index ) );
+			bigint_swap ( &selected.Z2.value,
+				      &candidate.Z2.value, ( i == index ) );
+		}
+
+		/* Add selected entry to running total */
+		x25519_edwards_add ( &point, &selected );
+	}
+
+	/* Convert to Montgomery curve coordinate u = (Z + Y) / (Z - Y) */
+	x25519_add ( &point.Z, &point.Y, &numerator );
+	x25519_subtract ( &point.Z, &point.Y, &denominator );
+	x25519_invert ( &denominator, &inverse );
+	x25519_multiply ( &numerator, &inverse.oct258, result );
+	x25519_reduce ( result );
+}
+
 /**
  * Reverse X25519 value endianness
  *
@@ -819,6 +1113,39 @@ int x25519_key ( const struct x25519_value *base,
 	return ( bigint_is_zero ( &point.value ) ? -EPERM : 0 );
 }
 
+/**
+ * Calculate X25519 key using the group generator
+ *
+ * @v scalar		Scalar multiple
+ * @v result		Point to hold result
+ * @ret rc		Return status code
+ */
+static int x25519_generate ( const struct x25519_value *scalar,
+			     struct x25519_value *result ) {
+	struct x25519_value tmp;
+	union x25519_quad257 point;
+
+	/* Clamp scalar as required by RFC7748
+	 *
+	 * The Montgomery ladder ignores bit 255, but the comb does
+	 * not and so we must clear it explicitly.
+	 */
+	memcpy ( &tmp, scalar, sizeof ( tmp ) );
+	tmp.raw[0] &= 0xf8;
+	tmp.raw[31] &= 0x7f;
+	tmp.raw[31] |= 0x40;
+
+	/* Multiply group generator */
+	x25519_comb ( &tmp, &point );
+
+	/* Reverse result */
+	bigint_done ( &point.value, result->raw, sizeof ( result->raw ) );
+	x25519_reverse ( result );
+
+	/* Fail if result was all zeros (as required by RFC8422) */
+	return ( bigint_is_zero ( &point.value ) ? -EPERM : 0 );
+}
+
 /**
  * Multiply scalar by curve point
  *
@@ -830,9 +1157,9 @@ int x25519_key ( const struct x25519_value *base,
 static int x25519_curve_multiply ( const void *base, const void *scalar,
 				   void *result ) {
 
-	/* Use base point if applicable */
+	/* Use fixed-base comb for the generator point */
 	if ( ! base )
-		base = &x25519_generator;
+		return x25519_generate ( scalar, result );
 
 	return x25519_key ( base, scalar, result );
 }
@@ -842,5 +1169,6 @@ struct elliptic_curve x25519_curve = {
 	.name = "x25519",
 	.pointsize = sizeof ( struct x25519_value ),
 	.keysize = sizeof ( struct x25519_value ),
+	.base = &x25519_generator,
 	.multiply = x25519_curve_multiply,
 };
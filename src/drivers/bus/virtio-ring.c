@@ -80,6 +80,11 @@ void *vring_get_buf(struct vring_virtqueue *vq, unsigned int *len)
 
    vq->last_used_idx++;
 
+   /* rearm the used event index if callbacks are wanted */
+
+   if (vq->event_idx && !(vr->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+           *vring_used_event(vr) = vq->last_used_idx;
+
    return opaque;
 }
 
@@ -126,12 +131,20 @@ void vring_kick(struct virtio_pci_modern_device *vdev, unsigned int ioaddr,
                 struct vring_virtqueue *vq, int num_added)
 {
    struct vring *vr = &vq->vring;
+   u16 old_idx = vr->avail->idx;
+   u16 new_idx = (old_idx + num_added);
+   int notify;
 
    wmb();
-   vr->avail->idx += num_added;
+   vr->avail->idx = new_idx;
 
    mb();
-   if (!(vr->used->flags & VRING_USED_F_NO_NOTIFY)) {
+   if (vq->event_idx) {
+           notify = vring_need_event(*vring_avail_event(vr), new_idx, old_idx);
+   } else {
+           notify = !(vr->used->flags & VRING_USED_F_NO_NOTIFY);
+   }
+   if (notify) {
            if (vdev) {
                    /* virtio 1.0 */
                    vpm_notify(vdev, vq);
@@ -45,16 +45,64 @@
 #define LINUX_SOCK_RAW 3
 #define LINUX_SIOCGIFINDEX 0x8933
 #define LINUX_SIOCGIFHWADDR 0x8927
+#define LINUX_SOL_PACKET 263
+#define LINUX_MSG_DONTWAIT 0x40
 
 #define RX_BUF_SIZE 1536
 
+/** Size of a memory-mapped ring block */
+#define AF_PACKET_BLOCK_SIZE ( 64 * 1024 )
+
+/** Size of a memory-mapped ring frame */
+#define AF_PACKET_FRAME_SIZE 2048
+
+/** Number of receive ring frames */
+#define AF_PACKET_RX_FRAMES 512
+
+/** Number of transmit ring frames */
+#define AF_PACKET_TX_FRAMES 64
+
+/** Number of transmit ring frames to fill before notifying the kernel */
+#define AF_PACKET_TX_BATCH ( AF_PACKET_TX_FRAMES / 2 )
+
+/** Offset to packet data within a transmit ring frame */
+#define AF_PACKET_TX_DATA_OFFSET \
+	( TPACKET2_HDRLEN - sizeof ( struct sockaddr_ll ) )
+
 /** @file
  *
  * The AF_PACKET driver.
  *
  * Bind to an existing linux network interface.
+ *
+ * Where supported by the host kernel, packets are exchanged via
+ * TPACKET_V2 receive and transmit rings mapped into the process.
+ * This allows each poll to drain all received packets and each
+ * transmission to be queued without a system call.  If the rings
+ * cannot be created, the driver falls back to using read() and
+ * sendto() on the packet socket.
+ *
+ * TPACKET_V3 is deliberately not used: it hands over received
+ * packets only in whole blocks, which are retired only when full or
+ * when a timer expires.  This adds up to a timer period of latency
+ * to every received packet, which is disastrous for the lock-step
+ * protocols (such as TFTP) typically exercised via this driver.
  */
 
+/** A memory-mapped packet ring */
+struct af_packet_ring {
+	/** Start of ring (or NULL if ring is not in use) */
+	void *base;
+	/** Length of ring */
+	size_t len;
+	/** Size of each frame */
+	size_t size;
+	/** Number of frames */
+	unsigned int count;
+	/** Index of next frame to process */
+	unsigned int index;
+};
+
 struct af_packet_nic {
 	/** Linux network interface name */
 	char * ifname;
@@ -62,8 +110,192 @@ struct af_packet_nic {
 	int fd;
 	/** ifindex */
 	int ifindex;
+	/** Receive ring */
+	struct af_packet_ring rx;
+	/** Transmit ring */
+	struct af_packet_ring tx;
+	/** Number of transmit frames awaiting notification */
+	unsigned int tx_pending;
 };
 
+/**
+ * Get next frame in packet ring
+ *
+ * @v ring		Packet ring
+ * @ret hdr		Frame header
+ */
+static inline struct tpacket2_hdr *
+af_packet_ring_frame ( struct af_packet_ring *ring )
+{
+	return ( ring->base + ( ring->index * ring->size ) );
+}
+
+/**
+ * Advance packet ring
+ *
+ * @v ring		Packet ring
+ */
+static inline void af_packet_ring_advance ( struct af_packet_ring *ring )
+{
+	if (++ring->index == ring->count)
+		ring->index = 0;
+}
+
+/**
+ * Destroy packet rings
+ *
+ * @v nic		AF_PACKET NIC
+ *
+ * The rings must not be mapped.  The socket remains usable via
+ * read() and sendto().
+ */
+static void af_packet_nic_unring ( struct af_packet_nic *nic )
+{
+	struct tpacket_req req;
+
+	/* A request for zero blocks destroys the ring */
+	memset(&req, 0, sizeof(req));
+	if (nic->tx.len) {
+		linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_TX_RING,
+				 &req, sizeof(req));
+	}
+	linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_RX_RING,
+			 &req, sizeof(req));
+	memset(&nic->rx, 0, sizeof(nic->rx));
+	memset(&nic->tx, 0, sizeof(nic->tx));
+}
+
+/**
+ * Create and map packet rings
+ *
+ * @v nic		AF_PACKET NIC
+ * @ret rc		Return status code
+ *
+ * Returns -ENOTSUP if the rings cannot be created or mapped, in which
+ * case the socket remains usable via read() and sendto().  The
+ * transmit ring is optional.
+ */
+static int af_packet_nic_map ( struct af_packet_nic *nic )
+{
+	struct tpacket_req req;
+	int version = TPACKET_V2;
+	int one = 1;
+	void *base;
+	int ret;
+
+	memset(&nic->rx, 0, sizeof(nic->rx));
+	memset(&nic->tx, 0, sizeof(nic->tx));
+	nic->tx_pending = 0;
+
+	/* Select TPACKET_V2 */
+	ret = linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_VERSION,
+			       &version, sizeof(version));
+	if (ret != 0) {
+		DBGC(nic, "af_packet %p cannot use TPACKET_V2 (%s)\n",
+		     nic, linux_strerror(linux_errno));
+		return -ENOTSUP;
+	}
+
+	/* Create receive ring */
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = AF_PACKET_BLOCK_SIZE;
+	req.tp_block_nr = ((AF_PACKET_RX_FRAMES * AF_PACKET_FRAME_SIZE) /
+			   AF_PACKET_BLOCK_SIZE);
+	req.tp_frame_size = AF_PACKET_FRAME_SIZE;
+	req.tp_frame_nr = AF_PACKET_RX_FRAMES;
+	ret = linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_RX_RING,
+			       &req, sizeof(req));
+	if (ret != 0) {
+		DBGC(nic, "af_packet %p cannot create RX ring (%s)\n",
+		     nic, linux_strerror(linux_errno));
+		return -ENOTSUP;
+	}
+	nic->rx.size = AF_PACKET_FRAME_SIZE;
+	nic->rx.count = AF_PACKET_RX_FRAMES;
+	nic->rx.len = (nic->rx.size * nic->rx.count);
+
+	/* Create transmit ring, if supported */
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = AF_PACKET_BLOCK_SIZE;
+	req.tp_block_nr = ((AF_PACKET_TX_FRAMES * AF_PACKET_FRAME_SIZE) /
+			   AF_PACKET_BLOCK_SIZE);
+	req.tp_frame_size = AF_PACKET_FRAME_SIZE;
+	req.tp_frame_nr = AF_PACKET_TX_FRAMES;
+	ret = linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_TX_RING,
+			       &req, sizeof(req));
+	if (ret == 0) {
+		nic->tx.size = AF_PACKET_FRAME_SIZE;
+		nic->tx.count = AF_PACKET_TX_FRAMES;
+		nic->tx.len = (nic->tx.size * nic->tx.count);
+	} else {
+		DBGC(nic, "af_packet %p cannot create TX ring (%s)\n",
+		     nic, linux_strerror(linux_errno));
+	}
+
+	/* Bypass the queueing discipline for transmitted packets.
+	 * This is an optimisation only, so ignore any failure.
+	 */
+	ret = linux_setsockopt(nic->fd, LINUX_SOL_PACKET, PACKET_QDISC_BYPASS,
+			       &one, sizeof(one));
+	if (ret != 0) {
+		DBGC(nic, "af_packet %p cannot bypass qdisc (%s)\n",
+		     nic, linux_strerror(linux_errno));
+	}
+
+	/* Map rings (receive ring first, as mandated by the kernel) */
+	base = linux_mmap(NULL, (nic->rx.len + nic->tx.len),
+			  (PROT_READ | PROT_WRITE), MAP_SHARED, nic->fd, 0);
+	if (base == MAP_FAILED) {
+		DBGC(nic, "af_packet %p cannot map rings (%s)\n",
+		     nic, linux_strerror(linux_errno));
+		af_packet_nic_unring(nic);
+		return -ENOTSUP;
+	}
+	nic->rx.base = base;
+	if (nic->tx.len)
+		nic->tx.base = (base + nic->rx.len);
+	DBGC(nic, "af_packet %p using TPACKET_V2 rings (%d RX, %d TX "
+	     "frames)\n", nic, nic->rx.count, nic->tx.count);
+
+	return 0;
+}
+
+/**
+ * Notify kernel of queued transmit frames
+ *
+ * @v nic		AF_PACKET NIC
+ * @v flags		Send flags
+ */
+static void af_packet_nic_flush ( struct af_packet_nic *nic, int flags )
+{
+	int ret;
+
+	ret = linux_sendto(nic->fd, NULL, 0, flags, NULL, 0);
+	if (ret < 0) {
+		DBGC(nic, "af_packet %p could not flush TX ring (%s)\n",
+		     nic, linux_strerror(linux_errno));
+	}
+	nic->tx_pending = 0;
+}
+
+/**
+ * Unmap packet rings
+ *
+ * @v nic		AF_PACKET NIC
+ */
+static void af_packet_nic_unmap ( struct af_packet_nic *nic )
+{
+	/* Wait for any queued transmissions to complete */
+	if (nic->tx_pending)
+		af_packet_nic_flush(nic, 0);
+
+	/* Unmap rings */
+	if (nic->rx.base)
+		linux_munmap(nic->rx.base, (nic->rx.len + nic->tx.len));
+	nic->rx.base = NULL;
+	nic->tx.base = NULL;
+}
+
 /** Open the linux interface */
 static int af_packet_nic_open ( struct net_device * netdev )
 {
@@ -93,6 +325,13 @@ static int af_packet_nic_open ( struct net_device * netdev )
 
 	nic->ifindex = if_data.ifr_ifindex;
 
+	/* create packet rings, if supported */
+	ret = af_packet_nic_map(nic);
+	if ((ret != 0) && (ret != -ENOTSUP)) {
+		linux_close(nic->fd);
+		return ret;
+	}
+
 	/* bind to interface */
 	memset(&socket_address, 0, sizeof(socket_address));
 	socket_address.sll_family = LINUX_AF_PACKET;
@@ -103,6 +342,7 @@ static int af_packet_nic_open ( struct net_device * netdev )
 	if (ret == -1) {
 		DBGC(nic, "af_packet %p bind() = %d (%s)\n",
 		     nic, ret, linux_strerror(linux_errno));
+		af_packet_nic_unmap(nic);
 		linux_close(nic->fd);
 		return ret;
 	}
@@ -112,6 +352,7 @@ static int af_packet_nic_open ( struct net_device * netdev )
 	if (ret != 0) {
 		DBGC(nic, "af_packet %p fcntl(%d, ...) = %d (%s)\n",
 		     nic, nic->fd, ret, linux_strerror(linux_errno));
+		af_packet_nic_unmap(nic);
 		linux_close(nic->fd);
 		return ret;
 	}
@@ -123,9 +364,53 @@ static int af_packet_nic_open ( struct net_device * netdev )
 static void af_packet_nic_close ( struct net_device *netdev )
 {
 	struct af_packet_nic * nic = netdev->priv;
+	af_packet_nic_unmap(nic);
 	linux_close(nic->fd);
 }
 
+/**
+ * Transmit an ethernet packet via the transmit ring.
+ *
+ * The packet is copied into the ring and can be marked as complete
+ * immediately.  The kernel is notified once a batch of frames has
+ * been queued, or on the next poll.
+ */
+static int af_packet_nic_transmit_ring ( struct net_device *netdev,
+					 struct io_buffer *iobuf )
+{
+	struct af_packet_nic * nic = netdev->priv;
+	struct tpacket2_hdr *hdr;
+	size_t len = iob_len(iobuf);
+
+	/* Check that packet fits within a frame */
+	if (len > (nic->tx.size - AF_PACKET_TX_DATA_OFFSET))
+		return -ERANGE;
+
+	/* Wait for the kernel to release a frame, if necessary */
+	hdr = af_packet_ring_frame(&nic->tx);
+	if (hdr->tp_status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) {
+		af_packet_nic_flush(nic, 0);
+		if (hdr->tp_status & (TP_STATUS_SEND_REQUEST |
+				      TP_STATUS_SENDING))
+			return -ENOBUFS;
+	}
+
+	/* Populate frame and hand over to kernel */
+	memcpy(((void *)hdr + AF_PACKET_TX_DATA_OFFSET), iobuf->data, len);
+	hdr->tp_len = len;
+	__sync_synchronize();
+	hdr->tp_status = TP_STATUS_SEND_REQUEST;
+	af_packet_ring_advance(&nic->tx);
+	DBGC2(nic, "af_packet %p queued %zd bytes\n", nic, len);
+	netdev_tx_complete(netdev, iobuf);
+
+	/* Notify kernel once a batch is ready */
+	if (++nic->tx_pending >= AF_PACKET_TX_BATCH)
+		af_packet_nic_flush(nic, LINUX_MSG_DONTWAIT);
+
+	return 0;
+}
+
 /**
  * Transmit an ethernet packet.
  *
@@ -139,6 +424,10 @@ static int af_packet_nic_transmit ( struct net_device *netdev,
 	const struct ethhdr * eh;
 	int rc;
 
+	/* Use transmit ring, if available */
+	if (nic->tx.base)
+		return af_packet_nic_transmit_ring(netdev, iobuf);
+
 	memset(&socket_address, 0, sizeof(socket_address));
 	socket_address.sll_family = LINUX_AF_PACKET;
 	socket_address.sll_ifindex = nic->ifindex;
@@ -157,6 +446,58 @@ static int af_packet_nic_transmit ( struct net_device *netdev,
 	return 0;
 }
 
+/**
+ * Poll for new packets via the receive ring.
+ *
+ * All frames that have been handed over by the kernel are drained
+ * and returned, without any system calls.
+ */
+static void af_packet_nic_poll_ring ( struct net_device *netdev )
+{
+	struct af_packet_nic * nic = netdev->priv;
+	struct tpacket2_hdr *hdr;
+	struct io_buffer *iobuf;
+	unsigned int frames;
+
+	/* Notify kernel of any queued transmit frames */
+	if (nic->tx_pending)
+		af_packet_nic_flush(nic, LINUX_MSG_DONTWAIT);
+
+	for (frames = 0; frames < nic->rx.count; frames++) {
+
+		/* Stop at first frame still owned by the kernel */
+		hdr = af_packet_ring_frame(&nic->rx);
+		if (! (hdr->tp_status & TP_STATUS_USER))
+			break;
+		__sync_synchronize();
+
+		/* Hand packet to the network stack */
+		DBGC2(nic, "af_packet %p received %d bytes\n",
+		      nic, hdr->tp_snaplen);
+		if (hdr->tp_len > hdr->tp_snaplen) {
+			DBGC(nic, "af_packet %p dropped truncated packet "
+			     "(%d of %d bytes)\n", nic, hdr->tp_snaplen,
+			     hdr->tp_len);
+			netdev_rx_err(netdev, NULL, -EMSGSIZE);
+			goto next;
+		}
+		iobuf = alloc_iob(hdr->tp_snaplen);
+		if (iobuf) {
+			memcpy(iob_put(iobuf, hdr->tp_snaplen),
+			       ((void *)hdr + hdr->tp_mac), hdr->tp_snaplen);
+			netdev_rx(netdev, iobuf);
+		} else {
+			netdev_rx_err(netdev, NULL, -ENOMEM);
+		}
+
+	next:
+		/* Return frame to kernel */
+		__sync_synchronize();
+		hdr->tp_status = TP_STATUS_KERNEL;
+		af_packet_ring_advance(&nic->rx);
+	}
+}
+
 /** Poll for new packets */
 static void af_packet_nic_poll ( struct net_device *netdev )
 {
@@ -165,6 +506,12 @@ static void af_packet_nic_poll ( struct net_device *netdev )
 	struct io_buffer * iobuf;
 	int r;
 
+	/* Use receive ring, if available */
+	if (nic->rx.base) {
+		af_packet_nic_poll_ring(netdev);
+		return;
+	}
+
 	pfd.fd = nic->fd;
 	pfd.events = POLLIN;
 	if (linux_poll(&pfd, 1, 0) == -1) {
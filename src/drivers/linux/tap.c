@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <ipxe/linux_api.h>
 #include <ipxe/list.h>
 #include <ipxe/linux.h>
@@ -29,6 +30,7 @@
 #include <ipxe/ethernet.h>
 #include <ipxe/settings.h>
 #include <ipxe/socket.h>
+#include <ipxe/tcp.h>
 
 /* This hack prevents pre-2.6.32 headers from redefining struct sockaddr */
 #define _SYS_SOCKET_H
@@ -38,64 +40,115 @@
 #include <linux/if.h>
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
+#include <linux/uio.h>
+#include <linux/virtio_net.h>
 
 #define RX_BUF_SIZE 1536
-#define RX_QUOTA 4
+#define RX_QUOTA 32
+
+/** Maximum number of queues */
+#define TAP_MAX_QUEUES 8
 
 /** @file
  *
  * The TAP driver.
  *
  * The TAP is a Virtual Ethernet network device.
+ *
+ * Each packet is preceded by a virtio net header (carrying checksum
+ * and segmentation offload information), which is transferred
+ * alongside the packet data using vectored I/O.  Multiple queues may
+ * be requested via the "queues" setting, in which case packets are
+ * received from all queues.
  */
 
 struct tap_nic {
 	/** Tap interface name */
 	char * interface;
-	/** File descriptor of the opened tap device */
-	int fd;
+	/** Number of queues */
+	unsigned int queues;
+	/** File descriptors of the opened tap device queues */
+	int fd[TAP_MAX_QUEUES];
 };
 
 /** Default MAC address */
 static const uint8_t tap_default_mac[ETH_ALEN] =
 	{ 0x52, 0x54, 0x00, 0x12, 0x34, 0x56 };
 
-/** Open the TAP device */
-static int tap_open(struct net_device * netdev)
+/**
+ * Open a TAP device queue
+ *
+ * @v nic		TAP NIC
+ * @ret fd		File descriptor, or negative error
+ */
+static int tap_open_queue(struct tap_nic *nic)
 {
-	struct tap_nic * nic = netdev->priv;
 	struct ifreq ifr;
+	int fd;
 	int ret;
 
-	nic->fd = linux_open("/dev/net/tun", O_RDWR);
-	if (nic->fd < 0) {
-		DBGC(nic, "tap %p open('/dev/net/tun') = %d (%s)\n", nic, nic->fd, linux_strerror(linux_errno));
-		return nic->fd;
+	fd = linux_open("/dev/net/tun", O_RDWR);
+	if (fd < 0) {
+		DBGC(nic, "tap %p open('/dev/net/tun') = %d (%s)\n", nic, fd, linux_strerror(linux_errno));
+		return fd;
 	}
 
 	memset(&ifr, 0, sizeof(ifr));
-	/* IFF_NO_PI for no extra packet information */
-	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	/* IFF_NO_PI for no extra packet information, IFF_VNET_HDR for
+	 * a virtio net header (carrying checksum offload information)
+	 * preceding each packet
+	 */
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI | IFF_VNET_HDR;
+	if (nic->queues > 1)
+		ifr.ifr_flags |= IFF_MULTI_QUEUE;
 	strncpy(ifr.ifr_name, nic->interface, IFNAMSIZ);
 	DBGC(nic, "tap %p interface = '%s'\n", nic, nic->interface);
 
-	ret = linux_ioctl(nic->fd, TUNSETIFF, &ifr);
+	ret = linux_ioctl(fd, TUNSETIFF, &ifr);
 
 	if (ret != 0) {
-		DBGC(nic, "tap %p ioctl(%d, ...) = %d (%s)\n", nic, nic->fd, ret, linux_strerror(linux_errno));
-		linux_close(nic->fd);
+		DBGC(nic, "tap %p ioctl(%d, ...) = %d (%s)\n", nic, fd, ret, linux_strerror(linux_errno));
+		linux_close(fd);
 		return ret;
 	}
 
+	/* Allow packets with partial checksums to be received.  This
+	 * is an optimisation only, so ignore any failure.
+	 */
+	ret = linux_ioctl(fd, TUNSETOFFLOAD, TUN_F_CSUM);
+	if (ret != 0) {
+		DBGC(nic, "tap %p could not enable checksum offload (%s)\n", nic, linux_strerror(linux_errno));
+	}
+
 	/* Set nonblocking mode to make tap_poll easier */
-	ret = linux_fcntl(nic->fd, F_SETFL, O_NONBLOCK);
+	ret = linux_fcntl(fd, F_SETFL, O_NONBLOCK);
 
 	if (ret != 0) {
-		DBGC(nic, "tap %p fcntl(%d, ...) = %d (%s)\n", nic, nic->fd, ret, linux_strerror(linux_errno));
-		linux_close(nic->fd);
+		DBGC(nic, "tap %p fcntl(%d, ...) = %d (%s)\n", nic, fd, ret, linux_strerror(linux_errno));
+		linux_close(fd);
 		return ret;
 	}
 
+	return fd;
+}
+
+/** Open the TAP device */
+static int tap_open(struct net_device * netdev)
+{
+	struct tap_nic * nic = netdev->priv;
+	unsigned int i;
+	int fd;
+
+	for (i = 0; i < nic->queues; i++) {
+		fd = tap_open_queue(nic);
+		if (fd < 0) {
+			while (i--)
+				linux_close(nic->fd[i]);
+			return fd;
+		}
+		nic->fd[i] = fd;
+	}
+
 	return 0;
 }
 
@@ -103,63 +156,110 @@ static int tap_open(struct net_device * netdev)
 static void tap_close(struct net_device *netdev)
 {
 	struct tap_nic * nic = netdev->priv;
-	linux_close(nic->fd);
+	unsigned int i;
+
+	for (i = 0; i < nic->queues; i++)
+		linux_close(nic->fd[i]);
 }
 
 /**
  * Transmit an ethernet packet.
  *
  * The packet can be written to the TAP device and marked as complete immediately.
+ *
+ * All packets are transmitted via the first queue.  There is only a
+ * single thread of execution, so spreading transmissions across
+ * queues would gain nothing and would risk reordering packets.
  */
 static int tap_transmit(struct net_device *netdev, struct io_buffer *iobuf)
 {
 	struct tap_nic * nic = netdev->priv;
+	struct virtio_net_hdr hdr;
+	struct tcp_header *tcphdr;
+	struct iovec iov[2];
 	int rc;
 
 	/* Pad and align packet */
 	iob_pad(iobuf, ETH_ZLEN);
 
-	rc = linux_write(nic->fd, iobuf->data, iobuf->tail - iobuf->data);
+	/* Construct virtio net header */
+	memset(&hdr, 0, sizeof(hdr));
+	if (iobuf->csum == IOB_CSUM_PARTIAL) {
+		hdr.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr.csum_start = (iobuf->csum_start - iobuf->data);
+		hdr.csum_offset = iobuf->csum_offset;
+	}
+	if (iobuf->gso) {
+		tcphdr = iobuf->csum_start;
+		hdr.gso_type = ((iobuf->gso == IOB_GSO_TCPV6) ?
+				VIRTIO_NET_HDR_GSO_TCPV6 :
+				VIRTIO_NET_HDR_GSO_TCPV4);
+		hdr.gso_size = iobuf->gso_size;
+		hdr.hdr_len = (hdr.csum_start + ((tcphdr->hlen & 0xf0) >> 2));
+	}
+
+	/* Write header and packet in a single system call */
+	iov[0].iov_base = &hdr;
+	iov[0].iov_len = sizeof(hdr);
+	iov[1].iov_base = iobuf->data;
+	iov[1].iov_len = iob_len(iobuf);
+	rc = linux_writev(nic->fd[0], iov, 2);
 	DBGC2(nic, "tap %p wrote %d bytes\n", nic, rc);
 	netdev_tx_complete(netdev, iobuf);
 
 	return 0;
 }
 
-/** Poll for new packets */
-static void tap_poll(struct net_device *netdev)
+/**
+ * Receive packets from a TAP device queue
+ *
+ * @v netdev		Network device
+ * @v fd		File descriptor
+ */
+static void tap_poll_queue(struct net_device *netdev, int fd)
 {
 	struct tap_nic * nic = netdev->priv;
-	struct pollfd pfd;
 	struct io_buffer * iobuf;
+	struct virtio_net_hdr hdr;
+	struct iovec iov[2];
 	unsigned int quota = RX_QUOTA;
 	int r;
 
-	pfd.fd = nic->fd;
-	pfd.events = POLLIN;
-	if (linux_poll(&pfd, 1, 0) == -1) {
-		DBGC(nic, "tap %p poll failed (%s)\n", nic, linux_strerror(linux_errno));
-		return;
-	}
-	if ((pfd.revents & POLLIN) == 0)
-		return;
-
-	/* At this point we know there is at least one new packet to be read */
-
 	iobuf = alloc_iob(RX_BUF_SIZE);
 	if (! iobuf)
 		goto allocfail;
 
-	while (quota-- &&
-	       ((r = linux_read(nic->fd, iobuf->data, RX_BUF_SIZE)) > 0)) {
+	iov[0].iov_base = &hdr;
+	iov[0].iov_len = sizeof(hdr);
+	iov[1].iov_base = iobuf->data;
+	iov[1].iov_len = RX_BUF_SIZE;
+	while (quota-- && ((r = linux_readv(fd, iov, 2)) > 0)) {
 		DBGC2(nic, "tap %p read %d bytes\n", nic, r);
 
-		iob_put(iobuf, r);
+		/* Strip virtio net header */
+		if (r < (int)sizeof(hdr)) {
+			netdev_rx_err(netdev, iobuf, -EINVAL);
+			goto next;
+		}
+		iob_put(iobuf, (r - sizeof(hdr)));
+
+		/* Packets with partial checksums originate from the
+		 * host itself and are known to be intact.  There is
+		 * no external consumer of received packets (such as
+		 * UNDI or SNP) on this platform, so there is no need
+		 * to complete the checksum.
+		 */
+		if (hdr.flags & (VIRTIO_NET_HDR_F_NEEDS_CSUM |
+				 VIRTIO_NET_HDR_F_DATA_VALID))
+			iobuf->csum = IOB_CSUM_VALID;
+
 		netdev_rx(netdev, iobuf);
 
+	next:
 		iobuf = alloc_iob(RX_BUF_SIZE);
 		if (! iobuf)
 			goto allocfail;
+		iov[1].iov_base = iobuf->data;
 	}
 
 	free_iob(iobuf);
@@ -169,6 +269,30 @@ allocfail:
 	DBGC(nic, "tap %p alloc_iob failed\n", nic);
 }
 
+/** Poll for new packets */
+static void tap_poll(struct net_device *netdev)
+{
+	struct tap_nic * nic = netdev->priv;
+	struct pollfd pfd[TAP_MAX_QUEUES];
+	unsigned int i;
+
+	for (i = 0; i < nic->queues; i++) {
+		pfd[i].fd = nic->fd[i];
+		pfd[i].events = POLLIN;
+		pfd[i].revents = 0;
+	}
+	if (linux_poll(pfd, nic->queues, 0) == -1) {
+		DBGC(nic, "tap %p poll failed (%s)\n", nic, linux_strerror(linux_errno));
+		return;
+	}
+
+	/* Receive from each queue with at least one new packet */
+	for (i = 0; i < nic->queues; i++) {
+		if (pfd[i].revents & POLLIN)
+			tap_poll_queue(netdev, nic->fd[i]);
+	}
+}
+
 /**
  * Set irq.
  *
@@ -194,6 +318,7 @@ static struct net_device_operations tap_operations = {
 static int tap_probe(struct linux_device *device, struct linux_device_request *request)
 {
 	struct linux_setting *if_setting;
+	struct linux_setting *queues_setting;
 	struct net_device *netdev;
 	struct tap_nic *nic;
 	int rc;
@@ -203,6 +328,7 @@ static int tap_probe(struct linux_device *device, struct linux_device_request *r
 		return -ENOMEM;
 
 	netdev_init(netdev, &tap_operations);
+	netdev->state |= (NETDEV_RX_CSUM | NETDEV_TX_CSUM | NETDEV_TX_TSO);
 	nic = netdev->priv;
 	linux_set_drvdata(device, netdev);
 	netdev->dev = &device->dev;
@@ -225,6 +351,20 @@ static int tap_probe(struct linux_device *device, struct linux_device_request *r
 	device->dev.desc.bus_type = BUS_TYPE_TAP;
 	if_setting->applied = 1;
 
+	/* Look for the optional queues setting */
+	nic->queues = 1;
+	queues_setting = linux_find_setting("queues", &request->settings);
+	if (queues_setting) {
+		nic->queues = strtoul(queues_setting->value, NULL, 0);
+		if ((nic->queues < 1) || (nic->queues > TAP_MAX_QUEUES)) {
+			printf("tap queues must be between 1 and %d\n",
+			       TAP_MAX_QUEUES);
+			rc = -EINVAL;
+			goto err_settings;
+		}
+		queues_setting->applied = 1;
+	}
+
 	/* Apply rest of the settings */
 	linux_apply_settings(&request->settings, &netdev->settings.settings);
 
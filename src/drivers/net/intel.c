@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <errno.h>
 #include <byteswap.h>
@@ -35,6 +36,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dma.h>
 #include <ipxe/pci.h>
 #include <ipxe/profile.h>
+#include <ipxe/settings.h>
 #include "intel.h"
 
 /** @file
@@ -585,7 +587,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	unsigned int refilled = 0;
 
 	/* Refill ring */
-	while ( ( intel->rx.prod - intel->rx.cons ) < INTEL_RX_FILL ) {
+	while ( ( intel->rx.prod - intel->rx.cons ) < intel->rx.fill ) {
 
 		/* Allocate I/O buffer */
 		iobuf = alloc_rx_iob ( INTEL_RX_MAX_LEN, intel->dma );
@@ -595,7 +597,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 		}
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.prod++ % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.prod++ % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Populate receive descriptor */
@@ -614,7 +616,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	/* Push descriptors to card, if applicable */
 	if ( refilled ) {
 		wmb();
-		rx_tail = ( intel->rx.prod % INTEL_NUM_RX_DESC );
+		rx_tail = ( intel->rx.prod % intel->rx.count );
 		profile_start ( &intel_vm_refill_profiler );
 		writel ( rx_tail, intel->regs + intel->rx.reg + INTEL_xDT );
 		profile_stop ( &intel_vm_refill_profiler );
@@ -631,13 +633,110 @@ void intel_empty_rx ( struct intel_nic *intel ) {
 	unsigned int i;
 
 	/* Discard unused receive buffers */
-	for ( i = 0 ; i < INTEL_NUM_RX_DESC ; i++ ) {
+	for ( i = 0 ; i < intel->rx.count ; i++ ) {
 		if ( intel->rx_iobuf[i] )
 			free_rx_iob ( intel->rx_iobuf[i] );
 		intel->rx_iobuf[i] = NULL;
 	}
 }
 
+/** Receive descriptor ring size setting */
+const struct setting rxring_setting __setting ( SETTING_NETDEV_EXTRA, rxring ) = {
+	.name = "rxring",
+	.description = "Receive ring size",
+	.type = &setting_type_uint16,
+};
+
+/** Receive descriptor ring fill level setting */
+const struct setting rxfill_setting __setting ( SETTING_NETDEV_EXTRA, rxfill ) = {
+	.name = "rxfill",
+	.description = "Receive ring fill level",
+	.type = &setting_type_uint16,
+};
+
+/** Transmit descriptor ring size setting */
+const struct setting txring_setting __setting ( SETTING_NETDEV_EXTRA, txring ) = {
+	.name = "txring",
+	.description = "Transmit ring size",
+	.type = &setting_type_uint16,
+};
+
+/**
+ * Fetch descriptor ring size setting
+ *
+ * @v settings		Settings block
+ * @v setting		Ring size setting
+ * @v count		Default number of descriptors
+ * @v max		Maximum number of descriptors
+ * @ret count		Number of descriptors
+ */
+static unsigned int intel_ring_count ( struct settings *settings,
+				       const struct setting *setting,
+				       unsigned int count, unsigned int max ) {
+	unsigned long value;
+
+	/* Use default value if setting is absent */
+	value = fetch_uintz_setting ( settings, setting );
+	if ( ! value )
+		return count;
+
+	/* Clamp to permitted range and round down to a power of two */
+	if ( value < INTEL_MIN_DESC )
+		value = INTEL_MIN_DESC;
+	if ( value > max )
+		value = max;
+	return ( 1U << ( fls ( value ) - 1 ) );
+}
+
+/**
+ * Choose descriptor ring sizes
+ *
+ * @v netdev		Network device
+ *
+ * Ring sizes are chosen according to the current link speed (if
+ * known), and may be overridden via the "rxring", "rxfill" and
+ * "txring" settings.
+ */
+static void intel_size_rings ( struct net_device *netdev ) {
+	struct intel_nic *intel = netdev->priv;
+	struct settings *settings = netdev_settings ( netdev );
+	unsigned int rx_count;
+	unsigned int rx_fill;
+	unsigned int tx_count;
+	uint32_t status;
+
+	/* Choose default ring sizes according to link speed.  A
+	 * gigabit link can fill a small ring within microseconds, so
+	 * assume the fastest possible speed unless the link is known
+	 * to be slower.
+	 */
+	status = readl ( intel->regs + INTEL_STATUS );
+	if ( ( status & INTEL_STATUS_LU ) &&
+	     ( ( status & INTEL_STATUS_SPEED_MASK ) <
+	       INTEL_STATUS_SPEED_1000 ) ) {
+		rx_count = INTEL_NUM_RX_DESC_SLOW;
+		tx_count = INTEL_NUM_TX_DESC_SLOW;
+	} else {
+		rx_count = INTEL_NUM_RX_DESC;
+		tx_count = INTEL_NUM_TX_DESC;
+	}
+
+	/* Apply any configured overrides */
+	rx_count = intel_ring_count ( settings, &rxring_setting, rx_count,
+				      INTEL_MAX_RX_DESC );
+	tx_count = intel_ring_count ( settings, &txring_setting, tx_count,
+				      INTEL_MAX_TX_DESC );
+	rx_fill = fetch_uintz_setting ( settings, &rxfill_setting );
+	if ( ( ! rx_fill ) || ( rx_fill >= rx_count ) )
+		rx_fill = INTEL_RX_FILL ( rx_count );
+
+	/* Resize rings */
+	intel_size_ring ( &intel->rx, rx_count, rx_fill );
+	intel_size_ring ( &intel->tx, tx_count, INTEL_TX_FILL ( tx_count ) );
+	DBGC ( intel, "INTEL %p using %d RX (fill %d) and %d TX "
+	       "descriptors\n", intel, rx_count, rx_fill, tx_count );
+}
+
 /**
  * Open network device
  *
@@ -664,6 +763,9 @@ static int intel_open ( struct net_device *netdev ) {
 		writel ( fextnvm11, intel->regs + INTEL_FEXTNVM11 );
 	}
 
+	/* Choose descriptor ring sizes */
+	intel_size_rings ( netdev );
+
 	/* Create transmit descriptor ring */
 	if ( ( rc = intel_create_ring ( intel, &intel->tx ) ) != 0 )
 		goto err_create_tx;
@@ -757,12 +859,12 @@ int intel_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	size_t len;
 
 	/* Get next transmit descriptor */
-	if ( ( intel->tx.prod - intel->tx.cons ) >= INTEL_TX_FILL ) {
+	if ( ( intel->tx.prod - intel->tx.cons ) >= intel->tx.fill ) {
 		DBGC ( intel, "INTEL %p out of transmit descriptors\n", intel );
 		return -ENOBUFS;
 	}
-	tx_idx = ( intel->tx.prod++ % INTEL_NUM_TX_DESC );
-	tx_tail = ( intel->tx.prod % INTEL_NUM_TX_DESC );
+	tx_idx = ( intel->tx.prod++ % intel->tx.count );
+	tx_tail = ( intel->tx.prod % intel->tx.count );
 	tx = &intel->tx.desc[tx_idx];
 
 	/* Populate transmit descriptor */
@@ -797,7 +899,7 @@ void intel_poll_tx ( struct net_device *netdev ) {
 	while ( intel->tx.cons != intel->tx.prod ) {
 
 		/* Get next transmit descriptor */
-		tx_idx = ( intel->tx.cons % INTEL_NUM_TX_DESC );
+		tx_idx = ( intel->tx.cons % intel->tx.count );
 		tx = &intel->tx.desc[tx_idx];
 
 		/* Stop if descriptor is still in use */
@@ -828,7 +930,7 @@ void intel_poll_rx ( struct net_device *netdev ) {
 	while ( intel->rx.cons != intel->rx.prod ) {
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.cons % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.cons % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Stop if descriptor is still in use */
@@ -882,9 +984,12 @@ static void intel_poll ( struct net_device *netdev ) {
 	if ( icr & ( INTEL_IRQ_RXT0 | INTEL_IRQ_RXO ) )
 		intel_poll_rx ( netdev );
 
-	/* Report receive overruns */
-	if ( icr & INTEL_IRQ_RXO )
+	/* Report receive overruns and record dropped packets */
+	if ( icr & INTEL_IRQ_RXO ) {
 		netdev_rx_err ( netdev, NULL, -ENOBUFS );
+		netdev_rx_dropped ( netdev,
+				    readl ( intel->regs + INTEL_MPC ) );
+	}
 
 	/* Check link state, if applicable */
 	if ( icr & INTEL_IRQ_LSC )
@@ -960,9 +1065,11 @@ static int intel_probe ( struct pci_device *pci ) {
 	memset ( intel, 0, sizeof ( *intel ) );
 	intel->port = PCI_FUNC ( pci->busdevfn );
 	intel->flags = pci->id->driver_data;
-	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTEL_TD,
+	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC,
+			  INTEL_TX_FILL ( INTEL_NUM_TX_DESC ), INTEL_TD,
 			  intel_describe_tx );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTEL_RD,
+	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC,
+			  INTEL_RX_FILL ( INTEL_NUM_RX_DESC ), INTEL_RD,
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
@@ -72,6 +72,8 @@ struct intel_descriptor {
 /** Device Status Register */
 #define INTEL_STATUS 0x00008UL
 #define INTEL_STATUS_LU		0x00000002UL	/**< Link up */
+#define INTEL_STATUS_SPEED_MASK	0x000000c0UL	/**< Link speed */
+#define INTEL_STATUS_SPEED_1000	0x00000080UL	/**< 1000Mbps (or above) */
 
 /** EEPROM Read Register */
 #define INTEL_EERD 0x00014UL
@@ -138,6 +140,9 @@ struct intel_descriptor {
 /** Packet Buffer Size */
 #define INTEL_PBS 0x01008UL
 
+/** Missed Packets Count (clear on read) */
+#define INTEL_MPC 0x04010UL
+
 /** Receive packet buffer size */
 #define INTEL_RXPBS 0x02404UL
 #define INTEL_RXPBS_I210	0x000000a2UL	/**< I210 power-up default */
@@ -145,15 +150,21 @@ struct intel_descriptor {
 /** Receive Descriptor register block */
 #define INTEL_RD 0x02800UL
 
-/** Number of receive descriptors
+/** Default number of receive descriptors
  *
  * Minimum value is 8, since the descriptor ring length must be a
- * multiple of 128.
+ * multiple of 128.  Any ring size must be a power of two.
  */
-#define INTEL_NUM_RX_DESC 16
+#define INTEL_NUM_RX_DESC 64
+
+/** Number of receive descriptors for slow (10/100Mbps) links */
+#define INTEL_NUM_RX_DESC_SLOW 16
 
-/** Receive descriptor ring fill level */
-#define INTEL_RX_FILL 8
+/** Maximum number of receive descriptors */
+#define INTEL_MAX_RX_DESC 256
+
+/** Default receive descriptor ring fill level */
+#define INTEL_RX_FILL( count ) ( (count) / 2 )
 
 /** Receive buffer length */
 #define INTEL_RX_MAX_LEN 2048
@@ -165,15 +176,25 @@ struct intel_descriptor {
 /** Transmit Descriptor register block */
 #define INTEL_TD 0x03800UL
 
-/** Number of transmit descriptors
+/** Default number of transmit descriptors
  *
  * Descriptor ring length must be a multiple of 16.  ICH8/9/10
- * requires a minimum of 16 TX descriptors.
+ * requires a minimum of 16 TX descriptors.  Any ring size must be a
+ * power of two.
  */
-#define INTEL_NUM_TX_DESC 16
+#define INTEL_NUM_TX_DESC 64
+
+/** Number of transmit descriptors for slow (10/100Mbps) links */
+#define INTEL_NUM_TX_DESC_SLOW 16
+
+/** Minimum number of receive or transmit descriptors */
+#define INTEL_MIN_DESC 16
+
+/** Maximum number of transmit descriptors */
+#define INTEL_MAX_TX_DESC 256
 
 /** Transmit descriptor ring maximum fill level */
-#define INTEL_TX_FILL ( INTEL_NUM_TX_DESC - 1 )
+#define INTEL_TX_FILL( count ) ( (count) - 1 )
 
 /** Receive/Transmit Descriptor Base Address Low (offset) */
 #define INTEL_xDBAL 0x00
@@ -230,6 +251,10 @@ struct intel_ring {
 
 	/** Register block */
 	unsigned int reg;
+	/** Number of descriptors */
+	unsigned int count;
+	/** Maximum fill level */
+	unsigned int fill;
 	/** Length (in bytes) */
 	size_t len;
 
@@ -243,20 +268,38 @@ struct intel_ring {
 			      size_t len );
 };
 
+/**
+ * Set descriptor ring size
+ *
+ * @v ring		Descriptor ring
+ * @v count		Number of descriptors (must be a power of two)
+ * @v fill		Maximum fill level
+ */
+static inline __attribute__ (( always_inline )) void
+intel_size_ring ( struct intel_ring *ring, unsigned int count,
+		  unsigned int fill ) {
+
+	ring->count = count;
+	ring->fill = fill;
+	ring->len = ( count * sizeof ( ring->desc[0] ) );
+}
+
 /**
  * Initialise descriptor ring
  *
  * @v ring		Descriptor ring
- * @v count		Number of descriptors
+ * @v count		Number of descriptors (must be a power of two)
+ * @v fill		Maximum fill level
  * @v reg		Descriptor register block
  * @v describe		Method to populate descriptor
  */
 static inline __attribute__ (( always_inline)) void
-intel_init_ring ( struct intel_ring *ring, unsigned int count, unsigned int reg,
+intel_init_ring ( struct intel_ring *ring, unsigned int count,
+		  unsigned int fill, unsigned int reg,
 		  void ( * describe ) ( struct intel_descriptor *desc,
 					physaddr_t addr, size_t len ) ) {
 
-	ring->len = ( count * sizeof ( ring->desc[0] ) );
+	intel_size_ring ( ring, count, fill );
 	ring->reg = reg;
 	ring->describe = describe;
 }
@@ -312,7 +355,7 @@ struct intel_nic {
 	/** Receive descriptor ring */
 	struct intel_ring rx;
 	/** Receive I/O buffers */
-	struct io_buffer *rx_iobuf[INTEL_NUM_RX_DESC];
+	struct io_buffer *rx_iobuf[INTEL_MAX_RX_DESC];
 };
 
 /** Driver flags */
@@ -395,9 +395,11 @@ static int intelx_probe ( struct pci_device *pci ) {
 	netdev->dev = &pci->dev;
 	memset ( intel, 0, sizeof ( *intel ) );
 	intel->port = PCI_FUNC ( pci->busdevfn );
-	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTELX_TD,
+	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC,
+			  INTEL_TX_FILL ( INTEL_NUM_TX_DESC ), INTELX_TD,
 			  intel_describe_tx );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELX_RD,
+	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC,
+			  INTEL_RX_FILL ( INTEL_NUM_RX_DESC ), INTELX_RD,
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
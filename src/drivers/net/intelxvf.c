@@ -447,9 +447,11 @@ static int intelxvf_probe ( struct pci_device *pci ) {
 	netdev->dev = &pci->dev;
 	memset ( intel, 0, sizeof ( *intel ) );
 	intel_init_mbox ( &intel->mbox, INTELXVF_MBCTRL, INTELXVF_MBMEM );
-	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTELXVF_TD(0),
+	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC,
+			  INTEL_TX_FILL ( INTEL_NUM_TX_DESC ), INTELXVF_TD(0),
 			  intel_describe_tx_adv );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELXVF_RD(0),
+	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC,
+			  INTEL_RX_FILL ( INTEL_NUM_RX_DESC ), INTELXVF_RD(0),
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
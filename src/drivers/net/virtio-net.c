@@ -24,7 +24,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <byteswap.h>
 #include <ipxe/list.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/netdevice.h>
@@ -32,6 +34,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dma.h>
 #include <ipxe/if_ether.h>
 #include <ipxe/ethernet.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/tcp.h>
 #include <ipxe/virtio-pci.h>
 #include <ipxe/virtio-ring.h>
 #include "virtio-net.h"
@@ -78,8 +82,22 @@ enum {
 	QUEUE_NB
 };
 
-/** Max number of pending rx packets */
-#define NUM_RX_BUF 8
+/** Max number of pending rx packets
+ *
+ * The number actually used is further limited by the size of the
+ * receive virtqueue.
+ */
+#define NUM_RX_BUF 32
+
+/** Features requested from the device (for both legacy and modern) */
+#define VIRTNET_FEATURES ( ( 1ULL << VIRTIO_NET_F_MAC ) |		\
+			   ( 1ULL << VIRTIO_NET_F_MTU ) |		\
+			   ( 1ULL << VIRTIO_NET_F_CSUM ) |		\
+			   ( 1ULL << VIRTIO_NET_F_GUEST_CSUM ) |	\
+			   ( 1ULL << VIRTIO_NET_F_HOST_TSO4 ) |		\
+			   ( 1ULL << VIRTIO_NET_F_HOST_TSO6 ) |		\
+			   ( 1ULL << VIRTIO_NET_F_MRG_RXBUF ) |		\
+			   ( 1ULL << VIRTIO_RING_F_EVENT_IDX ) )
 
 struct virtnet_nic {
 	/** Base pio register address */
@@ -100,34 +118,112 @@ struct virtnet_nic {
 	/** Pending rx packet count */
 	unsigned int rx_num_iobufs;
 
+	/** Maximum pending rx packet count */
+	unsigned int rx_fill;
+
+	/** Number of rx buffers to discard (continuations of a dropped
+	 * merged packet)
+	 */
+	unsigned int rx_discard;
+
+	/** Number of tx packets added but not yet made available */
+	unsigned int tx_pending;
+
+	/** Negotiated features */
+	u64 features;
+
+	/** Length of virtio net header */
+	size_t header_len;
+
+	/** Receive headers are placed inline within receive buffers */
+	int rx_inline;
+
+	/** Per-descriptor tx headers (if VIRTIO_NET_F_CSUM is in use) */
+	struct virtio_net_hdr_modern *tx_headers;
+
+	/** Length of per-descriptor tx headers */
+	size_t tx_headers_len;
+
+	/** Per-descriptor tx headers DMA mapping */
+	struct dma_mapping tx_headers_map;
+
 	/** DMA device */
 	struct dma_device *dma;
 
 };
 
+/** Check if a feature has been negotiated
+ *
+ * @v virtnet		Virtio-net device
+ * @v feature		Feature bit
+ * @ret present		Feature has been negotiated
+ */
+static inline int virtnet_has_feature ( struct virtnet_nic *virtnet,
+					unsigned int feature ) {
+	return ( ( virtnet->features & ( 1ULL << feature ) ) != 0 );
+}
+
+/** Convert virtio net header field to host byte order
+ *
+ * @v virtnet		Virtio-net device
+ * @v value		Value in device byte order
+ * @ret value		Value in host byte order
+ */
+static inline uint16_t virtnet_hdr_to_cpu ( struct virtnet_nic *virtnet,
+					    uint16_t value ) {
+	return ( virtnet->virtio_version ? le16_to_cpu ( value ) : value );
+}
+
+/** Convert virtio net header field to device byte order
+ *
+ * @v virtnet		Virtio-net device
+ * @v value		Value in host byte order
+ * @ret value		Value in device byte order
+ */
+static inline uint16_t virtnet_cpu_to_hdr ( struct virtnet_nic *virtnet,
+					    uint16_t value ) {
+	return ( virtnet->virtio_version ? cpu_to_le16 ( value ) : value );
+}
+
+/** Notify device of new buffers in a virtqueue
+ *
+ * @v netdev		Network device
+ * @v vq_idx		Virtqueue index (RX_INDEX or TX_INDEX)
+ * @v num_added		Number of buffers added since the last notification
+ */
+static void virtnet_kick ( struct net_device *netdev, int vq_idx,
+			   unsigned int num_added ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+
+	vring_kick ( virtnet->virtio_version ? &virtnet->vdev : NULL,
+		     virtnet->ioaddr, &virtnet->virtqueue[vq_idx], num_added );
+}
+
 /** Add an iobuf to a virtqueue
  *
  * @v netdev		Network device
  * @v vq_idx		Virtqueue index (RX_INDEX or TX_INDEX)
  * @v iobuf		I/O buffer
+ * @v num_added		Number of buffers added since the last notification
  *
- * The virtqueue is kicked after the iobuf has been added.
+ * The buffer is not made available to the device until the caller
+ * notifies the device using virtnet_kick().
  */
-static void virtnet_enqueue_iob ( struct net_device *netdev,
-				  int vq_idx, struct io_buffer *iobuf ) {
+static void virtnet_enqueue_iob ( struct net_device *netdev, int vq_idx,
+				  struct io_buffer *iobuf,
+				  unsigned int num_added ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	struct vring_virtqueue *vq = &virtnet->virtqueue[vq_idx];
 	struct virtio_net_hdr_modern *header = vq->empty_header;
+	struct tcp_header *tcphdr;
 	unsigned int out = ( vq_idx == TX_INDEX ) ? 2 : 0;
 	unsigned int in = ( vq_idx == TX_INDEX ) ? 0 : 2;
-	size_t header_len = ( virtnet->virtio_version ?
-			      sizeof ( *header ) : sizeof ( header->legacy ) );
 	struct vring_list list[] = {
 		{
 			/* Share a single zeroed virtio net header between all
-			 * packets in a ring.  This works because this driver
-			 * does not use any advanced features so none of the
-			 * header fields get used.
+			 * packets in a ring that do not require any offload
+			 * features, since none of the header fields then get
+			 * used.
 			 *
 			 * Some host implementations (notably Google Compute
 			 * Platform) are known to unconditionally write back
@@ -135,7 +231,7 @@ static void virtnet_enqueue_iob ( struct net_device *netdev,
 			 * this by using separate RX and TX headers.
 			 */
 			.addr = dma ( &vq->map, header ),
-			.length = header_len,
+			.length = virtnet->header_len,
 		},
 		{
 			.addr = iob_dma ( iobuf ),
@@ -143,12 +239,49 @@ static void virtnet_enqueue_iob ( struct net_device *netdev,
 		},
 	};
 
+	/* Use a dedicated header for packets requiring checksum
+	 * offload.  The header is indexed by the descriptor that will
+	 * form the head of this buffer's descriptor chain, which
+	 * remains unique until the buffer is returned by the device.
+	 */
+	if ( ( vq_idx == TX_INDEX ) && ( iobuf->csum == IOB_CSUM_PARTIAL ) ) {
+		assert ( virtnet->tx_headers != NULL );
+		header = &virtnet->tx_headers[vq->free_head];
+		memset ( header, 0, sizeof ( *header ) );
+		header->legacy.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		header->legacy.csum_start =
+			virtnet_cpu_to_hdr ( virtnet, ( iobuf->csum_start -
+							iobuf->data ) );
+		header->legacy.csum_offset =
+			virtnet_cpu_to_hdr ( virtnet, iobuf->csum_offset );
+		if ( iobuf->gso ) {
+			tcphdr = iobuf->csum_start;
+			header->legacy.gso_type =
+				( ( iobuf->gso == IOB_GSO_TCPV6 ) ?
+				  VIRTIO_NET_HDR_GSO_TCPV6 :
+				  VIRTIO_NET_HDR_GSO_TCPV4 );
+			header->legacy.gso_size =
+				virtnet_cpu_to_hdr ( virtnet,
+						     iobuf->gso_size );
+			header->legacy.hdr_len =
+				virtnet_cpu_to_hdr ( virtnet,
+						     ( ( iobuf->csum_start -
+							 iobuf->data ) +
+						       ( ( tcphdr->hlen &
+							   0xf0 ) >> 2 ) ) );
+		}
+		list[0].addr = dma ( &virtnet->tx_headers_map, header );
+	}
+
 	DBGC2 ( virtnet, "VIRTIO-NET %p enqueuing iobuf %p on vq %d\n",
 		virtnet, iobuf, vq_idx );
 
-	vring_add_buf ( vq, list, out, in, iobuf, 0 );
-	vring_kick ( virtnet->virtio_version ? &virtnet->vdev : NULL,
-		     virtnet->ioaddr, vq, 1 );
+	/* Receive buffers with inline headers need only one descriptor */
+	if ( ( vq_idx == RX_INDEX ) && virtnet->rx_inline ) {
+		vring_add_buf ( vq, &list[1], 0, 1, iobuf, num_added );
+	} else {
+		vring_add_buf ( vq, list, out, in, iobuf, num_added );
+	}
 }
 
 /** Try to keep rx virtqueue filled with iobufs
@@ -158,8 +291,13 @@ static void virtnet_enqueue_iob ( struct net_device *netdev,
 static void virtnet_refill_rx_virtqueue ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	size_t len = ( netdev->max_pkt_len + 4 /* VLAN */ );
+	unsigned int num_added = 0;
 
-	while ( virtnet->rx_num_iobufs < NUM_RX_BUF ) {
+	/* Allow space for inline header, if applicable */
+	if ( virtnet->rx_inline )
+		len += virtnet->header_len;
+
+	while ( virtnet->rx_num_iobufs < virtnet->rx_fill ) {
 		struct io_buffer *iobuf;
 
 		/* Try to allocate a buffer, stop for now if out of memory */
@@ -173,9 +311,99 @@ static void virtnet_refill_rx_virtqueue ( struct net_device *netdev ) {
 		/* Mark packet length until we know the actual size */
 		iob_put ( iobuf, len );
 
-		virtnet_enqueue_iob ( netdev, RX_INDEX, iobuf );
+		virtnet_enqueue_iob ( netdev, RX_INDEX, iobuf, num_added++ );
 		virtnet->rx_num_iobufs++;
 	}
+
+	/* Notify device of all new buffers at once */
+	if ( num_added )
+		virtnet_kick ( netdev, RX_INDEX, num_added );
+}
+
+/** Configure negotiated features
+ *
+ * @v netdev		Network device
+ * @v features		Negotiated features
+ */
+static void virtnet_set_features ( struct net_device *netdev, u64 features ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+
+	/* Record negotiated features */
+	virtnet->features = features;
+	DBGC ( virtnet, "VIRTIO-NET %p features %#08llx\n",
+	       virtnet, ( ( unsigned long long ) features ) );
+
+	/* The header includes the number of merged buffers for virtio
+	 * 1.0 devices or if mergeable receive buffers are in use.
+	 * Receive headers are placed within the receive buffers
+	 * whenever the device permits, so that received packets
+	 * require only a single descriptor and each packet has its
+	 * own header.
+	 */
+	virtnet->rx_inline =
+		( virtnet->virtio_version ||
+		  virtnet_has_feature ( virtnet, VIRTIO_NET_F_MRG_RXBUF ) );
+	virtnet->header_len = ( virtnet->rx_inline ?
+				sizeof ( struct virtio_net_hdr_modern ) :
+				sizeof ( struct virtio_net_hdr ) );
+
+	/* Advertise checksum and segmentation offload capabilities.
+	 * Segmentation offload is used only if available for both
+	 * IPv4 and IPv6.
+	 */
+	netdev->state &= ~( NETDEV_RX_CSUM | NETDEV_TX_CSUM |
+			    NETDEV_TX_TSO );
+	if ( virtnet_has_feature ( virtnet, VIRTIO_NET_F_GUEST_CSUM ) )
+		netdev->state |= NETDEV_RX_CSUM;
+	if ( virtnet_has_feature ( virtnet, VIRTIO_NET_F_CSUM ) ) {
+		netdev->state |= NETDEV_TX_CSUM;
+		if ( virtnet_has_feature ( virtnet, VIRTIO_NET_F_HOST_TSO4 ) &&
+		     virtnet_has_feature ( virtnet, VIRTIO_NET_F_HOST_TSO6 ) )
+			netdev->state |= NETDEV_TX_TSO;
+	}
+}
+
+/** Initialise rx/tx virtqueue state
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int virtnet_init_virtqueues ( struct net_device *netdev ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+	struct vring_virtqueue *rx_vq = &virtnet->virtqueue[RX_INDEX];
+	struct vring_virtqueue *tx_vq = &virtnet->virtqueue[TX_INDEX];
+	int event_idx;
+	int i;
+
+	/* Allocate per-descriptor tx headers, if applicable */
+	if ( netdev->state & NETDEV_TX_CSUM ) {
+		virtnet->tx_headers_len = ( tx_vq->vring.num *
+					    sizeof ( virtnet->tx_headers[0] ) );
+		virtnet->tx_headers = dma_alloc ( virtnet->dma,
+						  &virtnet->tx_headers_map,
+						  virtnet->tx_headers_len,
+						  sizeof ( virtnet->tx_headers[0] ) );
+		if ( ! virtnet->tx_headers )
+			return -ENOMEM;
+	}
+
+	/* Enable notification suppression, if applicable */
+	event_idx = virtnet_has_feature ( virtnet, VIRTIO_RING_F_EVENT_IDX );
+	for ( i = 0; i < QUEUE_NB; i++ )
+		virtnet->virtqueue[i].event_idx = event_idx;
+
+	/* Limit rx fill level to the capacity of the rx virtqueue */
+	virtnet->rx_fill = ( rx_vq->vring.num / ( virtnet->rx_inline ? 1 : 2 ));
+	if ( virtnet->rx_fill > NUM_RX_BUF )
+		virtnet->rx_fill = NUM_RX_BUF;
+
+	/* Initialize rx packets */
+	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
+	virtnet->rx_num_iobufs = 0;
+	virtnet->rx_discard = 0;
+	virtnet->tx_pending = 0;
+
+	return 0;
 }
 
 /** Helper to free all virtqueue memory
@@ -186,6 +414,12 @@ static void virtnet_free_virtqueues ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	int i;
 
+	if ( virtnet->tx_headers ) {
+		dma_free ( &virtnet->tx_headers_map, virtnet->tx_headers,
+			   virtnet->tx_headers_len );
+		virtnet->tx_headers = NULL;
+	}
+
 	for ( i = 0; i < QUEUE_NB; i++ ) {
 		virtio_pci_unmap_capability ( &virtnet->virtqueue[i].notification );
 		vp_free_vq ( &virtnet->virtqueue[i] );
@@ -205,10 +439,23 @@ static int virtnet_open_legacy ( struct net_device *netdev ) {
 	unsigned long ioaddr = virtnet->ioaddr;
 	u32 features;
 	int i;
+	int rc;
 
 	/* Reset for sanity */
 	vp_reset ( ioaddr );
 
+	/* Negotiate features */
+	features = vp_get_features ( ioaddr );
+	features &= VIRTNET_FEATURES;
+	if ( ! ( features & ( 1 << VIRTIO_NET_F_MRG_RXBUF ) ) ) {
+		/* Received checksum state cannot be reported via the
+		 * single header shared between all receive buffers.
+		 */
+		features &= ~( 1 << VIRTIO_NET_F_GUEST_CSUM );
+	}
+	vp_set_features ( ioaddr, features );
+	virtnet_set_features ( netdev, features );
+
 	/* Allocate virtqueues */
 	virtnet->virtqueue = zalloc ( QUEUE_NB *
 				      sizeof ( *virtnet->virtqueue ) );
@@ -227,17 +474,16 @@ static int virtnet_open_legacy ( struct net_device *netdev ) {
 	}
 
 	/* Initialize rx packets */
-	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
-	virtnet->rx_num_iobufs = 0;
+	if ( ( rc = virtnet_init_virtqueues ( netdev ) ) != 0 ) {
+		virtnet_free_virtqueues ( netdev );
+		return rc;
+	}
 	virtnet_refill_rx_virtqueue ( netdev );
 
 	/* Disable interrupts before starting */
 	netdev_irq ( netdev, 0 );
 
 	/* Driver is ready */
-	features = vp_get_features ( ioaddr );
-	vp_set_features ( ioaddr, features & ( ( 1 << VIRTIO_NET_F_MAC ) |
-					       ( 1 << VIRTIO_NET_F_MTU ) ) );
 	vp_set_status ( ioaddr, VIRTIO_CONFIG_S_DRIVER | VIRTIO_CONFIG_S_DRIVER_OK );
 	return 0;
 }
@@ -251,6 +497,7 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	u64 features;
 	u8 status;
+	int rc;
 
 	/* Negotiate features */
 	features = vpm_get_features ( &virtnet->vdev );
@@ -258,12 +505,12 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 		vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_FAILED );
 		return -EINVAL;
 	}
-	vpm_set_features ( &virtnet->vdev, features & (
-		( 1ULL << VIRTIO_NET_F_MAC ) |
-		( 1ULL << VIRTIO_NET_F_MTU ) |
-		( 1ULL << VIRTIO_F_VERSION_1 ) |
-		( 1ULL << VIRTIO_F_ANY_LAYOUT ) |
-		( 1ULL << VIRTIO_F_IOMMU_PLATFORM ) ) );
+	features &= ( VIRTNET_FEATURES |
+		      ( 1ULL << VIRTIO_F_VERSION_1 ) |
+		      ( 1ULL << VIRTIO_F_ANY_LAYOUT ) |
+		      ( 1ULL << VIRTIO_F_IOMMU_PLATFORM ) );
+	vpm_set_features ( &virtnet->vdev, features );
+	virtnet_set_features ( netdev, features );
 	vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_FEATURES_OK );
 
 	status = vpm_get_status ( &virtnet->vdev );
@@ -291,6 +538,11 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 		vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_FAILED );
 		return -ENOENT;
 	}
+	if ( ( rc = virtnet_init_virtqueues ( netdev ) ) != 0 ) {
+		virtnet_free_virtqueues ( netdev );
+		vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_FAILED );
+		return rc;
+	}
 
 	/* Disable interrupts before starting */
 	netdev_irq ( netdev, 0 );
@@ -298,8 +550,6 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 	vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_DRIVER_OK );
 
 	/* Initialize rx packets */
-	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
-	virtnet->rx_num_iobufs = 0;
 	virtnet_refill_rx_virtqueue ( netdev );
 	return 0;
 }
@@ -345,6 +595,19 @@ static void virtnet_close ( struct net_device *netdev ) {
 	virtnet->rx_num_iobufs = 0;
 }
 
+/** Make pending transmitted packets available to the device
+ *
+ * @v netdev	Network device
+ */
+static void virtnet_flush_tx ( struct net_device *netdev ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+
+	if ( virtnet->tx_pending ) {
+		virtnet_kick ( netdev, TX_INDEX, virtnet->tx_pending );
+		virtnet->tx_pending = 0;
+	}
+}
+
 /** Transmit packet
  *
  * @v netdev	Network device
@@ -353,7 +616,19 @@ static void virtnet_close ( struct net_device *netdev ) {
  */
 static int virtnet_transmit ( struct net_device *netdev,
 			      struct io_buffer *iobuf ) {
-	virtnet_enqueue_iob ( netdev, TX_INDEX, iobuf );
+	struct virtnet_nic *virtnet = netdev->priv;
+
+	virtnet_enqueue_iob ( netdev, TX_INDEX, iobuf,
+			      virtnet->tx_pending++ );
+
+	/* Defer notification until the next poll, so that packets
+	 * transmitted in quick succession share a single notification.
+	 * Notify immediately if interrupts are enabled, since the
+	 * caller may then wait for an interrupt rather than polling.
+	 */
+	if ( netdev_irq_enabled ( netdev ) )
+		virtnet_flush_tx ( netdev );
+
 	return 0;
 }
 
@@ -375,6 +650,41 @@ static void virtnet_process_tx_packets ( struct net_device *netdev ) {
 	}
 }
 
+/** Complete partial checksum of received packet
+ *
+ * @v virtnet		Virtio-net device
+ * @v header		Virtio net header
+ * @v iobuf		I/O buffer (excluding virtio net header)
+ * @ret rc		Return status code
+ *
+ * With VIRTIO_NET_F_GUEST_CSUM, the device may deliver packets (such
+ * as those originating from the host itself) whose checksum field
+ * contains only the pseudo-header checksum.
+ */
+static int virtnet_rx_csum ( struct virtnet_nic *virtnet,
+			     struct virtio_net_hdr_modern *header,
+			     struct io_buffer *iobuf ) {
+	size_t start = virtnet_hdr_to_cpu ( virtnet,
+					    header->legacy.csum_start );
+	size_t offset = virtnet_hdr_to_cpu ( virtnet,
+					     header->legacy.csum_offset );
+	uint16_t *csum;
+
+	/* Sanity check */
+	if ( ( start + offset + sizeof ( *csum ) ) > iob_len ( iobuf ) ) {
+		DBGC ( virtnet, "VIRTIO-NET %p invalid rx checksum location "
+		       "%zd+%zd\n", virtnet, start, offset );
+		return -EINVAL;
+	}
+
+	/* Calculate checksum over remainder of packet */
+	csum = ( iobuf->data + start + offset );
+	*csum = tcpip_chksum ( ( iobuf->data + start ),
+			       ( iob_len ( iobuf ) - start ) );
+
+	return 0;
+}
+
 /** Complete packet reception
  *
  * @v netdev	Network device
@@ -383,6 +693,10 @@ static void virtnet_process_rx_packets ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	struct vring_virtqueue *rx_vq = &virtnet->virtqueue[RX_INDEX];
 
+	struct virtio_net_hdr_modern *header;
+	unsigned int num_buffers;
+	int rc;
+
 	while ( vring_more_used ( rx_vq ) ) {
 		unsigned int len;
 		struct io_buffer *iobuf = vring_get_buf ( rx_vq, &len );
@@ -391,9 +705,68 @@ static void virtnet_process_rx_packets ( struct net_device *netdev ) {
 		list_del ( &iobuf->list );
 		virtnet->rx_num_iobufs--;
 
-		/* Update iobuf length */
+		/* Discard continuations of a dropped merged packet */
+		if ( virtnet->rx_discard ) {
+			virtnet->rx_discard--;
+			free_rx_iob ( iobuf );
+			continue;
+		}
+
+		/* Sanity check */
+		if ( len < virtnet->header_len ) {
+			DBGC ( virtnet, "VIRTIO-NET %p underlength rx %d\n",
+			       virtnet, len );
+			netdev_rx_err ( netdev, iobuf, -EINVAL );
+			continue;
+		}
+
+		/* Update iobuf length and strip inline header */
 		iob_unput ( iobuf, iob_len ( iobuf ) );
-		iob_put ( iobuf, len - sizeof ( struct virtio_net_hdr ) );
+		if ( ! virtnet->rx_inline ) {
+			iob_put ( iobuf, ( len - virtnet->header_len ) );
+		} else {
+			iob_put ( iobuf, len );
+			header = iobuf->data;
+			iob_pull ( iobuf, virtnet->header_len );
+
+			/* Drop packets spanning multiple buffers.  We
+			 * never negotiate large receive offloads, so
+			 * this can happen only if the packet is larger
+			 * than our maximum packet length.
+			 */
+			num_buffers = 1;
+			if ( virtnet_has_feature ( virtnet,
+						   VIRTIO_NET_F_MRG_RXBUF ) ) {
+				num_buffers = virtnet_hdr_to_cpu (
+					virtnet, header->num_buffers );
+			}
+			if ( num_buffers > 1 ) {
+				DBGC ( virtnet, "VIRTIO-NET %p dropping rx "
+				       "packet spanning %d buffers\n",
+				       virtnet, num_buffers );
+				virtnet->rx_discard = ( num_buffers - 1 );
+				netdev_rx_err ( netdev, iobuf, -ERANGE );
+				continue;
+			}
+
+			/* Record checksum state.  Partial checksums are
+			 * completed rather than merely marked as valid,
+			 * since the packet may be handed on intact via
+			 * UNDI or SNP.
+			 */
+			if ( header->legacy.flags &
+			     VIRTIO_NET_HDR_F_NEEDS_CSUM ) {
+				rc = virtnet_rx_csum ( virtnet, header, iobuf );
+				if ( rc != 0 ) {
+					netdev_rx_err ( netdev, iobuf, rc );
+					continue;
+				}
+				iobuf->csum = IOB_CSUM_VALID;
+			} else if ( header->legacy.flags &
+				    VIRTIO_NET_HDR_F_DATA_VALID ) {
+				iobuf->csum = IOB_CSUM_VALID;
+			}
+		}
 
 		DBGC2 ( virtnet, "VIRTIO-NET %p rx complete iobuf %p len %zd\n",
 			virtnet, iobuf, iob_len ( iobuf ) );
@@ -423,6 +796,7 @@ static void virtnet_poll ( struct net_device *netdev ) {
 		vp_get_isr ( virtnet->ioaddr );
 	}
 
+	virtnet_flush_tx ( netdev );
 	virtnet_process_tx_packets ( netdev );
 	virtnet_process_rx_packets ( netdev );
 }
@@ -33,6 +33,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/command.h>
 #include <ipxe/parseopt.h>
 #include <ipxe/shell.h>
+#include <ipxe/downloader.h>
 #include <usr/imgmgmt.h>
 
 /** @file
@@ -51,6 +52,8 @@ struct imgsingle_options {
 	int replace;
 	/** Free image after execution */
 	int autofree;
+	/** Decompress image while downloading */
+	int extract;
 };
 
 /** "img{single}" option list */
@@ -74,13 +77,25 @@ static union {
 	},
 };
 
+/** "imgfetch" option list */
+static struct option_descriptor imgfetch_opts[] = {
+	OPTION_DESC ( "name", 'n', required_argument,
+		      struct imgsingle_options, name, parse_string ),
+	OPTION_DESC ( "timeout", 't', required_argument,
+		      struct imgsingle_options, timeout, parse_timeout),
+	OPTION_DESC ( "autofree", 'a', no_argument,
+		      struct imgsingle_options, autofree, parse_flag ),
+	OPTION_DESC ( "extract", 'x', no_argument,
+		      struct imgsingle_options, extract, parse_flag ),
+};
+
 /** An "img{single}" family command descriptor */
 struct imgsingle_descriptor {
 	/** Command descriptor */
 	struct command_descriptor *cmd;
 	/** Function to use to acquire the image */
 	int ( * acquire ) ( const char *name, unsigned long timeout,
-			    struct image **image );
+			    unsigned int flags, struct image **image );
 	/** Pre-action to take upon image, or NULL */
 	void ( * preaction ) ( struct image *image );
 	/** Action to take upon image, or NULL */
@@ -90,6 +105,21 @@ struct imgsingle_descriptor {
 	const char *verb;
 };
 
+/**
+ * Acquire an existing or downloaded image
+ *
+ * @v name_uri		Name or URI string
+ * @v timeout		Download timeout
+ * @v flags		Download flags (ignored)
+ * @v image		Image to fill in
+ * @ret rc		Return status code
+ */
+static int imgsingle_acquire ( const char *name_uri, unsigned long timeout,
+			       unsigned int flags __unused,
+			       struct image **image ) {
+	return imgacquire ( name_uri, timeout, image );
+}
+
 /**
  * The "img{single}" family of commands
  *
@@ -106,6 +136,7 @@ static int imgsingle_exec ( int argc, char **argv,
 	char *name_uri = NULL;
 	char *cmdline = NULL;
 	struct image *image;
+	unsigned int flags;
 	int rc;
 
 	/* Parse options */
@@ -126,7 +157,8 @@ static int imgsingle_exec ( int argc, char **argv,
 
 	/* Acquire the image */
 	if ( name_uri ) {
-		if ( ( rc = desc->acquire ( name_uri, opts.timeout,
+		flags = ( opts.extract ? DOWNLOAD_EXTRACT : 0 );
+		if ( ( rc = desc->acquire ( name_uri, opts.timeout, flags,
 					    &image ) ) != 0 )
 			goto err_acquire;
 	} else {
@@ -187,7 +219,7 @@ static int imgsingle_exec ( int argc, char **argv,
 
 /** "imgfetch" command descriptor */
 static struct command_descriptor imgfetch_cmd =
-	COMMAND_DESC ( struct imgsingle_options, opts.imgsingle,
+	COMMAND_DESC ( struct imgsingle_options, imgfetch_opts,
 		       1, MAX_ARGUMENTS, "<uri> [<arguments>...]" );
 
 /** "imgfetch" family command descriptor */
@@ -227,7 +259,7 @@ static struct command_descriptor imgselect_cmd =
 /** "imgselect" family command descriptor */
 struct imgsingle_descriptor imgselect_desc = {
 	.cmd = &imgselect_cmd,
-	.acquire = imgacquire,
+	.acquire = imgsingle_acquire,
 	.action = imgselect,
 	.verb = "select",
 };
@@ -281,7 +313,7 @@ static int imgexec ( struct image *image, struct imgsingle_options *opts ) {
 /** "imgexec" family command descriptor */
 struct imgsingle_descriptor imgexec_desc = {
 	.cmd = &imgexec_cmd,
-	.acquire = imgacquire,
+	.acquire = imgsingle_acquire,
 	.action = imgexec,
 	.verb = "boot",
 };
@@ -305,7 +337,7 @@ static struct command_descriptor imgargs_cmd =
 /** "imgargs" family command descriptor */
 struct imgsingle_descriptor imgargs_desc = {
 	.cmd = &imgargs_cmd,
-	.acquire = imgacquire,
+	.acquire = imgsingle_acquire,
 	.preaction = image_clear_cmdline,
 };
 
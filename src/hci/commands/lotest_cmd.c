@@ -45,6 +45,12 @@ struct lotest_options {
 	unsigned int mtu;
 	/** Broadcast */
 	int broadcast;
+	/** Number of packets */
+	unsigned int count;
+	/** Number of packets in flight */
+	unsigned int window;
+	/** Use fixed payload */
+	int fixed;
 };
 
 /** "lotest" option list */
@@ -53,6 +59,12 @@ static struct option_descriptor lotest_opts[] = {
 		      struct lotest_options, mtu, parse_integer ),
 	OPTION_DESC ( "broadcast", 'b', no_argument,
 		      struct lotest_options, broadcast, parse_flag ),
+	OPTION_DESC ( "count", 'c', required_argument,
+		      struct lotest_options, count, parse_integer ),
+	OPTION_DESC ( "window", 'w', required_argument,
+		      struct lotest_options, window, parse_integer ),
+	OPTION_DESC ( "fixed", 'f', no_argument,
+		      struct lotest_options, fixed, parse_flag ),
 };
 
 /** "lotest" command descriptor */
@@ -91,7 +103,8 @@ static int lotest_exec ( int argc, char **argv ) {
 
 	/* Perform loopback test */
 	if ( ( rc = loopback_test ( sender, receiver, opts.mtu,
-				    opts.broadcast ) ) != 0 ) {
+				    opts.broadcast, opts.count,
+				    opts.window, opts.fixed ) ) != 0 ) {
 		printf ( "Test failed: %s\n", strerror ( rc ) );
 		return rc;
 	}
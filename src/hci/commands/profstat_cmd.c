@@ -36,10 +36,20 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 /** "profstat" options */
-struct profstat_options {};
+struct profstat_options {
+	/** Print statistics in machine-readable form */
+	int dump;
+	/** Reset statistics after printing */
+	int reset;
+};
 
 /** "profstat" option list */
-static struct option_descriptor profstat_opts[] = {};
+static struct option_descriptor profstat_opts[] = {
+	OPTION_DESC ( "dump", 'd', no_argument,
+		      struct profstat_options, dump, parse_flag ),
+	OPTION_DESC ( "reset", 'r', no_argument,
+		      struct profstat_options, reset, parse_flag ),
+};
 
 /** "profstat" command descriptor */
 static struct command_descriptor profstat_cmd =
@@ -60,7 +70,9 @@ static int profstat_exec ( int argc, char **argv ) {
 	if ( ( rc = parse_options ( argc, argv, &profstat_cmd, &opts ) ) != 0 )
 		return rc;
 
-	profstat();
+	/* Print (and optionally reset) statistics */
+	profstat_flags ( ( opts.dump ? PROFSTAT_DUMP : 0 ) |
+			 ( opts.reset ? PROFSTAT_RESET : 0 ) );
 
 	return 0;
 }
@@ -30,6 +30,7 @@
 #include <ipxe/uri.h>
 #include <ipxe/sanboot.h>
 #include <usr/autoboot.h>
+#include <usr/sanmgmt.h>
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
@@ -203,7 +204,41 @@ static int sanunhook_exec ( int argc, char **argv ) {
 				     URIBOOT_NO_SAN_BOOT ), 0 );
 }
 
+/** "sanstat" options */
+struct sanstat_options {};
+
+/** "sanstat" option list */
+static struct option_descriptor sanstat_opts[] = {};
+
+/** "sanstat" command descriptor */
+static struct command_descriptor sanstat_cmd =
+	COMMAND_DESC ( struct sanstat_options, sanstat_opts, 0, 0, NULL );
+
+/**
+ * The "sanstat" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int sanstat_exec ( int argc, char **argv ) {
+	struct sanstat_options opts;
+	struct san_device *sandev;
+	int rc;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &sanstat_cmd, &opts ) ) != 0 )
+		return rc;
+
+	/* Show status of all SAN devices */
+	for_each_sandev ( sandev )
+		sanstat ( sandev );
+
+	return 0;
+}
+
 /** SAN commands */
 COMMAND ( sanhook, sanhook_exec );
 COMMAND ( sanboot, sanboot_exec );
 COMMAND ( sanunhook, sanunhook_exec );
+COMMAND ( sanstat, sanstat_exec );
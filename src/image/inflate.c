@@ -0,0 +1,510 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/zlib.h>
+#include <ipxe/gzip.h>
+#include <ipxe/inflate.h>
+
+/** @file
+ *
+ * Streaming decompression of downloaded images
+ *
+ * gzip and zlib compressed images may be decompressed as they are
+ * downloaded, so that the compressed image is never held in memory.
+ * Data that does not start with a gzip or zlib signature is stored
+ * unmodified.
+ *
+ * The decompressor cannot be paused when its output buffer is full,
+ * so compressed data is fed to it in steps no larger than the
+ * worst-case expansion that the output buffer can accommodate.
+ */
+
+/**
+ * Allocate streaming decompressor
+ *
+ * @ret inflater	Streaming decompressor, or NULL on failure
+ */
+struct inflater * alloc_inflater ( void ) {
+
+	return zalloc ( sizeof ( struct inflater ) );
+}
+
+/**
+ * Reserve space in output buffer
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v len		Required space
+ * @ret rc		Return status code
+ */
+static int inflater_reserve ( struct inflater *inflater,
+			      struct xfer_buffer *xferbuf, size_t len ) {
+	size_t min_len;
+	size_t new_len;
+
+	/* Check for overflow */
+	min_len = ( inflater->len + len );
+	if ( min_len < len )
+		return -EOVERFLOW;
+
+	/* Do nothing if buffer is already large enough */
+	if ( min_len <= xferbuf->len )
+		return 0;
+
+	/* Grow buffer geometrically, to avoid reallocating for every
+	 * received packet.  Note that the old and new buffers are
+	 * both briefly held in memory while reallocating.
+	 */
+	new_len = ( xferbuf->len + ( xferbuf->len / 4 ) );
+	if ( new_len < min_len )
+		new_len = min_len;
+	return xferbuf_ensure_size ( xferbuf, new_len );
+}
+
+/**
+ * Store uncompressed data
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v data		Data
+ * @v len		Length of data
+ * @ret rc		Return status code
+ */
+static int inflater_copy ( struct inflater *inflater,
+			   struct xfer_buffer *xferbuf,
+			   const void *data, size_t len ) {
+	int rc;
+
+	/* Reserve space */
+	if ( ( rc = inflater_reserve ( inflater, xferbuf, len ) ) != 0 )
+		return rc;
+
+	/* Copy data */
+	memcpy ( ( xferbuf->data + inflater->len ), data, len );
+	inflater->len += len;
+
+	return 0;
+}
+
+/**
+ * Decompress data
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v data		Compressed data
+ * @v len		Length of compressed data
+ * @ret rc		Return status code
+ */
+static int inflater_inflate ( struct inflater *inflater,
+			      struct xfer_buffer *xferbuf,
+			      const void *data, size_t len ) {
+	struct deflate *deflate = &inflater->deflate;
+	struct deflate_chunk out;
+	size_t step;
+	size_t space;
+	int rc;
+
+	while ( len ) {
+
+		/* Ensure that output buffer can accommodate at least
+		 * a minimum-length step.
+		 */
+		step = len;
+		if ( step > INFLATE_MIN_STEP )
+			step = INFLATE_MIN_STEP;
+		if ( ( rc = inflater_reserve ( inflater, xferbuf,
+					       INFLATE_MAX_LEN ( step ) ) ) != 0 )
+			return rc;
+
+		/* Calculate largest step that cannot overflow the
+		 * output buffer.
+		 */
+		space = ( xferbuf->len - inflater->len );
+		step = ( ( space - INFLATE_MAX_LEN ( 0 ) ) /
+			 INFLATE_MAX_RATIO );
+		if ( step > len )
+			step = len;
+
+		/* Decompress data */
+		deflate_chunk_init ( &out, xferbuf->data, inflater->len,
+				     xferbuf->len );
+		if ( ( rc = deflate_inflate ( deflate, data, step,
+					      &out ) ) != 0 ) {
+			DBGC ( inflater, "INFLATE %p could not decompress: "
+			       "%s\n", inflater, strerror ( rc ) );
+			return rc;
+		}
+		assert ( out.offset <= xferbuf->len );
+		inflater->len = out.offset;
+		data += step;
+		len -= step;
+
+		/* Stop when decompression is complete, ignoring any
+		 * trailing data (such as a gzip footer).
+		 */
+		if ( deflate_finished ( deflate ) ) {
+			DBGC ( inflater, "INFLATE %p decompressed to %#zx "
+			       "bytes\n", inflater, inflater->len );
+			inflater->state = INFLATER_DONE;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Move to next gzip header field
+ *
+ * @v inflater		Streaming decompressor
+ */
+static void inflater_gzip_next ( struct inflater *inflater ) {
+
+	/* Reset accumulated header */
+	inflater->fill = 0;
+
+	/* Identify next header field, if any */
+	if ( inflater->flags & GZIP_FL_EXTRA ) {
+		inflater->flags &= ~GZIP_FL_EXTRA;
+		inflater->state = INFLATER_GZIP_EXTRA;
+	} else if ( inflater->flags & GZIP_FL_NAME ) {
+		inflater->flags &= ~GZIP_FL_NAME;
+		inflater->state = INFLATER_GZIP_STRING;
+	} else if ( inflater->flags & GZIP_FL_COMMENT ) {
+		inflater->flags &= ~GZIP_FL_COMMENT;
+		inflater->state = INFLATER_GZIP_STRING;
+	} else if ( inflater->flags & GZIP_FL_HCRC ) {
+		inflater->flags &= ~GZIP_FL_HCRC;
+		inflater->skip = sizeof ( struct gzip_crc_header );
+		inflater->state = INFLATER_GZIP_SKIP;
+	} else {
+		deflate_init ( &inflater->deflate, DEFLATE_RAW );
+		inflater->state = INFLATER_DATA;
+	}
+}
+
+/**
+ * Accumulate header
+ *
+ * @v inflater		Streaming decompressor
+ * @v data		Data
+ * @v len		Length of data
+ * @v total		Total length of header
+ * @ret used		Length of data used
+ */
+static size_t inflater_accumulate ( struct inflater *inflater,
+				    const void *data, size_t len,
+				    size_t total ) {
+	size_t frag_len;
+
+	/* Sanity check */
+	assert ( total <= sizeof ( inflater->header ) );
+	assert ( inflater->fill < total );
+
+	/* Accumulate as much as possible */
+	frag_len = ( total - inflater->fill );
+	if ( frag_len > len )
+		frag_len = len;
+	memcpy ( &inflater->header[inflater->fill], data, frag_len );
+	inflater->fill += frag_len;
+
+	return frag_len;
+}
+
+/**
+ * Identify compression format
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @ret rc		Return status code
+ */
+static int inflater_magic ( struct inflater *inflater,
+			    struct xfer_buffer *xferbuf ) {
+	const struct gzip_header *gzip = ( ( const void * ) inflater->header );
+	const union zlib_magic *zlib = ( ( const void * ) inflater->header );
+
+	/* Check for gzip signature */
+	if ( gzip->magic == cpu_to_be16 ( GZIP_MAGIC ) ) {
+		DBGC ( inflater, "INFLATE %p detected gzip\n", inflater );
+		inflater->state = INFLATER_GZIP_HEADER;
+		return 0;
+	}
+
+	/* Check for zlib signature */
+	if ( zlib_magic_is_valid ( zlib ) ) {
+		DBGC ( inflater, "INFLATE %p detected zlib\n", inflater );
+		deflate_init ( &inflater->deflate, DEFLATE_ZLIB );
+		inflater->state = INFLATER_DATA;
+		return inflater_inflate ( inflater, xferbuf, inflater->header,
+					  inflater->fill );
+	}
+
+	/* Otherwise, store data unmodified */
+	DBGC ( inflater, "INFLATE %p detected uncompressed data\n", inflater );
+	inflater->state = INFLATER_RAW;
+	return inflater_copy ( inflater, xferbuf, inflater->header,
+			       inflater->fill );
+}
+
+/**
+ * Process gzip fixed header
+ *
+ * @v inflater		Streaming decompressor
+ * @ret rc		Return status code
+ */
+static int inflater_gzip_header ( struct inflater *inflater ) {
+	const struct gzip_header *header =
+		( ( const void * ) inflater->header );
+
+	/* Check compression method */
+	if ( header->method != GZIP_METHOD_DEFLATE ) {
+		DBGC ( inflater, "INFLATE %p unsupported gzip method %d\n",
+		       inflater, header->method );
+		return -ENOTSUP;
+	}
+
+	/* Move to first optional header field, if any */
+	inflater->flags = header->flags;
+	inflater_gzip_next ( inflater );
+
+	return 0;
+}
+
+/**
+ * Process gzip extra header length
+ *
+ * @v inflater		Streaming decompressor
+ */
+static void inflater_gzip_extra ( struct inflater *inflater ) {
+	const struct gzip_extra_header *extra =
+		( ( const void * ) inflater->header );
+
+	/* Skip extra header */
+	inflater->skip = le16_to_cpu ( extra->len );
+	inflater->state = INFLATER_GZIP_SKIP;
+}
+
+/**
+ * Process received data
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v data		Data
+ * @v len		Length of data
+ * @ret rc		Return status code
+ */
+static int inflater_process ( struct inflater *inflater,
+			      struct xfer_buffer *xferbuf,
+			      const void *data, size_t len ) {
+	const void *nul;
+	size_t used;
+	int rc;
+
+	while ( len ) {
+
+		/* Process data according to current state */
+		rc = 0;
+		switch ( inflater->state ) {
+		case INFLATER_MAGIC:
+			used = inflater_accumulate ( inflater, data, len,
+						     sizeof ( union zlib_magic ));
+			if ( inflater->fill == sizeof ( union zlib_magic ) )
+				rc = inflater_magic ( inflater, xferbuf );
+			break;
+		case INFLATER_GZIP_HEADER:
+			used = inflater_accumulate ( inflater, data, len,
+						     sizeof ( struct gzip_header ));
+			if ( inflater->fill == sizeof ( struct gzip_header ) )
+				rc = inflater_gzip_header ( inflater );
+			break;
+		case INFLATER_GZIP_EXTRA:
+			used = inflater_accumulate ( inflater, data, len,
+					sizeof ( struct gzip_extra_header ) );
+			if ( inflater->fill ==
+			     sizeof ( struct gzip_extra_header ) )
+				inflater_gzip_extra ( inflater );
+			break;
+		case INFLATER_GZIP_SKIP:
+			used = inflater->skip;
+			if ( used > len )
+				used = len;
+			inflater->skip -= used;
+			if ( ! inflater->skip )
+				inflater_gzip_next ( inflater );
+			break;
+		case INFLATER_GZIP_STRING:
+			nul = memchr ( data, 0, len );
+			if ( nul ) {
+				used = ( nul + 1 /* NUL */ - data );
+				inflater_gzip_next ( inflater );
+			} else {
+				used = len;
+			}
+			break;
+		case INFLATER_DATA:
+			rc = inflater_inflate ( inflater, xferbuf, data, len );
+			used = len;
+			break;
+		case INFLATER_RAW:
+			rc = inflater_copy ( inflater, xferbuf, data, len );
+			used = len;
+			break;
+		case INFLATER_DONE:
+			/* Ignore trailing data */
+			used = len;
+			break;
+		default:
+			assert ( 0 );
+			return -EINVAL;
+		}
+		if ( rc != 0 )
+			return rc;
+
+		/* Consume data */
+		data += used;
+		len -= used;
+	}
+
+	return 0;
+}
+
+/**
+ * Receive downloaded data
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ *
+ * Compressed data must be received in order.  Data that has already
+ * been received (such as a retransmitted duplicate TFTP block) is
+ * discarded.  Zero-length seeks (as used by some protocols to presize
+ * the buffer) are ignored.
+ */
+int inflater_deliver ( struct inflater *inflater, struct xfer_buffer *xferbuf,
+		       struct io_buffer *iobuf, struct xfer_metadata *meta ) {
+	size_t len = iob_len ( iobuf );
+	size_t skip;
+	size_t pos;
+	int rc;
+
+	/* Calculate input position */
+	pos = inflater->pos;
+	if ( meta->flags & XFER_FL_ABS_OFFSET )
+		pos = 0;
+	pos += meta->offset;
+
+	/* Ignore zero-length seeks */
+	if ( ! len ) {
+		rc = 0;
+		goto done;
+	}
+
+	/* Discard any data that has already been received */
+	if ( pos < inflater->pos ) {
+		skip = ( inflater->pos - pos );
+		if ( skip >= len ) {
+			rc = 0;
+			goto done;
+		}
+		iob_pull ( iobuf, skip );
+		pos += skip;
+		len -= skip;
+	}
+
+	/* Check that data is received without gaps */
+	if ( pos != inflater->pos ) {
+		DBGC ( inflater, "INFLATE %p cannot process out-of-order data "
+		       "at %#zx (expected %#zx)\n", inflater, pos,
+		       inflater->pos );
+		rc = -ENOTSUP;
+		goto done;
+	}
+	inflater->pos += len;
+
+	/* Process data */
+	if ( ( rc = inflater_process ( inflater, xferbuf, iobuf->data,
+				       len ) ) != 0 )
+		goto done;
+
+	/* Record output position */
+	xferbuf->pos = inflater->len;
+
+ done:
+	free_iob ( iobuf );
+	return rc;
+}
+
+/**
+ * Complete download
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @ret rc		Return status code
+ */
+int inflater_finish ( struct inflater *inflater,
+		      struct xfer_buffer *xferbuf ) {
+	int rc;
+
+	/* Check for completion */
+	switch ( inflater->state ) {
+	case INFLATER_MAGIC:
+		/* Image too short to be compressed: store unmodified */
+		if ( ( rc = inflater_copy ( inflater, xferbuf, inflater->header,
+					    inflater->fill ) ) != 0 )
+			return rc;
+		break;
+	case INFLATER_RAW:
+	case INFLATER_DONE:
+		break;
+	default:
+		DBGC ( inflater, "INFLATE %p incomplete compressed data\n",
+		       inflater );
+		return -EINVAL;
+	}
+
+	/* Trim buffer to length of output */
+	if ( inflater->len ) {
+		if ( ( rc = xferbuf->op->realloc ( xferbuf,
+						   inflater->len ) ) != 0 ) {
+			return rc;
+		}
+	} else {
+		xferbuf_free ( xferbuf );
+	}
+	xferbuf->len = inflater->len;
+	xferbuf->pos = inflater->len;
+
+	return 0;
+}
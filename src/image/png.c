@@ -349,71 +349,110 @@ static int png_image_data ( struct image *image, struct png_context *png,
 }
 
 /**
- * Unfilter byte using the "None" filter
+ * Unfilter scanline using the "None" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v data		Filtered scanline data
+ * @v above		Unfiltered above scanline data, or NULL
+ * @v len		Length of scanline data
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_none ( unsigned int current,
-					unsigned int left __unused,
-					unsigned int above __unused,
-					unsigned int above_left __unused ) {
+static void png_unfilter_none ( uint8_t *data __unused,
+				const uint8_t *above __unused,
+				size_t len __unused,
+				size_t pixel_len __unused ) {
 
-	return current;
+	/* Nothing to do */
 }
 
 /**
- * Unfilter byte using the "Sub" filter
+ * Unfilter scanline using the "Sub" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v data		Filtered scanline data
+ * @v above		Unfiltered above scanline data, or NULL
+ * @v len		Length of scanline data
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_sub ( unsigned int current,
-				       unsigned int left,
-				       unsigned int above __unused,
-				       unsigned int above_left __unused ) {
+static void png_unfilter_sub ( uint8_t *data, const uint8_t *above __unused,
+			       size_t len, size_t pixel_len ) {
+	size_t i;
 
-	return ( current + left );
+	/* Add left byte (which is zero for the first pixel) */
+	for ( i = pixel_len ; i < len ; i++ )
+		data[i] += data[ i - pixel_len ];
 }
 
 /**
- * Unfilter byte using the "Up" filter
+ * Add bytes within a word without carrying between bytes
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v a			Packed bytes
+ * @v b			Packed bytes
+ * @ret sum		Packed sums (modulo 256)
  */
-static unsigned int png_unfilter_up ( unsigned int current,
-				      unsigned int left __unused,
-				      unsigned int above,
-				      unsigned int above_left __unused ) {
+static inline unsigned long png_add_bytes ( unsigned long a,
+					    unsigned long b ) {
+	const unsigned long high = ( ( ~0UL / 0xff ) * 0x80 );
 
-	return ( current + above );
+	return ( ( ( a & ~high ) + ( b & ~high ) ) ^ ( ( a ^ b ) & high ) );
 }
 
 /**
- * Unfilter byte using the "Average" filter
+ * Unfilter scanline using the "Up" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v data		Filtered scanline data
+ * @v above		Unfiltered above scanline data, or NULL
+ * @v len		Length of scanline data
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_average ( unsigned int current,
-					   unsigned int left,
-					   unsigned int above,
-					   unsigned int above_left __unused ) {
+static void png_unfilter_up ( uint8_t *data, const uint8_t *above,
+			      size_t len, size_t pixel_len __unused ) {
+	unsigned long current;
+	unsigned long prior;
+	size_t i;
+
+	/* Above bytes are taken to be zero on the first scanline */
+	if ( ! above )
+		return;
+
+	/* Add above bytes a word at a time, since there is no
+	 * dependency between bytes within the scanline.
+	 */
+	for ( i = 0 ; ( i + sizeof ( current ) ) <= len ;
+	      i += sizeof ( current ) ) {
+		memcpy ( &current, &data[i], sizeof ( current ) );
+		memcpy ( &prior, &above[i], sizeof ( prior ) );
+		current = png_add_bytes ( current, prior );
+		memcpy ( &data[i], &current, sizeof ( current ) );
+	}
 
-	return ( current + ( ( above + left ) >> 1 ) );
+	/* Add any remaining above bytes */
+	for ( ; i < len ; i++ )
+		data[i] += above[i];
+}
+
+/**
+ * Unfilter scanline using the "Average" filter
+ *
+ * @v data		Filtered scanline data
+ * @v above		Unfiltered above scanline data, or NULL
+ * @v len		Length of scanline data
+ * @v pixel_len		Pixel length
+ */
+static void png_unfilter_average ( uint8_t *data, const uint8_t *above,
+				   size_t len, size_t pixel_len ) {
+	size_t i;
+
+	/* Above bytes are taken to be zero on the first scanline */
+	if ( ! above ) {
+		for ( i = pixel_len ; i < len ; i++ )
+			data[i] += ( data[ i - pixel_len ] >> 1 );
+		return;
+	}
+
+	/* Left bytes are taken to be zero for the first pixel */
+	for ( i = 0 ; ( i < pixel_len ) && ( i < len ) ; i++ )
+		data[i] += ( above[i] >> 1 );
+	for ( ; i < len ; i++ )
+		data[i] += ( ( data[ i - pixel_len ] + above[i] ) >> 1 );
 }
 
 /**
@@ -424,8 +463,9 @@ static unsigned int png_unfilter_average ( unsigned int current,
  * @v c			Pixel C
  * @ret predictor	Predictor pixel
  */
-static unsigned int png_paeth_predictor ( unsigned int a, unsigned int b,
-					  unsigned int c ) {
+static inline unsigned int png_paeth_predictor ( unsigned int a,
+						 unsigned int b,
+						 unsigned int c ) {
 	unsigned int p;
 	unsigned int pa;
 	unsigned int pb;
@@ -446,37 +486,53 @@ static unsigned int png_paeth_predictor ( unsigned int a, unsigned int b,
 }
 
 /**
- * Unfilter byte using the "Paeth" filter
+ * Unfilter scanline using the "Paeth" filter
  *
- * @v current		Filtered current byte
- * @v above_left	Unfiltered above-left byte
- * @v above		Unfiltered above byte
- * @v left		Unfiltered left byte
- * @ret current		Unfiltered current byte
+ * @v data		Filtered scanline data
+ * @v above		Unfiltered above scanline data, or NULL
+ * @v len		Length of scanline data
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_paeth ( unsigned int current,
-					 unsigned int left,
-					 unsigned int above,
-					 unsigned int above_left ) {
+static void png_unfilter_paeth ( uint8_t *data, const uint8_t *above,
+				 size_t len, size_t pixel_len ) {
+	size_t i;
+
+	/* With zero above bytes, the predictor is always the left
+	 * byte and the filter is equivalent to the "Sub" filter.
+	 */
+	if ( ! above ) {
+		png_unfilter_sub ( data, above, len, pixel_len );
+		return;
+	}
 
-	return ( current + png_paeth_predictor ( left, above, above_left ) );
+	/* With zero left and above-left bytes, the predictor is
+	 * always the above byte for the first pixel.
+	 */
+	for ( i = 0 ; ( i < pixel_len ) && ( i < len ) ; i++ )
+		data[i] += above[i];
+	for ( ; i < len ; i++ ) {
+		data[i] += png_paeth_predictor ( data[ i - pixel_len ],
+						 above[i],
+						 above[ i - pixel_len ] );
+	}
 }
 
 /** A PNG filter */
 struct png_filter {
 	/**
-	 * Unfilter byte
+	 * Unfilter scanline
+	 *
+	 * @v data		Filtered scanline data
+	 * @v above		Unfiltered above scanline data, or NULL
+	 * @v len		Length of scanline data
+	 * @v pixel_len		Pixel length
 	 *
-	 * @v current		Filtered current byte
-	 * @v left		Unfiltered left byte
-	 * @v above		Unfiltered above byte
-	 * @v above_left	Unfiltered above-left byte
-	 * @ret current		Unfiltered current byte
+	 * The above scanline data is NULL for the first scanline
+	 * of each interlace pass, in which case all above bytes
+	 * are taken to be zero.
 	 */
-	unsigned int ( * unfilter ) ( unsigned int current,
-				      unsigned int left,
-				      unsigned int above,
-				      unsigned int above_left );
+	void ( * unfilter ) ( uint8_t *data, const uint8_t *above,
+			      size_t len, size_t pixel_len );
 };
 
 /** PNG filter types */
@@ -504,18 +560,15 @@ static int png_unfilter_pass ( struct image *image, struct png_context *png,
 	size_t pixel_len = png_pixel_len ( png );
 	size_t scanline_len = png_scanline_len ( png, interlace );
 	uint8_t *data = ( png->raw.data + png->raw.offset );
+	const uint8_t *above;
 	struct png_filter *filter;
 	unsigned int scanline;
-	unsigned int byte;
 	unsigned int filter_type;
-	unsigned int left;
-	unsigned int above;
-	unsigned int above_left;
 
 	/* On the first scanline of a pass, above bytes are assumed to
 	 * be zero.
 	 */
-	above = 0;
+	above = NULL;
 
 	/* Iterate over each scanline in turn */
 	for ( scanline = 0 ; scanline < interlace->height ; scanline++ ) {
@@ -533,30 +586,11 @@ static int png_unfilter_pass ( struct image *image, struct png_context *png,
 		DBGC2 ( image, "PNG %s pass %d scanline %d filter type %d\n",
 			image->name, interlace->pass, scanline, filter_type );
 
-		/* At the start of a line, both above-left and left
-		 * bytes are taken to be zero.
-		 */
-		left = 0;
-		above_left = 0;
-
-		/* Iterate over each byte (not pixel) in turn */
-		for ( byte = 0 ; byte < ( scanline_len - 1 ) ; byte++ ) {
-
-			/* Extract predictor bytes, if applicable */
-			if ( byte >= pixel_len )
-				left = *( data - pixel_len );
-			if ( scanline > 0 )
-				above = *( data - scanline_len );
-			if ( ( scanline > 0 ) && ( byte >= pixel_len ) ) {
-				above_left = *( data - scanline_len -
-						pixel_len );
-			}
-
-			/* Unfilter current byte */
-			*data = filter->unfilter ( *data, left, above,
-						   above_left );
-			data++;
-		}
+		/* Unfilter scanline */
+		filter->unfilter ( data, above, ( scanline_len - 1 ),
+				   pixel_len );
+		above = data;
+		data += ( scanline_len - 1 );
 	}
 
 	/* Update offset */
@@ -738,6 +772,79 @@ static void png_pixels_pass ( struct image *image,
 	png->raw.offset = ( ( ( const void * ) data ) - png->raw.data );
 }
 
+/**
+ * Fill one interlace pass of 8-bit truecolour PNG pixels
+ *
+ * @v image		PNG image
+ * @v png		PNG context
+ * @v interlace		Interlace pass
+ *
+ * This is a fast path equivalent to png_pixels_pass() for the common
+ * case of 8-bit RGB or RGBA images, avoiding the need to extract
+ * each sample individually.
+ */
+static void png_pixels_rgb_pass ( struct image *image,
+				  struct png_context *png,
+				  struct png_interlace *interlace ) {
+	int has_alpha = ( png->colour_type & PNG_COLOUR_TYPE_ALPHA );
+	const uint8_t *data = ( png->raw.data + png->raw.offset );
+	uint32_t *pixbuf_y;
+	uint32_t *pixbuf;
+	unsigned int pixbuf_x_stride;
+	unsigned int pixbuf_y_stride;
+	unsigned int red;
+	unsigned int green;
+	unsigned int blue;
+	unsigned int alpha;
+	unsigned int y;
+	unsigned int x;
+
+	/* Sanity check */
+	assert ( png->depth == 8 );
+	assert ( png->channels == ( has_alpha ? 4 : 3 ) );
+
+	/* Calculate pixel buffer position and strides */
+	pixbuf_y = &png->pixbuf->data[ ( interlace->y_indent *
+					 png->pixbuf->width ) +
+				       interlace->x_indent ];
+	pixbuf_x_stride = interlace->x_stride;
+	pixbuf_y_stride = ( interlace->y_stride * png->pixbuf->width );
+	DBGC2 ( image, "PNG %s pass %d %dx%d at (%d,%d) stride (%d,%d) "
+		"(fast)\n", image->name, interlace->pass, interlace->width,
+		interlace->height, interlace->x_indent, interlace->y_indent,
+		interlace->x_stride, interlace->y_stride );
+
+	/* Iterate over each scanline in turn */
+	for ( y = 0 ; y < interlace->height ; y++ ) {
+
+		/* Skip filter byte */
+		data++;
+
+		/* Convert each pixel in turn */
+		pixbuf = pixbuf_y;
+		for ( x = 0 ; x < interlace->width ; x++ ) {
+			red = data[0];
+			green = data[1];
+			blue = data[2];
+			alpha = ( has_alpha ? data[3] : 0xff );
+			if ( alpha != 0xff ) {
+				red = png_pixel ( red, alpha, 0xff );
+				green = png_pixel ( green, alpha, 0xff );
+				blue = png_pixel ( blue, alpha, 0xff );
+			}
+			*pixbuf = ( ( red << 16 ) | ( green << 8 ) | blue );
+			data += png->channels;
+			pixbuf += pixbuf_x_stride;
+		}
+
+		/* Move to next output row */
+		pixbuf_y += pixbuf_y_stride;
+	}
+
+	/* Update offset */
+	png->raw.offset = ( ( ( const void * ) data ) - png->raw.data );
+}
+
 /**
  * Fill PNG pixels
  *
@@ -763,8 +870,14 @@ static void png_pixels ( struct image *image, struct png_context *png ) {
 		if ( interlace.width == 0 )
 			continue;
 
-		/* Unfilter this pass */
-		png_pixels_pass ( image, png, &interlace );
+		/* Fill pixels for this pass */
+		if ( ( png->depth == 8 ) &&
+		     ( ( png->colour_type & ~PNG_COLOUR_TYPE_ALPHA ) ==
+		       PNG_COLOUR_TYPE_RGB ) ) {
+			png_pixels_rgb_pass ( image, png, &interlace );
+		} else {
+			png_pixels_pass ( image, png, &interlace );
+		}
 	}
 	assert ( png->raw.offset == png->raw.len );
 }
@@ -157,3 +157,7 @@ struct image_type zlib_image_type __image_type ( PROBE_NORMAL ) = {
 	.extract = zlib_extract,
 	.exec = image_extract_exec,
 };
+
+/* Drag in streaming decompression via zlib_deflate() */
+REQUIRING_SYMBOL ( zlib_deflate );
+REQUIRE_OBJECT ( inflate );
@@ -108,8 +108,16 @@ struct aoehdr {
 /** AoE tag magic marker */
 #define AOE_TAG_MAGIC 0x18ae0000
 
-/** Maximum number of sectors per packet */
-#define AOE_MAX_COUNT 2
+/** Maximum number of sectors per command
+ *
+ * This is limited by the single-byte sector count field within the
+ * AoE ATA command header.  The number of sectors actually used will
+ * be further limited to fit within the network device's MTU.
+ */
+#define AOE_MAX_COUNT 255
+
+/** Default maximum number of concurrent ATA commands per device */
+#define AOE_DEFAULT_WINDOW 8
 
 /** An AoE device */
 struct aoe_device {
@@ -131,6 +139,13 @@ struct aoe_device {
 	/** Saved timeout value */
 	unsigned long timeout;
 
+	/** Maximum number of sectors per command */
+	unsigned int max_count;
+	/** Maximum number of concurrent ATA commands */
+	unsigned int max_window;
+	/** Current number of concurrent ATA commands permitted */
+	unsigned int window;
+
 	/** Configuration command interface */
 	struct interface config;
 	/** Device is configued */
@@ -127,9 +127,45 @@ struct asn1_builder_header {
 #define ASN1_OID_TRIPLE( value ) \
 	( 0x80 | ( ( (value) >> 14 ) & 0x7f ) ), ASN1_OID_DOUBLE ( (value) )
 
+/** ASN.1 OID for id-ecPublicKey (1.2.840.10045.2.1) */
+#define ASN1_OID_ECPUBLICKEY					\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 2 ),	\
+	ASN1_OID_SINGLE ( 1 )
+
+/** ASN.1 OID for ecdsa-with-SHA1 (1.2.840.10045.4.1) */
+#define ASN1_OID_ECDSA_WITH_SHA1				\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 4 ),	\
+	ASN1_OID_SINGLE ( 1 )
+
+/** ASN.1 OID for ecdsa-with-SHA224 (1.2.840.10045.4.3.1) */
+#define ASN1_OID_ECDSA_WITH_SHA224				\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 4 ),	\
+	ASN1_OID_SINGLE ( 3 ), ASN1_OID_SINGLE ( 1 )
+
+/** ASN.1 OID for ecdsa-with-SHA256 (1.2.840.10045.4.3.2) */
+#define ASN1_OID_ECDSA_WITH_SHA256				\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 4 ),	\
+	ASN1_OID_SINGLE ( 3 ), ASN1_OID_SINGLE ( 2 )
+
+/** ASN.1 OID for ecdsa-with-SHA384 (1.2.840.10045.4.3.3) */
+#define ASN1_OID_ECDSA_WITH_SHA384				\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 4 ),	\
+	ASN1_OID_SINGLE ( 3 ), ASN1_OID_SINGLE ( 3 )
+
+/** ASN.1 OID for ecdsa-with-SHA512 (1.2.840.10045.4.3.4) */
+#define ASN1_OID_ECDSA_WITH_SHA512				\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 4 ),	\
+	ASN1_OID_SINGLE ( 3 ), ASN1_OID_SINGLE ( 4 )
+
 /** ASN.1 OID for prime256v1 (1.2.840.10045.3.1.7) */
 #define ASN1_OID_PRIME256V1					\
-	ASN1_OID_INITIAL ( 1, 1 ), ASN1_OID_DOUBLE ( 840 ),	\
+	ASN1_OID_INITIAL ( 1, 2 ), ASN1_OID_DOUBLE ( 840 ),	\
 	ASN1_OID_DOUBLE ( 10045 ), ASN1_OID_SINGLE ( 3 ),	\
 	ASN1_OID_SINGLE ( 1 ), ASN1_OID_SINGLE ( 7 )
 
@@ -417,6 +453,12 @@ extern struct asn1_algorithm
 sha512_with_rsa_encryption_algorithm __asn1_algorithm;
 extern struct asn1_algorithm
 sha224_with_rsa_encryption_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ec_public_key_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ecdsa_with_sha1_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ecdsa_with_sha224_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ecdsa_with_sha256_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ecdsa_with_sha384_algorithm __asn1_algorithm;
+extern struct asn1_algorithm ecdsa_with_sha512_algorithm __asn1_algorithm;
 extern struct asn1_algorithm oid_md4_algorithm __asn1_algorithm;
 extern struct asn1_algorithm oid_md5_algorithm __asn1_algorithm;
 extern struct asn1_algorithm oid_sha1_algorithm __asn1_algorithm;
@@ -509,6 +551,8 @@ extern int asn1_cipher_algorithm ( const struct asn1_cursor *cursor,
 				   struct asn1_cursor *params );
 extern int asn1_signature_algorithm ( const struct asn1_cursor *cursor,
 				      struct asn1_algorithm **algorithm );
+extern int asn1_curve_algorithm ( const struct asn1_cursor *cursor,
+				  struct asn1_algorithm **algorithm );
 extern int asn1_check_algorithm ( const struct asn1_cursor *cursor,
 				  struct asn1_algorithm *expected );
 extern int asn1_parse_cbc ( struct asn1_algorithm *algorithm,
@@ -188,6 +188,10 @@ struct elliptic_curve {
 	size_t pointsize;
 	/** Scalar (and private key) size */
 	size_t keysize;
+	/** Generator base point */
+	const void *base;
+	/** Order of the generator base point (if applicable) */
+	const void *order;
 	/** Multiply scalar by curve point
 	 *
 	 * @v base		Base point (or NULL to use generator)
@@ -197,6 +201,15 @@ struct elliptic_curve {
 	 */
 	int ( * multiply ) ( const void *base, const void *scalar,
 			     void *result );
+	/** Add curve points (if applicable)
+	 *
+	 * @v addend		Curve point to add
+	 * @v augend		Curve point to add
+	 * @v result		Curve point to hold result
+	 * @ret rc		Return status code
+	 */
+	int ( * add ) ( const void *addend, const void *augend,
+			void *result );
 };
 
 static inline __attribute__ (( always_inline )) void
@@ -312,6 +325,12 @@ elliptic_multiply ( struct elliptic_curve *curve,
 	return curve->multiply ( base, scalar, result );
 }
 
+static inline __attribute__ (( always_inline )) int
+elliptic_add ( struct elliptic_curve *curve,
+	       const void *addend, const void *augend, void *result ) {
+	return curve->add ( addend, augend, result );
+}
+
 extern void digest_null_init ( void *ctx );
 extern void digest_null_update ( void *ctx, const void *src, size_t len );
 extern void digest_null_final ( void *ctx, void *out );
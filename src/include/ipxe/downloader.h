@@ -12,6 +12,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 struct interface;
 struct image;
 
-extern int create_downloader ( struct interface *job, struct image *image );
+/** Decompress gzip or zlib compressed content while downloading */
+#define DOWNLOAD_EXTRACT 0x0001
+
+extern int create_downloader ( struct interface *job, struct image *image,
+			       unsigned int flags );
 
 #endif /* _IPXE_DOWNLOADER_H */
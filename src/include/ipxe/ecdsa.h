@@ -0,0 +1,19 @@
+#ifndef _IPXE_ECDSA_H
+#define _IPXE_ECDSA_H
+
+/** @file
+ *
+ * Elliptic Curve Digital Signature Algorithm (ECDSA)
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/crypto.h>
+
+/** Uncompressed curve point format identifier */
+#define ECDSA_UNCOMPRESSED 0x04
+
+extern struct pubkey_algorithm ecdsa_algorithm;
+
+#endif /* _IPXE_ECDSA_H */
@@ -89,6 +89,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_efi_connect	       ( ERRFILE_CORE | 0x00310000 )
 #define ERRFILE_gpio		       ( ERRFILE_CORE | 0x00320000 )
 #define ERRFILE_spcr		       ( ERRFILE_CORE | 0x00330000 )
+#define ERRFILE_trace		       ( ERRFILE_CORE | 0x00340000 )
 
 #define ERRFILE_eisa		     ( ERRFILE_DRIVER | 0x00000000 )
 #define ERRFILE_isa		     ( ERRFILE_DRIVER | 0x00010000 )
@@ -321,6 +322,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_lldp			( ERRFILE_NET | 0x004c0000 )
 #define ERRFILE_eap_md5			( ERRFILE_NET | 0x004d0000 )
 #define ERRFILE_eap_mschapv2		( ERRFILE_NET | 0x004e0000 )
+#define ERRFILE_gso			( ERRFILE_NET | 0x004f0000 )
+#define ERRFILE_peerserv		( ERRFILE_NET | 0x00500000 )
 
 #define ERRFILE_image		      ( ERRFILE_IMAGE | 0x00000000 )
 #define ERRFILE_elf		      ( ERRFILE_IMAGE | 0x00010000 )
@@ -338,6 +341,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_efi_siglist	      ( ERRFILE_IMAGE | 0x000d0000 )
 #define ERRFILE_lkrn		      ( ERRFILE_IMAGE | 0x000e0000 )
 #define ERRFILE_initrd		      ( ERRFILE_IMAGE | 0x000f0000 )
+#define ERRFILE_inflate		      ( ERRFILE_IMAGE | 0x00100000 )
 
 #define ERRFILE_asn1		      ( ERRFILE_OTHER | 0x00000000 )
 #define ERRFILE_chap		      ( ERRFILE_OTHER | 0x00010000 )
@@ -443,6 +447,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_usb_settings	      ( ERRFILE_OTHER | 0x00650000 )
 #define ERRFILE_weierstrass	      ( ERRFILE_OTHER | 0x00660000 )
 #define ERRFILE_efi_cacert	      ( ERRFILE_OTHER | 0x00670000 )
+#define ERRFILE_ecdsa		      ( ERRFILE_OTHER | 0x00680000 )
+#define ERRFILE_http_test	      ( ERRFILE_OTHER | 0x00690000 )
+#define ERRFILE_peerblk_test	      ( ERRFILE_OTHER | 0x006a0000 )
 
 /** @} */
 
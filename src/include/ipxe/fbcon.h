@@ -102,6 +102,36 @@ struct fbcon_text {
 	struct fbcon_text_cell *cells;
 };
 
+/** A dirty range of characters within a text row */
+struct fbcon_dirty {
+	/** Starting X position */
+	unsigned int start;
+	/** Ending X position (exclusive), or zero if row is clean */
+	unsigned int end;
+};
+
+/** Number of pixels in an expanded glyph row fragment */
+#define FBCON_EXPANDED_PIXELS 4
+
+/** Number of expanded glyph row colour pairs to cache */
+#define FBCON_EXPANDED_CACHE 4
+
+/** Expanded glyph row fragments for a colour pair
+ *
+ * Each possible four-bit fragment of a glyph row is expanded to a
+ * sequence of 32-bit raw foreground and background colours, allowing
+ * a glyph row to be drawn using a few wide stores rather than one
+ * store per pixel.
+ */
+struct fbcon_expanded {
+	/** Foreground raw colour */
+	uint32_t foreground;
+	/** Background raw colour */
+	uint32_t background;
+	/** Expanded fragments */
+	uint32_t pixels[16][FBCON_EXPANDED_PIXELS];
+};
+
 /** A frame buffer background picture */
 struct fbcon_picture {
 	/** Start address */
@@ -114,6 +144,17 @@ struct fbcon {
 	void *start;
 	/** Length of one complete displayed screen */
 	size_t len;
+	/** Shadow frame buffer, or NULL if not in use
+	 *
+	 * All drawing takes place in the shadow frame buffer (which
+	 * resides in system memory), and dirty regions are then
+	 * copied to the (potentially uncached) real frame buffer.
+	 */
+	void *shadow;
+	/** Drawing area (shadow frame buffer, or real frame buffer) */
+	void *draw;
+	/** Dirty ranges (one per text row), if shadow is in use */
+	struct fbcon_dirty *dirty;
 	/** Pixel geometry */
 	struct fbcon_geometry *pixel;
 	/** Character geometry */
@@ -146,6 +187,12 @@ struct fbcon {
 	struct fbcon_picture picture;
 	/** Display cursor */
 	int show_cursor;
+	/** Glyph rows may be drawn using expanded fragments */
+	int expandable;
+	/** Expanded glyph row fragment cache */
+	struct fbcon_expanded expanded[FBCON_EXPANDED_CACHE];
+	/** Next expanded glyph row fragment cache entry to replace */
+	unsigned int expanded_next;
 };
 
 extern int fbcon_init ( struct fbcon *fbcon, void *start,
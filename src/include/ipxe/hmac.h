@@ -10,6 +10,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <ipxe/crypto.h>
 
+/** HMAC input pad byte */
+#define HMAC_IPAD 0x36
+
+/** HMAC output pad byte */
+#define HMAC_OPAD 0x5c
+
 /** HMAC context type */
 #define hmac_context_t( digest ) struct {				\
 		/** Digest context */					\
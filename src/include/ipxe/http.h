@@ -86,8 +86,40 @@ struct http_connection {
 	struct interface xfer;
 	/** Pooled connection */
 	struct pooled_connection pool;
+
+	/** List of active connections */
+	struct list_head active;
+	/** Pipelined transactions awaiting their responses */
+	struct list_head pipeline;
+	/** Pipelined transmission process */
+	struct process process;
+	/** Received data belonging to the next pipelined response */
+	struct io_buffer *unconsumed;
+	/** Flags */
+	unsigned int flags;
 };
 
+/** HTTP connection flags */
+enum http_connection_flags {
+	/** Server has kept the connection alive after a response */
+	HTTP_CONN_PERSISTENT = 0x0001,
+	/** Current transaction may have further requests pipelined */
+	HTTP_CONN_PIPELINE = 0x0002,
+	/** Current transaction has transmitted its request */
+	HTTP_CONN_SENT = 0x0004,
+	/** A pipelined request has been abandoned after transmission */
+	HTTP_CONN_ABANDONED = 0x0008,
+};
+
+/** HTTP connection request flags */
+enum http_connect_flags {
+	/** Request may be pipelined onto an active connection */
+	HTTP_CONNECT_PIPELINE = 0x0001,
+};
+
+/** Maximum number of pipelined transactions per HTTP connection */
+#define HTTP_PIPELINE_MAX 4
+
 /******************************************************************************
  *
  * HTTP methods
@@ -439,6 +471,8 @@ struct http_transaction {
 
 	/** Transaction state */
 	struct http_state *state;
+	/** Received data currently being processed (if any) */
+	struct io_buffer *rx;
 	/** Accumulated transfer-decoded length */
 	size_t len;
 	/** Chunk length remaining */
@@ -555,7 +589,12 @@ struct http_authentication {
  */
 
 extern char * http_token ( char **line, char **value );
-extern int http_connect ( struct interface *xfer, struct uri *uri );
+extern int http_connect ( struct interface *xfer, struct uri *uri,
+			  unsigned int flags );
+extern void http_unconsumed ( struct interface *intf,
+			      struct io_buffer *iobuf );
+#define http_unconsumed_TYPE( object_type ) \
+	typeof ( void ( object_type, struct io_buffer *iobuf ) )
 extern int http_open ( struct interface *xfer, struct http_method *method,
 		       struct uri *uri, struct http_request_range *range,
 		       struct http_request_content *content );
@@ -0,0 +1,96 @@
+#ifndef _IPXE_INFLATE_H
+#define _IPXE_INFLATE_H
+
+/** @file
+ *
+ * Streaming decompression of downloaded images
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/deflate.h>
+#include <ipxe/gzip.h>
+
+struct io_buffer;
+struct xfer_buffer;
+struct xfer_metadata;
+
+/** Streaming decompressor state */
+enum inflater_state {
+	/** Awaiting magic signature */
+	INFLATER_MAGIC = 0,
+	/** Within gzip fixed header */
+	INFLATER_GZIP_HEADER,
+	/** Within gzip extra header length */
+	INFLATER_GZIP_EXTRA,
+	/** Skipping gzip extra header or CRC */
+	INFLATER_GZIP_SKIP,
+	/** Skipping gzip file name or comment */
+	INFLATER_GZIP_STRING,
+	/** Within compressed data */
+	INFLATER_DATA,
+	/** Within uncompressed data */
+	INFLATER_RAW,
+	/** Decompression complete */
+	INFLATER_DONE,
+};
+
+/** A streaming decompressor */
+struct inflater {
+	/** Decompressor */
+	struct deflate deflate;
+	/** State */
+	enum inflater_state state;
+	/** Current input position */
+	size_t pos;
+	/** Length of output data */
+	size_t len;
+	/** Accumulated header */
+	uint8_t header[ sizeof ( struct gzip_header ) ];
+	/** Length of accumulated header */
+	size_t fill;
+	/** Remaining gzip header flags */
+	unsigned int flags;
+	/** Remaining length of data to skip */
+	size_t skip;
+};
+
+/** Maximum length of a duplicated string */
+#define INFLATE_MAX_DUP 258
+
+/** Maximum expansion ratio of compressed data
+ *
+ * The longest duplicated string may be encoded using a single-bit
+ * length code and a single-bit distance code.
+ */
+#define INFLATE_MAX_RATIO ( INFLATE_MAX_DUP * 8 / 2 )
+
+/** Maximum length of output that may be produced by inflating data
+ *
+ * @v len		Length of compressed input data
+ * @ret max_len		Maximum length of output
+ *
+ * Allow for bits already held in the decompressor's accumulator.
+ */
+#define INFLATE_MAX_LEN( len )						\
+	( ( ( (len) + sizeof ( uint32_t ) ) * INFLATE_MAX_RATIO ) +	\
+	  INFLATE_MAX_DUP )
+
+/** Minimum length of compressed data to inflate in one step
+ *
+ * The output buffer is grown if it cannot accommodate the worst-case
+ * expansion of this much input data.
+ */
+#define INFLATE_MIN_STEP 256
+
+extern struct inflater * alloc_inflater ( void );
+extern int inflater_deliver ( struct inflater *inflater,
+			      struct xfer_buffer *xferbuf,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta );
+extern int inflater_finish ( struct inflater *inflater,
+			     struct xfer_buffer *xferbuf );
+
+#endif /* _IPXE_INFLATE_H */
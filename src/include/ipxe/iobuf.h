@@ -54,8 +54,55 @@ struct io_buffer {
 	void *tail;
 	/** End of the buffer */
         void *end;
+
+	/** Checksum offload state */
+	unsigned int csum;
+	/** Offset of deferred checksum field within checksummed data */
+	size_t csum_offset;
+	/** Start of data covered by deferred checksum */
+	void *csum_start;
+
+	/** Segmentation offload type */
+	unsigned int gso;
+	/** Maximum segment payload length (for segmentation offload) */
+	size_t gso_size;
+	/** Start of network-layer header (for segmentation offload) */
+	void *gso_start;
 };
 
+/** Checksum has been neither verified nor deferred */
+#define IOB_CSUM_NONE 0
+
+/** Received transport-layer checksum has been verified by network device */
+#define IOB_CSUM_VALID 1
+
+/** Transmitted transport-layer checksum calculation has been deferred
+ *
+ * The checksum covers all data from @c csum_start to the end of the
+ * I/O buffer, and is to be placed at offset @c csum_offset from @c
+ * csum_start.  The checksum field initially holds zero; once the
+ * network layer has routed the packet, it holds either the complete
+ * checksum (if calculated in software) or the pseudo-header checksum
+ * (if the network device will complete the calculation).
+ */
+#define IOB_CSUM_PARTIAL 2
+
+/** No segmentation is required */
+#define IOB_GSO_NONE 0
+
+/** Packet is a TCP/IPv4 segment to be split at @c gso_size bytes
+ *
+ * A packet requiring segmentation comprises a single template set of
+ * headers followed by a payload that may exceed the path MTU.  The
+ * transport-layer checksum is always deferred (see @c
+ * IOB_CSUM_PARTIAL), and @c gso_start identifies the network-layer
+ * header once the network layer has constructed it.
+ */
+#define IOB_GSO_TCPV4 1
+
+/** Packet is a TCP/IPv6 segment to be split at @c gso_size bytes */
+#define IOB_GSO_TCPV6 2
+
 /**
  * Reserve space at start of I/O buffer
  *
@@ -196,6 +243,44 @@ static inline void iob_populate ( struct io_buffer *iobuf,
 	iobuf->head = iobuf->data = data;
 	iobuf->tail = ( data + len );
 	iobuf->end = ( data + max_len );
+	iobuf->csum = IOB_CSUM_NONE;
+	iobuf->gso = IOB_GSO_NONE;
+}
+
+/**
+ * Defer calculation of transport-layer checksum
+ *
+ * @v iobuf	I/O buffer
+ * @v csum	Checksum field
+ *
+ * The checksum will cover all data from the current start of the I/O
+ * buffer, and will be calculated by either the network layer or the
+ * network device once the transmitting network device is known.
+ */
+static inline void iob_csum_defer ( struct io_buffer *iobuf,
+				    uint16_t *csum ) {
+	iobuf->csum = IOB_CSUM_PARTIAL;
+	iobuf->csum_start = iobuf->data;
+	iobuf->csum_offset = ( ( ( void * ) csum ) - iobuf->data );
+	*csum = 0;
+}
+
+/**
+ * Defer segmentation of transport-layer payload
+ *
+ * @v iobuf	I/O buffer
+ * @v gso	Segmentation offload type
+ * @v size	Maximum segment payload length
+ *
+ * The packet will be split into segments by either the network
+ * device or the network device core once the transmitting network
+ * device is known.  The transport-layer checksum must already have
+ * been deferred using iob_csum_defer().
+ */
+static inline void iob_gso_defer ( struct io_buffer *iobuf,
+				   unsigned int gso, size_t size ) {
+	iobuf->gso = gso;
+	iobuf->gso_size = size;
 }
 
 /**
@@ -50,6 +50,7 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #endif
 
 struct sockaddr;
+struct iovec;
 struct slirp_config;
 struct slirp_callbacks;
 struct Slirp;
@@ -63,6 +64,10 @@ extern int __asmcall linux_close ( int fd );
 extern off_t __asmcall linux_lseek ( int fd, off_t offset, int whence );
 extern ssize_t __asmcall linux_read ( int fd, void *buf, size_t count );
 extern ssize_t __asmcall linux_write ( int fd, const void *buf, size_t count );
+extern ssize_t __asmcall linux_readv ( int fd, const struct iovec *iov,
+				       int iovcnt );
+extern ssize_t __asmcall linux_writev ( int fd, const struct iovec *iov,
+					int iovcnt );
 extern int __asmcall linux_fcntl ( int fd, int cmd, ... );
 extern int __asmcall linux_ioctl ( int fd, unsigned long request, ... );
 extern int __asmcall linux_fstat_size ( int fd, size_t *size );
@@ -81,6 +86,8 @@ extern int __asmcall linux_munmap ( void *addr, size_t length );
 extern int __asmcall linux_socket ( int domain, int type, int protocol );
 extern int __asmcall linux_bind ( int sockfd, const struct sockaddr *addr,
 				  size_t addrlen );
+extern int __asmcall linux_setsockopt ( int sockfd, int level, int optname,
+					const void *optval, size_t optlen );
 extern ssize_t __asmcall linux_sendto ( int sockfd, const void *buf,
 					size_t len, int flags,
 					const struct sockaddr *dest_addr,
@@ -16,6 +16,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/settings.h>
 #include <ipxe/interface.h>
 #include <ipxe/retry.h>
+#include <ipxe/profile.h>
 
 struct io_buffer;
 struct net_device;
@@ -339,6 +340,24 @@ struct net_device_configurator {
 /** Maximum length of a network device name */
 #define NETDEV_NAME_LEN 12
 
+/** Network device polling statistics */
+struct net_device_poll_stats {
+	/** Number of polls */
+	unsigned int polls;
+	/** Number of polls skipped while device was idle */
+	unsigned int skipped;
+	/** Number of times the receive budget was exhausted */
+	unsigned int exhausted;
+};
+
+/** A per-device profiler */
+struct net_device_profiler {
+	/** Profiler */
+	struct profiler profiler;
+	/** Profiler name */
+	char name[ NETDEV_NAME_LEN + 8 /* ".xxxx" */ ];
+};
+
 /**
  * A network device
  *
@@ -423,6 +442,23 @@ struct net_device {
 	struct net_device_stats tx_stats;
 	/** RX statistics */
 	struct net_device_stats rx_stats;
+	/** Count of received packets dropped by hardware
+	 *
+	 * This counts packets that were discarded by the hardware
+	 * (e.g. due to a lack of available receive buffers) and so
+	 * were never seen by the network stack.
+	 */
+	unsigned int rx_dropped;
+	/** Polling statistics */
+	struct net_device_poll_stats poll_stats;
+	/** Number of consecutive idle polls */
+	unsigned int poll_idle;
+	/** Number of polls skipped since the device was last polled */
+	unsigned int poll_skip;
+	/** Poll profiler */
+	struct net_device_profiler poll_profiler;
+	/** Receive profiler */
+	struct net_device_profiler rx_profiler;
 
 	/** Configuration settings applicable to this device */
 	struct generic_settings settings;
@@ -460,6 +496,32 @@ struct net_device {
 /** Network device must be polled even when closed */
 #define NETDEV_INSOMNIAC 0x0040
 
+/** Network device can verify received transport-layer checksums
+ *
+ * This flag can be used by a network device to indicate that it may
+ * mark received I/O buffers with IOB_CSUM_VALID.  The network stack
+ * will skip software verification of the transport-layer checksum
+ * only for I/O buffers so marked by a device setting this flag.
+ */
+#define NETDEV_RX_CSUM 0x0080
+
+/** Network device can calculate transmitted transport-layer checksums
+ *
+ * This flag can be used by a network device to indicate that it will
+ * complete the checksum for any transmitted I/O buffer marked with
+ * IOB_CSUM_PARTIAL.
+ */
+#define NETDEV_TX_CSUM 0x0100
+
+/** Network device can segment transmitted TCP packets
+ *
+ * This flag can be used by a network device to indicate that it will
+ * perform segmentation for any transmitted I/O buffer marked with
+ * IOB_GSO_TCPV4 or IOB_GSO_TCPV6.  A network device setting this flag
+ * must also set NETDEV_TX_CSUM.
+ */
+#define NETDEV_TX_TSO 0x0200
+
 /** Link-layer protocol table */
 #define LL_PROTOCOLS __table ( struct ll_protocol, "ll_protocols" )
 
@@ -707,6 +769,39 @@ netdev_insomniac ( struct net_device *netdev ) {
 	return ( netdev->state & NETDEV_INSOMNIAC );
 }
 
+/**
+ * Check whether or not network device can verify received checksums
+ *
+ * @v netdev		Network device
+ * @ret rx_csum		Network device can verify received checksums
+ */
+static inline __attribute__ (( always_inline )) int
+netdev_rx_csum ( struct net_device *netdev ) {
+	return ( netdev->state & NETDEV_RX_CSUM );
+}
+
+/**
+ * Check whether or not network device can calculate transmit checksums
+ *
+ * @v netdev		Network device
+ * @ret tx_csum		Network device can calculate transmit checksums
+ */
+static inline __attribute__ (( always_inline )) int
+netdev_tx_csum ( struct net_device *netdev ) {
+	return ( netdev->state & NETDEV_TX_CSUM );
+}
+
+/**
+ * Check whether or not network device can segment transmitted packets
+ *
+ * @v netdev		Network device
+ * @ret tx_tso		Network device can segment transmitted packets
+ */
+static inline __attribute__ (( always_inline )) int
+netdev_tx_tso ( struct net_device *netdev ) {
+	return ( netdev->state & NETDEV_TX_TSO );
+}
+
 extern void * netdev_priv ( struct net_device *netdev,
 			    struct net_driver *driver );
 extern void netdev_rx_freeze ( struct net_device *netdev );
@@ -717,6 +812,8 @@ extern void netdev_link_block ( struct net_device *netdev,
 				unsigned long timeout );
 extern void netdev_link_unblock ( struct net_device *netdev );
 extern int netdev_tx ( struct net_device *netdev, struct io_buffer *iobuf );
+extern int netdev_tx_gso ( struct net_device *netdev,
+			   struct io_buffer *iobuf );
 extern void netdev_tx_defer ( struct net_device *netdev,
 			      struct io_buffer *iobuf );
 extern void netdev_tx_err ( struct net_device *netdev,
@@ -779,6 +876,17 @@ static inline void netdev_tx_complete_next ( struct net_device *netdev ) {
 	netdev_tx_complete_next_err ( netdev, 0 );
 }
 
+/**
+ * Record packets dropped by hardware
+ *
+ * @v netdev		Network device
+ * @v count		Number of dropped packets
+ */
+static inline __attribute__ (( always_inline )) void
+netdev_rx_dropped ( struct net_device *netdev, unsigned int count ) {
+	netdev->rx_dropped += count;
+}
+
 /**
  * Mark network device as having link up
  *
@@ -20,6 +20,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define PEERDIST_DISCOVERY_IPV6 \
 	{ 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xc }
 
+/** A PeerDist discovery request */
+struct peerdist_discovery_probe {
+	/** Message ID */
+	char *id;
+	/** List of segment ID strings
+	 *
+	 * The list is terminated with a zero-length string.
+	 */
+	char *ids;
+};
+
 /** A PeerDist discovery reply block count */
 struct peerdist_discovery_block_count {
 	/** Count (as an eight-digit hex value) */
@@ -43,5 +54,13 @@ struct peerdist_discovery_reply {
 extern char * peerdist_discovery_request ( const char *uuid, const char *id );
 extern int peerdist_discovery_reply ( char *data, size_t len,
 				      struct peerdist_discovery_reply *reply );
+extern int peerdist_discovery_probe ( char *data, size_t len,
+				      struct peerdist_discovery_probe *probe );
+extern char * peerdist_discovery_response ( const char *uuid,
+					    const char *relates,
+					    const char *endpoint,
+					    const char *ids,
+					    const unsigned int *counts,
+					    const char *location );
 
 #endif /* _IPXE_PCCRD_H */
@@ -111,6 +111,12 @@ struct peerdist_block {
 	struct peerdisc_client discovery;
 	/** Current position in discovered peer list */
 	struct peerdisc_peer *peer;
+	/** Peers attempted within the current cycle
+	 *
+	 * This is a bitmask indexed by position within the discovered
+	 * peer list.
+	 */
+	uint32_t tried;
 	/** Block download queue */
 	struct peerdist_block_queue *queue;
 	/** List of queued block downloads */
@@ -128,6 +134,34 @@ struct peerdist_block {
 	unsigned long attempted;
 };
 
+/** PeerDist maximum number of concurrent raw block downloads
+ *
+ * Raw block downloads are expensive if the origin server uses HTTPS,
+ * since each concurrent download will require local TLS resources
+ * (including potentially large received encrypted data buffers).
+ *
+ * Raw block downloads may also be prohibitively slow to initiate when
+ * the origin server is using HTTPS and client certificates.  Origin
+ * servers for PeerDist downloads are likely to be running IIS, which
+ * has a bug that breaks session resumption and requires each
+ * connection to go through the full client certificate verification.
+ *
+ * Limit the total number of concurrent raw block downloads to
+ * ameliorate these problems.  The limit starts low, is raised after
+ * each successful raw block download, and is halved (but never below
+ * its initial value) after each failed raw block download, so that a
+ * responsive origin server may be used more aggressively.
+ *
+ * This is a policy decision.
+ */
+#define PEERBLK_RAW_MAX 8
+
+/** PeerDist initial number of concurrent raw block downloads
+ *
+ * This is a policy decision.
+ */
+#define PEERBLK_RAW_INITIAL 2
+
 /** PeerDist block download queue */
 struct peerdist_block_queue {
 	/** Download opening process */
@@ -162,6 +196,9 @@ struct peerdist_block_queue {
 				     blksize ) msg;			\
 	} __attribute__ (( packed ))
 
+extern void peerblk_queue_report ( struct peerdist_block_queue *queue,
+				   int rc );
+extern struct peerdisc_peer * peerblk_select ( struct peerdist_block *peerblk );
 extern int peerblk_open ( struct interface *xfer, struct uri *uri,
 			  struct peerdist_info_block *block );
 
@@ -115,6 +115,17 @@ extern void peerdisc_stat ( struct interface *intf, struct peerdisc_peer *peer,
 	typeof ( void ( object_type, struct peerdisc_peer *peer,	\
 			struct list_head *peers ) )
 
+extern void peerdisc_report ( struct interface *intf, const char *location,
+			      size_t len, unsigned long elapsed, int rc );
+#define peerdisc_report_TYPE( object_type )				\
+	typeof ( void ( object_type, const char *location, size_t len,	\
+			unsigned long elapsed, int rc ) )
+
+extern unsigned long peerdisc_rank ( struct interface *intf,
+				     const char *location );
+#define peerdisc_rank_TYPE( object_type )				\
+	typeof ( unsigned long ( object_type, const char *location ) )
+
 extern int peerdisc_open ( struct peerdisc_client *peerdisc, const void *id,
 			   size_t len );
 extern void peerdisc_close ( struct peerdisc_client *peerdisc );
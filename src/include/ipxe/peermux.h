@@ -19,7 +19,16 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/pccrc.h>
 
 /** Maximum number of concurrent block downloads */
-#define PEERMUX_MAX_BLOCKS 32
+#define PEERMUX_MAX_BLOCKS 64
+
+/** Initial number of concurrent block downloads */
+#define PEERMUX_INITIAL_BLOCKS 32
+
+/** Minimum number of concurrent block downloads */
+#define PEERMUX_MIN_BLOCKS 4
+
+/** Number of consecutive failures after which a peer is demoted */
+#define PEERMUX_DEMOTE_FAILURES 2
 
 /** PeerDist download content information cache */
 struct peerdist_info_cache {
@@ -41,6 +50,18 @@ struct peerdist_multiplexed_block {
 	struct interface xfer;
 };
 
+/** A PeerDist peer performance record */
+struct peerdist_peer {
+	/** List of peers */
+	struct list_head list;
+	/** Smoothed throughput (in bytes per second) */
+	unsigned long rate;
+	/** Number of consecutive failures */
+	unsigned int failures;
+	/** Peer location */
+	char location[0];
+};
+
 /** PeerDist statistics */
 struct peerdist_statistics {
 	/** Maximum observed number of peers */
@@ -73,8 +94,14 @@ struct peerdist_multiplexer {
 	struct list_head busy;
 	/** List of idle block downloads */
 	struct list_head idle;
+	/** Number of busy block downloads */
+	unsigned int count;
+	/** Maximum number of busy block downloads */
+	unsigned int window;
 	/** Block downloads */
 	struct peerdist_multiplexed_block block[PEERMUX_MAX_BLOCKS];
+	/** List of peer performance records */
+	struct list_head peers;
 
 	/** Statistics */
 	struct peerdist_statistics stats;
@@ -0,0 +1,56 @@
+#ifndef _IPXE_PEERSERV_H
+#define _IPXE_PEERSERV_H
+
+/** @file
+ *
+ * Peer Content Caching and Retrieval (PeerDist) protocol content server
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/list.h>
+#include <ipxe/pccrc.h>
+
+struct uri;
+struct image;
+
+/** PeerDist content server HTTP port */
+#define PEERSERV_PORT 80
+
+/** Maximum number of concurrent PeerDist content server connections */
+#define PEERSERV_MAX_CONNECTIONS 8
+
+/** Maximum length of a PeerDist content server HTTP request */
+#define PEERSERV_MAX_REQUEST 4096
+
+/** A served PeerDist segment */
+struct peerserv_segment {
+	/** Segment identifier */
+	uint8_t id[PEERDIST_DIGEST_MAX_SIZE];
+	/** First servable block index */
+	unsigned int first;
+	/** Number of servable blocks */
+	unsigned int count;
+};
+
+/** A served PeerDist content */
+struct peerserv_content {
+	/** List of served contents */
+	struct list_head list;
+	/** Original URI */
+	char *uri;
+	/** Image holding content (once identified) */
+	struct image *image;
+	/** Content information */
+	struct peerdist_info info;
+	/** Segments */
+	struct peerserv_segment *segment;
+};
+
+extern int peerserv_parse_headers ( char *data, size_t len, size_t *hdr_len,
+				    size_t *content_len );
+extern int peerserv_add ( struct uri *uri, const void *data, size_t len );
+
+#endif /* _IPXE_PEERSERV_H */
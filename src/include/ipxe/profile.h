@@ -11,6 +11,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <bits/profile.h>
 #include <ipxe/tables.h>
+#include <ipxe/list.h>
 
 #ifndef PROFILING
 #ifdef NDEBUG
@@ -20,6 +21,23 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #endif
 #endif
 
+/** Number of profiler histogram sub-buckets per power of two (log2) */
+#define PROFILE_SUB_BUCKETS_LOG2 3
+
+/** Number of profiler histogram sub-buckets per power of two */
+#define PROFILE_SUB_BUCKETS ( 1 << PROFILE_SUB_BUCKETS_LOG2 )
+
+/** Number of profiler histogram buckets
+ *
+ * Samples are assigned to log-linear buckets: each power-of-two
+ * range [2^N,2^(N+1)) is divided into PROFILE_SUB_BUCKETS equally
+ * sized buckets.  Samples smaller than ( 2 * PROFILE_SUB_BUCKETS )
+ * each have a bucket of their own.  The final bucket also holds all
+ * samples of 2^32 or larger.
+ */
+#define PROFILE_BUCKETS \
+	( ( 32 - PROFILE_SUB_BUCKETS_LOG2 + 1 ) * PROFILE_SUB_BUCKETS )
+
 /**
  * A data structure for storing profiling information
  */
@@ -48,6 +66,18 @@ struct profiler {
 	 * (i.e. one less than would be returned by flsll(raw_accvar)).
 	 */
 	unsigned int accvar_msb;
+	/** Minimum sample value */
+	unsigned long min;
+	/** Maximum sample value */
+	unsigned long max;
+	/** Sample histogram */
+	unsigned int hist[PROFILE_BUCKETS];
+	/** List of dynamically registered profilers
+	 *
+	 * This is used only by profilers that are not present in the
+	 * profiler table (e.g. per-device profilers).
+	 */
+	struct list_head list;
 };
 
 /** Profiler table */
@@ -63,11 +93,17 @@ struct profiler {
 unsigned long profile_timestamp ( void );
 
 extern unsigned long profile_excluded;
+extern struct list_head profilers;
 
 extern void profile_update ( struct profiler *profiler, unsigned long sample );
 extern unsigned long profile_mean ( struct profiler *profiler );
 extern unsigned long profile_variance ( struct profiler *profiler );
 extern unsigned long profile_stddev ( struct profiler *profiler );
+extern unsigned long profile_percentile ( struct profiler *profiler,
+					  unsigned int percent );
+extern int profile_format ( struct profiler *profiler, char *buf,
+			    size_t len );
+extern void profile_reset ( struct profiler *profiler );
 
 /**
  * Get start time
@@ -190,6 +226,32 @@ profile_exclude ( struct profiler *profiler ) {
 		profile_excluded += profile_elapsed ( profiler );
 }
 
+/**
+ * Register dynamically allocated profiler
+ *
+ * @v profiler		Profiler
+ */
+static inline __attribute__ (( always_inline )) void
+profile_register ( struct profiler *profiler ) {
+
+	/* If profiling is active then add to list of profilers */
+	if ( PROFILING )
+		list_add_tail ( &profiler->list, &profilers );
+}
+
+/**
+ * Unregister dynamically allocated profiler
+ *
+ * @v profiler		Profiler
+ */
+static inline __attribute__ (( always_inline )) void
+profile_unregister ( struct profiler *profiler ) {
+
+	/* If profiling is active then remove from list of profilers */
+	if ( PROFILING )
+		list_del ( &profiler->list );
+}
+
 /**
  * Record profiling sample in custom units
  *
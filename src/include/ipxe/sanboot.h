@@ -32,6 +32,20 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define SAN_DEFAULT_DRIVE 0x80
 
+/** SAN path statistics */
+struct san_path_stats {
+	/** Number of successfully completed commands */
+	unsigned int commands;
+	/** Number of failed commands */
+	unsigned int errors;
+	/** Number of outstanding commands */
+	unsigned int outstanding;
+	/** Total latency of successfully completed commands (in ticks) */
+	unsigned long ticks;
+	/** Maximum latency of successfully completed commands (in ticks) */
+	unsigned long max_ticks;
+};
+
 /** A SAN path */
 struct san_path {
 	/** Containing SAN device */
@@ -49,11 +63,49 @@ struct san_path {
 	struct process process;
 	/** Path status */
 	int path_rc;
+	/** Path statistics */
+	struct san_path_stats stats;
 
 	/** ACPI descriptor (if applicable) */
 	struct acpi_descriptor *desc;
 };
 
+/** Maximum number of concurrent SAN device read/write fragments */
+#define SAN_MAX_FRAGMENTS 8
+
+/** A SAN device read/write fragment */
+struct san_fragment {
+	/** Containing SAN device */
+	struct san_device *sandev;
+	/** SAN path used for command, or NULL if not in progress */
+	struct san_path *sanpath;
+	/** Command start time (in ticks) */
+	unsigned long started;
+	/** Command interface */
+	struct interface command;
+	/** Command timeout timer */
+	struct retry_timer timer;
+	/** Command status */
+	int rc;
+
+	/** Starting LBA (in underlying blocks) */
+	uint64_t lba;
+	/** Block count (in underlying blocks), or zero if idle */
+	unsigned int count;
+	/** Data buffer */
+	void *buffer;
+};
+
+/** SAN multipath policies */
+enum san_policy {
+	/** Use a single active path, failing over to other paths */
+	SAN_POLICY_FAILOVER = 0,
+	/** Distribute commands across all available paths in turn */
+	SAN_POLICY_ROUND_ROBIN,
+	/** Distribute commands to the path with fewest outstanding commands */
+	SAN_POLICY_LEAST_OUTSTANDING,
+};
+
 /** A SAN device */
 struct san_device {
 	/** Reference count */
@@ -72,6 +124,8 @@ struct san_device {
 	struct retry_timer timer;
 	/** Command status */
 	int command_rc;
+	/** Concurrent read/write fragments */
+	struct san_fragment frag[SAN_MAX_FRAGMENTS];
 
 	/** Raw block device capacity */
 	struct block_device_capacity capacity;
@@ -90,6 +144,10 @@ struct san_device {
 
 	/** Number of paths */
 	unsigned int paths;
+	/** Multipath policy */
+	unsigned int policy;
+	/** Next path index for round-robin distribution */
+	unsigned int next;
 	/** Current active path */
 	struct san_path *active;
 	/** List of opened SAN paths */
@@ -256,6 +314,7 @@ static inline int sandev_needs_reopen ( struct san_device *sandev ) {
 	return ( sandev->active == NULL );
 }
 
+extern const char * san_policy_name ( unsigned int policy );
 extern struct san_device * sandev_find ( unsigned int drive );
 extern struct san_device * sandev_next ( unsigned int drive );
 extern int sandev_reopen ( struct san_device *sandev );
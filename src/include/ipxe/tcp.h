@@ -11,6 +11,8 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <ipxe/list.h>
+#include <ipxe/interface.h>
 #include <ipxe/tcpip.h>
 
 /**
@@ -378,6 +380,18 @@ struct tcp_options {
 #define TCP_PATH_MTU							\
 	( 1280 - 40 /* IPv6 */ - 20 /* TCP */ - 12 /* TCP timestamp */ )
 
+/**
+ * Maximum length of a single transmission using segmentation offload
+ *
+ * If the transmitting network device is capable of segmentation
+ * offload, then we may construct a single packet containing many
+ * path-MTU-sized segments.  This reduces the per-segment overhead of
+ * bulk uploads, at the cost of retransmitting the whole packet in the
+ * event of a loss.  We choose a length that comfortably fits within
+ * the 16-bit IPv4 total length field.
+ */
+#define TCP_MAX_TSO_LEN ( 32 * TCP_PATH_MTU )
+
 /** TCP maximum segment lifetime
  *
  * Currently set to 2 minutes, as per RFC 793.
@@ -439,6 +453,34 @@ static inline int tcp_in_window ( uint32_t seq, uint32_t start,
  */
 #define TCP_FINISH_TIMEOUT ( 1 * TICKS_PER_SEC )
 
+/** A TCP listening port */
+struct tcp_listener {
+	/** List of listening ports */
+	struct list_head list;
+	/** Local port */
+	unsigned int port;
+	/** Maximum number of concurrently accepted connections */
+	unsigned int max;
+	/**
+	 * Accept incoming connection
+	 *
+	 * @v listener		TCP listening port
+	 * @v xfer		Data transfer interface for new connection
+	 * @v peer		Peer socket address
+	 * @ret rc		Return status code
+	 *
+	 * The listener should plug its own data transfer interface
+	 * into @c xfer in order to accept the connection.  If an
+	 * error is returned, the connection will be refused.
+	 */
+	int ( * accept ) ( struct tcp_listener *listener,
+			   struct interface *xfer,
+			   struct sockaddr_tcpip *peer );
+};
+
 extern struct tcpip_protocol tcp_protocol __tcpip_protocol;
 
+extern int tcp_listen ( struct tcp_listener *listener );
+extern void tcp_unlisten ( struct tcp_listener *listener );
+
 #endif /* _IPXE_TCP_H */
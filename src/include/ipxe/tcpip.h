@@ -196,6 +196,10 @@ extern int tcpip_tx ( struct io_buffer *iobuf, struct tcpip_protocol *tcpip,
 		      struct sockaddr_tcpip *st_dest,
 		      struct net_device *netdev,
 		      uint16_t *trans_csum );
+extern void tcpip_tx_chksum ( struct io_buffer *iobuf,
+			      struct tcpip_protocol *tcpip_protocol,
+			      struct net_device *netdev, uint16_t *trans_csum,
+			      uint16_t csum );
 extern struct tcpip_net_protocol * tcpip_net_protocol ( sa_family_t sa_family );
 extern struct net_device * tcpip_netdev ( struct sockaddr_tcpip *st_dest );
 extern size_t tcpip_mtu ( struct sockaddr_tcpip *st_dest );
@@ -0,0 +1,73 @@
+#ifndef _IPXE_TRACE_H
+#define _IPXE_TRACE_H
+
+/** @file
+ *
+ * Boot phase timeline tracing
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stddef.h>
+#include <config/general.h>
+
+#ifdef BOOT_TRACE
+#define TRACING 1
+#else
+#define TRACING 0
+#endif
+
+/** Number of trace events retained
+ *
+ * Older events are overwritten once the trace ring is full.  Must be
+ * a power of two.
+ */
+#define TRACE_EVENTS 128
+
+/** Trace upload timeout */
+#define TRACE_UPLOAD_TIMEOUT ( 5 * TICKS_PER_SEC )
+
+/** A trace event */
+struct trace_event {
+	/** Name */
+	const char *name;
+	/** System timer ticks */
+	unsigned long ticks;
+	/** Profiler timestamp */
+	unsigned long timestamp;
+	/** Status code */
+	int rc;
+};
+
+extern void trace_record ( const char *name, int rc );
+extern size_t trace_format ( char *buf, size_t len );
+extern void trace_export ( void );
+
+/**
+ * Record trace event
+ *
+ * @v name		Event name (must be a static string)
+ * @v rc		Status code
+ */
+static inline __attribute__ (( always_inline )) void
+trace ( const char *name, int rc ) {
+
+	/* Force dead code elimination in non-tracing builds */
+	if ( TRACING )
+		trace_record ( name, rc );
+}
+
+/**
+ * Export trace events
+ *
+ */
+static inline __attribute__ (( always_inline )) void
+trace_flush ( void ) {
+
+	/* Force dead code elimination in non-tracing builds */
+	if ( TRACING )
+		trace_export();
+}
+
+#endif /* _IPXE_TRACE_H */
@@ -19,6 +19,8 @@
 /* Virtio feature flags used to negotiate device and driver features. */
 /* Can the device handle any descriptor layout? */
 #define VIRTIO_F_ANY_LAYOUT             27
+/* Can the driver and device suppress notifications using event indices? */
+#define VIRTIO_RING_F_EVENT_IDX         29
 /* v1.0 compliant. */
 #define VIRTIO_F_VERSION_1              32
 #define VIRTIO_F_IOMMU_PLATFORM         33
@@ -69,9 +71,10 @@ struct vring {
 
 #define vring_size(num) \
    (((((sizeof(struct vring_desc) * num) + \
-      (sizeof(struct vring_avail) + sizeof(u16) * num)) \
+      (sizeof(struct vring_avail) + sizeof(u16) * (num + 1))) \
          + PAGE_MASK) & ~PAGE_MASK) + \
-         (sizeof(struct vring_used) + sizeof(struct vring_used_elem) * num))
+         (sizeof(struct vring_used) + sizeof(struct vring_used_elem) * num) + \
+         sizeof(u16))
 
 struct vring_virtqueue {
    unsigned char *queue;
@@ -81,6 +84,8 @@ struct vring_virtqueue {
    struct vring vring;
    u16 free_head;
    u16 last_used_idx;
+   /* Non-zero if VIRTIO_RING_F_EVENT_IDX has been negotiated */
+   int event_idx;
    void **vdata;
    struct virtio_net_hdr_modern *empty_header;
    /* PCI */
@@ -111,7 +116,7 @@ static inline void vring_init(struct vring *vr,
 
    /* physical address of used must be page aligned */
 
-   pa = virt_to_phys(&vr->avail->ring[num]);
+   pa = virt_to_phys(&vr->avail->ring[num + 1]);
    pa = (pa + PAGE_MASK) & ~PAGE_MASK;
    vr->used = phys_to_virt(pa);
 
@@ -120,14 +125,50 @@ static inline void vring_init(struct vring *vr,
    vr->desc[i].next = 0;
 }
 
+/*
+ * vring_used_event, vring_avail_event
+ *
+ * event indices following the avail and used rings
+ * (VIRTIO_RING_F_EVENT_IDX)
+ *
+ */
+
+static inline u16 *vring_used_event(struct vring *vr)
+{
+   return &vr->avail->ring[vr->num];
+}
+
+static inline u16 *vring_avail_event(struct vring *vr)
+{
+   return (u16 *)&vr->used->ring[vr->num];
+}
+
 static inline void vring_enable_cb(struct vring_virtqueue *vq)
 {
    vq->vring.avail->flags &= ~VRING_AVAIL_F_NO_INTERRUPT;
+   if (vq->event_idx)
+           *vring_used_event(&vq->vring) = vq->last_used_idx;
 }
 
 static inline void vring_disable_cb(struct vring_virtqueue *vq)
 {
    vq->vring.avail->flags |= VRING_AVAIL_F_NO_INTERRUPT;
+   /* place the used event index just behind the used ring */
+   if (vq->event_idx)
+           *vring_used_event(&vq->vring) = vq->last_used_idx - 1;
+}
+
+/*
+ * vring_need_event
+ *
+ * has the other side asked to be notified when the index moves
+ * from old_idx to new_idx ?
+ *
+ */
+
+static inline int vring_need_event(u16 event_idx, u16 new_idx, u16 old_idx)
+{
+   return (u16)(new_idx - event_idx - 1) < (u16)(new_idx - old_idx);
 }
 
 
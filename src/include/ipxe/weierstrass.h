@@ -82,6 +82,21 @@ enum weierstrass_multiple {
 	  1 /* fermat */ + 1 /* mont */ +				\
 	  WEIERSTRASS_NUM_MONT )
 
+/**
+ * Number of teeth in the fixed-base comb
+ *
+ * Multiplication of the generator point uses a precomputed comb
+ * table containing all 2^t combinations of the points
+ * (2^(i*d))G for 0<=i<t, where t is the number of teeth and d is
+ * the spacing between teeth (in bits).  This reduces the number of
+ * point additions required by around a factor of four compared to
+ * the Montgomery ladder, at the cost of storing 2^t points per curve.
+ */
+#define WEIERSTRASS_COMB_TEETH 4
+
+/** Number of entries in the fixed-base comb table */
+#define WEIERSTRASS_COMB_ENTRIES ( 1 << WEIERSTRASS_COMB_TEETH )
+
 /**
  * A Weierstrass elliptic curve
  *
@@ -102,6 +117,8 @@ struct weierstrass_curve {
 	const uint8_t *b_raw;
 	/** Base point */
 	const uint8_t *base;
+	/** Order of base point */
+	const uint8_t *order;
 
 	/** Cached field prime "N" (and multiples thereof) */
 	bigint_element_t *prime[WEIERSTRASS_NUM_CACHED];
@@ -121,16 +138,24 @@ struct weierstrass_curve {
 		};
 		bigint_element_t *mont[WEIERSTRASS_NUM_MONT];
 	};
+	/** Cached fixed-base comb table (in projective co-ordinates) */
+	bigint_element_t *comb;
 };
 
 extern int weierstrass_multiply ( struct weierstrass_curve *curve,
 				  const void *base, const void *scalar,
 				  void *result );
+extern int weierstrass_add_once ( struct weierstrass_curve *curve,
+				  const void *addend, const void *augend,
+				  void *result );
 
 /** Define a Weierstrass curve */
-#define WEIERSTRASS_CURVE( _name, _curve, _len, _prime, _a, _b, _base )	\
+#define WEIERSTRASS_CURVE( _name, _curve, _len, _prime, _a, _b, _base,	\
+			   _order )					\
 	static bigint_t ( weierstrass_size(_len) )			\
 		_name ## _cache[WEIERSTRASS_NUM_CACHED];		\
+	static bigint_t ( weierstrass_size(_len) * 3 )			\
+		_name ## _comb[WEIERSTRASS_COMB_ENTRIES];		\
 	static struct weierstrass_curve _name ## _weierstrass = {	\
 		.size = weierstrass_size(_len),				\
 		.name = #_name,						\
@@ -139,6 +164,7 @@ extern int weierstrass_multiply ( struct weierstrass_curve *curve,
 		.a_raw = (_a),						\
 		.b_raw = (_b),						\
 		.base = (_base),					\
+		.order = (_order),					\
 		.prime = {						\
 			(_name ## _cache)[0].element,			\
 			(_name ## _cache)[1].element,			\
@@ -149,6 +175,7 @@ extern int weierstrass_multiply ( struct weierstrass_curve *curve,
 		.one = (_name ## _cache)[5].element,			\
 		.a = (_name ## _cache)[6].element,			\
 		.b3 = (_name ## _cache)[7].element,			\
+		.comb = (_name ## _comb)[0].element,			\
 	};								\
 	static int _name ## _multiply ( const void *base,		\
 					const void *scalar,		\
@@ -156,11 +183,20 @@ extern int weierstrass_multiply ( struct weierstrass_curve *curve,
 		return weierstrass_multiply ( &_name ## _weierstrass,	\
 					      base, scalar, result );	\
 	}								\
+	static int _name ## _add ( const void *addend,			\
+				   const void *augend,			\
+				   void *result ) {			\
+		return weierstrass_add_once ( &_name ## _weierstrass,	\
+					      addend, augend, result );	\
+	}								\
 	struct elliptic_curve _curve = {				\
 		.name = #_name,						\
 		.pointsize = ( WEIERSTRASS_AXES * (_len) ),		\
 		.keysize = (_len),					\
+		.base = (_base),					\
+		.order = (_order),					\
 		.multiply = _name ## _multiply,				\
+		.add = _name ## _add,					\
 	}
 
 #endif /* _IPXE_WEIERSTRASS_H */
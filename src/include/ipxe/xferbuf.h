@@ -98,6 +98,7 @@ xferbuf_void_init ( struct xfer_buffer *xferbuf ) {
 
 extern void xferbuf_detach ( struct xfer_buffer *xferbuf );
 extern void xferbuf_free ( struct xfer_buffer *xferbuf );
+extern int xferbuf_ensure_size ( struct xfer_buffer *xferbuf, size_t len );
 extern int xferbuf_write ( struct xfer_buffer *xferbuf, size_t offset,
 			   const void *data, size_t len );
 extern int xferbuf_read ( struct xfer_buffer *xferbuf, size_t offset,
@@ -12,9 +12,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/image.h>
 
 extern int imgdownload ( struct uri *uri, unsigned long timeout,
-			 struct image **image );
+			 unsigned int flags, struct image **image );
 extern int imgdownload_string ( const char *uri_string, unsigned long timeout,
-				struct image **image );
+				unsigned int flags, struct image **image );
 extern int imgacquire ( const char *name, unsigned long timeout,
 			struct image **image );
 extern void imgstat ( struct image *image );
@@ -11,6 +11,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 extern int loopback_test ( struct net_device *sender,
 			   struct net_device *receiver,
-			   size_t mtu, int broadcast );
+			   size_t mtu, int broadcast, unsigned int count,
+			   unsigned int window, int fixed );
 
 #endif /* _USR_LOTEST_H */
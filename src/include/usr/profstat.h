@@ -9,6 +9,21 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
-extern void profstat ( void );
+/** Print statistics in machine-readable form */
+#define PROFSTAT_DUMP 0x0001
+
+/** Reset statistics after printing */
+#define PROFSTAT_RESET 0x0002
+
+extern void profstat_flags ( unsigned int flags );
+
+/**
+ * Print profiling statistics
+ *
+ */
+static inline void profstat ( void ) {
+
+	profstat_flags ( 0 );
+}
 
 #endif /* _USR_PROFSTAT_H */
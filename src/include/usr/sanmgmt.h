@@ -0,0 +1,16 @@
+#ifndef _USR_SANMGMT_H
+#define _USR_SANMGMT_H
+
+/** @file
+ *
+ * SAN device management
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/sanboot.h>
+
+extern void sanstat ( struct san_device *sandev );
+
+#endif /* _USR_SANMGMT_H */
@@ -94,6 +94,26 @@ struct efi_file {
 	size_t ( * read ) ( struct efi_file_reader *reader );
 };
 
+/** An EFI virtual file extent */
+struct efi_file_extent {
+	/** Offset within virtual file */
+	size_t offset;
+	/** Data, or NULL to zero-fill */
+	const void *data;
+	/** Length of data */
+	size_t len;
+};
+
+/** An EFI virtual file extent map */
+struct efi_file_map {
+	/** Extents (in order of offset) */
+	struct efi_file_extent *extents;
+	/** Number of extents */
+	unsigned int count;
+	/** Length of virtual file */
+	size_t len;
+};
+
 /** An EFI fixed device path file */
 struct efi_file_path {
 	/** EFI file */
@@ -107,6 +127,9 @@ struct efi_file_path {
 static struct efi_file efi_file_root;
 static struct efi_file_path efi_file_initrd;
 
+/** Magic initrd extent map */
+static struct efi_file_map efi_file_initrd_map;
+
 /**
  * Free EFI file
  *
@@ -232,24 +255,60 @@ static size_t efi_file_read_image ( struct efi_file_reader *reader ) {
 }
 
 /**
- * Read from magic initrd file
+ * Add extent to EFI virtual file extent map
  *
- * @v reader		EFI file reader
- * @ret len		Length read
+ * @v map		Extent map
+ * @v data		Data, or NULL to zero-fill
+ * @v len		Length of data
  */
-static size_t efi_file_read_initrd ( struct efi_file_reader *reader ) {
-	struct efi_file *file = reader->file;
-	struct cpio_header cpio;
+static void efi_file_map_add ( struct efi_file_map *map, const void *data,
+			       size_t len ) {
+	struct efi_file_extent *extent;
+
+	/* Ignore empty extents */
+	if ( ! len )
+		return;
+
+	/* Record extent, if applicable */
+	if ( map->extents ) {
+		extent = &map->extents[map->count];
+		extent->offset = map->len;
+		extent->data = data;
+		extent->len = len;
+	}
+
+	/* Consume extent */
+	map->count++;
+	map->len += len;
+}
+
+/**
+ * Construct magic initrd extent map
+ *
+ * @v map		Extent map to fill in
+ * @v cpio		CPIO header storage, or NULL
+ * @ret count		Number of CPIO headers
+ *
+ * If the extent map has no extent storage, then only the number of
+ * extents, the length, and the number of CPIO headers will be
+ * calculated.
+ */
+static unsigned int efi_file_initrd_extents ( struct efi_file_map *map,
+					      struct cpio_header *cpio ) {
+	struct cpio_header tmp;
+	struct cpio_header *header;
 	struct image *image;
 	const char *name;
 	size_t pad_len;
 	size_t cpio_len;
 	size_t name_len;
-	size_t len;
+	unsigned int count;
 	unsigned int i;
 
-	/* Read from file */
-	len = 0;
+	/* Construct extents */
+	map->count = 0;
+	map->len = 0;
+	count = 0;
 	for_each_image ( image ) {
 
 		/* Skip hidden images */
@@ -257,37 +316,139 @@ static size_t efi_file_read_initrd ( struct efi_file_reader *reader ) {
 			continue;
 
 		/* Pad to alignment boundary */
-		pad_len = ( ( -reader->pos ) & ( INITRD_ALIGN - 1 ) );
-		if ( pad_len ) {
-			DBGC ( file, "EFIFILE %s [%#08zx,%#08zx) pad\n",
-			       efi_file_name ( file ), reader->pos,
-			       ( reader->pos + pad_len ) );
-		}
-		len += efi_file_read_chunk ( reader, NULL, pad_len );
+		pad_len = ( ( -map->len ) & ( INITRD_ALIGN - 1 ) );
+		efi_file_map_add ( map, NULL, pad_len );
 
-		/* Read CPIO header(s), if applicable */
+		/* Add CPIO header(s), if applicable */
 		name = cpio_name ( image );
-		for ( i = 0 ; ( cpio_len = cpio_header ( image, i, &cpio ) );
-		      i++ ) {
-			name_len = ( cpio_len - sizeof ( cpio ) );
+		for ( i = 0 ; ; i++ ) {
+			header = ( cpio ? &cpio[count] : &tmp );
+			cpio_len = cpio_header ( image, i, header );
+			if ( ! cpio_len )
+				break;
+			name_len = ( cpio_len - sizeof ( *header ) );
 			pad_len = cpio_pad_len ( cpio_len );
-			DBGC ( file, "EFIFILE %s [%#08zx,%#08zx) %s header\n",
-			       efi_file_name ( file ), reader->pos,
-			       ( reader->pos + cpio_len + pad_len ),
-			       image->name );
-			len += efi_file_read_chunk ( reader, &cpio,
-						     sizeof ( cpio ) );
-			len += efi_file_read_chunk ( reader, name, name_len );
-			len += efi_file_read_chunk ( reader, NULL, pad_len );
+			efi_file_map_add ( map, header, sizeof ( *header ) );
+			efi_file_map_add ( map, name, name_len );
+			efi_file_map_add ( map, NULL, pad_len );
+			count++;
+		}
+
+		/* Add file data */
+		efi_file_map_add ( map, image->data, image->len );
+	}
+
+	return count;
+}
+
+/**
+ * Free magic initrd extent map
+ *
+ */
+static void efi_file_initrd_unmap ( void ) {
+	struct efi_file_map *map = &efi_file_initrd_map;
+
+	free ( map->extents );
+	memset ( map, 0, sizeof ( *map ) );
+}
+
+/**
+ * (Re)construct magic initrd extent map
+ *
+ * @ret rc		Return status code
+ *
+ * The CPIO headers are constructed once, so that each read from the
+ * magic initrd file requires only a search of the extent map.
+ */
+static int efi_file_initrd_remap ( void ) {
+	struct efi_file_map *map = &efi_file_initrd_map;
+	struct efi_file *file = &efi_file_initrd.file;
+	struct efi_file_extent *extent;
+	struct cpio_header *cpio;
+	unsigned int count;
+	unsigned int i;
+
+	/* Free any existing extent map */
+	efi_file_initrd_unmap();
+
+	/* Calculate map size */
+	count = efi_file_initrd_extents ( map, NULL );
+	if ( ! map->count )
+		return 0;
+
+	/* Allocate and construct map */
+	map->extents = malloc ( ( map->count * sizeof ( map->extents[0] ) ) +
+				( count * sizeof ( *cpio ) ) );
+	if ( ! map->extents ) {
+		efi_file_initrd_unmap();
+		return -ENOMEM;
+	}
+	cpio = ( ( void * ) &map->extents[map->count] );
+	efi_file_initrd_extents ( map, cpio );
+
+	/* Dump map */
+	DBGC ( file, "EFIFILE %s mapped %d extents (%#zx bytes)\n",
+	       efi_file_name ( file ), map->count, map->len );
+	for ( i = 0 ; i < map->count ; i++ ) {
+		extent = &map->extents[i];
+		DBGC2 ( file, "EFIFILE %s [%#08zx,%#08zx) %s\n",
+			efi_file_name ( file ), extent->offset,
+			( extent->offset + extent->len ),
+			( extent->data ? "data" : "pad" ) );
+	}
+
+	return 0;
+}
+
+/**
+ * Read from magic initrd file
+ *
+ * @v reader		EFI file reader
+ * @ret len		Length read
+ */
+static size_t efi_file_read_initrd ( struct efi_file_reader *reader ) {
+	struct efi_file *file = reader->file;
+	struct efi_file_map *map = &efi_file_initrd_map;
+	struct efi_file_extent *extent;
+	unsigned int min;
+	unsigned int max;
+	unsigned int mid;
+	size_t len;
+	int rc;
+
+	/* Construct extent map, if not already constructed */
+	if ( ( ! map->extents ) &&
+	     ( ( rc = efi_file_initrd_remap() ) != 0 ) ) {
+		DBGC ( file, "EFIFILE %s could not map: %s\n",
+		       efi_file_name ( file ), strerror ( rc ) );
+		return 0;
+	}
+
+	/* Find first extent containing the current file position */
+	min = 0;
+	max = map->count;
+	while ( min < max ) {
+		mid = ( ( min + max ) / 2 );
+		extent = &map->extents[mid];
+		if ( ( extent->offset + extent->len ) <= file->pos ) {
+			min = ( mid + 1 );
+		} else {
+			max = mid;
 		}
+	}
 
-		/* Read file data */
-		DBGC ( file, "EFIFILE %s [%#08zx,%#08zx) %s\n",
-		       efi_file_name ( file ), reader->pos,
-		       ( reader->pos + image->len ), image->name );
-		len += efi_file_read_chunk ( reader, image->data, image->len );
+	/* Read from extents */
+	len = 0;
+	for ( ; ( min < map->count ) && reader->len ; min++ ) {
+		extent = &map->extents[min];
+		reader->pos = extent->offset;
+		len += efi_file_read_chunk ( reader, extent->data,
+					     extent->len );
 	}
 
+	/* Consume remainder of file */
+	reader->pos = map->len;
+
 	return len;
 }
 
@@ -375,6 +536,7 @@ efi_file_open ( EFI_FILE_PROTOCOL *this, EFI_FILE_PROTOCOL **new,
 	struct image *image;
 	char *name;
 	char *sep;
+	int rc;
 
 	/* Convert name to ASCII */
 	snprintf ( buf, sizeof ( buf ), "%ls", wname );
@@ -414,6 +576,8 @@ efi_file_open ( EFI_FILE_PROTOCOL *this, EFI_FILE_PROTOCOL **new,
 
 	/* Allow magic initrd to be opened */
 	if ( strcasecmp ( name, efi_file_initrd.file.name ) == 0 ) {
+		if ( ( rc = efi_file_initrd_remap() ) != 0 )
+			return EFIRC ( rc );
 		return efi_file_open_fixed ( &efi_file_initrd.file, wname,
 					     new );
 	}
@@ -765,12 +929,18 @@ efi_file_load ( EFI_LOAD_FILE2_PROTOCOL *this,
 	size_t max_len;
 	size_t file_len;
 	EFI_STATUS efirc;
+	int rc;
 
 	/* Calculate maximum length */
 	max_len = ( data ? *len : 0 );
 	DBGC ( file, "EFIFILE %s load at %p+%#zx\n",
 	       efi_file_name ( file ), data, max_len );
 
+	/* Remap magic initrd, if applicable */
+	if ( ( file == &efi_file_initrd.file ) &&
+	     ( ( rc = efi_file_initrd_remap() ) != 0 ) )
+		return EFIRC ( rc );
+
 	/* Check buffer size */
 	file_len = efi_file_len ( file );
 	if ( file_len > max_len ) {
@@ -1215,6 +1385,7 @@ void efi_file_uninstall ( EFI_HANDLE handle ) {
 
 	/* Uninstall Linux initrd fixed device path file */
 	efi_file_path_uninstall ( &efi_file_initrd );
+	efi_file_initrd_unmap();
 
 	/* Close our own disk I/O protocol */
 	efi_close_by_driver ( handle, &efi_disk_io_protocol_guid );
@@ -31,6 +31,7 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <netinet/in.h>
@@ -163,6 +164,34 @@ ssize_t __asmcall linux_write ( int fd, const void *buf, size_t count ) {
 	return ret;
 }
 
+/**
+ * Wrap readv()
+ *
+ */
+ssize_t __asmcall linux_readv ( int fd, const struct iovec *iov,
+				int iovcnt ) {
+	ssize_t ret;
+
+	ret = readv ( fd, iov, iovcnt );
+	if ( ret == -1 )
+		linux_errno = errno;
+	return ret;
+}
+
+/**
+ * Wrap writev()
+ *
+ */
+ssize_t __asmcall linux_writev ( int fd, const struct iovec *iov,
+				 int iovcnt ) {
+	ssize_t ret;
+
+	ret = writev ( fd, iov, iovcnt );
+	if ( ret == -1 )
+		linux_errno = errno;
+	return ret;
+}
+
 /**
  * Wrap fcntl()
  *
@@ -341,6 +370,20 @@ int __asmcall linux_bind ( int sockfd, const struct sockaddr *addr,
 	return ret;
 }
 
+/**
+ * Wrap setsockopt()
+ *
+ */
+int __asmcall linux_setsockopt ( int sockfd, int level, int optname,
+				 const void *optval, size_t optlen ) {
+	int ret;
+
+	ret = setsockopt ( sockfd, level, optname, optval, optlen );
+	if ( ret == -1 )
+		linux_errno = errno;
+	return ret;
+}
+
 /**
  * Wrap sendto()
  *
@@ -502,6 +545,8 @@ PROVIDE_IPXE_SYM ( linux_close );
 PROVIDE_IPXE_SYM ( linux_lseek );
 PROVIDE_IPXE_SYM ( linux_read );
 PROVIDE_IPXE_SYM ( linux_write );
+PROVIDE_IPXE_SYM ( linux_readv );
+PROVIDE_IPXE_SYM ( linux_writev );
 PROVIDE_IPXE_SYM ( linux_fcntl );
 PROVIDE_IPXE_SYM ( linux_ioctl );
 PROVIDE_IPXE_SYM ( linux_fstat_size );
@@ -514,6 +559,7 @@ PROVIDE_IPXE_SYM ( linux_mremap );
 PROVIDE_IPXE_SYM ( linux_munmap );
 PROVIDE_IPXE_SYM ( linux_socket );
 PROVIDE_IPXE_SYM ( linux_bind );
+PROVIDE_IPXE_SYM ( linux_setsockopt );
 PROVIDE_IPXE_SYM ( linux_sendto );
 PROVIDE_IPXE_SYM ( linux_strerror );
 
@@ -30,6 +30,77 @@ FILE_LICENCE ( GPL2_OR_LATER );
  * Frontend for WPA using a pre-shared key.
  */
 
+/** A cached WPA-PSK Pairwise Master Key */
+struct wpa_psk_cache {
+	/** Digest of ESSID and passphrase */
+	u8 id[SHA1_DIGEST_SIZE];
+	/** Pairwise Master Key derived from passphrase and ESSID */
+	u8 pmk[WPA_PMK_LEN];
+	/** Cache entry is valid */
+	int valid;
+};
+
+/** Most recently derived Pairwise Master Key
+ *
+ * Deriving the PMK requires 8192 iterations of HMAC-SHA1, which is
+ * slow enough to be noticeable on some platforms.  The PMK depends
+ * only upon the ESSID and the passphrase, so we retain the most
+ * recently derived PMK to allow reassociation to the same network to
+ * skip the derivation.  The cache is keyed on a digest of the ESSID
+ * and passphrase, so that the passphrase itself is not retained.
+ */
+static struct wpa_psk_cache wpa_psk_cache;
+
+/**
+ * Calculate WPA-PSK cache identifier
+ *
+ * @v essid	ESSID
+ * @v passphrase	Passphrase
+ * @ret id	Digest of ESSID and passphrase
+ */
+static void wpa_psk_id ( const char *essid, const char *passphrase, u8 *id )
+{
+	u8 ctx[SHA1_CTX_SIZE];
+
+	digest_init ( &sha1_algorithm, ctx );
+	digest_update ( &sha1_algorithm, ctx, essid, ( strlen ( essid ) + 1 ) );
+	digest_update ( &sha1_algorithm, ctx, passphrase,
+			strlen ( passphrase ) );
+	digest_final ( &sha1_algorithm, ctx, id );
+	memset ( ctx, 0, sizeof ( ctx ) );
+}
+
+/**
+ * Derive Pairwise Master Key from passphrase
+ *
+ * @v essid	ESSID
+ * @v passphrase	Passphrase
+ * @ret pmk	Pairwise Master Key
+ */
+static void wpa_psk_derive ( const char *essid, const char *passphrase,
+			     u8 *pmk )
+{
+	struct wpa_psk_cache *cache = &wpa_psk_cache;
+	u8 id[SHA1_DIGEST_SIZE];
+
+	/* Use cached PMK if ESSID and passphrase match */
+	wpa_psk_id ( essid, passphrase, id );
+	if ( cache->valid && ( memcmp ( cache->id, id, sizeof ( id ) ) == 0 )){
+		DBGC ( cache, "WPA-PSK using cached PMK for `%s'\n", essid );
+		memcpy ( pmk, cache->pmk, WPA_PMK_LEN );
+		return;
+	}
+
+	/* Derive PMK */
+	pbkdf2_sha1 ( passphrase, strlen ( passphrase ), essid,
+		      strlen ( essid ), 4096, pmk, WPA_PMK_LEN );
+
+	/* Record in cache */
+	memcpy ( cache->id, id, sizeof ( cache->id ) );
+	memcpy ( cache->pmk, pmk, WPA_PMK_LEN );
+	cache->valid = 1;
+}
+
 /**
  * Initialise WPA-PSK state
  *
@@ -64,8 +135,7 @@ static int wpa_psk_start ( struct net80211_device *dev )
 		return -EACCES;
 	}
 
-	pbkdf2_sha1 ( passphrase, len, dev->essid, strlen ( dev->essid ),
-		      4096, pmk, WPA_PMK_LEN );
+	wpa_psk_derive ( dev->essid, passphrase, pmk );
 
 	DBGC ( ctx, "WPA-PSK %p: derived PMK from passphrase `%s':\n", ctx,
 	       passphrase );
@@ -95,13 +165,36 @@ static int wpa_psk_step ( struct net80211_device *dev )
 }
 
 /**
- * Do-nothing function; you can't change a WPA key post-authentication
+ * Handle change of key setting
  *
  * @v dev	802.11 device
  * @ret rc	Return status code
+ *
+ * You can't change a WPA key post-authentication, but any cached PMK
+ * that no longer matches the key setting is erased.
  */
-static int wpa_psk_no_change_key ( struct net80211_device *dev __unused )
+static int wpa_psk_change_key ( struct net80211_device *dev )
 {
+	struct wpa_psk_cache *cache = &wpa_psk_cache;
+	char passphrase[64+1];
+	u8 id[SHA1_DIGEST_SIZE];
+
+	/* Do nothing unless a PMK is cached */
+	if ( ! cache->valid )
+		return 0;
+
+	/* Erase cached PMK if ESSID or passphrase no longer match */
+	memset ( passphrase, 0, sizeof ( passphrase ) );
+	fetch_string_setting ( netdev_settings ( dev->netdev ),
+			       &net80211_key_setting, passphrase,
+			       sizeof ( passphrase ) );
+	wpa_psk_id ( dev->essid, passphrase, id );
+	if ( memcmp ( cache->id, id, sizeof ( id ) ) != 0 ) {
+		DBGC ( cache, "WPA-PSK erasing cached PMK\n" );
+		memset ( cache, 0, sizeof ( *cache ) );
+	}
+	memset ( passphrase, 0, sizeof ( passphrase ) );
+
 	return 0;
 }
 
@@ -121,7 +214,7 @@ struct net80211_handshaker wpa_psk_handshaker __net80211_handshaker = {
 	.init = wpa_psk_init,
 	.start = wpa_psk_start,
 	.step = wpa_psk_step,
-	.change_key = wpa_psk_no_change_key,
+	.change_key = wpa_psk_change_key,
 	.stop = wpa_psk_stop,
 	.priv_len = sizeof ( struct wpa_common_ctx ),
 };
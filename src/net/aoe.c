@@ -40,6 +40,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/uri.h>
 #include <ipxe/open.h>
 #include <ipxe/ata.h>
+#include <ipxe/blockdev.h>
+#include <ipxe/settings.h>
 #include <ipxe/device.h>
 #include <ipxe/efi/efi_path.h>
 #include <ipxe/aoe.h>
@@ -55,6 +57,14 @@ FEATURE ( FEATURE_PROTOCOL, "AoE", DHCP_EB_FEATURE_AOE, 1 );
 struct net_protocol aoe_protocol __net_protocol;
 struct acpi_model abft_model __acpi_model;
 
+/** The "aoe-window" setting */
+const struct setting aoe_window_setting __setting ( SETTING_SANBOOT_EXTRA,
+						    aoe-window ) = {
+	.name = "aoe-window",
+	.description = "AoE concurrent command limit",
+	.type = &setting_type_uint16,
+};
+
 /******************************************************************************
  *
  * AoE devices and commands
@@ -89,6 +99,8 @@ struct aoe_command {
 
 	/** Retransmission timer */
 	struct retry_timer timer;
+	/** Number of retransmissions */
+	unsigned int retransmissions;
 };
 
 /** An AoE command type */
@@ -219,6 +231,9 @@ static void aoecmd_close ( struct aoe_command *aoecmd, int rc ) {
 
 	/* Shut down interfaces */
 	intf_shutdown ( &aoecmd->ata, rc );
+
+	/* Notify device that a command slot may have become free */
+	xfer_window_changed ( &aoedev->ata );
 }
 
 /**
@@ -318,6 +333,10 @@ static int aoecmd_rx ( struct aoe_command *aoecmd, struct io_buffer *iobuf,
 					ll_source ) ) != 0 )
 		goto done;
 
+	/* Reopen concurrency window following a successful response */
+	if ( aoedev->window < aoedev->max_window )
+		aoedev->window++;
+
  done:
 	/* Free I/O buffer */
 	free_iob ( iobuf );
@@ -337,12 +356,30 @@ static int aoecmd_rx ( struct aoe_command *aoecmd, struct io_buffer *iobuf,
 static void aoecmd_expired ( struct retry_timer *timer, int fail ) {
 	struct aoe_command *aoecmd =
 		container_of ( timer, struct aoe_command, timer );
+	struct aoe_device *aoedev = aoecmd->aoedev;
 
+	/* Fail command if retransmission timer has given up */
 	if ( fail ) {
+		DBGC ( aoedev, "AoE %s/%08x timed out after %d "
+		       "retransmissions\n", aoedev_name ( aoedev ),
+		       aoecmd->tag, aoecmd->retransmissions );
 		aoecmd_close ( aoecmd, -ETIMEDOUT );
-	} else {
-		aoecmd_tx ( aoecmd );
+		return;
 	}
+
+	/* Treat a lost request or response as a sign of congestion,
+	 * and halve the number of concurrent commands permitted.
+	 * Other outstanding commands are unaffected, and will be
+	 * retransmitted only if their own timers expire.
+	 */
+	aoecmd->retransmissions++;
+	aoedev->window = ( ( aoedev->window + 1 ) / 2 );
+	DBGC ( aoedev, "AoE %s/%08x retransmitting (attempt %d, window "
+	       "%d)\n", aoedev_name ( aoedev ), aoecmd->tag,
+	       aoecmd->retransmissions, aoedev->window );
+
+	/* Retransmit command */
+	aoecmd_tx ( aoecmd );
 }
 
 /**
@@ -511,6 +548,7 @@ static int aoecmd_cfg_rsp ( struct aoe_command *aoecmd, const void *data,
 	struct ll_protocol *ll_protocol = aoedev->netdev->ll_protocol;
 	const struct aoehdr *aoehdr = data;
 	const struct aoecfg *aoecfg = &aoehdr->payload[0].cfg;
+	unsigned int bufcnt;
 
 	/* Sanity check */
 	if ( len < ( sizeof ( *aoehdr ) + sizeof ( *aoecfg ) ) ) {
@@ -523,6 +561,19 @@ static int aoecmd_cfg_rsp ( struct aoe_command *aoecmd, const void *data,
 	       aoedev_name ( aoedev ), aoecmd->tag, ntohs ( aoecfg->bufcnt ),
 	       aoecfg->fwver, aoecfg->scnt );
 
+	/* Limit sectors per command to the target's maximum */
+	if ( aoecfg->scnt && ( aoecfg->scnt < aoedev->max_count ) )
+		aoedev->max_count = aoecfg->scnt;
+
+	/* Limit concurrent commands to the target's queue depth */
+	bufcnt = ntohs ( aoecfg->bufcnt );
+	if ( bufcnt && ( bufcnt < aoedev->max_window ) )
+		aoedev->max_window = bufcnt;
+	aoedev->window = aoedev->max_window;
+	DBGC ( aoedev, "AoE %s using up to %d sectors per command and up to "
+	       "%d concurrent commands\n", aoedev_name ( aoedev ),
+	       aoedev->max_count, aoedev->max_window );
+
 	/* Record target MAC address */
 	memcpy ( aoedev->target, ll_source, ll_protocol->ll_addr_len );
 	DBGC ( aoedev, "AoE %s has MAC address %s\n",
@@ -725,9 +776,42 @@ static void aoedev_close ( struct aoe_device *aoedev, int rc ) {
  *
  * @v aoedev		AoE device
  * @ret len		Length of window
+ *
+ * The window is open only while the device is configured and has
+ * fewer than the permitted number of ATA commands outstanding.
  */
 static size_t aoedev_window ( struct aoe_device *aoedev ) {
-	return ( aoedev->configured ? ~( ( size_t ) 0 ) : 0 );
+	struct aoe_command *aoecmd;
+	unsigned int outstanding = 0;
+
+	/* Wait until device is configured */
+	if ( ! aoedev->configured )
+		return 0;
+
+	/* Count outstanding ATA commands */
+	list_for_each_entry ( aoecmd, &aoe_commands, list ) {
+		if ( ( aoecmd->aoedev == aoedev ) &&
+		     ( aoecmd->type == &aoecmd_ata ) )
+			outstanding++;
+	}
+	if ( outstanding >= aoedev->window )
+		return 0;
+
+	return ~( ( size_t ) 0 );
+}
+
+/**
+ * Update AoE device capacity
+ *
+ * @v aoedev		AoE device
+ * @v capacity		Block device capacity
+ */
+static void aoedev_capacity ( struct aoe_device *aoedev,
+			      struct block_device_capacity *capacity ) {
+
+	/* Limit maximum number of blocks per transfer */
+	if ( aoedev->max_count < capacity->max_count )
+		capacity->max_count = aoedev->max_count;
 }
 
 /**
@@ -776,6 +860,7 @@ static struct acpi_descriptor * aoedev_describe ( struct aoe_device *aoedev ) {
 static struct interface_operation aoedev_ata_op[] = {
 	INTF_OP ( ata_command, struct aoe_device *, aoedev_ata_command ),
 	INTF_OP ( xfer_window, struct aoe_device *, aoedev_window ),
+	INTF_OP ( block_capacity, struct aoe_device *, aoedev_capacity ),
 	INTF_OP ( intf_close, struct aoe_device *, aoedev_close ),
 	INTF_OP ( acpi_describe, struct aoe_device *, aoedev_describe ),
 	INTF_OP ( identify_device, struct aoe_device *,
@@ -808,6 +893,8 @@ static struct interface_descriptor aoedev_config_desc =
 static int aoedev_open ( struct interface *parent, struct net_device *netdev,
 			 unsigned int major, unsigned int minor ) {
 	struct aoe_device *aoedev;
+	unsigned long window;
+	size_t max_len;
 	int rc;
 
 	/* Allocate and initialise structure */
@@ -826,6 +913,25 @@ static int aoedev_open ( struct interface *parent, struct net_device *netdev,
 		 netdev->ll_protocol->ll_addr_len );
 	acpi_init ( &aoedev->desc, &abft_model, &aoedev->refcnt );
 
+	/* Use as many sectors per command as will fit within the
+	 * network device's MTU (which may include jumbo frames).
+	 */
+	max_len = ( sizeof ( struct aoehdr ) + sizeof ( struct aoeata ) );
+	max_len = ( ( netdev->mtu > max_len ) ? ( netdev->mtu - max_len ) : 0 );
+	aoedev->max_count = ( max_len / ATA_SECTOR_SIZE );
+	if ( aoedev->max_count > AOE_MAX_COUNT )
+		aoedev->max_count = AOE_MAX_COUNT;
+	if ( ! aoedev->max_count )
+		aoedev->max_count = 1;
+
+	/* Limit number of concurrent ATA commands */
+	if ( ( fetch_uint_setting ( NULL, &aoe_window_setting,
+				    &window ) < 0 ) || ( ! window ) ) {
+		window = AOE_DEFAULT_WINDOW;
+	}
+	aoedev->max_window = window;
+	aoedev->window = window;
+
 	/* Initiate configuration */
 	if ( ( rc = aoedev_cfg_command ( aoedev, &aoedev->config ) ) < 0 ) {
 		DBGC ( aoedev, "AoE %s could not initiate configuration: %s\n",
@@ -835,7 +941,7 @@ static int aoedev_open ( struct interface *parent, struct net_device *netdev,
 
 	/* Attach ATA device to parent interface */
 	if ( ( rc = ata_open ( parent, &aoedev->ata, ATA_DEV_MASTER,
-			       AOE_MAX_COUNT ) ) != 0 ) {
+			       aoedev->max_count ) ) != 0 ) {
 		DBGC ( aoedev, "AoE %s could not create ATA device: %s\n",
 		       aoedev_name ( aoedev ), strerror ( rc ) );
 		goto err_ata_open;
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Software segmentation offload
+ *
+ * Packets constructed with a payload exceeding the path MTU (see
+ * iob_gso_defer()) are split into individual segments here, if the
+ * transmitting network device is not capable of performing the
+ * segmentation itself.  Each segment is constructed by duplicating
+ * the template headers and then fixing up the lengths, sequence
+ * number, flags, and checksums.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/tcp.h>
+#include <ipxe/ip.h>
+#include <ipxe/ipv6.h>
+
+/**
+ * Construct segment
+ *
+ * @v netdev		Network device
+ * @v iobuf		I/O buffer requiring segmentation
+ * @v hdr_len		Length of template headers
+ * @v offset		Offset of segment payload within I/O buffer
+ * @v len		Length of segment payload
+ * @v index		Segment index
+ * @ret segment		Segment, or NULL on error
+ */
+static struct io_buffer * gso_segment ( struct net_device *netdev,
+					struct io_buffer *iobuf,
+					size_t hdr_len, size_t offset,
+					size_t len, unsigned int index ) {
+	struct tcp_header *tcphdr = iobuf->csum_start;
+	size_t net_offset = ( iobuf->gso_start - iobuf->data );
+	size_t trans_offset = ( iobuf->csum_start - iobuf->data );
+	struct io_buffer *segment;
+	struct tcp_header *seghdr;
+	struct iphdr *iphdr;
+	struct ipv6_header *ip6hdr;
+	size_t trans_len;
+	uint16_t lens[2];
+	uint16_t csum;
+
+	/* Allocate and populate segment */
+	segment = alloc_iob ( hdr_len + len );
+	if ( ! segment )
+		return NULL;
+	memcpy ( iob_put ( segment, hdr_len ), iobuf->data, hdr_len );
+	memcpy ( iob_put ( segment, len ), ( iobuf->data + offset ), len );
+	trans_len = ( iob_len ( segment ) - trans_offset );
+
+	/* Fix up network-layer header */
+	if ( iobuf->gso == IOB_GSO_TCPV4 ) {
+		iphdr = ( segment->data + net_offset );
+		iphdr->len = htons ( iob_len ( segment ) - net_offset );
+
+		/* ipv4_tx() increments only the high byte of the
+		 * identifier for each datagram, using the low byte to
+		 * carry network device statistics.  Advance the high
+		 * byte for each segment so that every segment carries
+		 * a distinct identifier while preserving the low byte.
+		 */
+		iphdr->ident = htons ( ntohs ( iphdr->ident ) + ( index << 8 ) );
+		iphdr->chksum = 0;
+		iphdr->chksum = tcpip_chksum ( iphdr, ( ( iphdr->verhdrlen &
+							  IP_MASK_HLEN ) * 4 ) );
+	} else {
+		ip6hdr = ( segment->data + net_offset );
+		ip6hdr->len = htons ( iob_len ( segment ) - net_offset -
+				      sizeof ( *ip6hdr ) );
+	}
+
+	/* Fix up transport-layer header.  FIN and PSH apply only to
+	 * the final segment.
+	 */
+	seghdr = ( segment->data + trans_offset );
+	seghdr->seq = htonl ( ntohl ( tcphdr->seq ) + ( offset - hdr_len ) );
+	if ( ( offset + len ) < iob_len ( iobuf ) )
+		seghdr->flags &= ~( TCP_FIN | TCP_PSH );
+
+	/* Adjust pseudo-header checksum for segment length */
+	lens[0] = ~htons ( iob_len ( iobuf ) - trans_offset );
+	lens[1] = htons ( trans_len );
+	csum = tcpip_continue_chksum ( ~tcphdr->csum, lens, sizeof ( lens ) );
+
+	/* Complete checksum, unless network device will do so */
+	if ( netdev_tx_csum ( netdev ) ) {
+		seghdr->csum = ~csum;
+		segment->csum = IOB_CSUM_PARTIAL;
+		segment->csum_start = seghdr;
+		segment->csum_offset = iobuf->csum_offset;
+	} else {
+		seghdr->csum = 0;
+		seghdr->csum = tcpip_continue_chksum ( csum, seghdr,
+						       trans_len );
+	}
+
+	return segment;
+}
+
+/**
+ * Transmit packet requiring segmentation
+ *
+ * @v netdev		Network device
+ * @v iobuf		I/O buffer
+ * @ret rc		Return status code
+ *
+ * This function takes ownership of the I/O buffer.
+ */
+int netdev_tx_gso ( struct net_device *netdev, struct io_buffer *iobuf ) {
+	struct tcp_header *tcphdr = iobuf->csum_start;
+	struct io_buffer *segment;
+	unsigned int index = 0;
+	size_t hdr_len;
+	size_t offset;
+	size_t len;
+	int rc;
+
+	/* Sanity checks */
+	assert ( iobuf->csum == IOB_CSUM_PARTIAL );
+	assert ( iobuf->gso_size != 0 );
+
+	/* Calculate length of template headers */
+	hdr_len = ( ( iobuf->csum_start - iobuf->data ) +
+		    ( ( tcphdr->hlen & 0xf0 ) >> 2 ) );
+	DBGC2 ( netdev, "NETDEV %s segmenting %p (%p+%zx) at %zd bytes\n",
+		netdev->name, iobuf, iobuf->data, iob_len ( iobuf ),
+		iobuf->gso_size );
+
+	/* Construct and transmit each segment */
+	for ( offset = hdr_len ; offset < iob_len ( iobuf ) ;
+	      offset += len, index++ ) {
+
+		/* Construct segment */
+		len = ( iob_len ( iobuf ) - offset );
+		if ( len > iobuf->gso_size )
+			len = iobuf->gso_size;
+		segment = gso_segment ( netdev, iobuf, hdr_len, offset, len,
+					index );
+		if ( ! segment ) {
+			rc = -ENOMEM;
+			netdev_tx_err ( netdev, iobuf, rc );
+			return rc;
+		}
+
+		/* Transmit segment */
+		if ( ( rc = netdev_tx ( netdev, segment ) ) != 0 ) {
+			free_iob ( iobuf );
+			return rc;
+		}
+	}
+
+	/* Discard original packet */
+	free_iob ( iobuf );
+	return 0;
+}
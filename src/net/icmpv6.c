@@ -194,9 +194,11 @@ static int icmpv6_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 		goto done;
 	}
 
-	/* Verify checksum */
-	csum = tcpip_continue_chksum ( pshdr_csum, icmp, len );
-	if ( csum != 0 ) {
+	/* Verify checksum, unless already verified by network device */
+	if ( ! ( netdev_rx_csum ( netdev ) &&
+		 ( iobuf->csum == IOB_CSUM_VALID ) ) &&
+	     ( ( csum = tcpip_continue_chksum ( pshdr_csum, icmp,
+						len ) ) != 0 ) ) {
 		DBGC ( netdev, "ICMPv6 checksum incorrect (is %04x, should be "
 		       "0000)\n", csum );
 		DBGC_HDA ( netdev, 0, icmp, len );
@@ -512,11 +512,14 @@ static int ipv4_tx ( struct io_buffer *iobuf,
 			       ( ( netdev->rx_stats.bad & 0xf ) << 4 ) |
 			       ( ( netdev->rx_stats.good & 0xf ) << 0 ) );
 
+	/* Record network-layer header for segmentation, if applicable */
+	if ( iobuf->gso )
+		iobuf->gso_start = iphdr;
+
 	/* Fix up checksums */
 	if ( trans_csum ) {
-		*trans_csum = ipv4_pshdr_chksum ( iobuf, *trans_csum );
-		if ( ! *trans_csum )
-			*trans_csum = tcpip_protocol->zero_csum;
+		tcpip_tx_chksum ( iobuf, tcpip_protocol, netdev, trans_csum,
+				  ipv4_pshdr_chksum ( iobuf, *trans_csum ) );
 	}
 	iphdr->chksum = tcpip_chksum ( iphdr, sizeof ( *iphdr ) );
 
@@ -737,7 +740,10 @@ static int ipv4_rx ( struct io_buffer *iobuf,
 	memset ( &dest, 0, sizeof ( dest ) );
 	dest.sin.sin_family = AF_INET;
 	dest.sin.sin_addr = iphdr->dest;
-	pshdr_csum = ipv4_pshdr_chksum ( iobuf, TCPIP_EMPTY_CSUM );
+	pshdr_csum = ( ( netdev_rx_csum ( netdev ) &&
+			 ( iobuf->csum == IOB_CSUM_VALID ) ) ?
+		       TCPIP_EMPTY_CSUM :
+		       ipv4_pshdr_chksum ( iobuf, TCPIP_EMPTY_CSUM ) );
 	iob_pull ( iobuf, hdrlen );
 	if ( ( rc = tcpip_rx ( iobuf, netdev, iphdr->protocol, &src.st,
 			       &dest.st, pshdr_csum, &ipv4_stats ) ) != 0 ) {
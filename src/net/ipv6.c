@@ -537,6 +537,7 @@ static int ipv6_tx ( struct io_buffer *iobuf,
 	uint8_t ll_dest_buf[MAX_LL_ADDR_LEN];
 	const void *ll_dest;
 	size_t len;
+	uint16_t csum;
 	int rc;
 
 	/* Update statistics */
@@ -571,13 +572,17 @@ static int ipv6_tx ( struct io_buffer *iobuf,
 	if ( src )
 		memcpy ( &iphdr->src, src, sizeof ( iphdr->src ) );
 
+	/* Record network-layer header for segmentation, if applicable */
+	if ( iobuf->gso )
+		iobuf->gso_start = iphdr;
+
 	/* Fix up checksums */
 	if ( trans_csum ) {
-		*trans_csum = ipv6_pshdr_chksum ( iphdr, len,
-						  tcpip_protocol->tcpip_proto,
-						  *trans_csum );
-		if ( ! *trans_csum )
-			*trans_csum = tcpip_protocol->zero_csum;
+		csum = ipv6_pshdr_chksum ( iphdr, len,
+					   tcpip_protocol->tcpip_proto,
+					   *trans_csum );
+		tcpip_tx_chksum ( iobuf, tcpip_protocol, netdev, trans_csum,
+				  csum );
 	}
 
 	/* Print IPv6 header for debugging */
@@ -796,8 +801,11 @@ static int ipv6_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 		 sizeof ( dest.sin6.sin6_addr ) );
 	dest.sin6.sin6_scope_id = netdev->scope_id;
 	iob_pull ( iobuf, hdrlen );
-	pshdr_csum = ipv6_pshdr_chksum ( iphdr, iob_len ( iobuf ),
-					 next_header, TCPIP_EMPTY_CSUM );
+	pshdr_csum = ( ( netdev_rx_csum ( netdev ) &&
+			 ( iobuf->csum == IOB_CSUM_VALID ) ) ?
+		       TCPIP_EMPTY_CSUM :
+		       ipv6_pshdr_chksum ( iphdr, iob_len ( iobuf ),
+					   next_header, TCPIP_EMPTY_CSUM ) );
 	if ( ( rc = tcpip_rx ( iobuf, netdev, next_header, &src.st, &dest.st,
 			       pshdr_csum, &ipv6_stats ) ) != 0 ) {
 		DBGC ( ipv6col ( &src.sin6.sin6_addr ), "IPv6 received packet "
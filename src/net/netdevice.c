@@ -64,6 +64,18 @@ static struct profiler net_rx_profiler __profiler = { .name = "net.rx" };
 /** Network transmit profiler */
 static struct profiler net_tx_profiler __profiler = { .name = "net.tx" };
 
+/** Maximum number of received packets processed per device per pass */
+#define NET_RX_BUDGET 16
+
+/** Maximum number of polling passes within a single call to net_poll() */
+#define NET_POLL_MAX_PASSES 8
+
+/** Number of consecutive idle polls before halving the poll frequency */
+#define NET_POLL_IDLE_LIMIT 64
+
+/** Maximum poll interval (as a power of two) for an idle device */
+#define NET_POLL_MAX_SHIFT 3
+
 /** Default unknown link status code */
 #define EUNKNOWN_LINK_STATUS __einfo_error ( EINFO_EUNKNOWN_LINK_STATUS )
 #define EINFO_EUNKNOWN_LINK_STATUS \
@@ -336,6 +348,11 @@ int netdev_tx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 
 	DBGC2 ( netdev, "NETDEV %s transmitting %p (%p+%zx)\n",
 		netdev->name, iobuf, iobuf->data, iob_len ( iobuf ) );
+
+	/* Segment packet in software, if required */
+	if ( iobuf->gso && ! netdev_tx_tso ( netdev ) )
+		return netdev_tx_gso ( netdev, iobuf );
+
 	profile_start ( &net_tx_profiler );
 
 	/* Enqueue packet */
@@ -747,6 +764,23 @@ struct net_device * alloc_netdev ( size_t priv_len ) {
 	return netdev;
 }
 
+/**
+ * Register per-device profiler
+ *
+ * @v netdev		Network device
+ * @v profiler		Per-device profiler
+ * @v type		Profiler type (e.g. "poll")
+ */
+static void netdev_register_profiler ( struct net_device *netdev,
+				       struct net_device_profiler *profiler,
+				       const char *type ) {
+
+	snprintf ( profiler->name, sizeof ( profiler->name ), "%s.%s",
+		   netdev->name, type );
+	profiler->profiler.name = profiler->name;
+	profile_register ( &profiler->profiler );
+}
+
 /**
  * Register network device
  *
@@ -815,6 +849,10 @@ int register_netdev ( struct net_device *netdev ) {
 	       netdev->name, netdev->dev->name,
 	       netdev_addr ( netdev ) );
 
+	/* Register per-device profilers */
+	netdev_register_profiler ( netdev, &netdev->poll_profiler, "poll" );
+	netdev_register_profiler ( netdev, &netdev->rx_profiler, "rx" );
+
 	/* Register per-netdev configuration settings */
 	if ( ( rc = register_settings ( netdev_settings ( netdev ),
 					NULL, netdev->name ) ) != 0 ) {
@@ -846,6 +884,8 @@ int register_netdev ( struct net_device *netdev ) {
 	clear_settings ( netdev_settings ( netdev ) );
 	unregister_settings ( netdev_settings ( netdev ) );
  err_register_settings:
+	profile_unregister ( &netdev->rx_profiler.profiler );
+	profile_unregister ( &netdev->poll_profiler.profiler );
 	list_del ( &netdev->list );
 	netdev_put ( netdev );
  err_duplicate:
@@ -956,6 +996,10 @@ void unregister_netdev ( struct net_device *netdev ) {
 	clear_settings ( netdev_settings ( netdev ) );
 	unregister_settings ( netdev_settings ( netdev ) );
 
+	/* Unregister per-device profilers */
+	profile_unregister ( &netdev->rx_profiler.profiler );
+	profile_unregister ( &netdev->poll_profiler.profiler );
+
 	/* Remove from device list */
 	DBGC ( netdev, "NETDEV %s unregistered\n", netdev->name );
 	list_del ( &netdev->list );
@@ -1118,13 +1162,59 @@ int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 }
 
 /**
- * Poll the network stack
+ * Poll network device for completed and received packets
  *
- * This polls all interfaces for received packets, and processes
- * packets from the RX queue.
+ * @v netdev		Network device
+ *
+ * Devices that have been idle for some time are polled less
+ * frequently, since polling may be expensive (e.g. when each register
+ * access traps to a hypervisor).  Devices with outstanding
+ * transmissions are always polled.
  */
-void net_poll ( void ) {
-	struct net_device *netdev;
+static void net_poll_netdev ( struct net_device *netdev ) {
+	unsigned int shift;
+
+	/* Skip poll if device is idle */
+	shift = ( netdev->poll_idle / NET_POLL_IDLE_LIMIT );
+	if ( shift > NET_POLL_MAX_SHIFT )
+		shift = NET_POLL_MAX_SHIFT;
+	if ( list_empty ( &netdev->tx_queue ) &&
+	     ( ++netdev->poll_skip < ( 1U << shift ) ) ) {
+		netdev->poll_stats.skipped++;
+		return;
+	}
+	netdev->poll_skip = 0;
+	netdev->poll_stats.polls++;
+
+	/* Poll for new packets */
+	profile_start ( &net_poll_profiler );
+	profile_start_at ( &netdev->poll_profiler.profiler,
+			   profile_started ( &net_poll_profiler ) );
+	netdev_poll ( netdev );
+	profile_stop ( &net_poll_profiler );
+	profile_stop_at ( &netdev->poll_profiler.profiler,
+			  profile_stopped ( &net_poll_profiler ) );
+
+	/* Record device as idle or active */
+	if ( list_empty ( &netdev->rx_queue ) &&
+	     list_empty ( &netdev->tx_queue ) ) {
+		if ( netdev->poll_idle < ( NET_POLL_IDLE_LIMIT <<
+					   NET_POLL_MAX_SHIFT ) ) {
+			netdev->poll_idle++;
+		}
+	} else {
+		netdev->poll_idle = 0;
+	}
+}
+
+/**
+ * Process packets from network device's receive queue
+ *
+ * @v netdev		Network device
+ * @v budget		Maximum number of packets to process
+ * @ret more		Packets remain to be processed
+ */
+static int net_poll_rx ( struct net_device *netdev, unsigned int budget ) {
 	struct io_buffer *iobuf;
 	struct ll_protocol *ll_protocol;
 	const void *ll_dest;
@@ -1133,51 +1223,99 @@ void net_poll ( void ) {
 	unsigned int flags;
 	int rc;
 
-	/* Poll and process each network device */
-	list_for_each_entry ( netdev, &net_devices, list ) {
+	/* Process received packets, up to the budget */
+	while ( budget-- ) {
+
+		/* Dequeue next packet, if any */
+		iobuf = netdev_rx_dequeue ( netdev );
+		if ( ! iobuf )
+			return 0;
+
+		DBGC2 ( netdev, "NETDEV %s processing %p (%p+%zx)\n",
+			netdev->name, iobuf, iobuf->data,
+			iob_len ( iobuf ) );
+		profile_start ( &net_rx_profiler );
+		profile_start_at ( &netdev->rx_profiler.profiler,
+				   profile_started ( &net_rx_profiler ) );
+
+		/* Remove link-layer header */
+		ll_protocol = netdev->ll_protocol;
+		if ( ( rc = ll_protocol->pull ( netdev, iobuf,
+						&ll_dest, &ll_source,
+						&net_proto,
+						&flags ) ) != 0 ) {
+			free_iob ( iobuf );
+			continue;
+		}
 
-		/* Poll for new packets */
-		profile_start ( &net_poll_profiler );
-		netdev_poll ( netdev );
-		profile_stop ( &net_poll_profiler );
+		/* Hand packet to network layer */
+		if ( ( rc = net_rx ( iob_disown ( iobuf ), netdev,
+				     net_proto, ll_dest,
+				     ll_source, flags ) ) != 0 ) {
+			/* Record error for diagnosis */
+			netdev_rx_err ( netdev, NULL, rc );
+		}
+		profile_stop ( &net_rx_profiler );
+		profile_stop_at ( &netdev->rx_profiler.profiler,
+				  profile_stopped ( &net_rx_profiler ) );
+	}
 
-		/* Leave received packets on the queue if receive
-		 * queue processing is currently frozen.  This will
-		 * happen when the raw packets are to be manually
-		 * dequeued using netdev_rx_dequeue(), rather than
-		 * processed via the usual networking stack.
-		 */
-		if ( netdev_rx_frozen ( netdev ) )
-			continue;
+	/* Budget exhausted */
+	if ( list_empty ( &netdev->rx_queue ) )
+		return 0;
+	netdev->poll_stats.exhausted++;
+	return 1;
+}
 
-		/* Process all received packets */
-		while ( ( iobuf = netdev_rx_dequeue ( netdev ) ) ) {
-
-			DBGC2 ( netdev, "NETDEV %s processing %p (%p+%zx)\n",
-				netdev->name, iobuf, iobuf->data,
-				iob_len ( iobuf ) );
-			profile_start ( &net_rx_profiler );
-
-			/* Remove link-layer header */
-			ll_protocol = netdev->ll_protocol;
-			if ( ( rc = ll_protocol->pull ( netdev, iobuf,
-							&ll_dest, &ll_source,
-							&net_proto,
-							&flags ) ) != 0 ) {
-				free_iob ( iobuf );
-				continue;
-			}
+/**
+ * Poll the network stack
+ *
+ * This polls all interfaces for received packets, and processes
+ * packets from the RX queue.
+ *
+ * Received packets are processed in batches of at most NET_RX_BUDGET
+ * packets per device, with each device being given a turn in each
+ * pass.  A device is polled again (reaping any completed
+ * transmissions) only once its existing backlog of received packets
+ * has been processed, so that a burst of traffic on one device can
+ * neither starve other devices nor grow the receive queue without
+ * bound.
+ */
+void net_poll ( void ) {
+	struct net_device *netdev;
+	unsigned int passes = 0;
+	int more;
 
-			/* Hand packet to network layer */
-			if ( ( rc = net_rx ( iob_disown ( iobuf ), netdev,
-					     net_proto, ll_dest,
-					     ll_source, flags ) ) != 0 ) {
-				/* Record error for diagnosis */
-				netdev_rx_err ( netdev, NULL, rc );
+	do {
+		more = 0;
+
+		/* Poll and process each network device */
+		list_for_each_entry ( netdev, &net_devices, list ) {
+
+			/* Poll for new packets, unless a backlog of
+			 * received packets remains to be processed.
+			 */
+			if ( list_empty ( &netdev->rx_queue ) ||
+			     netdev_rx_frozen ( netdev ) ) {
+				net_poll_netdev ( netdev );
 			}
-			profile_stop ( &net_rx_profiler );
+
+			/* Leave received packets on the queue if
+			 * receive queue processing is currently
+			 * frozen.  This will happen when the raw
+			 * packets are to be manually dequeued using
+			 * netdev_rx_dequeue(), rather than processed
+			 * via the usual networking stack.
+			 */
+			if ( netdev_rx_frozen ( netdev ) )
+				continue;
+
+			/* Process received packets */
+			if ( net_poll_rx ( netdev, NET_RX_BUDGET ) )
+				more = 1;
 		}
-	}
+
+	} while ( more && ( ++passes < NET_POLL_MAX_PASSES ) );
 }
 
 /**
@@ -1231,6 +1369,21 @@ __weak void vlan_netdev_rx_err ( struct net_device *netdev,
 	netdev_rx_err ( netdev, iobuf, rc );
 }
 
+/**
+ * Transmit packet requiring segmentation (when segmentation support
+ * is not present)
+ *
+ * @v netdev		Network device
+ * @v iobuf		I/O buffer
+ * @ret rc		Return status code
+ */
+__weak int netdev_tx_gso ( struct net_device *netdev,
+			   struct io_buffer *iobuf ) {
+
+	netdev_tx_err ( netdev, iobuf, -ENOTSUP );
+	return -ENOTSUP;
+}
+
 /** Networking stack process */
 PERMANENT_PROCESS ( net_process, net_step );
 
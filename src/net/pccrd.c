@@ -157,6 +157,7 @@ static char * peerdist_discovery_reply_tag ( char *data, size_t len,
 static char * peerdist_discovery_reply_values ( char *data, size_t len,
 						const char *name ) {
 	char buf[ 2 /* "</" */ + strlen ( name ) + 1 /* ">" */ + 1 /* NUL */ ];
+	size_t skip;
 	char *open;
 	char *close;
 	char *start;
@@ -165,13 +166,23 @@ static char * peerdist_discovery_reply_values ( char *data, size_t len,
 	char *out;
 	char c;
 
-	/* Locate opening tag */
-	snprintf ( buf, sizeof ( buf ), "<%s>", name );
-	open = peerdist_discovery_reply_tag ( data, len, buf );
-	if ( ! open )
+	/* Locate opening tag, which may include attributes */
+	snprintf ( buf, sizeof ( buf ), "<%s", name );
+	do {
+		open = peerdist_discovery_reply_tag ( data, len, buf );
+		if ( ! open )
+			return NULL;
+		skip = ( open + strlen ( buf ) - data );
+		len -= skip;
+		data += skip;
+	} while ( ! ( len && ( ( *data == '>' ) || isspace ( *data ) ) ) );
+
+	/* Skip any attributes */
+	for ( ; len && ( *data != '>' ) ; data++, len-- ) {}
+	if ( ! len )
 		return NULL;
-	start = ( open + strlen ( buf ) );
-	len -= ( start - data );
+	start = ( data + 1 );
+	len--;
 	data = start;
 
 	/* Locate closing tag */
@@ -284,3 +295,180 @@ int peerdist_discovery_reply ( char *data, size_t len,
 
 	return 0;
 }
+
+/**
+ * Parse discovery request
+ *
+ * @v data		Request data (not NUL-terminated, will be modified)
+ * @v len		Length of request data
+ * @v probe		Discovery request to fill in
+ * @ret rc		Return status code
+ *
+ * The discovery request includes pointers to strings within the
+ * modified request data.
+ */
+int peerdist_discovery_probe ( char *data, size_t len,
+			       struct peerdist_discovery_probe *probe ) {
+	char *types;
+	char *type;
+	char *id;
+	char *scopes;
+
+	/* Find <wsd:Types> tag */
+	types = peerdist_discovery_reply_values ( data, len, "wsd:Types" );
+	if ( ! types ) {
+		DBGC ( probe, "PCCRD %p missing <wsd:Types> tag\n", probe );
+		return -ENOENT;
+	}
+
+	/* Check for PeerDist data type */
+	for ( type = types ; *type ; type += ( strlen ( type ) + 1 /* NUL */ ) ){
+		if ( strcmp ( type, "PeerDist:PeerDistData" ) == 0 )
+			break;
+	}
+	if ( ! *type ) {
+		DBGC ( probe, "PCCRD %p not a PeerDist request\n", probe );
+		return -ENOTSUP;
+	}
+
+	/* Find <wsa:MessageID> tag */
+	id = peerdist_discovery_reply_values ( data, len, "wsa:MessageID" );
+	if ( ! ( id && *id ) ) {
+		DBGC ( probe, "PCCRD %p missing <wsa:MessageID> tag\n",
+		       probe );
+		return -ENOENT;
+	}
+
+	/* Find <wsd:Scopes> tag */
+	scopes = peerdist_discovery_reply_values ( data, len, "wsd:Scopes" );
+	if ( ! scopes ) {
+		DBGC ( probe, "PCCRD %p missing <wsd:Scopes> tag\n", probe );
+		return -ENOENT;
+	}
+
+	/* Fill in discovery request */
+	probe->id = id;
+	probe->ids = scopes;
+
+	return 0;
+}
+
+/** Discovery response format */
+#define PEERDIST_DISCOVERY_RESPONSE					      \
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?>"			      \
+	"<soap:Envelope "						      \
+	    "xmlns:soap=\"http://www.w3.org/2003/05/soap-envelope\" "	      \
+	    "xmlns:wsa=\"http://schemas.xmlsoap.org/ws/2004/08/addressing\" " \
+	    "xmlns:wsd=\"http://schemas.xmlsoap.org/ws/2005/04/discovery\" "  \
+	    "xmlns:PeerDist=\"http://schemas.microsoft.com/p2p/"	      \
+			     "2007/09/PeerDistributionDiscovery\">"	      \
+	  "<soap:Header>"						      \
+	    "<wsa:To>"							      \
+	      "http://schemas.xmlsoap.org/ws/2004/08/addressing/role/"	      \
+	      "anonymous"						      \
+	    "</wsa:To>"							      \
+	    "<wsa:Action>"						      \
+	      "http://schemas.xmlsoap.org/ws/2005/04/discovery/ProbeMatches"  \
+	    "</wsa:Action>"						      \
+	    "<wsa:MessageID>"						      \
+	      "urn:uuid:%s"						      \
+	    "</wsa:MessageID>"						      \
+	    "<wsa:RelatesTo>"						      \
+	      "%s"							      \
+	    "</wsa:RelatesTo>"						      \
+	  "</soap:Header>"						      \
+	  "<soap:Body>"							      \
+	    "<wsd:ProbeMatches>"					      \
+	      "<wsd:ProbeMatch>"					      \
+		"<wsa:EndpointReference>"				      \
+		  "<wsa:Address>"					      \
+		    "urn:uuid:%s"					      \
+		  "</wsa:Address>"					      \
+		"</wsa:EndpointReference>"				      \
+		"<wsd:Types>"						      \
+		  "PeerDist:PeerDistData"				      \
+		"</wsd:Types>"						      \
+		"<wsd:Scopes>"						      \
+		  "%s"							      \
+		"</wsd:Scopes>"						      \
+		"<wsd:XAddrs>"						      \
+		  "%s"							      \
+		"</wsd:XAddrs>"						      \
+		"<wsd:MetadataVersion>"					      \
+		  "1"							      \
+		"</wsd:MetadataVersion>"				      \
+		"<PeerDist:PeerDistData>"				      \
+		  "<PeerDist:BlockCount>"				      \
+		    "%s"						      \
+		  "</PeerDist:BlockCount>"				      \
+		"</PeerDist:PeerDistData>"				      \
+	      "</wsd:ProbeMatch>"					      \
+	    "</wsd:ProbeMatches>"					      \
+	  "</soap:Body>"						      \
+	"</soap:Envelope>"
+
+/**
+ * Construct discovery response
+ *
+ * @v uuid		Message UUID string
+ * @v relates		Message ID of discovery request
+ * @v endpoint		Endpoint UUID string
+ * @v ids		List of segment ID strings
+ * @v counts		Block count for each segment
+ * @v location		Peer location
+ * @ret response	Discovery response, or NULL on failure
+ *
+ * The list of segment ID strings is terminated with a zero-length
+ * string.  The response is dynamically allocated; the caller must
+ * eventually free() the response.
+ */
+char * peerdist_discovery_response ( const char *uuid, const char *relates,
+				     const char *endpoint, const char *ids,
+				     const unsigned int *counts,
+				     const char *location ) {
+	struct peerdist_discovery_block_count *count;
+	const char *id;
+	unsigned int segments = 0;
+	size_t scopes_len = 0;
+	char *response = NULL;
+	char *scopes;
+	char *blockcount;
+	char *out;
+	unsigned int i;
+	int len;
+
+	/* Calculate lengths */
+	for ( id = ids ; *id ; id += ( strlen ( id ) + 1 /* NUL */ ) ) {
+		scopes_len += ( strlen ( id ) + 1 /* " " or NUL */ );
+		segments++;
+	}
+	if ( ! segments )
+		return NULL;
+
+	/* Allocate space-separated segment ID list and block counts */
+	scopes = malloc ( scopes_len + ( segments * sizeof ( *count ) ) +
+			  1 /* NUL */ );
+	if ( ! scopes )
+		return NULL;
+	blockcount = ( scopes + scopes_len );
+
+	/* Construct segment ID list and block counts */
+	out = scopes;
+	count = ( ( struct peerdist_discovery_block_count * ) blockcount );
+	for ( id = ids, i = 0 ; *id ; id += ( strlen ( id ) + 1 ), i++ ) {
+		out += sprintf ( out, "%s%s", ( i ? " " : "" ), id );
+		/* Include the NUL to avoid overwriting the next count */
+		snprintf ( count[i].hex, ( sizeof ( count[i].hex ) + 1 ),
+			   "%08X", counts[i] );
+	}
+	blockcount[ segments * sizeof ( *count ) ] = '\0';
+
+	/* Construct response */
+	len = asprintf ( &response, PEERDIST_DISCOVERY_RESPONSE, uuid,
+			 relates, endpoint, scopes, location, blockcount );
+	free ( scopes );
+	if ( len < 0 )
+		return NULL;
+
+	return response;
+}
@@ -49,25 +49,6 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define PEERBLK_DECRYPT_CHUNKSIZE 2048
 
-/** PeerDist maximum number of concurrent raw block downloads
- *
- * Raw block downloads are expensive if the origin server uses HTTPS,
- * since each concurrent download will require local TLS resources
- * (including potentially large received encrypted data buffers).
- *
- * Raw block downloads may also be prohibitively slow to initiate when
- * the origin server is using HTTPS and client certificates.  Origin
- * servers for PeerDist downloads are likely to be running IIS, which
- * has a bug that breaks session resumption and requires each
- * connection to go through the full client certificate verification.
- *
- * Limit the total number of concurrent raw block downloads to
- * ameliorate these problems.
- *
- * This is a policy decision.
- */
-#define PEERBLK_RAW_MAX 2
-
 /** PeerDist raw block download attempt initial progress timeout
  *
  * This is a policy decision.
@@ -103,6 +84,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define PEERBLK_MAX_ATTEMPT_CYCLES 4
 
+/** PeerDist maximum number of peers attempted per cycle
+ *
+ * This is limited by the size of the attempted peer bitmask.  Any
+ * further discovered peers will be ignored.
+ */
+#define PEERBLK_MAX_PEERS 32
+
 /** PeerDist block download profiler */
 static struct profiler peerblk_download_profiler __profiler =
 	{ .name = "peerblk.download" };
@@ -127,6 +115,7 @@ static struct profiler peerblk_discovery_success_profiler __profiler =
 static struct profiler peerblk_discovery_timeout_profiler __profiler =
 	{ .name = "peerblk.discovery.timeout" };
 
+static struct peerdist_block_queue peerblk_raw_queue;
 static void peerblk_dequeue ( struct peerdist_block *peerblk );
 
 /**
@@ -288,6 +277,59 @@ static int peerblk_deliver ( struct peerdist_block *peerblk,
 	return 0;
 }
 
+/**
+ * Adjust raw block download concurrency limit
+ *
+ * @v queue		Raw block download queue
+ * @v rc		Download attempt status code
+ *
+ * The limit is raised additively after each successful attempt, and
+ * lowered multiplicatively after each failed attempt, within the range
+ * [PEERBLK_RAW_INITIAL,PEERBLK_RAW_MAX].
+ */
+void peerblk_queue_report ( struct peerdist_block_queue *queue, int rc ) {
+
+	if ( rc != 0 ) {
+		queue->max /= 2;
+		if ( queue->max < PEERBLK_RAW_INITIAL )
+			queue->max = PEERBLK_RAW_INITIAL;
+	} else if ( queue->max < PEERBLK_RAW_MAX ) {
+		queue->max++;
+	}
+}
+
+/**
+ * Report PeerDist block download attempt outcome
+ *
+ * @v peerblk		PeerDist block download
+ * @v rc		Download attempt status code
+ */
+static void peerblk_report ( struct peerdist_block *peerblk, int rc ) {
+	struct peerdisc_segment *segment = peerblk->discovery.segment;
+	struct peerdist_block_queue *queue = &peerblk_raw_queue;
+	struct peerdisc_peer *head;
+	unsigned long elapsed = ( currticks() - peerblk->attempted );
+	const char *location;
+
+	/* Identify peer, adjusting raw download concurrency limit for
+	 * attempts made to the origin server.
+	 */
+	head = list_entry ( &segment->peers, struct peerdisc_peer, list );
+	if ( peerblk->peer != head ) {
+		location = peerblk->peer->location;
+	} else {
+		location = NULL;
+		peerblk_queue_report ( queue, rc );
+		DBGC2 ( peerblk, "PEERBLK %p %d.%d raw concurrency %d\n",
+			peerblk, peerblk->segment, peerblk->block, queue->max );
+	}
+
+	/* Report outcome */
+	peerdisc_report ( &peerblk->xfer, location,
+			  ( peerblk->range.end - peerblk->range.start ),
+			  elapsed, rc );
+}
+
 /**
  * Finish PeerDist block download attempt
  *
@@ -329,6 +371,7 @@ static void peerblk_done ( struct peerdist_block *peerblk, int rc ) {
 	head = list_entry ( &segment->peers, struct peerdisc_peer, list );
 	peer = ( ( peerblk->peer == head ) ? NULL : peerblk->peer );
 	peerdisc_stat ( &peerblk->xfer, peer, &segment->peers );
+	peerblk_report ( peerblk, 0 );
 
 	/* Close download */
 	peerblk_close ( peerblk, 0 );
@@ -338,6 +381,7 @@ static void peerblk_done ( struct peerdist_block *peerblk, int rc ) {
 	/* Record failure reason and schedule a retry attempt */
 	profile_custom ( &peerblk_attempt_failure_profiler,
 			 ( now - peerblk->attempted ) );
+	peerblk_report ( peerblk, rc );
 	peerblk_reset ( peerblk, rc );
 	peerblk->rc = rc;
 	start_timer_nodelay ( &peerblk->timer );
@@ -564,7 +608,7 @@ static struct process_descriptor peerblk_queue_desc =
 static struct peerdist_block_queue peerblk_raw_queue = {
 	.process = PROC_INIT ( peerblk_raw_queue.process, &peerblk_queue_desc ),
 	.list = LIST_HEAD_INIT ( peerblk_raw_queue.list ),
-	.max = PEERBLK_RAW_MAX,
+	.max = PEERBLK_RAW_INITIAL,
 	.open = peerblk_raw_open,
 };
 
@@ -1270,6 +1314,48 @@ static void peerblk_retrieval_close ( struct peerdist_block *peerblk, int rc ) {
  ******************************************************************************
  */
 
+/**
+ * Select next peer for retrieval protocol download attempt
+ *
+ * @v peerblk		PeerDist block download
+ * @ret peer		Selected peer, or NULL if no peers remain
+ *
+ * Peers are attempted in order of rank (as determined from the
+ * throughput and failures observed across all blocks of the overall
+ * download), with ties broken by discovery order.  Each peer is
+ * attempted at most once per cycle.
+ */
+struct peerdisc_peer * peerblk_select ( struct peerdist_block *peerblk ) {
+	struct peerdisc_segment *segment = peerblk->discovery.segment;
+	struct peerdisc_peer *peer;
+	struct peerdisc_peer *best = NULL;
+	unsigned long best_rank = 0;
+	unsigned long rank;
+	unsigned int best_index = 0;
+	unsigned int index = 0;
+
+	/* Find highest-ranked peer not yet attempted in this cycle */
+	list_for_each_entry ( peer, &segment->peers, list ) {
+		if ( index >= PEERBLK_MAX_PEERS )
+			break;
+		if ( ! ( peerblk->tried & ( 1UL << index ) ) ) {
+			rank = peerdisc_rank ( &peerblk->xfer, peer->location );
+			if ( ( ! best ) || ( rank > best_rank ) ) {
+				best = peer;
+				best_rank = rank;
+				best_index = index;
+			}
+		}
+		index++;
+	}
+
+	/* Record peer as attempted */
+	if ( best )
+		peerblk->tried |= ( 1UL << best_index );
+
+	return best;
+}
+
 /**
  * Handle PeerDist retry timer expiry
  *
@@ -1281,8 +1367,8 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 		container_of ( timer, struct peerdist_block, timer );
 	struct peerdisc_segment *segment = peerblk->discovery.segment;
 	struct peerdisc_peer *head;
+	struct peerdisc_peer *peer;
 	unsigned long now = peerblk_timestamp();
-	const char *location;
 	int rc;
 
 	/* Profile discovery timeout, if applicable */
@@ -1301,13 +1387,14 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 		DBGC ( peerblk, "PEERBLK %p %d.%d timed out after %ld ticks\n",
 		       peerblk, peerblk->segment, peerblk->block,
 		       timer->timeout );
+		peerblk_report ( peerblk, -ETIMEDOUT );
 	}
 
 	/* Abort any current download attempt */
 	peerblk_reset ( peerblk, -ETIMEDOUT );
 
 	/* Record attempt start time */
-	peerblk->attempted = now;
+	peerblk->attempted = currticks();
 
 	/* If we have exceeded our maximum number of attempt cycles
 	 * (each cycle comprising a retrieval protocol download from
@@ -1322,19 +1409,19 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 		goto err;
 	}
 
-	/* If we have not yet made any download attempts, then move to
-	 * the start of the peer list.
+	/* If we have not yet made any download attempts, or have just
+	 * completed a cycle, then start a new cycle.
 	 */
-	if ( peerblk->peer == NULL )
-		peerblk->peer = head;
+	if ( ( peerblk->peer == NULL ) || ( peerblk->peer == head ) )
+		peerblk->tried = 0;
 
-	/* Attempt retrieval protocol download from next usable peer */
-	list_for_each_entry_continue ( peerblk->peer, &segment->peers, list ) {
+	/* Attempt retrieval protocol download from best usable peer */
+	while ( ( peer = peerblk_select ( peerblk ) ) != NULL ) {
 
 		/* Attempt retrieval protocol download from this peer */
-		location = peerblk->peer->location;
+		peerblk->peer = peer;
 		if ( ( rc = peerblk_retrieval_open ( peerblk,
-						     location ) ) != 0 ) {
+						     peer->location ) ) != 0 ) {
 			/* Non-fatal: continue to try next peer */
 			continue;
 		}
@@ -1344,6 +1431,7 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 	}
 
 	/* Add to raw download queue */
+	peerblk->peer = head;
 	peerblk_enqueue ( peerblk, &peerblk_raw_queue );
 
 	return;
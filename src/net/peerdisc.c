@@ -113,6 +113,56 @@ void peerdisc_stat ( struct interface *intf, struct peerdisc_peer *peer,
 	intf_put ( dest );
 }
 
+/**
+ * Report PeerDist download attempt outcome
+ *
+ * @v intf		Interface
+ * @v location		Peer location (or NULL for the origin server)
+ * @v len		Length of data downloaded
+ * @v elapsed		Time taken by download attempt (in ticks)
+ * @v rc		Download attempt status code
+ */
+void peerdisc_report ( struct interface *intf, const char *location,
+		       size_t len, unsigned long elapsed, int rc ) {
+	struct interface *dest;
+	peerdisc_report_TYPE ( void * ) *op =
+		intf_get_dest_op ( intf, peerdisc_report, &dest );
+	void *object = intf_object ( dest );
+
+	if ( op ) {
+		op ( object, location, len, elapsed, rc );
+	} else {
+		/* Default is to do nothing */
+	}
+
+	intf_put ( dest );
+}
+
+/**
+ * Rank PeerDist peer
+ *
+ * @v intf		Interface
+ * @v location		Peer location
+ * @ret rank		Peer rank (higher ranks are preferred)
+ */
+unsigned long peerdisc_rank ( struct interface *intf, const char *location ) {
+	struct interface *dest;
+	peerdisc_rank_TYPE ( void * ) *op =
+		intf_get_dest_op ( intf, peerdisc_rank, &dest );
+	void *object = intf_object ( dest );
+	unsigned long rank;
+
+	if ( op ) {
+		rank = op ( object, location );
+	} else {
+		/* Default is to rank all peers equally */
+		rank = 0;
+	}
+
+	intf_put ( dest );
+	return rank;
+}
+
 /******************************************************************************
  *
  * Discovery sockets
@@ -30,8 +30,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/uri.h>
 #include <ipxe/xferbuf.h>
 #include <ipxe/job.h>
+#include <ipxe/timer.h>
 #include <ipxe/peerblk.h>
 #include <ipxe/peermux.h>
+#include <ipxe/peerserv.h>
 
 /** @file
  *
@@ -47,12 +49,31 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 static void peermux_free ( struct refcnt *refcnt ) {
 	struct peerdist_multiplexer *peermux =
 		container_of ( refcnt, struct peerdist_multiplexer, refcnt );
+	struct peerdist_peer *peer;
+	struct peerdist_peer *tmp;
 
+	list_for_each_entry_safe ( peer, tmp, &peermux->peers, list ) {
+		list_del ( &peer->list );
+		free ( peer );
+	}
 	uri_put ( peermux->uri );
 	xferbuf_free ( &peermux->buffer );
 	free ( peermux );
 }
 
+/**
+ * Add content to PeerDist content server (when not present)
+ *
+ * @v uri		Original URI
+ * @v data		Content information
+ * @v len		Length of content information
+ * @ret rc		Return status code
+ */
+__weak int peerserv_add ( struct uri *uri __unused,
+			  const void *data __unused, size_t len __unused ) {
+	return 0;
+}
+
 /**
  * Close PeerDist download multiplexer
  *
@@ -185,10 +206,12 @@ static void peermux_step ( struct peerdist_multiplexer *peermux ) {
 	unsigned int next_block;
 	int rc;
 
-	/* Stop initiation process if all block downloads are busy */
+	/* Stop initiation process if all permitted block downloads
+	 * are busy.
+	 */
 	peermblk = list_first_entry ( &peermux->idle,
 				      struct peerdist_multiplexed_block, list );
-	if ( ! peermblk ) {
+	if ( ( ! peermblk ) || ( peermux->count >= peermux->window ) ) {
 		process_del ( &peermux->process );
 		return;
 	}
@@ -210,8 +233,12 @@ static void peermux_step ( struct peerdist_multiplexer *peermux ) {
 		 */
 		if ( next_segment >= info->segments ) {
 			process_del ( &peermux->process );
-			if ( list_empty ( &peermux->busy ) )
+			if ( list_empty ( &peermux->busy ) ) {
+				peerserv_add ( peermux->uri,
+					       peermux->buffer.data,
+					       peermux->buffer.len );
 				peermux_close ( peermux, 0 );
+			}
 			return;
 		}
 
@@ -252,6 +279,7 @@ static void peermux_step ( struct peerdist_multiplexer *peermux ) {
 	/* Move to list of busy block downloads */
 	list_del ( &peermblk->list );
 	list_add_tail ( &peermblk->list, &peermux->busy );
+	peermux->count++;
 
 	return;
 
@@ -328,6 +356,114 @@ static void peermux_block_stat ( struct peerdist_multiplexed_block *peermblk,
 		peermux, stats->local, stats->total, stats->peers );
 }
 
+/**
+ * Find peer performance record
+ *
+ * @v peermux		PeerDist download multiplexer
+ * @v location		Peer location
+ * @ret peer		Peer performance record, or NULL if not found
+ */
+static struct peerdist_peer *
+peermux_peer ( struct peerdist_multiplexer *peermux, const char *location ) {
+	struct peerdist_peer *peer;
+
+	list_for_each_entry ( peer, &peermux->peers, list ) {
+		if ( strcmp ( peer->location, location ) == 0 )
+			return peer;
+	}
+	return NULL;
+}
+
+/**
+ * Record block download attempt outcome
+ *
+ * @v peermblk		PeerDist multiplexed block download
+ * @v location		Peer location (or NULL for the origin server)
+ * @v len		Length of data downloaded
+ * @v elapsed		Time taken by download attempt (in ticks)
+ * @v rc		Download attempt status code
+ */
+static void peermux_block_report ( struct peerdist_multiplexed_block *peermblk,
+				   const char *location, size_t len,
+				   unsigned long elapsed, int rc ) {
+	struct peerdist_multiplexer *peermux = peermblk->peermux;
+	struct peerdist_peer *peer;
+	unsigned long rate;
+
+	/* Adjust concurrency: increase additively on success, and
+	 * decrease multiplicatively on failure.
+	 */
+	if ( rc != 0 ) {
+		peermux->window /= 2;
+		if ( peermux->window < PEERMUX_MIN_BLOCKS )
+			peermux->window = PEERMUX_MIN_BLOCKS;
+	} else if ( peermux->window < PEERMUX_MAX_BLOCKS ) {
+		peermux->window++;
+		process_add ( &peermux->process );
+	}
+
+	/* Do nothing more for the origin server */
+	if ( ! location )
+		return;
+
+	/* Find or create peer performance record */
+	peer = peermux_peer ( peermux, location );
+	if ( ! peer ) {
+		peer = zalloc ( sizeof ( *peer ) + strlen ( location ) +
+				1 /* NUL */ );
+		if ( ! peer )
+			return;
+		strcpy ( peer->location, location );
+		list_add_tail ( &peer->list, &peermux->peers );
+	}
+
+	/* Update performance record */
+	if ( rc != 0 ) {
+		peer->failures++;
+	} else {
+		peer->failures = 0;
+		if ( ! elapsed )
+			elapsed = 1;
+		rate = ( ( ( ( uint64_t ) len ) * TICKS_PER_SEC ) / elapsed );
+		peer->rate = ( peer->rate ?
+			       ( ( ( 3 * peer->rate ) + rate ) / 4 ) : rate );
+	}
+	DBGC2 ( peermux, "PEERMUX %p peer %s rate %ld failures %d window %d\n",
+		peermux, location, peer->rate, peer->failures,
+		peermux->window );
+}
+
+/**
+ * Rank peer for block download
+ *
+ * @v peermblk		PeerDist multiplexed block download
+ * @v location		Peer location
+ * @ret rank		Peer rank (higher ranks are preferred)
+ *
+ * Peers with a measured throughput are ranked by that throughput.
+ * Untested peers are ranked below all peers with a measured
+ * throughput, and demoted peers (with repeated consecutive failures)
+ * are ranked below all other peers.
+ */
+static unsigned long
+peermux_block_rank ( struct peerdist_multiplexed_block *peermblk,
+		     const char *location ) {
+	struct peerdist_multiplexer *peermux = peermblk->peermux;
+	struct peerdist_peer *peer;
+
+	/* Rank untested peers below all tested peers */
+	peer = peermux_peer ( peermux, location );
+	if ( ! peer )
+		return 1;
+
+	/* Rank demoted peers below all other peers */
+	if ( peer->failures >= PEERMUX_DEMOTE_FAILURES )
+		return 0;
+
+	/* Rank remaining peers by throughput */
+	return ( peer->rate + 2 );
+}
+
 /**
  * Close multiplexed block download
  *
@@ -341,6 +477,7 @@ static void peermux_block_close ( struct peerdist_multiplexed_block *peermblk,
 	/* Move to list of idle downloads */
 	list_del ( &peermblk->list );
 	list_add_tail ( &peermblk->list, &peermux->idle );
+	peermux->count--;
 
 	/* If any error occurred, terminate the whole multiplexer */
 	if ( rc != 0 ) {
@@ -388,6 +525,10 @@ static struct interface_operation peermux_block_operations[] = {
 		  peermux_block_buffer ),
 	INTF_OP ( peerdisc_stat, struct peerdist_multiplexed_block *,
 		  peermux_block_stat ),
+	INTF_OP ( peerdisc_report, struct peerdist_multiplexed_block *,
+		  peermux_block_report ),
+	INTF_OP ( peerdisc_rank, struct peerdist_multiplexed_block *,
+		  peermux_block_rank ),
 	INTF_OP ( intf_close, struct peerdist_multiplexed_block *,
 		  peermux_block_close ),
 };
@@ -428,6 +569,8 @@ int peermux_filter ( struct interface *xfer, struct interface *info,
 			       &peermux->refcnt );
 	INIT_LIST_HEAD ( &peermux->busy );
 	INIT_LIST_HEAD ( &peermux->idle );
+	INIT_LIST_HEAD ( &peermux->peers );
+	peermux->window = PEERMUX_INITIAL_BLOCKS;
 	for ( i = 0 ; i < PEERMUX_MAX_BLOCKS ; i++ ) {
 		peermblk = &peermux->block[i];
 		peermblk->peermux = peermux;
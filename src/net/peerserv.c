@@ -0,0 +1,1253 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <byteswap.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/list.h>
+#include <ipxe/interface.h>
+#include <ipxe/xfer.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/open.h>
+#include <ipxe/in.h>
+#include <ipxe/ip.h>
+#include <ipxe/tcp.h>
+#include <ipxe/uri.h>
+#include <ipxe/uuid.h>
+#include <ipxe/base16.h>
+#include <ipxe/image.h>
+#include <ipxe/aes.h>
+#include <ipxe/crypto.h>
+#include <ipxe/settings.h>
+#include <ipxe/pccrc.h>
+#include <ipxe/pccrd.h>
+#include <ipxe/pccrr.h>
+#include <ipxe/peerblk.h>
+#include <ipxe/peerserv.h>
+
+/** @file
+ *
+ * Peer Content Caching and Retrieval (PeerDist) protocol content server
+ *
+ * This allows iPXE to act as a PeerDist peer for content that it has
+ * itself downloaded using PeerDist content encoding.  Blocks are
+ * served directly from the downloaded image, and so remain available
+ * only for as long as the image remains registered and unmodified.
+ *
+ * Only IPv4 discovery is supported.
+ */
+
+/** PeerDist content server is enabled (via the "peerserve" setting) */
+static long peerserv_enabled = 0;
+
+/** List of served contents */
+static LIST_HEAD ( peerserv_contents );
+
+/** PeerDist content server is active */
+static int peerserv_active;
+
+/** Endpoint UUID */
+static char peerserv_endpoint[ sizeof ( "00000000-0000-0000-0000-000000000000" ) ];
+
+/******************************************************************************
+ *
+ * Served contents
+ *
+ ******************************************************************************
+ */
+
+/**
+ * Free served content
+ *
+ * @v content		Served content
+ */
+static void peerserv_free ( struct peerserv_content *content ) {
+
+	list_del ( &content->list );
+	image_put ( content->image );
+	free ( content->segment );
+	free ( content->uri );
+	free ( content );
+}
+
+/**
+ * Discard served contents whose image is no longer available
+ *
+ * Served content remains available only for as long as the image
+ * holding it remains registered and unmodified.
+ */
+static void peerserv_prune ( void ) {
+	struct peerserv_content *content;
+	struct peerserv_content *tmp;
+	size_t len;
+
+	list_for_each_entry_safe ( content, tmp, &peerserv_contents, list ) {
+		if ( ! content->image )
+			continue;
+		len = ( content->info.trim.end - content->info.trim.start );
+		if ( ( content->image->flags & IMAGE_REGISTERED ) &&
+		     ( content->image->len == len ) )
+			continue;
+		DBGC ( &peerserv_contents, "PEERSERV no longer serving %s\n",
+		       content->uri );
+		peerserv_free ( content );
+	}
+}
+
+/**
+ * Find served segment
+ *
+ * @v id		Segment identifier
+ * @v digestsize	Length of segment identifier
+ * @v content		Served content to fill in
+ * @ret segment		Served segment, or NULL if not found
+ */
+static struct peerserv_segment *
+peerserv_find ( const void *id, size_t digestsize,
+		struct peerserv_content **content ) {
+	struct peerserv_content *tmp;
+	unsigned int i;
+
+	/* Discard any contents that can no longer be served */
+	peerserv_prune();
+
+	list_for_each_entry ( tmp, &peerserv_contents, list ) {
+		if ( tmp->info.digestsize != digestsize )
+			continue;
+		for ( i = 0 ; i < tmp->info.segments ; i++ ) {
+			if ( memcmp ( tmp->segment[i].id, id,
+				      digestsize ) == 0 ) {
+				*content = tmp;
+				return &tmp->segment[i];
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Find image holding served content
+ *
+ * @v content		Served content
+ * @ret image		Image, or NULL if not found
+ *
+ * The content is added when its download completes, before the image
+ * holding it has been registered.  The image is therefore identified
+ * by its URI and length on first use, and is then retained (and
+ * compared by pointer) so that a different image subsequently
+ * downloaded from the same URI can never be served in its place.
+ */
+static struct image * peerserv_image ( struct peerserv_content *content ) {
+	size_t len = ( content->info.trim.end - content->info.trim.start );
+	struct image *image;
+	struct image *found = NULL;
+	char *uri;
+
+	/* Use previously identified image, if still available */
+	if ( content->image ) {
+		image = content->image;
+		if ( ( image->flags & IMAGE_REGISTERED ) &&
+		     ( image->len == len ) )
+			return image;
+		return NULL;
+	}
+
+	/* Identify most recently registered matching image */
+	for_each_image ( image ) {
+		if ( ( ! image->uri ) || ( image->len != len ) )
+			continue;
+		uri = format_uri_alloc ( image->uri );
+		if ( ! uri )
+			continue;
+		if ( strcmp ( uri, content->uri ) == 0 )
+			found = image;
+		free ( uri );
+	}
+	if ( ! found )
+		return NULL;
+
+	/* Retain image */
+	content->image = image_get ( found );
+	DBGC ( &peerserv_contents, "PEERSERV serving %s from %s\n",
+	       content->uri, found->name );
+	return found;
+}
+
+/**
+ * Describe servable blocks within a segment
+ *
+ * @v info		Content information
+ * @v index		Segment index
+ * @v segment		Served segment to fill in
+ * @ret rc		Return status code
+ *
+ * Only blocks lying entirely within the trimmed content range can be
+ * served, since we do not hold the data outside this range.  Only the
+ * first and last blocks of the content can be partially trimmed, and
+ * so the servable blocks within each segment are always contiguous.
+ */
+static int peerserv_describe ( const struct peerdist_info *info,
+			       unsigned int index,
+			       struct peerserv_segment *segment ) {
+	struct peerdist_info_segment seg;
+	struct peerdist_info_block block;
+	unsigned int i;
+	int rc;
+
+	/* Get content information segment */
+	if ( ( rc = peerdist_info_segment ( info, &seg, index ) ) != 0 )
+		return rc;
+	memcpy ( segment->id, seg.id, sizeof ( segment->id ) );
+
+	/* Identify servable blocks */
+	for ( i = 0 ; i < seg.blocks ; i++ ) {
+		if ( ( rc = peerdist_info_block ( &seg, &block, i ) ) != 0 )
+			return rc;
+		if ( ( block.trim.start != block.range.start ) ||
+		     ( block.trim.end != block.range.end ) ) {
+			continue;
+		}
+		if ( ! segment->count )
+			segment->first = i;
+		segment->count++;
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ *
+ * Retrieval protocol
+ *
+ ******************************************************************************
+ */
+
+/** A retrieval protocol response */
+struct peerserv_response {
+	/** Response data (including transport header) */
+	void *data;
+	/** Length of response data */
+	size_t len;
+};
+
+/**
+ * Allocate retrieval protocol response
+ *
+ * @v rsp		Retrieval protocol response
+ * @v len		Length of message
+ * @v type		Message type
+ * @v version		Message version
+ * @v algorithm		Cryptographic algorithm ID
+ * @ret msg		Message header, or NULL on error
+ */
+static struct peerdist_msg_header *
+peerserv_alloc ( struct peerserv_response *rsp, size_t len, uint32_t type,
+		 uint32_t version, uint32_t algorithm ) {
+	struct peerdist_msg_transport_header *transport;
+	struct peerdist_msg_header *msg;
+
+	/* Allocate response */
+	rsp->len = ( sizeof ( *transport ) + len );
+	rsp->data = zalloc ( rsp->len );
+	if ( ! rsp->data )
+		return NULL;
+
+	/* Populate headers */
+	transport = rsp->data;
+	transport->len = htonl ( len );
+	msg = ( ( ( void * ) transport ) + sizeof ( *transport ) );
+	msg->version.raw = htonl ( version );
+	msg->type = htonl ( type );
+	msg->len = htonl ( len );
+	msg->algorithm = htonl ( algorithm );
+
+	return msg;
+}
+
+/**
+ * Handle retrieval protocol negotiation request
+ *
+ * @v req		Request message
+ * @v len		Length of request message
+ * @v rsp		Response to fill in
+ * @ret rc		Return status code
+ */
+static int peerserv_nego ( const void *req __unused, size_t len __unused,
+			   struct peerserv_response *rsp ) {
+	struct peerdist_msg_nego_resp *nego;
+
+	/* Construct response */
+	nego = ( ( struct peerdist_msg_nego_resp * )
+		 peerserv_alloc ( rsp, sizeof ( *nego ),
+				  PEERDIST_MSG_NEGO_RESP_TYPE,
+				  PEERDIST_MSG_NEGO_RESP_VERSION,
+				  PEERDIST_MSG_PLAINTEXT ) );
+	if ( ! nego )
+		return -ENOMEM;
+	nego->versions.min.raw = htonl ( PEERDIST_MSG_VERSION_1_0 );
+	nego->versions.max.raw = htonl ( PEERDIST_MSG_VERSION_1_0 );
+
+	return 0;
+}
+
+/**
+ * Parse retrieval protocol segment and block range
+ *
+ * @v req		Request message
+ * @v len		Length of request message
+ * @v content		Served content to fill in
+ * @v range		First requested block range to fill in
+ * @ret segment		Served segment, or NULL if not found
+ *
+ * The block list and block fetch requests share a common prefix
+ * comprising a segment identifier followed by a block range list.
+ */
+static struct peerserv_segment *
+peerserv_parse ( const void *req, size_t len,
+		 struct peerserv_content **content,
+		 struct peerdist_msg_range *range ) {
+	const struct {
+		struct peerdist_msg_header hdr;
+		struct peerdist_msg_segment segment;
+	} __attribute__ (( packed )) *prefix = req;
+	size_t digestsize;
+
+	/* Extract digest size */
+	if ( len < sizeof ( *prefix ) )
+		return NULL;
+	digestsize = ntohl ( prefix->segment.digestsize );
+	if ( digestsize > PEERDIST_DIGEST_MAX_SIZE )
+		return NULL;
+
+	/* Parse segment identifier and first block range */
+	{
+		const peerdist_msg_getblklist_t ( digestsize, 1 ) *msg = req;
+
+		if ( len < sizeof ( *msg ) )
+			return NULL;
+		if ( ! msg->ranges.ranges.count )
+			return NULL;
+		range->first = ntohl ( msg->ranges.range[0].first );
+		range->count = ntohl ( msg->ranges.range[0].count );
+		return peerserv_find ( msg->segment.id, digestsize, content );
+	}
+}
+
+/**
+ * Handle retrieval protocol block list request
+ *
+ * @v req		Request message
+ * @v len		Length of request message
+ * @v rsp		Response to fill in
+ * @ret rc		Return status code
+ */
+static int peerserv_getblklist ( const void *req, size_t len,
+				 struct peerserv_response *rsp ) {
+	struct peerserv_content *content;
+	struct peerserv_segment *segment;
+	struct peerdist_msg_range range;
+	size_t digestsize;
+	unsigned int count;
+
+	/* Identify segment */
+	segment = peerserv_parse ( req, len, &content, &range );
+	if ( ! segment )
+		return -ENOENT;
+	digestsize = content->info.digestsize;
+	count = ( segment->count ? 1 : 0 );
+
+	/* Construct response */
+	{
+		peerdist_msg_blklist_t ( digestsize, count ) *blklist;
+
+		blklist = ( ( void * )
+			    peerserv_alloc ( rsp, sizeof ( *blklist ),
+					     PEERDIST_MSG_BLKLIST_TYPE,
+					     PEERDIST_MSG_BLKLIST_VERSION,
+					     PEERDIST_MSG_PLAINTEXT ) );
+		if ( ! blklist )
+			return -ENOMEM;
+		blklist->segment.segment.digestsize = htonl ( digestsize );
+		memcpy ( blklist->segment.id, segment->id, digestsize );
+		blklist->ranges.ranges.count = htonl ( count );
+		if ( count ) {
+			blklist->ranges.range[0].first =
+				htonl ( segment->first );
+			blklist->ranges.range[0].count =
+				htonl ( segment->count );
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Handle retrieval protocol block fetch request
+ *
+ * @v req		Request message
+ * @v len		Length of request message
+ * @v rsp		Response to fill in
+ * @ret rc		Return status code
+ *
+ * Only the first block of the first requested range is returned.
+ * A zero-length data block is returned if the block is not
+ * available.
+ */
+static int peerserv_getblks ( const void *req, size_t len,
+			      struct peerserv_response *rsp ) {
+	const struct peerdist_msg_header *hdr = req;
+	struct peerdist_info_segment seg;
+	struct peerdist_info_block block;
+	struct peerserv_content *content;
+	struct peerserv_segment *segment;
+	struct peerdist_msg_range range;
+	struct cipher_algorithm *cipher;
+	struct image *image = NULL;
+	uint32_t algorithm;
+	size_t digestsize;
+	size_t keylen = 0;
+	size_t blksize;
+	size_t data_len = 0;
+	size_t block_len = 0;
+	unsigned int next = 0;
+	unsigned int i;
+	int rc;
+
+	/* Identify segment */
+	segment = peerserv_parse ( req, len, &content, &range );
+	if ( ! segment )
+		return -ENOENT;
+	digestsize = content->info.digestsize;
+
+	/* Determine cipher algorithm and key length */
+	algorithm = ntohl ( hdr->algorithm );
+	cipher = &aes_cbc_algorithm;
+	switch ( algorithm ) {
+	case PEERDIST_MSG_PLAINTEXT:
+		cipher = NULL;
+		break;
+	case PEERDIST_MSG_AES_128_CBC:
+		keylen = ( 128 / 8 );
+		break;
+	case PEERDIST_MSG_AES_192_CBC:
+		keylen = ( 192 / 8 );
+		break;
+	case PEERDIST_MSG_AES_256_CBC:
+		keylen = ( 256 / 8 );
+		break;
+	default:
+		return -ENOTSUP;
+	}
+	if ( keylen > digestsize )
+		return -ENOTSUP;
+	blksize = ( cipher ? cipher->blocksize : 0 );
+
+	/* Identify block, if available */
+	if ( ( range.first >= segment->first ) &&
+	     ( range.first < ( segment->first + segment->count ) ) &&
+	     ( ( image = peerserv_image ( content ) ) != NULL ) ) {
+		if ( ( rc = peerdist_info_segment ( &content->info, &seg,
+				( segment - content->segment ) ) ) != 0 )
+			return rc;
+		if ( ( rc = peerdist_info_block ( &seg, &block,
+						  range.first ) ) != 0 )
+			return rc;
+		data_len = ( block.range.end - block.range.start );
+		block_len = data_len;
+		if ( blksize ) {
+			block_len = ( ( block_len + blksize - 1 ) &
+				      ~( blksize - 1 ) );
+		}
+		if ( ( range.first + 1 ) < ( segment->first + segment->count ))
+			next = ( range.first + 1 );
+	}
+
+	/* Construct response */
+	{
+		peerdist_msg_blk_t ( digestsize, block_len, 0, blksize ) *blk;
+		void *cipherctx;
+
+		blk = ( ( void * )
+			peerserv_alloc ( rsp, sizeof ( *blk ),
+					 PEERDIST_MSG_BLK_TYPE,
+					 PEERDIST_MSG_BLK_VERSION,
+					 algorithm ) );
+		if ( ! blk )
+			return -ENOMEM;
+		blk->segment.segment.digestsize = htonl ( digestsize );
+		memcpy ( blk->segment.id, segment->id, digestsize );
+		blk->index = htonl ( range.first );
+		blk->next = htonl ( next );
+		blk->block.block.len = htonl ( block_len );
+		blk->iv.iv.blksize = htonl ( blksize );
+		if ( ! data_len )
+			return 0;
+
+		/* Copy block data */
+		memcpy ( blk->block.data,
+			 ( image->data + block.range.start -
+			   content->info.trim.start ), data_len );
+
+		/* Encrypt block data, if applicable */
+		if ( cipher ) {
+			cipherctx = malloc ( cipher->ctxsize );
+			if ( ! cipherctx ) {
+				rc = -ENOMEM;
+				goto err_cipherctx;
+			}
+			if ( ( rc = cipher_setkey ( cipher, cipherctx,
+						    seg.secret,
+						    keylen ) ) != 0 ) {
+				goto err_setkey;
+			}
+
+			/* Generate a random initialisation vector.
+			 * The content secret is derivable from the
+			 * content itself, so this does not require
+			 * high quality randomness.
+			 */
+			for ( i = 0 ; i < blksize ; i++ )
+				blk->iv.data[i] = random();
+			cipher_setiv ( cipher, cipherctx, blk->iv.data,
+				       blksize );
+			cipher_encrypt ( cipher, cipherctx, blk->block.data,
+					 blk->block.data, block_len );
+			free ( cipherctx );
+		}
+		return 0;
+
+	err_setkey:
+		free ( cipherctx );
+	err_cipherctx:
+		free ( rsp->data );
+		rsp->data = NULL;
+		return rc;
+	}
+}
+
+/**
+ * Handle retrieval protocol request
+ *
+ * @v req		Request message
+ * @v len		Length of request message
+ * @v rsp		Response to fill in
+ * @ret rc		Return status code
+ */
+static int peerserv_request ( const void *req, size_t len,
+			      struct peerserv_response *rsp ) {
+	const struct peerdist_msg_header *hdr = req;
+
+	/* Sanity check */
+	if ( ( len < sizeof ( *hdr ) ) || ( ntohl ( hdr->len ) > len ) )
+		return -EINVAL;
+	len = ntohl ( hdr->len );
+
+	/* Handle request */
+	switch ( ntohl ( hdr->type ) ) {
+	case PEERDIST_MSG_NEGO_REQ_TYPE:
+		return peerserv_nego ( req, len, rsp );
+	case PEERDIST_MSG_GETBLKLIST_TYPE:
+		return peerserv_getblklist ( req, len, rsp );
+	case PEERDIST_MSG_GETBLKS_TYPE:
+		return peerserv_getblks ( req, len, rsp );
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/******************************************************************************
+ *
+ * HTTP connections
+ *
+ ******************************************************************************
+ */
+
+/** A PeerDist content server connection */
+struct peerserv_connection {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Received request */
+	struct xfer_buffer buffer;
+	/** Length of request headers (or zero if not yet received) */
+	size_t hdr_len;
+	/** Length of request content */
+	size_t content_len;
+};
+
+/**
+ * Free PeerDist content server connection
+ *
+ * @v refcnt		Reference count
+ */
+static void peerserv_conn_free ( struct refcnt *refcnt ) {
+	struct peerserv_connection *conn =
+		container_of ( refcnt, struct peerserv_connection, refcnt );
+
+	xferbuf_free ( &conn->buffer );
+	free ( conn );
+}
+
+/**
+ * Close PeerDist content server connection
+ *
+ * @v conn		Connection
+ * @v rc		Reason for close
+ */
+static void peerserv_conn_close ( struct peerserv_connection *conn, int rc ) {
+
+	intf_shutdown ( &conn->xfer, rc );
+}
+
+/**
+ * Send HTTP response and close connection
+ *
+ * @v conn		Connection
+ * @v status		HTTP status line
+ * @v rsp		Retrieval protocol response, or NULL
+ */
+static void peerserv_conn_respond ( struct peerserv_connection *conn,
+				    const char *status,
+				    struct peerserv_response *rsp ) {
+	struct io_buffer *iobuf;
+	size_t len = ( rsp ? rsp->len : 0 );
+	size_t hdr_len;
+	int rc;
+
+	/* Allocate I/O buffer */
+	hdr_len = snprintf ( NULL, 0, "HTTP/1.1 %s\r\nContent-Length: %zd\r\n"
+			     "Connection: close\r\n\r\n", status, len );
+	iobuf = xfer_alloc_iob ( &conn->xfer, ( hdr_len + 1 /* NUL */ +
+						len ) );
+	if ( ! iobuf ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+
+	/* Construct response */
+	snprintf ( iob_put ( iobuf, hdr_len ), ( hdr_len + 1 /* NUL */ ),
+		   "HTTP/1.1 %s\r\nContent-Length: %zd\r\n"
+		   "Connection: close\r\n\r\n", status, len );
+	if ( len )
+		memcpy ( iob_put ( iobuf, len ), rsp->data, len );
+
+	/* Send response */
+	if ( ( rc = xfer_deliver_iob ( &conn->xfer, iobuf ) ) != 0 )
+		goto err_deliver;
+
+ err_deliver:
+ err_alloc:
+	peerserv_conn_close ( conn, rc );
+}
+
+/**
+ * Parse HTTP request headers
+ *
+ * @v data		Received request (will be modified)
+ * @v len		Length of received request
+ * @ret hdr_len		Length of request headers
+ * @ret content_len	Length of request content
+ * @ret rc		Return status code
+ *
+ * Returns -EINPROGRESS if the request headers are not yet complete,
+ * or -ENOENT if the request is not a retrieval protocol request.
+ */
+int peerserv_parse_headers ( char *data, size_t len, size_t *hdr_len,
+			     size_t *content_len ) {
+	size_t headers_len;
+	char *method;
+	char *path;
+	char *line;
+	char *next;
+	char *sep;
+
+	/* Find end of headers */
+	for ( headers_len = 4 ; headers_len <= len ; headers_len++ ) {
+		if ( memcmp ( &data[ headers_len - 4 ], "\r\n\r\n", 4 ) == 0 )
+			break;
+	}
+	if ( headers_len > len )
+		return -EINPROGRESS;
+
+	/* Reject headers containing NULs, which would otherwise
+	 * truncate the lines that we parse
+	 */
+	if ( memchr ( data, '\0', headers_len ) != NULL )
+		return -EINVAL;
+
+	/* Terminate headers (leaving a trailing CRLF) */
+	data[ headers_len - 2 ] = '\0';
+
+	/* Parse request line */
+	method = data;
+	next = strchr ( method, '\r' );
+	if ( ! next )
+		return -EINVAL;
+	*next = '\0';
+	path = strchr ( method, ' ' );
+	if ( ! path )
+		return -EINVAL;
+	*(path++) = '\0';
+	sep = strchr ( path, ' ' );
+	if ( sep )
+		*sep = '\0';
+	if ( ( strcmp ( method, "POST" ) != 0 ) ||
+	     ( strcmp ( path, PEERDIST_MAGIC_PATH ) != 0 ) )
+		return -ENOENT;
+
+	/* Parse headers */
+	*content_len = 0;
+	for ( line = ( next + 2 ) ; *line ; line = ( next + 2 ) ) {
+		next = strchr ( line, '\r' );
+		if ( ! next )
+			return -EINVAL;
+		*next = '\0';
+		sep = strchr ( line, ':' );
+		if ( ! sep )
+			continue;
+		*(sep++) = '\0';
+		if ( strcasecmp ( line, "Content-Length" ) == 0 )
+			*content_len = strtoul ( sep, NULL, 10 );
+	}
+	if ( *content_len > ( PEERSERV_MAX_REQUEST - headers_len ) )
+		return -EINVAL;
+
+	*hdr_len = headers_len;
+	return 0;
+}
+
+/**
+ * Parse HTTP request
+ *
+ * @v conn		Connection
+ * @ret rc		Return status code
+ *
+ * Returns -EINPROGRESS if the request is not yet complete.
+ */
+static int peerserv_conn_parse ( struct peerserv_connection *conn ) {
+	struct peerserv_response rsp;
+	char *data = conn->buffer.data;
+	size_t len = conn->buffer.len;
+	int rc;
+
+	/* Parse request line and headers, if not already done */
+	if ( ! conn->hdr_len ) {
+		rc = peerserv_parse_headers ( data, len, &conn->hdr_len,
+					      &conn->content_len );
+		if ( rc == -EINPROGRESS )
+			return rc;
+		if ( rc != 0 ) {
+			DBGC ( conn, "PEERSERV %p rejected request: %s\n",
+			       conn, strerror ( rc ) );
+			peerserv_conn_respond ( conn, ( ( rc == -ENOENT ) ?
+							"404 Not Found" :
+							"400 Bad Request" ),
+						NULL );
+			return 0;
+		}
+	}
+
+	/* Wait for remainder of request */
+	if ( len < ( conn->hdr_len + conn->content_len ) )
+		return -EINPROGRESS;
+
+	/* Handle retrieval protocol request */
+	if ( ( rc = peerserv_request ( ( data + conn->hdr_len ),
+				       conn->content_len, &rsp ) ) != 0 ) {
+		DBGC ( conn, "PEERSERV %p could not handle request: %s\n",
+		       conn, strerror ( rc ) );
+		peerserv_conn_respond ( conn, ( ( rc == -ENOENT ) ?
+						"404 Not Found" :
+						"400 Bad Request" ), NULL );
+		return 0;
+	}
+	peerserv_conn_respond ( conn, "200 OK", &rsp );
+	free ( rsp.data );
+	return 0;
+}
+
+/**
+ * Receive data on PeerDist content server connection
+ *
+ * @v conn		Connection
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int peerserv_conn_deliver ( struct peerserv_connection *conn,
+				   struct io_buffer *iobuf,
+				   struct xfer_metadata *meta ) {
+	int rc;
+
+	/* Reject overlength requests */
+	if ( ( conn->buffer.len + iob_len ( iobuf ) ) > PEERSERV_MAX_REQUEST ){
+		free_iob ( iobuf );
+		rc = -ERANGE;
+		goto err;
+	}
+
+	/* Add data to buffer */
+	if ( ( rc = xferbuf_deliver ( &conn->buffer, iobuf, meta ) ) != 0 )
+		goto err;
+
+	/* Parse request, if complete */
+	if ( ( rc = peerserv_conn_parse ( conn ) ) == -EINPROGRESS )
+		return 0;
+
+	return rc;
+
+ err:
+	DBGC ( conn, "PEERSERV %p could not receive: %s\n",
+	       conn, strerror ( rc ) );
+	peerserv_conn_close ( conn, rc );
+	return rc;
+}
+
+/** PeerDist content server connection interface operations */
+static struct interface_operation peerserv_conn_operations[] = {
+	INTF_OP ( xfer_deliver, struct peerserv_connection *,
+		  peerserv_conn_deliver ),
+	INTF_OP ( intf_close, struct peerserv_connection *,
+		  peerserv_conn_close ),
+};
+
+/** PeerDist content server connection interface descriptor */
+static struct interface_descriptor peerserv_conn_desc =
+	INTF_DESC ( struct peerserv_connection, xfer,
+		    peerserv_conn_operations );
+
+/**
+ * Accept PeerDist content server connection
+ *
+ * @v listener		TCP listening port
+ * @v xfer		Data transfer interface for new connection
+ * @v peer		Peer socket address
+ * @ret rc		Return status code
+ */
+static int peerserv_accept ( struct tcp_listener *listener __unused,
+			     struct interface *xfer,
+			     struct sockaddr_tcpip *peer ) {
+	struct peerserv_connection *conn;
+
+	/* Allocate and initialise structure */
+	conn = zalloc ( sizeof ( *conn ) );
+	if ( ! conn )
+		return -ENOMEM;
+	ref_init ( &conn->refcnt, peerserv_conn_free );
+	intf_init ( &conn->xfer, &peerserv_conn_desc, &conn->refcnt );
+	xferbuf_malloc_init ( &conn->buffer );
+	DBGC ( conn, "PEERSERV %p accepted connection from %s\n",
+	       conn, sock_ntoa ( ( struct sockaddr * ) peer ) );
+
+	/* Attach to TCP connection and mortalise self */
+	intf_plug_plug ( &conn->xfer, xfer );
+	ref_put ( &conn->refcnt );
+
+	return 0;
+}
+
+/** PeerDist content server TCP listener */
+static struct tcp_listener peerserv_listener = {
+	.port = PEERSERV_PORT,
+	.max = PEERSERV_MAX_CONNECTIONS,
+	.accept = peerserv_accept,
+};
+
+/******************************************************************************
+ *
+ * Discovery protocol
+ *
+ ******************************************************************************
+ */
+
+/** PeerDist content server discovery socket */
+static struct interface peerserv_socket;
+
+/**
+ * Receive discovery request
+ *
+ * @v socket		Discovery socket
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int peerserv_socket_rx ( struct interface *socket,
+				struct io_buffer *iobuf,
+				struct xfer_metadata *meta ) {
+	struct sockaddr_in *sin_src = ( ( struct sockaddr_in * ) meta->src );
+	struct peerdist_discovery_probe probe;
+	struct peerserv_content *content;
+	struct peerserv_segment *segment;
+	struct ipv4_miniroute *miniroute;
+	struct xfer_metadata reply_meta;
+	struct io_buffer *reply;
+	union {
+		union uuid uuid;
+		uint32_t dword[ sizeof ( union uuid ) / sizeof ( uint32_t ) ];
+	} random_uuid;
+	uint8_t raw[PEERDIST_DIGEST_MAX_SIZE];
+	char location[ sizeof ( "255.255.255.255:65535" ) ];
+	unsigned int *counts;
+	unsigned int count = 0;
+	unsigned int i;
+	char *response;
+	char *ids;
+	char *id;
+	char *match;
+	int raw_len;
+	int rc;
+
+	/* Parse probe */
+	if ( ( rc = peerdist_discovery_probe ( iobuf->data, iob_len ( iobuf ),
+					       &probe ) ) != 0 )
+		goto err_probe;
+
+	/* Identify local address */
+	if ( ( ! sin_src ) || ( sin_src->sin_family != AF_INET ) ) {
+		rc = -ENOTSUP;
+		goto err_src;
+	}
+	miniroute = ipv4_route ( 0, &sin_src->sin_addr );
+	if ( ! miniroute ) {
+		rc = -ENETUNREACH;
+		goto err_route;
+	}
+	snprintf ( location, sizeof ( location ), "%s:%d",
+		   inet_ntoa ( miniroute->address ), PEERSERV_PORT );
+
+	/* Allocate list of matching block counts and segment IDs
+	 * (placing the counts first to ensure correct alignment)
+	 */
+	for ( id = probe.ids ; *id ; id += ( strlen ( id ) + 1 /* NUL */ ) )
+		count++;
+	counts = zalloc ( ( count * sizeof ( counts[0] ) ) +
+			  ( id - probe.ids ) + 1 /* NUL */ );
+	if ( ! counts ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	ids = ( ( char * ) ( counts + count ) );
+
+	/* Identify segments for which we hold blocks */
+	match = ids;
+	count = 0;
+	for ( id = probe.ids ; *id ; id += ( strlen ( id ) + 1 /* NUL */ ) ) {
+		raw_len = base16_decode ( id, raw, sizeof ( raw ) );
+		if ( raw_len < 0 )
+			continue;
+		segment = peerserv_find ( raw, raw_len, &content );
+		if ( ( ! segment ) || ( ! segment->count ) )
+			continue;
+		strcpy ( match, id );
+		match += ( strlen ( match ) + 1 /* NUL */ );
+		counts[count++] = segment->count;
+	}
+	if ( ! count ) {
+		rc = 0;
+		goto no_match;
+	}
+
+	/* Construct response */
+	for ( i = 0 ; i < ( sizeof ( random_uuid.dword ) /
+			    sizeof ( random_uuid.dword[0] ) ) ; i++ )
+		random_uuid.dword[i] = random();
+	response = peerdist_discovery_response ( uuid_ntoa ( &random_uuid.uuid ),
+						 probe.id, peerserv_endpoint,
+						 ids, counts, location );
+	if ( ! response ) {
+		rc = -ENOMEM;
+		goto err_response;
+	}
+	DBGC ( &peerserv_contents, "PEERSERV replying to %s from %s\n",
+	       probe.id, location );
+
+	/* Send response */
+	reply = xfer_alloc_iob ( socket, strlen ( response ) );
+	if ( ! reply ) {
+		rc = -ENOMEM;
+		goto err_reply;
+	}
+	memcpy ( iob_put ( reply, strlen ( response ) ), response,
+		 strlen ( response ) );
+	memset ( &reply_meta, 0, sizeof ( reply_meta ) );
+	reply_meta.dest = meta->src;
+	if ( ( rc = xfer_deliver ( socket, iob_disown ( reply ),
+				   &reply_meta ) ) != 0 ) {
+		DBGC ( &peerserv_contents, "PEERSERV could not reply: %s\n",
+		       strerror ( rc ) );
+		goto err_deliver;
+	}
+
+ err_deliver:
+ err_reply:
+	free ( response );
+ err_response:
+ no_match:
+	free ( counts );
+ err_alloc:
+ err_route:
+ err_src:
+ err_probe:
+	free_iob ( iobuf );
+	return rc;
+}
+
+/** PeerDist content server discovery socket interface operations */
+static struct interface_operation peerserv_socket_operations[] = {
+	INTF_OP ( xfer_deliver, struct interface *, peerserv_socket_rx ),
+};
+
+/** PeerDist content server discovery socket interface descriptor */
+static struct interface_descriptor peerserv_socket_desc =
+	INTF_DESC_PURE ( peerserv_socket_operations );
+
+/** PeerDist content server discovery socket */
+static struct interface peerserv_socket =
+	INTF_INIT ( peerserv_socket_desc );
+
+/******************************************************************************
+ *
+ * Server activation
+ *
+ ******************************************************************************
+ */
+
+/**
+ * Start PeerDist content server
+ *
+ * @ret rc		Return status code
+ */
+static int peerserv_start ( void ) {
+	static struct sockaddr_in peer = {
+		.sin_family = AF_INET,
+		.sin_port = htons ( PEERDIST_DISCOVERY_PORT ),
+		.sin_addr.s_addr = htonl ( PEERDIST_DISCOVERY_IPV4 ),
+	};
+	static struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons ( PEERDIST_DISCOVERY_PORT ),
+	};
+	union {
+		union uuid uuid;
+		uint32_t dword[ sizeof ( union uuid ) / sizeof ( uint32_t ) ];
+	} random_uuid;
+	unsigned int i;
+	int rc;
+
+	/* Do nothing if already active */
+	if ( peerserv_active )
+		return 0;
+
+	/* Generate endpoint UUID */
+	for ( i = 0 ; i < ( sizeof ( random_uuid.dword ) /
+			    sizeof ( random_uuid.dword[0] ) ) ; i++ )
+		random_uuid.dword[i] = random();
+	snprintf ( peerserv_endpoint, sizeof ( peerserv_endpoint ), "%s",
+		   uuid_ntoa ( &random_uuid.uuid ) );
+
+	/* Open discovery socket */
+	if ( ( rc = xfer_open_socket ( &peerserv_socket, SOCK_DGRAM,
+				       ( struct sockaddr * ) &peer,
+				       ( struct sockaddr * ) &local ) ) != 0 ) {
+		DBGC ( &peerserv_contents, "PEERSERV could not open discovery "
+		       "socket: %s\n", strerror ( rc ) );
+		goto err_socket;
+	}
+
+	/* Listen for retrieval connections */
+	if ( ( rc = tcp_listen ( &peerserv_listener ) ) != 0 ) {
+		DBGC ( &peerserv_contents, "PEERSERV could not listen: %s\n",
+		       strerror ( rc ) );
+		goto err_listen;
+	}
+
+	DBGC ( &peerserv_contents, "PEERSERV started as endpoint %s\n",
+	       peerserv_endpoint );
+	peerserv_active = 1;
+	return 0;
+
+ err_listen:
+	intf_restart ( &peerserv_socket, rc );
+ err_socket:
+	return rc;
+}
+
+/**
+ * Stop PeerDist content server
+ *
+ */
+static void peerserv_stop ( void ) {
+
+	/* Do nothing if not active */
+	if ( ! peerserv_active )
+		return;
+
+	/* Close discovery socket and stop listening */
+	tcp_unlisten ( &peerserv_listener );
+	intf_restart ( &peerserv_socket, 0 );
+	peerserv_active = 0;
+	DBGC ( &peerserv_contents, "PEERSERV stopped\n" );
+}
+
+/**
+ * Add content to PeerDist content server
+ *
+ * @v uri		Original URI
+ * @v data		Content information
+ * @v len		Length of content information
+ * @ret rc		Return status code
+ *
+ * The content itself will be served from the image downloaded from
+ * the original URI, for as long as that image remains registered.
+ */
+int peerserv_add ( struct uri *uri, const void *data, size_t len ) {
+	struct peerserv_content *content;
+	struct peerserv_content *tmp;
+	void *raw;
+	unsigned int i;
+	int rc;
+
+	/* Do nothing if disabled */
+	if ( ! peerserv_enabled )
+		return 0;
+
+	/* Allocate and initialise structure */
+	content = zalloc ( sizeof ( *content ) + len );
+	if ( ! content ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	INIT_LIST_HEAD ( &content->list );
+	raw = ( ( ( void * ) content ) + sizeof ( *content ) );
+	memcpy ( raw, data, len );
+	content->uri = format_uri_alloc ( uri );
+	if ( ! content->uri ) {
+		rc = -ENOMEM;
+		goto err_uri;
+	}
+
+	/* Parse content information */
+	if ( ( rc = peerdist_info ( raw, len, &content->info ) ) != 0 )
+		goto err_info;
+	content->segment = zalloc ( content->info.segments *
+				    sizeof ( content->segment[0] ) );
+	if ( ! content->segment ) {
+		rc = -ENOMEM;
+		goto err_segment;
+	}
+	for ( i = 0 ; i < content->info.segments ; i++ ) {
+		if ( ( rc = peerserv_describe ( &content->info, i,
+						&content->segment[i] ) ) != 0 )
+			goto err_describe;
+	}
+
+	/* Start server, if applicable */
+	if ( ( rc = peerserv_start() ) != 0 )
+		goto err_start;
+
+	/* Discard any contents that can no longer be served */
+	peerserv_prune();
+
+	/* Replace any existing content for the same URI */
+	list_for_each_entry ( tmp, &peerserv_contents, list ) {
+		if ( strcmp ( tmp->uri, content->uri ) == 0 ) {
+			peerserv_free ( tmp );
+			break;
+		}
+	}
+
+	/* Add to list of served contents */
+	list_add ( &content->list, &peerserv_contents );
+	DBGC ( &peerserv_contents, "PEERSERV serving %d segments of %s\n",
+	       content->info.segments, content->uri );
+
+	return 0;
+
+ err_start:
+ err_describe:
+ err_segment:
+ err_info:
+ err_uri:
+	peerserv_free ( content );
+ err_alloc:
+	DBGC ( &peerserv_contents, "PEERSERV could not serve content: %s\n",
+	       strerror ( rc ) );
+	return rc;
+}
+
+/******************************************************************************
+ *
+ * Settings
+ *
+ ******************************************************************************
+ */
+
+/** PeerDist content server enabled setting */
+const struct setting peerserve_setting __setting ( SETTING_MISC, peerserve ) = {
+	.name = "peerserve",
+	.description = "PeerDist content serving enabled",
+	.type = &setting_type_int8,
+};
+
+/**
+ * Apply PeerDist content server settings
+ *
+ * @ret rc		Return status code
+ */
+static int apply_peerserv_settings ( void ) {
+	struct peerserv_content *content;
+	struct peerserv_content *tmp;
+
+	/* Fetch PeerDist content server enabled setting.  Serving
+	 * content to other peers must be explicitly enabled.
+	 */
+	if ( fetch_int_setting ( NULL, &peerserve_setting,
+				 &peerserv_enabled ) < 0 ) {
+		peerserv_enabled = 0;
+	}
+
+	/* Stop serving and discard all contents if disabled */
+	if ( ! peerserv_enabled ) {
+		peerserv_stop();
+		list_for_each_entry_safe ( content, tmp, &peerserv_contents,
+					   list ) {
+			peerserv_free ( content );
+		}
+	}
+
+	return 0;
+}
+
+/** PeerDist content server settings applicator */
+struct settings_applicator peerserv_applicator __settings_applicator = {
+	.apply = apply_peerserv_settings,
+};
@@ -20,6 +20,7 @@
 #include <ipxe/job.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/tcp.h>
+#include <ipxe/trace.h>
 
 /** @file
  *
@@ -135,6 +136,10 @@ enum tcp_flags {
 	TCP_ACK_PENDING = 0x0004,
 	/** TCP selective acknowledgement is enabled */
 	TCP_SACK_ENABLED = 0x0008,
+	/** TCP segmentation offload is enabled */
+	TCP_TSO_ENABLED = 0x0010,
+	/** TCP connection was accepted from a listening port */
+	TCP_PASSIVE = 0x0020,
 };
 
 /** TCP internal header
@@ -167,6 +172,11 @@ struct tcp_rx_queued_header {
  */
 static LIST_HEAD ( tcp_conns );
 
+/**
+ * List of TCP listening ports
+ */
+static LIST_HEAD ( tcp_listeners );
+
 /** Transmit profiler */
 static struct profiler tcp_tx_profiler __profiler = { .name = "tcp.tx" };
 
@@ -182,7 +192,9 @@ static struct interface_descriptor tcp_xfer_desc;
 static void tcp_expired ( struct retry_timer *timer, int over );
 static void tcp_keepalive_expired ( struct retry_timer *timer, int over );
 static void tcp_wait_expired ( struct retry_timer *timer, int over );
-static struct tcp_connection * tcp_demux ( unsigned int local_port );
+static void tcp_close ( struct tcp_connection *tcp, int rc );
+static struct tcp_connection * tcp_demux ( unsigned int local_port,
+					   struct sockaddr_tcpip *peer );
 static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 			uint32_t win );
 
@@ -258,26 +270,60 @@ tcp_dump_flags ( struct tcp_connection *tcp, unsigned int flags ) {
  * @ret port		Local port number, or negative error
  */
 static int tcp_port_available ( int port ) {
+	struct tcp_listener *listener;
+
+	/* Check for listening ports */
+	list_for_each_entry ( listener, &tcp_listeners, list ) {
+		if ( listener->port == ( unsigned int ) port )
+			return -EADDRINUSE;
+	}
 
-	return ( tcp_demux ( port ) ? -EADDRINUSE : port );
+	return ( tcp_demux ( port, NULL ) ? -EADDRINUSE : port );
 }
 
 /**
- * Open a TCP connection
+ * Check if local TCP port is available for listening
  *
- * @v xfer		Data transfer interface
- * @v peer		Peer socket address
- * @v local		Local socket address, or NULL
+ * @v port		Local port number
  * @ret rc		Return status code
+ *
+ * Connections in TIME_WAIT (such as those previously accepted from a
+ * listening port that has since been closed) do not prevent a new
+ * listening port from being opened, since any new connections will be
+ * distinguished from them by the peer socket address.
  */
-static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
-		      struct sockaddr *local ) {
-	struct sockaddr_tcpip *st_peer = ( struct sockaddr_tcpip * ) peer;
-	struct sockaddr_tcpip *st_local = ( struct sockaddr_tcpip * ) local;
+static int tcp_port_listenable ( unsigned int port ) {
+	struct tcp_listener *listener;
 	struct tcp_connection *tcp;
+
+	/* Check for listening ports */
+	list_for_each_entry ( listener, &tcp_listeners, list ) {
+		if ( listener->port == port )
+			return -EADDRINUSE;
+	}
+
+	/* Check for connections not in TIME_WAIT */
+	list_for_each_entry ( tcp, &tcp_conns, list ) {
+		if ( ( tcp->local_port == port ) &&
+		     ( tcp->tcp_state != TCP_TIME_WAIT ) )
+			return -EADDRINUSE;
+	}
+
+	return 0;
+}
+
+/**
+ * Create a TCP connection
+ *
+ * @v st_peer		Peer socket address
+ * @ret tcp_ret		TCP connection
+ * @ret rc		Return status code
+ */
+static int tcp_create ( struct sockaddr_tcpip *st_peer,
+			struct tcp_connection **tcp_ret ) {
+	struct tcp_connection *tcp;
+	struct net_device *netdev;
 	size_t mtu;
-	int port;
-	int rc;
 
 	/* Allocate and initialise structure */
 	tcp = zalloc ( sizeof ( *tcp ) );
@@ -302,12 +348,41 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	mtu = tcpip_mtu ( &tcp->peer );
 	if ( ! mtu ) {
 		DBGC ( tcp, "TCP %p has no route to %s\n",
-		       tcp, sock_ntoa ( peer ) );
-		rc = -ENETUNREACH;
-		goto err;
+		       tcp, sock_ntoa ( ( struct sockaddr * ) st_peer ) );
+		ref_put ( &tcp->refcnt );
+		return -ENETUNREACH;
 	}
 	tcp->mss = ( mtu - sizeof ( struct tcp_header ) );
 
+	/* Use segmentation offload, if supported */
+	netdev = tcpip_netdev ( &tcp->peer );
+	if ( netdev && netdev_tx_tso ( netdev ) )
+		tcp->flags |= TCP_TSO_ENABLED;
+
+	*tcp_ret = tcp;
+	return 0;
+}
+
+/**
+ * Open a TCP connection
+ *
+ * @v xfer		Data transfer interface
+ * @v peer		Peer socket address
+ * @v local		Local socket address, or NULL
+ * @ret rc		Return status code
+ */
+static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
+		      struct sockaddr *local ) {
+	struct sockaddr_tcpip *st_peer = ( struct sockaddr_tcpip * ) peer;
+	struct sockaddr_tcpip *st_local = ( struct sockaddr_tcpip * ) local;
+	struct tcp_connection *tcp;
+	int port;
+	int rc;
+
+	/* Create connection */
+	if ( ( rc = tcp_create ( st_peer, &tcp ) ) != 0 )
+		return rc;
+
 	/* Bind to local port */
 	port = tcpip_bind ( st_local, tcp_port_available );
 	if ( port < 0 ) {
@@ -320,6 +395,7 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	DBGC ( tcp, "TCP %p bound to port %d\n", tcp, tcp->local_port );
 
 	/* Start timer to initiate SYN */
+	trace ( "tcp.open", 0 );
 	start_timer_nodelay ( &tcp->timer );
 
 	/* Add a pending operation for the SYN */
@@ -337,6 +413,97 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	return rc;
 }
 
+/**
+ * Accept an incoming TCP connection
+ *
+ * @v listener		TCP listening port
+ * @v st_peer		Peer socket address
+ * @ret tcp		TCP connection, or NULL on error
+ */
+static struct tcp_connection * tcp_accept ( struct tcp_listener *listener,
+					    struct sockaddr_tcpip *st_peer ) {
+	struct tcp_connection *tcp;
+	unsigned int count = 0;
+	int rc;
+
+	/* Refuse connection if listener already has too many
+	 * connections (including those awaiting final closure)
+	 */
+	list_for_each_entry ( tcp, &tcp_conns, list ) {
+		if ( ( tcp->flags & TCP_PASSIVE ) &&
+		     ( tcp->local_port == listener->port ) )
+			count++;
+	}
+	if ( count >= listener->max ) {
+		DBGC ( listener, "TCP %p refusing %s on port %d: too many "
+		       "connections\n", listener,
+		       sock_ntoa ( ( struct sockaddr * ) st_peer ),
+		       listener->port );
+		return NULL;
+	}
+
+	/* Create connection */
+	if ( ( rc = tcp_create ( st_peer, &tcp ) ) != 0 )
+		return NULL;
+	tcp->flags |= TCP_PASSIVE;
+	tcp->local_port = listener->port;
+	DBGC ( tcp, "TCP %p accepting %s on port %d\n", tcp,
+	       sock_ntoa ( ( struct sockaddr * ) st_peer ), tcp->local_port );
+
+	/* Add a pending operation for the SYN */
+	pending_get ( &tcp->pending_flags );
+
+	/* Transfer reference to connection list */
+	list_add ( &tcp->list, &tcp_conns );
+
+	/* Offer connection to listener */
+	if ( ( rc = listener->accept ( listener, &tcp->xfer, st_peer ) ) != 0 ){
+		DBGC ( tcp, "TCP %p refused: %s\n", tcp, strerror ( rc ) );
+		tcp_close ( tcp, rc );
+		return NULL;
+	}
+
+	return tcp;
+}
+
+/**
+ * Listen for incoming TCP connections
+ *
+ * @v listener		TCP listening port
+ * @ret rc		Return status code
+ */
+int tcp_listen ( struct tcp_listener *listener ) {
+	int rc;
+
+	/* Check that port is not already in use */
+	if ( ( rc = tcp_port_listenable ( listener->port ) ) != 0 ) {
+		DBGC ( listener, "TCP %p could not listen on port %d: %s\n",
+		       listener, listener->port, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Add to list of listening ports */
+	list_add ( &listener->list, &tcp_listeners );
+	DBGC ( listener, "TCP %p listening on port %d\n",
+	       listener, listener->port );
+
+	return 0;
+}
+
+/**
+ * Stop listening for incoming TCP connections
+ *
+ * @v listener		TCP listening port
+ *
+ * Connections that have already been accepted are not affected.
+ */
+void tcp_unlisten ( struct tcp_listener *listener ) {
+
+	list_del ( &listener->list );
+	DBGC ( listener, "TCP %p stopped listening on port %d\n",
+	       listener, listener->port );
+}
+
 /**
  * Close TCP connection
  *
@@ -430,16 +597,21 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
  * @ret len		Maximum length that can be sent in a single packet
  */
 static size_t tcp_xmit_win ( struct tcp_connection *tcp ) {
+	size_t max_len;
 	size_t len;
 
 	/* Not ready if we're not in a suitable connection state */
 	if ( ! TCP_CAN_SEND_DATA ( tcp->tcp_state ) )
 		return 0;
 
-	/* Length is the minimum of the receiver's window and the path MTU */
+	/* Length is the minimum of the receiver's window and the path
+	 * MTU (or the maximum segmentation offload length)
+	 */
 	len = tcp->snd_win;
-	if ( len > TCP_PATH_MTU )
-		len = TCP_PATH_MTU;
+	max_len = ( ( tcp->flags & TCP_TSO_ENABLED ) ?
+		    TCP_MAX_TSO_LEN : TCP_PATH_MTU );
+	if ( len > max_len )
+		len = max_len;
 
 	return len;
 }
@@ -692,17 +864,28 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 		mssopt->kind = TCP_OPTION_MSS;
 		mssopt->length = sizeof ( *mssopt );
 		mssopt->mss = htons ( tcp->mss );
-		wsopt = iob_push ( iobuf, sizeof ( *wsopt ) );
-		wsopt->nop = TCP_OPTION_NOP;
-		wsopt->wsopt.kind = TCP_OPTION_WS;
-		wsopt->wsopt.length = sizeof ( wsopt->wsopt );
-		wsopt->wsopt.scale = TCP_RX_WINDOW_SCALE;
-		spopt = iob_push ( iobuf, sizeof ( *spopt ) );
-		memset ( spopt->nop, TCP_OPTION_NOP, sizeof ( spopt->nop ) );
-		spopt->spopt.kind = TCP_OPTION_SACK_PERMITTED;
-		spopt->spopt.length = sizeof ( spopt->spopt );
+		/* A passive open may include only those options
+		 * which were offered by the peer.
+		 */
+		if ( ( ! ( tcp->flags & TCP_PASSIVE ) ) ||
+		     tcp->rcv_win_scale ) {
+			wsopt = iob_push ( iobuf, sizeof ( *wsopt ) );
+			wsopt->nop = TCP_OPTION_NOP;
+			wsopt->wsopt.kind = TCP_OPTION_WS;
+			wsopt->wsopt.length = sizeof ( wsopt->wsopt );
+			wsopt->wsopt.scale = TCP_RX_WINDOW_SCALE;
+		}
+		if ( ( ! ( tcp->flags & TCP_PASSIVE ) ) ||
+		     ( tcp->flags & TCP_SACK_ENABLED ) ) {
+			spopt = iob_push ( iobuf, sizeof ( *spopt ) );
+			memset ( spopt->nop, TCP_OPTION_NOP,
+				 sizeof ( spopt->nop ) );
+			spopt->spopt.kind = TCP_OPTION_SACK_PERMITTED;
+			spopt->spopt.length = sizeof ( spopt->spopt );
+		}
 	}
-	if ( ( flags & TCP_SYN ) || ( tcp->flags & TCP_TS_ENABLED ) ) {
+	if ( ( ( flags & TCP_SYN ) && ! ( tcp->flags & TCP_PASSIVE ) ) ||
+	     ( tcp->flags & TCP_TS_ENABLED ) ) {
 		tsopt = iob_push ( iobuf, sizeof ( *tsopt ) );
 		memset ( tsopt->nop, TCP_OPTION_NOP, sizeof ( tsopt->nop ) );
 		tsopt->tsopt.kind = TCP_OPTION_TS;
@@ -736,7 +919,12 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	tcphdr->hlen = ( ( payload - iobuf->data ) << 2 );
 	tcphdr->flags = flags;
 	tcphdr->win = htons ( tcp->rcv_win >> tcp->rcv_win_scale );
-	tcphdr->csum = tcpip_chksum ( iobuf->data, iob_len ( iobuf ) );
+	iob_csum_defer ( iobuf, &tcphdr->csum );
+	if ( len > TCP_PATH_MTU ) {
+		iob_gso_defer ( iobuf, ( ( tcp->peer.st_family == AF_INET6 ) ?
+					 IOB_GSO_TCPV6 : IOB_GSO_TCPV4 ),
+				TCP_PATH_MTU );
+	}
 
 	/* Dump header */
 	DBGC2 ( tcp, "TCP %p TX %d->%d %08x..%08x           %08x %4zd",
@@ -890,7 +1078,7 @@ static int tcp_xmit_reset ( struct tcp_connection *tcp,
 	tcphdr->hlen = ( ( sizeof ( *tcphdr ) / 4 ) << 4 );
 	tcphdr->flags = ( TCP_RST | TCP_ACK );
 	tcphdr->win = htons ( 0 );
-	tcphdr->csum = tcpip_chksum ( iobuf->data, iob_len ( iobuf ) );
+	iob_csum_defer ( iobuf, &tcphdr->csum );
 
 	/* Dump header */
 	DBGC2 ( tcp, "TCP %p TX %d->%d %08x..%08x           %08x %4d",
@@ -924,14 +1112,42 @@ static int tcp_xmit_reset ( struct tcp_connection *tcp,
  * Identify TCP connection by local port number
  *
  * @v local_port	Local port
+ * @v peer		Peer socket address, or NULL to match any peer
  * @ret tcp		TCP connection, or NULL
+ *
+ * Connections accepted from a listening port all share the same
+ * local port, and so must additionally be identified by the peer
+ * socket address.
  */
-static struct tcp_connection * tcp_demux ( unsigned int local_port ) {
+static struct tcp_connection * tcp_demux ( unsigned int local_port,
+					   struct sockaddr_tcpip *peer ) {
 	struct tcp_connection *tcp;
 
 	list_for_each_entry ( tcp, &tcp_conns, list ) {
-		if ( tcp->local_port == local_port )
-			return tcp;
+		if ( tcp->local_port != local_port )
+			continue;
+		if ( peer && ( tcp->flags & TCP_PASSIVE ) &&
+		     ( ( tcp->peer.st_port != peer->st_port ) ||
+		       ( memcmp ( tcp->peer.pad, peer->pad,
+				  sizeof ( tcp->peer.pad ) ) != 0 ) ) )
+			continue;
+		return tcp;
+	}
+	return NULL;
+}
+
+/**
+ * Identify TCP listening port
+ *
+ * @v local_port	Local port
+ * @ret listener	TCP listening port, or NULL
+ */
+static struct tcp_listener * tcp_demux_listener ( unsigned int local_port ) {
+	struct tcp_listener *listener;
+
+	list_for_each_entry ( listener, &tcp_listeners, list ) {
+		if ( listener->port == local_port )
+			return listener;
 	}
 	return NULL;
 }
@@ -1153,13 +1369,24 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 	if ( ack_len == 0 )
 		return 0;
 
-	/* Stop the retransmission timer */
+	/* Stop the retransmission timer.  If only part of the sent
+	 * data has been acknowledged (as will happen when a packet
+	 * using segmentation offload is acknowledged segment by
+	 * segment), then restart the timer to wait for the remainder
+	 * rather than immediately retransmitting it.
+	 */
 	stop_timer ( &tcp->timer );
+	if ( ack_len < tcp->snd_sent )
+		start_timer ( &tcp->timer );
 
-	/* Determine acknowledged flags and data length */
+	/* Determine acknowledged flags and data length.  A FIN is
+	 * acknowledged only when all sent data has been acknowledged.
+	 */
 	len = ack_len;
 	acked_flags = ( TCP_FLAGS_SENDING ( tcp->tcp_state ) &
 			( TCP_SYN | TCP_FIN ) );
+	if ( ack_len < tcp->snd_sent )
+		acked_flags &= ~TCP_FIN;
 	if ( acked_flags ) {
 		len--;
 		pending_put ( &tcp->pending_flags );
@@ -1167,7 +1394,7 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 
 	/* Update SEQ and sent counters */
 	tcp->snd_seq = ack;
-	tcp->snd_sent = 0;
+	tcp->snd_sent -= ack_len;
 
 	/* Remove any acknowledged data from transmit queue */
 	tcp_process_tx_queue ( tcp, len, NULL, 1 );
@@ -1175,6 +1402,8 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 	/* Mark SYN/FIN as acknowledged if applicable. */
 	if ( acked_flags )
 		tcp->tcp_state |= TCP_STATE_ACKED ( acked_flags );
+	if ( acked_flags & TCP_SYN )
+		trace ( "tcp.connect", 0 );
 
 	/* Start sending FIN if we've had all possible data ACKed */
 	if ( list_empty ( &tcp->tx_queue ) &&
@@ -1393,11 +1622,12 @@ static void tcp_process_rx_queue ( struct tcp_connection *tcp ) {
  * @ret rc		Return status code
   */
 static int tcp_rx ( struct io_buffer *iobuf,
-		    struct net_device *netdev __unused,
+		    struct net_device *netdev,
 		    struct sockaddr_tcpip *st_src,
 		    struct sockaddr_tcpip *st_dest __unused,
 		    uint16_t pshdr_csum ) {
 	struct tcp_header *tcphdr = iobuf->data;
+	struct tcp_listener *listener;
 	struct tcp_connection *tcp;
 	struct tcp_options options;
 	size_t hlen;
@@ -1435,9 +1665,10 @@ static int tcp_rx ( struct io_buffer *iobuf,
 		rc = -EINVAL;
 		goto discard;
 	}
-	csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data,
-				       iob_len ( iobuf ) );
-	if ( csum != 0 ) {
+	if ( ! ( netdev_rx_csum ( netdev ) &&
+		 ( iobuf->csum == IOB_CSUM_VALID ) ) &&
+	     ( ( csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data,
+						iob_len ( iobuf ) ) ) != 0 ) ) {
 		DBG ( "TCP checksum incorrect (is %04x including checksum "
 		      "field, should be 0000)\n", csum );
 		rc = -EINVAL;
@@ -1445,11 +1676,21 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	}
 	
 	/* Parse parameters from header and strip header */
-	tcp = tcp_demux ( ntohs ( tcphdr->dest ) );
+	st_src->st_port = tcphdr->src;
+	tcp = tcp_demux ( ntohs ( tcphdr->dest ), st_src );
 	seq = ntohl ( tcphdr->seq );
 	ack = ntohl ( tcphdr->ack );
 	raw_win = ntohs ( tcphdr->win );
 	flags = tcphdr->flags;
+
+	/* Accept new connection on a listening port, if applicable */
+	if ( ( ! tcp ) &&
+	     ( ( flags & ( TCP_SYN | TCP_ACK | TCP_RST ) ) == TCP_SYN ) &&
+	     ( ( listener = tcp_demux_listener ( ntohs ( tcphdr->dest ) ) )
+	       != NULL ) ) {
+		tcp = tcp_accept ( listener, st_src );
+	}
+
 	if ( ( rc = tcp_rx_opts ( tcp, tcphdr, hlen, &options ) ) != 0 )
 		goto discard;
 	if ( tcp && options.tsopt )
@@ -1779,3 +2020,6 @@ struct uri_opener tcp_uri_opener __uri_opener = {
 	.open		= tcp_open_uri,
 };
 
+/* Drag in software segmentation offload */
+REQUIRING_SYMBOL ( tcp_protocol );
+REQUIRE_OBJECT ( gso );
@@ -49,6 +49,30 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** HTTP connection pool */
 static LIST_HEAD ( http_connection_pool );
 
+/** Active HTTP connections */
+static LIST_HEAD ( http_connection_active );
+
+/**
+ * A pipelined HTTP transaction
+ *
+ * This represents a transaction that has been queued behind the
+ * current transaction on an active HTTP connection.  The request may
+ * be transmitted immediately, but the response will not be delivered
+ * until all preceding responses have been received.
+ */
+struct http_pipelined {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** HTTP connection */
+	struct http_connection *conn;
+	/** List of pipelined transactions */
+	struct list_head list;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Request has been transmitted */
+	int sent;
+};
+
 /**
  * Identify HTTP scheme
  *
@@ -81,10 +105,58 @@ static void http_conn_free ( struct refcnt *refcnt ) {
 		container_of ( refcnt, struct http_connection, refcnt );
 
 	/* Free connection */
+	free_iob ( conn->unconsumed );
 	uri_put ( conn->uri );
 	free ( conn );
 }
 
+/**
+ * Check if HTTP connection is to a specified server
+ *
+ * @v conn		HTTP connection
+ * @v scheme		HTTP scheme
+ * @v host		Server host name
+ * @v port		Server port
+ * @ret is_server	Connection is to the specified server
+ */
+static int http_conn_is_server ( struct http_connection *conn,
+				 struct http_scheme *scheme, const char *host,
+				 unsigned int port ) {
+
+	/* Sanity checks */
+	assert ( conn->uri != NULL );
+	assert ( conn->uri->host != NULL );
+
+	return ( ( scheme == conn->scheme ) &&
+		 ( strcmp ( host, conn->uri->host ) == 0 ) &&
+		 ( port == uri_port ( conn->uri, scheme->port ) ) );
+}
+
+/**
+ * Remove HTTP connection from list of active connections
+ *
+ * @v conn		HTTP connection
+ */
+static void http_conn_deactivate ( struct http_connection *conn ) {
+
+	/* Remove from list of active connections */
+	list_del ( &conn->active );
+	INIT_LIST_HEAD ( &conn->active );
+}
+
+/**
+ * Free pipelined HTTP transaction
+ *
+ * @v refcnt		Reference count
+ */
+static void http_pipelined_free ( struct refcnt *refcnt ) {
+	struct http_pipelined *pipelined =
+		container_of ( refcnt, struct http_pipelined, refcnt );
+
+	ref_put ( &pipelined->conn->refcnt );
+	free ( pipelined );
+}
+
 /**
  * Close HTTP connection
  *
@@ -92,10 +164,37 @@ static void http_conn_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for close
  */
 static void http_conn_close ( struct http_connection *conn, int rc ) {
+	struct http_pipelined *pipelined;
 
 	/* Remove from connection pool, if applicable */
 	pool_del ( &conn->pool );
 
+	/* Remove from list of active connections */
+	http_conn_deactivate ( conn );
+
+	/* Stop pipelined transmission process */
+	process_del ( &conn->process );
+
+	/* Discard any unconsumed data */
+	free_iob ( conn->unconsumed );
+	conn->unconsumed = NULL;
+
+	/* Reopen any pipelined transactions.  No part of their
+	 * responses can have been received, so it is safe for them
+	 * to retry their (idempotent) requests on a new connection.
+	 */
+	while ( ( pipelined = list_first_entry ( &conn->pipeline,
+						 struct http_pipelined,
+						 list ) ) ) {
+		DBGC2 ( conn, "HTTPCONN %p reopening pipelined %p\n",
+			conn, pipelined );
+		list_del ( &pipelined->list );
+		INIT_LIST_HEAD ( &pipelined->list );
+		pool_reopen ( &pipelined->xfer );
+		intf_shutdown ( &pipelined->xfer, rc );
+		ref_put ( &pipelined->refcnt );
+	}
+
 	/* Shut down interfaces */
 	intf_shutdown ( &conn->socket, rc );
 	intf_shutdown ( &conn->xfer, rc );
@@ -149,6 +248,9 @@ static int http_conn_socket_deliver ( struct http_connection *conn,
  */
 static void http_conn_socket_close ( struct http_connection *conn, int rc ) {
 
+	/* Prevent reuse of this connection by a reopened transaction */
+	http_conn_deactivate ( conn );
+
 	/* If we are reopenable (i.e. we are a recycled connection
 	 * from the connection pool, and we have received no data from
 	 * the underlying socket since we were pooled), then suggest
@@ -170,9 +272,84 @@ static void http_conn_xfer_recycle ( struct http_connection *conn ) {
 
 	/* Mark connection as recyclable */
 	pool_recyclable ( &conn->pool );
+	conn->flags |= HTTP_CONN_PERSISTENT;
 	DBGC2 ( conn, "HTTPCONN %p keepalive enabled\n", conn );
 }
 
+/**
+ * Transmit data on behalf of current transaction
+ *
+ * @v conn		HTTP connection
+ * @v iobuf		I/O buffer
+ * @v meta		Transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_conn_xfer_deliver ( struct http_connection *conn,
+				    struct io_buffer *iobuf,
+				    struct xfer_metadata *meta ) {
+
+	/* Allow any pipelined requests to be transmitted */
+	if ( ! ( conn->flags & HTTP_CONN_SENT ) ) {
+		conn->flags |= HTTP_CONN_SENT;
+		if ( ! list_empty ( &conn->pipeline ) )
+			process_add ( &conn->process );
+	}
+
+	/* Pass on to transport layer interface */
+	return xfer_deliver ( &conn->socket, iobuf, meta );
+}
+
+/**
+ * Accept unconsumed received data from current transaction
+ *
+ * @v conn		HTTP connection
+ * @v iobuf		I/O buffer
+ */
+static void http_conn_xfer_unconsumed ( struct http_connection *conn,
+					struct io_buffer *iobuf ) {
+
+	/* Retain data for delivery to the next pipelined transaction */
+	assert ( conn->unconsumed == NULL );
+	conn->unconsumed = iobuf;
+}
+
+/**
+ * Hand over HTTP connection to next pipelined transaction
+ *
+ * @v conn		HTTP connection
+ * @v pipelined		Pipelined HTTP transaction
+ */
+static void http_conn_promote ( struct http_connection *conn,
+				struct http_pipelined *pipelined ) {
+	struct io_buffer *iobuf;
+
+	/* Mark as a freshly recycled connection */
+	pool_del ( &conn->pool );
+	conn->flags &= ~HTTP_CONN_SENT;
+	conn->flags |= HTTP_CONN_PIPELINE;
+	if ( pipelined->sent )
+		conn->flags |= HTTP_CONN_SENT;
+
+	/* Attach transaction to data transfer interface */
+	list_del ( &pipelined->list );
+	INIT_LIST_HEAD ( &pipelined->list );
+	intf_plug_plug ( &conn->xfer, pipelined->xfer.dest );
+	intf_unplug ( &pipelined->xfer );
+	ref_put ( &pipelined->refcnt );
+	DBGC2 ( conn, "HTTPCONN %p promoted pipelined %p\n", conn, pipelined );
+
+	/* Deliver any data already received for this response */
+	if ( ( iobuf = conn->unconsumed ) ) {
+		conn->unconsumed = NULL;
+		pool_alive ( &conn->pool );
+		xfer_deliver_iob ( &conn->xfer, iobuf );
+	}
+
+	/* Allow transmission to proceed */
+	if ( ! ( conn->flags & HTTP_CONN_SENT ) )
+		xfer_window_changed ( &conn->xfer );
+}
+
 /**
  * Close HTTP connection data transfer interface
  *
@@ -181,26 +358,82 @@ static void http_conn_xfer_recycle ( struct http_connection *conn ) {
  */
 static void http_conn_xfer_close ( struct http_connection *conn, int rc ) {
 
-	/* Add to the connection pool if keepalive is enabled and no
-	 * error occurred.
+	struct http_pipelined *pipelined;
+
+	/* Reuse the connection if keepalive is enabled, no error
+	 * occurred, and no pipelined request has been abandoned
+	 * (since we would not know where its response ends).
 	 */
-	if ( ( rc == 0 ) && pool_is_recyclable ( &conn->pool ) ) {
+	if ( ( rc == 0 ) && pool_is_recyclable ( &conn->pool ) &&
+	     ( ! ( conn->flags & HTTP_CONN_ABANDONED ) ) ) {
 		intf_restart ( &conn->xfer, rc );
-		pool_add ( &conn->pool, &http_connection_pool,
-			   HTTP_CONN_EXPIRY );
-		DBGC2 ( conn, "HTTPCONN %p pooled %s://%s\n",
-			conn, conn->scheme->name, conn->uri->host );
-		return;
+
+		/* Hand over to next pipelined transaction, if any */
+		pipelined = list_first_entry ( &conn->pipeline,
+					       struct http_pipelined, list );
+		if ( pipelined ) {
+			http_conn_promote ( conn, pipelined );
+			return;
+		}
+
+		/* Otherwise, add to the connection pool (unless the
+		 * server has sent data that nobody asked for).
+		 */
+		if ( ! conn->unconsumed ) {
+			http_conn_deactivate ( conn );
+			pool_add ( &conn->pool, &http_connection_pool,
+				   HTTP_CONN_EXPIRY );
+			DBGC2 ( conn, "HTTPCONN %p pooled %s://%s\n",
+				conn, conn->scheme->name, conn->uri->host );
+			return;
+		}
+		DBGC ( conn, "HTTPCONN %p received unsolicited data\n",
+		       conn );
+		rc = -EPROTO;
 	}
 
 	/* Otherwise, close the connection */
 	http_conn_close ( conn, rc );
 }
 
+/**
+ * Handle transport layer flow control window change
+ *
+ * @v conn		HTTP connection
+ */
+static void http_conn_socket_window_changed ( struct http_connection *conn ){
+
+	/* Allow any pipelined requests to be transmitted */
+	if ( ! list_empty ( &conn->pipeline ) )
+		process_add ( &conn->process );
+
+	/* Pass on to data transfer interface */
+	xfer_window_changed ( &conn->xfer );
+}
+
+/**
+ * Allow next pipelined request to be transmitted
+ *
+ * @v conn		HTTP connection
+ */
+static void http_conn_step ( struct http_connection *conn ) {
+	struct http_pipelined *pipelined;
+
+	/* Notify first untransmitted pipelined transaction, if any */
+	list_for_each_entry ( pipelined, &conn->pipeline, list ) {
+		if ( ! pipelined->sent ) {
+			xfer_window_changed ( &pipelined->xfer );
+			break;
+		}
+	}
+}
+
 /** HTTP connection socket interface operations */
 static struct interface_operation http_conn_socket_operations[] = {
 	INTF_OP ( xfer_deliver, struct http_connection *,
 		  http_conn_socket_deliver ),
+	INTF_OP ( xfer_window_changed, struct http_connection *,
+		  http_conn_socket_window_changed ),
 	INTF_OP ( intf_close, struct http_connection *,
 		  http_conn_socket_close ),
 };
@@ -212,8 +445,12 @@ static struct interface_descriptor http_conn_socket_desc =
 
 /** HTTP connection data transfer interface operations */
 static struct interface_operation http_conn_xfer_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_connection *,
+		  http_conn_xfer_deliver ),
 	INTF_OP ( pool_recycle, struct http_connection *,
 		  http_conn_xfer_recycle ),
+	INTF_OP ( http_unconsumed, struct http_connection *,
+		  http_conn_xfer_unconsumed ),
 	INTF_OP ( intf_close, struct http_connection *,
 		  http_conn_xfer_close ),
 };
@@ -223,17 +460,217 @@ static struct interface_descriptor http_conn_xfer_desc =
 	INTF_DESC_PASSTHRU ( struct http_connection, xfer,
 			     http_conn_xfer_operations, socket );
 
+/** HTTP connection pipelined transmission process descriptor */
+static struct process_descriptor http_conn_process_desc =
+	PROC_DESC_ONCE ( struct http_connection, process, http_conn_step );
+
+/**
+ * Check flow control window for pipelined HTTP transaction
+ *
+ * @v pipelined		Pipelined HTTP transaction
+ * @ret len		Length of window
+ */
+static size_t http_pipelined_window ( struct http_pipelined *pipelined ) {
+	struct http_connection *conn = pipelined->conn;
+	struct http_pipelined *tmp;
+
+	/* Block window until all preceding requests have been
+	 * transmitted, to ensure that responses arrive in the same
+	 * order as the pipelined transactions.
+	 */
+	if ( ! ( conn->flags & HTTP_CONN_SENT ) )
+		return 0;
+	list_for_each_entry ( tmp, &conn->pipeline, list ) {
+		if ( tmp == pipelined )
+			break;
+		if ( ! tmp->sent )
+			return 0;
+	}
+
+	return xfer_window ( &conn->socket );
+}
+
+/**
+ * Allocate I/O buffer for pipelined HTTP transaction
+ *
+ * @v pipelined		Pipelined HTTP transaction
+ * @v len		I/O buffer payload length
+ * @ret iobuf		I/O buffer
+ */
+static struct io_buffer *
+http_pipelined_alloc_iob ( struct http_pipelined *pipelined, size_t len ) {
+
+	return xfer_alloc_iob ( &pipelined->conn->socket, len );
+}
+
+/**
+ * Transmit data on behalf of pipelined HTTP transaction
+ *
+ * @v pipelined		Pipelined HTTP transaction
+ * @v iobuf		I/O buffer
+ * @v meta		Transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_pipelined_deliver ( struct http_pipelined *pipelined,
+				    struct io_buffer *iobuf,
+				    struct xfer_metadata *meta ) {
+	struct http_connection *conn = pipelined->conn;
+
+	/* Allow next pipelined request to be transmitted */
+	pipelined->sent = 1;
+	process_add ( &conn->process );
+
+	/* Pass on to transport layer interface */
+	return xfer_deliver ( &conn->socket, iobuf, meta );
+}
+
+/**
+ * Close pipelined HTTP transaction
+ *
+ * @v pipelined		Pipelined HTTP transaction
+ * @v rc		Reason for close
+ */
+static void http_pipelined_close ( struct http_pipelined *pipelined,
+				   int rc ) {
+	struct http_connection *conn = pipelined->conn;
+
+	/* Shut down interface */
+	intf_shutdown ( &pipelined->xfer, rc );
+
+	/* Do nothing more if already removed from connection */
+	if ( list_empty ( &pipelined->list ) )
+		return;
+
+	/* If the request has already been transmitted, then the
+	 * connection cannot be reused after the current response.
+	 */
+	if ( pipelined->sent ) {
+		DBGC ( conn, "HTTPCONN %p abandoned pipelined %p: %s\n",
+		       conn, pipelined, strerror ( rc ) );
+		conn->flags |= HTTP_CONN_ABANDONED;
+	}
+
+	/* Remove from connection */
+	list_del ( &pipelined->list );
+	INIT_LIST_HEAD ( &pipelined->list );
+	process_add ( &conn->process );
+	ref_put ( &pipelined->refcnt );
+}
+
+/** Pipelined HTTP transaction data transfer interface operations */
+static struct interface_operation http_pipelined_xfer_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_pipelined *,
+		  http_pipelined_deliver ),
+	INTF_OP ( xfer_window, struct http_pipelined *,
+		  http_pipelined_window ),
+	INTF_OP ( xfer_alloc_iob, struct http_pipelined *,
+		  http_pipelined_alloc_iob ),
+	INTF_OP ( intf_close, struct http_pipelined *,
+		  http_pipelined_close ),
+};
+
+/** Pipelined HTTP transaction data transfer interface descriptor */
+static struct interface_descriptor http_pipelined_xfer_desc =
+	INTF_DESC ( struct http_pipelined, xfer,
+		    http_pipelined_xfer_operations );
+
+/**
+ * Check if HTTP connection may accept a pipelined transaction
+ *
+ * @v conn		HTTP connection
+ * @ret ok		Connection may accept a pipelined transaction
+ */
+static int http_conn_may_pipeline ( struct http_connection *conn ) {
+	struct http_pipelined *pipelined;
+	unsigned int count = 0;
+
+	/* Require a server known to support persistent connections,
+	 * a current transaction that permits pipelining, and no
+	 * abandoned pipelined requests.
+	 */
+	if ( ( conn->flags & ( HTTP_CONN_PERSISTENT | HTTP_CONN_PIPELINE |
+			       HTTP_CONN_ABANDONED ) ) !=
+	     ( HTTP_CONN_PERSISTENT | HTTP_CONN_PIPELINE ) ) {
+		return 0;
+	}
+
+	/* Limit pipeline depth */
+	list_for_each_entry ( pipelined, &conn->pipeline, list )
+		count++;
+	return ( count < HTTP_PIPELINE_MAX );
+}
+
+/**
+ * Pipeline transaction onto an active HTTP connection
+ *
+ * @v conn		HTTP connection
+ * @v xfer		Data transfer interface
+ * @ret rc		Return status code
+ */
+static int http_conn_pipeline ( struct http_connection *conn,
+				struct interface *xfer ) {
+	struct http_pipelined *pipelined;
+
+	/* Allocate and initialise structure */
+	pipelined = zalloc ( sizeof ( *pipelined ) );
+	if ( ! pipelined )
+		return -ENOMEM;
+	ref_init ( &pipelined->refcnt, http_pipelined_free );
+	intf_init ( &pipelined->xfer, &http_pipelined_xfer_desc,
+		    &pipelined->refcnt );
+	ref_get ( &conn->refcnt );
+	pipelined->conn = conn;
+
+	/* Add to list of pipelined transactions (which holds our
+	 * reference), and attach to parent interface.
+	 */
+	list_add_tail ( &pipelined->list, &conn->pipeline );
+	intf_plug_plug ( &pipelined->xfer, xfer );
+	process_add ( &conn->process );
+
+	DBGC2 ( conn, "HTTPCONN %p pipelined %p %s://%s\n", conn, pipelined,
+		conn->scheme->name, conn->uri->host );
+	return 0;
+}
+
+/**
+ * Return unconsumed received data to HTTP connection
+ *
+ * @v intf		Interface
+ * @v iobuf		I/O buffer
+ *
+ * This is used to return any data following the end of a response,
+ * which must belong to the response to a pipelined request.
+ */
+void http_unconsumed ( struct interface *intf, struct io_buffer *iobuf ) {
+	struct interface *dest;
+	http_unconsumed_TYPE ( void * ) *op =
+		intf_get_dest_op ( intf, http_unconsumed, &dest );
+	void *object = intf_object ( dest );
+
+	if ( op ) {
+		op ( object, iobuf );
+	} else {
+		/* Default is to discard the data */
+		free_iob ( iobuf );
+	}
+
+	intf_put ( dest );
+}
+
 /**
  * Connect to an HTTP server
  *
  * @v xfer		Data transfer interface
  * @v uri		Connection URI
+ * @v flags		Connection request flags
  * @ret rc		Return status code
  *
- * HTTP connections are pooled.  The caller should be prepared to
- * receive a pool_reopen() message.
+ * HTTP connections are pooled, and requests may be pipelined.  The
+ * caller should be prepared to receive a pool_reopen() message.
  */
-int http_connect ( struct interface *xfer, struct uri *uri ) {
+int http_connect ( struct interface *xfer, struct uri *uri,
+		   unsigned int flags ) {
 	struct http_connection *conn;
 	struct http_scheme *scheme;
 	struct sockaddr_tcpip server;
@@ -260,19 +697,18 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 	 */
 	list_for_each_entry_reverse ( conn, &http_connection_pool, pool.list ) {
 
-		/* Sanity checks */
-		assert ( conn->uri != NULL );
-		assert ( conn->uri->host != NULL );
-
 		/* Reuse connection, if possible */
-		if ( ( scheme == conn->scheme ) &&
-		     ( strcmp ( uri->host, conn->uri->host ) == 0 ) &&
-		     ( port == uri_port ( conn->uri, scheme->port ) ) ) {
+		if ( http_conn_is_server ( conn, scheme, uri->host, port ) ) {
 
 			/* Remove from connection pool, stop timer,
 			 * attach to parent interface, and return.
 			 */
 			pool_del ( &conn->pool );
+			conn->flags &= ~( HTTP_CONN_PIPELINE | HTTP_CONN_SENT );
+			if ( flags & HTTP_CONNECT_PIPELINE )
+				conn->flags |= HTTP_CONN_PIPELINE;
+			list_add_tail ( &conn->active,
+					&http_connection_active );
 			intf_plug_plug ( &conn->xfer, xfer );
 			DBGC2 ( conn, "HTTPCONN %p reused %s://%s:%d\n", conn,
 				conn->scheme->name, conn->uri->host, port );
@@ -280,6 +716,19 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 		}
 	}
 
+	/* Look for an active connection on which the request may be
+	 * pipelined, if permitted.
+	 */
+	if ( flags & HTTP_CONNECT_PIPELINE ) {
+		list_for_each_entry ( conn, &http_connection_active, active ) {
+			if ( http_conn_is_server ( conn, scheme, uri->host,
+						   port ) &&
+			     http_conn_may_pipeline ( conn ) ) {
+				return http_conn_pipeline ( conn, xfer );
+			}
+		}
+	}
+
 	/* Allocate and initialise structure */
 	conn = zalloc ( sizeof ( *conn ) );
 	if ( ! conn ) {
@@ -292,6 +741,12 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 	intf_init ( &conn->socket, &http_conn_socket_desc, &conn->refcnt );
 	intf_init ( &conn->xfer, &http_conn_xfer_desc, &conn->refcnt );
 	pool_init ( &conn->pool, http_conn_expired, &conn->refcnt );
+	INIT_LIST_HEAD ( &conn->active );
+	INIT_LIST_HEAD ( &conn->pipeline );
+	process_init_stopped ( &conn->process, &http_conn_process_desc,
+			       &conn->refcnt );
+	if ( flags & HTTP_CONNECT_PIPELINE )
+		conn->flags |= HTTP_CONN_PIPELINE;
 
 	/* Open socket */
 	memset ( &server, 0, sizeof ( server ) );
@@ -306,6 +761,7 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 		goto err_filter;
 
 	/* Attach to parent interface, mortalise self, and return */
+	list_add_tail ( &conn->active, &http_connection_active );
 	intf_plug_plug ( &conn->xfer, xfer );
 	ref_put ( &conn->refcnt );
 
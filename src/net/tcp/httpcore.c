@@ -301,6 +301,22 @@ static void http_close_error ( struct http_transaction *http, int rc ) {
 	http_close ( http, ( rc ? rc : -EPIPE ) );
 }
 
+/**
+ * Determine HTTP connection request flags
+ *
+ * @v http		HTTP transaction
+ * @ret flags		Connection request flags
+ */
+static unsigned int http_connect_flags ( struct http_transaction *http ) {
+	struct http_method *method = http->request.method;
+
+	/* Allow idempotent requests to be pipelined */
+	if ( ( method == &http_get ) || ( method == &http_head ) )
+		return HTTP_CONNECT_PIPELINE;
+
+	return 0;
+}
+
 /**
  * Reopen stale HTTP connection
  *
@@ -313,7 +329,8 @@ static void http_reopen ( struct http_transaction *http ) {
 	intf_restart ( &http->conn, -ECANCELED );
 
 	/* Reopen connection */
-	if ( ( rc = http_connect ( &http->conn, http->uri ) ) != 0 ) {
+	if ( ( rc = http_connect ( &http->conn, http->uri,
+				   http_connect_flags ( http ) ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not reconnect: %s\n",
 		       http, strerror ( rc ) );
 		goto err_connect;
@@ -393,9 +410,15 @@ static int http_conn_deliver ( struct http_transaction *http,
 			       struct xfer_metadata *meta __unused ) {
 	int rc;
 
+	/* Record received data, so that any data following the end
+	 * of the response may be returned to the connection.
+	 */
+	assert ( http->rx == NULL );
+	http->rx = iobuf;
+
 	/* Handle received data */
 	profile_start ( &http_rx_profiler );
-	while ( iobuf && iob_len ( iobuf ) ) {
+	while ( http->rx && iob_len ( http->rx ) ) {
 
 		/* Sanity check */
 		if ( ( ! http->state ) || ( ! http->state->rx ) ) {
@@ -405,18 +428,20 @@ static int http_conn_deliver ( struct http_transaction *http,
 		}
 
 		/* Receive (some) data */
-		if ( ( rc = http->state->rx ( http, &iobuf ) ) != 0 )
+		if ( ( rc = http->state->rx ( http, &http->rx ) ) != 0 )
 			goto err;
 	}
 
 	/* Free I/O buffer, if applicable */
-	free_iob ( iobuf );
+	free_iob ( http->rx );
+	http->rx = NULL;
 
 	profile_stop ( &http_rx_profiler );
 	return 0;
 
  err:
-	free_iob ( iobuf );
+	free_iob ( http->rx );
+	http->rx = NULL;
 	http_close ( http, rc );
 	return rc;
 }
@@ -669,7 +694,8 @@ int http_open ( struct interface *xfer, struct http_method *method,
 		http->request.host, http->request.uri );
 
 	/* Open connection */
-	if ( ( rc = http_connect ( &http->conn, uri ) ) != 0 ) {
+	if ( ( rc = http_connect ( &http->conn, uri,
+				   http_connect_flags ( http ) ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not connect: %s\n",
 		       http, strerror ( rc ) );
 		goto err_connect;
@@ -747,6 +773,12 @@ static int http_transfer_complete ( struct http_transaction *http ) {
 	if ( http->response.flags & HTTP_RESPONSE_KEEPALIVE )
 		pool_recycle ( &http->conn );
 
+	/* Return any data following the end of the response (which
+	 * must belong to a pipelined response) to the connection.
+	 */
+	if ( http->rx && iob_len ( http->rx ) )
+		http_unconsumed ( &http->conn, iob_disown ( http->rx ) );
+
 	/* Restart server connection interface */
 	intf_restart ( &http->conn, 0 );
 
@@ -1586,23 +1618,41 @@ static int http_init_transfer_identity ( struct http_transaction *http ) {
 static int http_rx_transfer_identity ( struct http_transaction *http,
 				       struct io_buffer **iobuf ) {
 	size_t len = iob_len ( *iobuf );
+	struct io_buffer *payload;
+	size_t remaining;
 	int rc;
 
-	/* Update lengths */
-	http->len += len;
-
-	/* Fail if this transfer would overrun the expected content
-	 * length (if any).
-	 */
+	/* Use whole/partial buffer as applicable */
+	remaining = ( http->response.content.len - http->len );
 	if ( ( http->response.flags & HTTP_RESPONSE_CONTENT_LEN ) &&
-	     ( http->len > http->response.content.len ) ) {
-		DBGC ( http, "HTTP %p content length overrun\n", http );
-		return -EIO_CONTENT_LENGTH;
+	     ( len > remaining ) ) {
+
+		/* Partial buffer is to be consumed (with the
+		 * remainder belonging to a subsequent pipelined
+		 * response): copy data to a temporary I/O buffer.
+		 */
+		payload = alloc_iob ( remaining );
+		if ( ! payload )
+			return -ENOMEM;
+		memcpy ( iob_put ( payload, remaining ), (*iobuf)->data,
+			 remaining );
+		iob_pull ( *iobuf, remaining );
+		len = remaining;
+
+	} else {
+
+		/* Whole buffer is to be consumed: use original I/O
+		 * buffer as payload.
+		 */
+		payload = iob_disown ( *iobuf );
 	}
 
+	/* Update lengths */
+	http->len += len;
+
 	/* Hand off to content encoding */
 	if ( ( rc = xfer_deliver_iob ( &http->transfer,
-				       iob_disown ( *iobuf ) ) ) != 0 )
+				       iob_disown ( payload ) ) ) != 0 )
 		return rc;
 
 	/* Complete transfer if we have received the expected content
@@ -105,6 +105,51 @@ int tcpip_tx ( struct io_buffer *iobuf, struct tcpip_protocol *tcpip_protocol,
 	return -EAFNOSUPPORT;
 }
 
+/**
+ * Complete transport-layer checksum for transmission
+ *
+ * @v iobuf		I/O buffer
+ * @v tcpip_protocol	Transport-layer protocol
+ * @v netdev		Transmitting network device
+ * @v trans_csum	Transport-layer checksum to complete
+ * @v csum		Checksum including pseudo-header
+ *
+ * If calculation of the checksum over the transport-layer data has
+ * been deferred, then it is calculated now unless the transmitting
+ * network device is capable of completing the calculation itself.
+ */
+void tcpip_tx_chksum ( struct io_buffer *iobuf,
+		       struct tcpip_protocol *tcpip_protocol,
+		       struct net_device *netdev, uint16_t *trans_csum,
+		       uint16_t csum ) {
+
+	/* Calculate deferred checksum, if applicable */
+	if ( iobuf->csum == IOB_CSUM_PARTIAL ) {
+
+		/* Leave (uncomplemented) pseudo-header checksum in
+		 * place if network device will complete the checksum,
+		 * or if the packet is to be segmented (in which case
+		 * each segment's checksum will be completed
+		 * separately).
+		 */
+		if ( netdev_tx_csum ( netdev ) || iobuf->gso ) {
+			*trans_csum = ~csum;
+			return;
+		}
+
+		/* Otherwise, calculate checksum in software */
+		csum = tcpip_continue_chksum ( csum, iobuf->csum_start,
+					       ( iobuf->tail -
+						 iobuf->csum_start ) );
+		iobuf->csum = IOB_CSUM_NONE;
+	}
+
+	/* Store checksum */
+	if ( ! csum )
+		csum = tcpip_protocol->zero_csum;
+	*trans_csum = csum;
+}
+
 /**
  * Determine transmitting network device
  *
@@ -52,6 +52,7 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <ipxe/dhe.h>
 #include <ipxe/ecdhe.h>
 #include <ipxe/tls.h>
+#include <ipxe/trace.h>
 #include <config/crypto.h>
 
 /* Disambiguate the various error causes */
@@ -1136,6 +1137,7 @@ static void tls_restart ( struct tls_connection *tls ) {
 	assert ( ! is_pending ( &tls->server.validation ) );
 
 	/* (Re)start negotiation */
+	trace ( "tls.start", 0 );
 	tls->tx.pending = TLS_TX_CLIENT_HELLO;
 	tls_tx_resume ( tls );
 	pending_get ( &tls->client.negotiation );
@@ -2583,6 +2585,7 @@ static int tls_new_server_hello_done ( struct tls_connection *tls,
 	}
 
 	/* Begin certificate validation */
+	trace ( "tls.verify", 0 );
 	if ( ( rc = create_validator ( &tls->server.validator,
 				       tls->server.chain,
 				       tls->server.root ) ) != 0 ) {
@@ -2668,6 +2671,9 @@ static int tls_new_finished ( struct tls_connection *tls,
 	list_add_tail ( &tls->list, &session->conn );
 	tls_tx_resume_all ( session );
 
+	/* Record handshake completion */
+	trace ( "tls.ready", 0 );
+
 	/* Send notification of a window change */
 	xfer_window_changed ( &tls->plainstream );
 
@@ -3472,8 +3478,27 @@ static struct interface_descriptor tls_plainstream_desc =
  *
  * @v tls		TLS connection
  * @ret rc		Returned status code
+ *
+ * Data buffers are not allocated until the first portion of the data
+ * payload is received, since the payload may be processed in place
+ * without requiring any additional buffers.
  */
 static int tls_newdata_process_header ( struct tls_connection *tls ) {
+
+	/* Move to data state */
+	assert ( list_empty ( &tls->rx.data ) );
+	tls->rx.state = TLS_RX_DATA;
+
+	return 0;
+}
+
+/**
+ * Allocate TLS data payload buffers
+ *
+ * @v tls		TLS connection
+ * @ret rc		Returned status code
+ */
+static int tls_newdata_alloc ( struct tls_connection *tls ) {
 	struct tls_cipherspec *cipherspec = &tls->rx.cipherspec.active;
 	struct cipher_algorithm *cipher = cipherspec->suite->cipher;
 	size_t iv_len = cipherspec->suite->record_iv_len;
@@ -3537,9 +3562,6 @@ static int tls_newdata_process_header ( struct tls_connection *tls ) {
 		list_add_tail ( &iobuf->list, &tls->rx.data );
 	}
 
-	/* Move to data state */
-	tls->rx.state = TLS_RX_DATA;
-
 	return 0;
 
  err:
@@ -3551,24 +3573,64 @@ static int tls_newdata_process_header ( struct tls_connection *tls ) {
 }
 
 /**
- * Handle received TLS data payload
+ * Extract complete TLS data payload from received buffer
  *
  * @v tls		TLS connection
- * @ret rc		Returned status code
+ * @v iobuf		Received I/O buffer (may be replaced or consumed)
+ * @ret record		Data payload buffer, or NULL to use copied buffers
+ *
+ * If the whole data payload is present within the received I/O
+ * buffer, then the payload may be decrypted in place and delivered
+ * without any further copying.  Any trailing data (i.e. the start of
+ * the following record) is copied out to a new I/O buffer, provided
+ * that it is smaller than the payload itself, so that the total
+ * amount of data copied can never exceed the amount that would have
+ * been copied into separately allocated data buffers.
  */
-static int tls_newdata_process_data ( struct tls_connection *tls ) {
-	struct io_buffer *iobuf;
-	int rc;
+static struct io_buffer * tls_newdata_extract ( struct tls_connection *tls,
+						struct io_buffer **iobuf ) {
+	size_t len = ntohs ( tls->rx.header.length );
+	struct io_buffer *record;
+	struct io_buffer *rest;
+	size_t rest_len;
+
+	/* Use copied buffers unless the whole payload is present */
+	if ( iob_len ( *iobuf ) < len )
+		return NULL;
+	rest_len = ( iob_len ( *iobuf ) - len );
 
-	/* Move current buffer to end of list */
-	iobuf = list_first_entry ( &tls->rx.data, struct io_buffer, list );
-	list_del ( &iobuf->list );
-	list_add_tail ( &iobuf->list, &tls->rx.data );
+	/* Use received buffer as-is if it contains only this payload */
+	if ( ! rest_len ) {
+		record = *iobuf;
+		*iobuf = NULL;
+		return record;
+	}
 
-	/* Continue receiving data if any space remains */
-	iobuf = list_first_entry ( &tls->rx.data, struct io_buffer, list );
-	if ( iob_tailroom ( iobuf ) )
-		return 0;
+	/* Use copied buffers if trailing data is larger than payload */
+	if ( rest_len > len )
+		return NULL;
+
+	/* Copy out trailing data */
+	rest = alloc_iob ( rest_len );
+	if ( ! rest )
+		return NULL;
+	memcpy ( iob_put ( rest, rest_len ), ( (*iobuf)->data + len ),
+		 rest_len );
+	iob_unput ( *iobuf, rest_len );
+	record = *iobuf;
+	*iobuf = rest;
+
+	return record;
+}
+
+/**
+ * Handle received TLS record
+ *
+ * @v tls		TLS connection
+ * @ret rc		Returned status code
+ */
+static int tls_newdata_process_record ( struct tls_connection *tls ) {
+	int rc;
 
 	/* Process record */
 	if ( ( rc = tls_new_ciphertext ( tls, &tls->rx.header,
@@ -3586,6 +3648,29 @@ static int tls_newdata_process_data ( struct tls_connection *tls ) {
 	return 0;
 }
 
+/**
+ * Handle received TLS data payload
+ *
+ * @v tls		TLS connection
+ * @ret rc		Returned status code
+ */
+static int tls_newdata_process_data ( struct tls_connection *tls ) {
+	struct io_buffer *iobuf;
+
+	/* Move current buffer to end of list */
+	iobuf = list_first_entry ( &tls->rx.data, struct io_buffer, list );
+	list_del ( &iobuf->list );
+	list_add_tail ( &iobuf->list, &tls->rx.data );
+
+	/* Continue receiving data if any space remains */
+	iobuf = list_first_entry ( &tls->rx.data, struct io_buffer, list );
+	if ( iob_tailroom ( iobuf ) )
+		return 0;
+
+	/* Process record */
+	return tls_newdata_process_record ( tls );
+}
+
 /**
  * Check flow control window
  *
@@ -3614,10 +3699,11 @@ static int tls_cipherstream_deliver ( struct tls_connection *tls,
 				      struct xfer_metadata *xfer __unused ) {
 	size_t frag_len;
 	int ( * process ) ( struct tls_connection *tls );
+	struct io_buffer *record;
 	struct io_buffer *dest;
 	int rc;
 
-	while ( iob_len ( iobuf ) ) {
+	while ( iobuf && iob_len ( iobuf ) ) {
 
 		/* Select buffer according to current state */
 		switch ( tls->rx.state ) {
@@ -3626,6 +3712,29 @@ static int tls_cipherstream_deliver ( struct tls_connection *tls,
 			process = tls_newdata_process_header;
 			break;
 		case TLS_RX_DATA:
+			if ( list_empty ( &tls->rx.data ) ) {
+
+				/* Process whole payload in place, if
+				 * possible.
+				 */
+				record = tls_newdata_extract ( tls, &iobuf );
+				if ( record ) {
+					list_add_tail ( &record->list,
+							&tls->rx.data );
+					if ( ( rc = tls_newdata_process_record
+					       ( tls ) ) != 0 ) {
+						tls_close ( tls, rc );
+						goto done;
+					}
+					continue;
+				}
+
+				/* Otherwise, allocate data buffers */
+				if ( ( rc = tls_newdata_alloc ( tls ) ) != 0 ) {
+					tls_close ( tls, rc );
+					goto done;
+				}
+			}
 			dest = list_first_entry ( &tls->rx.data,
 						  struct io_buffer, list );
 			assert ( dest != NULL );
@@ -3693,6 +3802,7 @@ static void tls_validator_done ( struct tls_connection *tls, int rc ) {
 	struct x509_certificate *cert;
 
 	/* Mark validation as complete */
+	trace ( "tls.verified", rc );
 	pending_put ( &tls->server.validation );
 
 	/* Close validator interface */
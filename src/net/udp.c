@@ -199,8 +199,7 @@ static int udp_tx ( struct udp_connection *udp, struct io_buffer *iobuf,
 	udphdr->dest = dest->st_port;
 	udphdr->src = src->st_port;
 	udphdr->len = htons ( len );
-	udphdr->chksum = 0;
-	udphdr->chksum = tcpip_chksum ( udphdr, len );
+	iob_csum_defer ( iobuf, &udphdr->chksum );
 
 	/* Dump debugging information */
 	DBGC2 ( udp, "UDP %p TX %d->%d len %d\n", udp,
@@ -254,7 +253,7 @@ static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
  * @ret rc		Return status code
  */
 static int udp_rx ( struct io_buffer *iobuf,
-		    struct net_device *netdev __unused,
+		    struct net_device *netdev,
 		    struct sockaddr_tcpip *st_src,
 		    struct sockaddr_tcpip *st_dest, uint16_t pshdr_csum ) {
 	struct udp_header *udphdr = iobuf->data;
@@ -285,7 +284,9 @@ static int udp_rx ( struct io_buffer *iobuf,
 		rc = -EINVAL;
 		goto done;
 	}
-	if ( udphdr->chksum ) {
+	if ( udphdr->chksum &&
+	     ! ( netdev_rx_csum ( netdev ) &&
+		 ( iobuf->csum == IOB_CSUM_VALID ) ) ) {
 		csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data, ulen );
 		if ( csum != 0 ) {
 			DBG ( "UDP checksum incorrect (is %04x including "
@@ -48,6 +48,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcppkt.h>
 #include <ipxe/dhcparch.h>
 #include <ipxe/features.h>
+#include <ipxe/trace.h>
 #include <config/dhcp.h>
 
 /** @file
@@ -267,6 +268,9 @@ static void dhcp_free ( struct refcnt *refcnt ) {
  */
 static void dhcp_finished ( struct dhcp_session *dhcp, int rc ) {
 
+	/* Record completion */
+	trace ( "dhcp.done", rc );
+
 	/* Stop retry timer */
 	stop_timer ( &dhcp->timer );
 
@@ -1380,6 +1384,7 @@ int start_dhcp ( struct interface *job, struct net_device *netdev ) {
 		goto err;
 
 	/* Enter DHCPDISCOVER state */
+	trace ( "dhcp.start", 0 );
 	dhcp_set_state ( dhcp, &dhcp_state_discover );
 
 	/* Attach parent interface, mortalise self, and return */
@@ -46,6 +46,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcp.h>
 #include <ipxe/dhcpv6.h>
 #include <ipxe/dns.h>
+#include <ipxe/trace.h>
 
 /** @file
  *
@@ -500,6 +501,9 @@ struct dns_request {
  */
 static void dns_done ( struct dns_request *dns, int rc ) {
 
+	/* Record completion */
+	trace ( "dns.done", rc );
+
 	/* Stop the retry timer */
 	stop_timer ( &dns->timer );
 
@@ -1036,6 +1040,7 @@ static int dns_resolv ( struct interface *resolv,
 	}
 
 	/* Start timer to trigger first packet */
+	trace ( "dns.start", 0 );
 	start_timer_nodelay ( &dns->timer );
 
 	/* Attach parent interface, mortalise self, and return */
@@ -1468,6 +1468,168 @@ MESSAGE ( nonsigned_sig,
 	       0x5d, 0x70, 0x47, 0x54, 0xbc, 0x15, 0xad, 0x9c, 0xe8, 0x90,
 	       0x52, 0x3e, 0x49, 0x86 ) );
 
+/** Valid ECDSA signature */
+MESSAGE ( ecdsasigned_sig,
+	DATA ( 0x30, 0x82, 0x06, 0x2d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86,
+	       0xf7, 0x0d, 0x01, 0x07, 0x02, 0xa0, 0x82, 0x06, 0x1e, 0x30,
+	       0x82, 0x06, 0x1a, 0x02, 0x01, 0x01, 0x31, 0x0d, 0x30, 0x0b,
+	       0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02,
+	       0x01, 0x30, 0x0b, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7,
+	       0x0d, 0x01, 0x07, 0x01, 0xa0, 0x82, 0x04, 0xf3, 0x30, 0x82,
+	       0x02, 0x50, 0x30, 0x82, 0x01, 0xf5, 0xa0, 0x03, 0x02, 0x01,
+	       0x02, 0x02, 0x01, 0x01, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86,
+	       0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x81, 0x8e, 0x31,
+	       0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02,
+	       0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04,
+	       0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64,
+	       0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31, 0x12, 0x30,
+	       0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09, 0x43, 0x61,
+	       0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31, 0x19, 0x30,
+	       0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65,
+	       0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x73, 0x20,
+	       0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03,
+	       0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x69,
+	       0x6e, 0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03, 0x55, 0x04,
+	       0x03, 0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20, 0x73, 0x65,
+	       0x6c, 0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20, 0x45, 0x43,
+	       0x44, 0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43,
+	       0x41, 0x30, 0x1e, 0x17, 0x0d, 0x31, 0x32, 0x30, 0x31, 0x30,
+	       0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a, 0x17, 0x0d,
+	       0x33, 0x38, 0x31, 0x32, 0x33, 0x31, 0x30, 0x30, 0x30, 0x30,
+	       0x30, 0x30, 0x5a, 0x30, 0x81, 0x8e, 0x31, 0x0b, 0x30, 0x09,
+	       0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x47, 0x42, 0x31,
+	       0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0e,
+	       0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x73,
+	       0x68, 0x69, 0x72, 0x65, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03,
+	       0x55, 0x04, 0x07, 0x0c, 0x09, 0x43, 0x61, 0x6d, 0x62, 0x72,
+	       0x69, 0x64, 0x67, 0x65, 0x31, 0x19, 0x30, 0x17, 0x06, 0x03,
+	       0x55, 0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65, 0x6e, 0x20, 0x53,
+	       0x79, 0x73, 0x74, 0x65, 0x6d, 0x73, 0x20, 0x4c, 0x74, 0x64,
+	       0x2e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0b,
+	       0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x69, 0x6e, 0x67, 0x31,
+	       0x25, 0x30, 0x23, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x1c,
+	       0x69, 0x50, 0x58, 0x45, 0x20, 0x73, 0x65, 0x6c, 0x66, 0x2d,
+	       0x74, 0x65, 0x73, 0x74, 0x20, 0x45, 0x43, 0x44, 0x53, 0x41,
+	       0x20, 0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x30, 0x59,
+	       0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02,
+	       0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01,
+	       0x07, 0x03, 0x42, 0x00, 0x04, 0xed, 0x87, 0x51, 0xc4, 0x9b,
+	       0x32, 0xf0, 0x09, 0xe1, 0x55, 0x17, 0xcf, 0x18, 0x12, 0x72,
+	       0x61, 0x66, 0xba, 0x6e, 0x66, 0xd6, 0xdd, 0x86, 0x6a, 0x45,
+	       0xfb, 0x75, 0xb4, 0x9e, 0x9b, 0x01, 0x87, 0x94, 0xb8, 0x1e,
+	       0x0b, 0xb1, 0x51, 0xa1, 0x57, 0x78, 0x7e, 0x50, 0x3d, 0x7e,
+	       0x65, 0xab, 0x76, 0x9e, 0xce, 0x89, 0x9d, 0x5e, 0x28, 0x30,
+	       0x6a, 0xce, 0x7d, 0x75, 0x29, 0x3a, 0x34, 0xff, 0xea, 0xa3,
+	       0x42, 0x30, 0x40, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x1d, 0x13,
+	       0x01, 0x01, 0xff, 0x04, 0x05, 0x30, 0x03, 0x01, 0x01, 0xff,
+	       0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01, 0x01, 0xff,
+	       0x04, 0x04, 0x03, 0x02, 0x01, 0x06, 0x30, 0x1d, 0x06, 0x03,
+	       0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x4a, 0x39, 0xc3,
+	       0x32, 0x11, 0x91, 0x6f, 0x12, 0x86, 0x76, 0x78, 0x2c, 0x4c,
+	       0xef, 0xd4, 0x06, 0xcf, 0xe4, 0x73, 0x1e, 0x30, 0x0a, 0x06,
+	       0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03,
+	       0x49, 0x00, 0x30, 0x46, 0x02, 0x21, 0x00, 0xce, 0x99, 0xba,
+	       0xa6, 0xcc, 0x22, 0x0e, 0x42, 0x02, 0x70, 0xd4, 0x01, 0x7a,
+	       0xf2, 0x65, 0x26, 0x70, 0x84, 0x5c, 0x6c, 0x41, 0xf8, 0xca,
+	       0x50, 0xe5, 0xda, 0x06, 0xbb, 0x95, 0xa9, 0xab, 0xde, 0x02,
+	       0x21, 0x00, 0xe7, 0xbc, 0x66, 0x46, 0x08, 0x78, 0xc8, 0x9f,
+	       0xf7, 0xad, 0xc9, 0xd1, 0xd2, 0x76, 0x4e, 0x91, 0xf5, 0x18,
+	       0x19, 0x3b, 0x85, 0x02, 0xc8, 0x39, 0x5a, 0xac, 0x7e, 0x68,
+	       0x3b, 0xe6, 0x44, 0x20, 0x30, 0x82, 0x02, 0x9b, 0x30, 0x82,
+	       0x02, 0x41, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x01, 0x02,
+	       0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04,
+	       0x03, 0x02, 0x30, 0x81, 0x8e, 0x31, 0x0b, 0x30, 0x09, 0x06,
+	       0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x47, 0x42, 0x31, 0x17,
+	       0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43,
+	       0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x73, 0x68,
+	       0x69, 0x72, 0x65, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55,
+	       0x04, 0x07, 0x0c, 0x09, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69,
+	       0x64, 0x67, 0x65, 0x31, 0x19, 0x30, 0x17, 0x06, 0x03, 0x55,
+	       0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65, 0x6e, 0x20, 0x53, 0x79,
+	       0x73, 0x74, 0x65, 0x6d, 0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e,
+	       0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c,
+	       0x07, 0x54, 0x65, 0x73, 0x74, 0x69, 0x6e, 0x67, 0x31, 0x25,
+	       0x30, 0x23, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x1c, 0x69,
+	       0x50, 0x58, 0x45, 0x20, 0x73, 0x65, 0x6c, 0x66, 0x2d, 0x74,
+	       0x65, 0x73, 0x74, 0x20, 0x45, 0x43, 0x44, 0x53, 0x41, 0x20,
+	       0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41, 0x30, 0x1e, 0x17,
+	       0x0d, 0x31, 0x32, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30,
+	       0x30, 0x30, 0x30, 0x5a, 0x17, 0x0d, 0x31, 0x33, 0x30, 0x31,
+	       0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a, 0x30,
+	       0x81, 0x85, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04,
+	       0x06, 0x13, 0x02, 0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06,
+	       0x03, 0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62,
+	       0x72, 0x69, 0x64, 0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65,
+	       0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c,
+	       0x09, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65,
+	       0x31, 0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c,
+	       0x10, 0x46, 0x65, 0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65,
+	       0x6d, 0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30,
+	       0x0e, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65,
+	       0x73, 0x74, 0x69, 0x6e, 0x67, 0x31, 0x1c, 0x30, 0x1a, 0x06,
+	       0x03, 0x55, 0x04, 0x03, 0x0c, 0x13, 0x65, 0x63, 0x64, 0x73,
+	       0x61, 0x2e, 0x74, 0x65, 0x73, 0x74, 0x2e, 0x69, 0x70, 0x78,
+	       0x65, 0x2e, 0x6f, 0x72, 0x67, 0x30, 0x59, 0x30, 0x13, 0x06,
+	       0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08,
+	       0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42,
+	       0x00, 0x04, 0x87, 0x03, 0x67, 0xef, 0x33, 0xae, 0xa7, 0x95,
+	       0xef, 0x8b, 0x6b, 0x9c, 0x7c, 0xd5, 0xb0, 0xb5, 0x49, 0x01,
+	       0xa0, 0x9c, 0xef, 0x63, 0x5c, 0x85, 0x66, 0x26, 0xaa, 0xf3,
+	       0xb0, 0xb3, 0xa2, 0x44, 0x84, 0x6f, 0x68, 0x07, 0xb6, 0xd0,
+	       0x8f, 0xa6, 0xb4, 0xd3, 0x35, 0x88, 0xd5, 0x69, 0x85, 0x3a,
+	       0x40, 0x41, 0xfc, 0x23, 0xb2, 0x5f, 0x59, 0xf2, 0x98, 0x02,
+	       0xc4, 0x37, 0x9c, 0xab, 0x65, 0x55, 0xa3, 0x81, 0x96, 0x30,
+	       0x81, 0x93, 0x30, 0x0c, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01,
+	       0x01, 0xff, 0x04, 0x02, 0x30, 0x00, 0x30, 0x0e, 0x06, 0x03,
+	       0x55, 0x1d, 0x0f, 0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02,
+	       0x07, 0x80, 0x30, 0x13, 0x06, 0x03, 0x55, 0x1d, 0x25, 0x04,
+	       0x0c, 0x30, 0x0a, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x05, 0x05,
+	       0x07, 0x03, 0x03, 0x30, 0x1e, 0x06, 0x03, 0x55, 0x1d, 0x11,
+	       0x04, 0x17, 0x30, 0x15, 0x82, 0x13, 0x65, 0x63, 0x64, 0x73,
+	       0x61, 0x2e, 0x74, 0x65, 0x73, 0x74, 0x2e, 0x69, 0x70, 0x78,
+	       0x65, 0x2e, 0x6f, 0x72, 0x67, 0x30, 0x1d, 0x06, 0x03, 0x55,
+	       0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0xeb, 0x8d, 0x94, 0x8a,
+	       0x51, 0x5e, 0xb1, 0x3b, 0x86, 0x09, 0x9b, 0xbb, 0xa7, 0xcf,
+	       0x0f, 0x45, 0x93, 0x95, 0xde, 0x5e, 0x30, 0x1f, 0x06, 0x03,
+	       0x55, 0x1d, 0x23, 0x04, 0x18, 0x30, 0x16, 0x80, 0x14, 0x4a,
+	       0x39, 0xc3, 0x32, 0x11, 0x91, 0x6f, 0x12, 0x86, 0x76, 0x78,
+	       0x2c, 0x4c, 0xef, 0xd4, 0x06, 0xcf, 0xe4, 0x73, 0x1e, 0x30,
+	       0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03,
+	       0x02, 0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x20, 0x0c, 0x72,
+	       0x5d, 0x48, 0x2f, 0xa5, 0x31, 0x9e, 0x18, 0x9e, 0x1b, 0x02,
+	       0x26, 0x4b, 0x89, 0x71, 0xd1, 0x82, 0x77, 0x0c, 0xfb, 0xf3,
+	       0xb5, 0xac, 0x1a, 0x53, 0x26, 0xa1, 0xfa, 0x72, 0xa6, 0x6f,
+	       0x02, 0x21, 0x00, 0xae, 0x31, 0x9b, 0xd9, 0x39, 0x63, 0xf2,
+	       0xbf, 0x3e, 0x23, 0x70, 0xe4, 0x78, 0xeb, 0x7c, 0x19, 0x6f,
+	       0x1b, 0x1e, 0xa7, 0x35, 0x50, 0x08, 0x6d, 0x0d, 0x07, 0x98,
+	       0xe7, 0xa4, 0x41, 0x6e, 0x43, 0x31, 0x82, 0x01, 0x00, 0x30,
+	       0x81, 0xfd, 0x02, 0x01, 0x01, 0x30, 0x81, 0x94, 0x30, 0x81,
+	       0x8e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06,
+	       0x13, 0x02, 0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03,
+	       0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72,
+	       0x69, 0x64, 0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31,
+	       0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09,
+	       0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31,
+	       0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10,
+	       0x46, 0x65, 0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d,
+	       0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e,
+	       0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73,
+	       0x74, 0x69, 0x6e, 0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03,
+	       0x55, 0x04, 0x03, 0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20,
+	       0x73, 0x65, 0x6c, 0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20,
+	       0x45, 0x43, 0x44, 0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74,
+	       0x20, 0x43, 0x41, 0x02, 0x01, 0x02, 0x30, 0x0b, 0x06, 0x09,
+	       0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x30,
+	       0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03,
+	       0x02, 0x04, 0x48, 0x30, 0x46, 0x02, 0x21, 0x00, 0x94, 0x7c,
+	       0xea, 0x3c, 0xa8, 0x27, 0x60, 0x76, 0xf6, 0x97, 0x29, 0xea,
+	       0x13, 0x79, 0xe0, 0x4f, 0x41, 0x39, 0xd5, 0xb1, 0x25, 0x52,
+	       0xc2, 0xbb, 0x5c, 0x8a, 0x76, 0x4c, 0xb1, 0x49, 0x35, 0x3d,
+	       0x02, 0x21, 0x00, 0xc5, 0x1a, 0x8e, 0x73, 0x9d, 0xd8, 0xe7,
+	       0x21, 0x69, 0x53, 0x1c, 0x3c, 0xd8, 0x10, 0x2f, 0xeb, 0x0c,
+	       0x03, 0x6a, 0xf8, 0xd3, 0x66, 0x94, 0x75, 0x98, 0x65, 0x27,
+	       0x4a, 0x35, 0x2b, 0x2d, 0x4a ) );
+
 /** Client certificate and private key */
 KEYPAIR ( client_keypair,
 	DATA ( 0x30, 0x82, 0x02, 0x77, 0x02, 0x01, 0x00, 0x30, 0x0d, 0x06,
@@ -1607,6 +1769,13 @@ static uint8_t root_crt_fingerprint[] =
 		      0x96, 0xe7, 0xa8, 0x6d, 0x63, 0x2d, 0x32, 0x38,
 		      0xaf, 0x00, 0xc4, 0x1a, 0xfc, 0xd8, 0xac, 0xc3 );
 
+/** iPXE self-test ECDSA root CA certificate */
+static uint8_t ecdsa_root_crt_fingerprint[] =
+	FINGERPRINT ( 0x1a, 0x51, 0x82, 0xd4, 0x70, 0x8d, 0x76, 0xc3,
+		      0xbd, 0x2a, 0xfb, 0x6b, 0xd8, 0xe0, 0x12, 0x25,
+		      0x2c, 0xe9, 0x13, 0x3c, 0x3c, 0x1b, 0xfc, 0x1a,
+		      0xf2, 0xb5, 0xef, 0x24, 0x59, 0x94, 0xdf, 0xe1 );
+
 /** Empty certificate store */
 static struct x509_chain empty_store = {
 	.refcnt = REF_INIT ( ref_no_free ),
@@ -1621,6 +1790,14 @@ static struct x509_root test_root = {
 	.fingerprints = root_crt_fingerprint,
 };
 
+/** Root certificate list containing the iPXE self-test ECDSA root CA */
+static struct x509_root ecdsa_root = {
+	.refcnt = REF_INIT ( ref_no_free ),
+	.digest = &cms_test_algorithm,
+	.count = 1,
+	.fingerprints = ecdsa_root_crt_fingerprint,
+};
+
 /** Dummy fingerprint (not matching any certificates) */
 static uint8_t dummy_fingerprint[] =
 	FINGERPRINT ( 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
@@ -1783,6 +1960,7 @@ static void cms_test_exec ( void ) {
 	cms_message_ok ( &brokenchain_sig );
 	cms_message_ok ( &genericsigned_sig );
 	cms_message_ok ( &nonsigned_sig );
+	cms_message_ok ( &ecdsasigned_sig );
 	cms_message_ok ( &hidden_code_cbc_env );
 	cms_message_ok ( &hidden_code_gcm_env );
 
@@ -1821,6 +1999,16 @@ static void cms_test_exec ( void ) {
 	cms_verify_fail_ok ( &codesigned_sig, &test_code,
 			     NULL, test_expired, &empty_store, &test_root );
 
+	/* Check ECDSA signature */
+	cms_verify_ok ( &ecdsasigned_sig, &test_code, "ecdsa.test.ipxe.org",
+			test_time, &empty_store, &ecdsa_root );
+	cms_verify_fail_ok ( &ecdsasigned_sig, &bad_code,
+			     NULL, test_time, &empty_store, &ecdsa_root );
+	cms_verify_fail_ok ( &ecdsasigned_sig, &test_code,
+			     NULL, test_time, &empty_store, &test_root );
+	cms_verify_fail_ok ( &ecdsasigned_sig, &test_code,
+			     NULL, test_expired, &empty_store, &ecdsa_root );
+
 	/* Check CBC decryption (with padding) */
 	cms_decrypt_ok ( &hidden_code_cbc_dat, &hidden_code_cbc_env,
 			 &client_keypair, &hidden_code );
@@ -1835,6 +2023,7 @@ static void cms_test_exec ( void ) {
 	/* Drop message references */
 	cms_put ( hidden_code_gcm_env.cms );
 	cms_put ( hidden_code_cbc_env.cms );
+	cms_put ( ecdsasigned_sig.cms );
 	cms_put ( nonsigned_sig.cms );
 	cms_put ( genericsigned_sig.cms );
 	cms_put ( brokenchain_sig.cms );
@@ -1853,6 +2042,8 @@ struct self_test cms_test __self_test = {
 /* Drag in algorithms required for tests */
 REQUIRING_SYMBOL ( cms_test );
 REQUIRE_OBJECT ( rsa );
+REQUIRE_OBJECT ( ecdsa );
+REQUIRE_OBJECT ( oid_p256 );
 REQUIRE_OBJECT ( md5 );
 REQUIRE_OBJECT ( sha1 );
 REQUIRE_OBJECT ( sha256 );
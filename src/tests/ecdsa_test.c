@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ECDSA self-tests
+ *
+ * These test vectors are generated using openssl's ecparam, pkey,
+ * and dgst tools.
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <ipxe/crypto.h>
+#include <ipxe/ecdsa.h>
+#include <ipxe/sha1.h>
+#include <ipxe/sha256.h>
+#include <ipxe/sha512.h>
+#include <ipxe/test.h>
+#include "pubkey_test.h"
+
+/** "Hello world" P-256 with SHA-256 signature test */
+PUBKEY_VERIFY_TEST ( p256_sha256_test, &ecdsa_algorithm,
+	PUBLIC ( 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce,
+		 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d,
+		 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0xab, 0x6c, 0x4f,
+		 0x05, 0x46, 0xa4, 0x20, 0x9c, 0x52, 0xa8, 0xfb, 0x24, 0x75,
+		 0x26, 0x34, 0x80, 0x50, 0x0b, 0x61, 0x26, 0xa8, 0xd7, 0x2f,
+		 0xcd, 0xfc, 0x02, 0xfd, 0x4e, 0x19, 0xd0, 0x4a, 0xa2, 0x76,
+		 0x50, 0xa8, 0xa8, 0x3e, 0x72, 0xfe, 0x14, 0x7d, 0xcc, 0x8d,
+		 0x69, 0xd4, 0xf1, 0x4d, 0x2c, 0x36, 0x6d, 0x9b, 0x7e, 0x93,
+		 0xe2, 0x21, 0x0b, 0x1b, 0x94, 0x11, 0xbc, 0x04, 0xa2, 0x26,
+		 0x53 ),
+	PLAINTEXT ( 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c,
+		    0x64, 0x0a ),
+	&sha256_algorithm,
+	SIGNATURE ( 0x30, 0x45, 0x02, 0x21, 0x00, 0xb9, 0x80, 0xe3, 0x7c, 0xde,
+		    0xbe, 0x69, 0x89, 0xcc, 0x72, 0xe1, 0xbf, 0xd1, 0xde, 0x9a,
+		    0xb4, 0x68, 0xfd, 0x9f, 0x2a, 0x0d, 0x5c, 0x3b, 0x83, 0x4f,
+		    0x54, 0x74, 0x68, 0xd0, 0x4b, 0x4a, 0x5a, 0x02, 0x20, 0x26,
+		    0xae, 0x29, 0xe5, 0xf8, 0xf4, 0xa9, 0x83, 0x4f, 0x1f, 0x33,
+		    0xd4, 0x53, 0xb7, 0xeb, 0x46, 0xef, 0x67, 0xe9, 0x81, 0x9b,
+		    0x8c, 0x64, 0xb3, 0x55, 0xc7, 0x3e, 0xed, 0x89, 0x0f, 0xdd,
+		    0x05 ) );
+
+/** "Hello world" P-256 with SHA-1 signature test */
+PUBKEY_VERIFY_TEST ( p256_sha1_test, &ecdsa_algorithm,
+	PUBLIC ( 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce,
+		 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d,
+		 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x43, 0x62, 0x82,
+		 0x4e, 0x1b, 0x89, 0x88, 0x44, 0xbc, 0x3a, 0xd5, 0xce, 0x95,
+		 0xae, 0xae, 0x88, 0x3e, 0x8b, 0x6e, 0x82, 0xff, 0x66, 0x2e,
+		 0x66, 0xfb, 0xf5, 0x4e, 0x11, 0x34, 0x61, 0xf9, 0x7a, 0x9f,
+		 0x25, 0x67, 0xf2, 0xd4, 0x30, 0x0f, 0x24, 0xbb, 0xe2, 0xf8,
+		 0x5b, 0x27, 0x1f, 0xac, 0x5b, 0xcf, 0xf5, 0xef, 0xf9, 0x42,
+		 0xc3, 0x9b, 0xa4, 0xd3, 0x53, 0x24, 0xe9, 0xe1, 0x68, 0x44,
+		 0x8d ),
+	PLAINTEXT ( 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c,
+		    0x64, 0x0a ),
+	&sha1_algorithm,
+	SIGNATURE ( 0x30, 0x46, 0x02, 0x21, 0x00, 0x90, 0x4f, 0x80, 0x0f, 0x7c,
+		    0xe5, 0x28, 0xda, 0xa3, 0x5e, 0x6a, 0x29, 0x26, 0xd3, 0xdb,
+		    0x8c, 0x93, 0x67, 0x87, 0xa1, 0x18, 0x3c, 0x0a, 0x9e, 0xed,
+		    0xf6, 0x9a, 0xc3, 0x80, 0xff, 0xce, 0x20, 0x02, 0x21, 0x00,
+		    0x96, 0x65, 0x96, 0x76, 0x99, 0x2f, 0x99, 0x55, 0x09, 0x63,
+		    0x41, 0x42, 0x9f, 0x70, 0x1f, 0xf2, 0x7e, 0xbe, 0x73, 0xef,
+		    0xe9, 0x79, 0xe7, 0x43, 0x4d, 0x5b, 0x90, 0x06, 0x6f, 0x88,
+		    0x90, 0x01 ) );
+
+/** "Hello world" P-384 with SHA-384 signature test */
+PUBKEY_VERIFY_TEST ( p384_sha384_test, &ecdsa_algorithm,
+	PUBLIC ( 0x30, 0x76, 0x30, 0x10, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce,
+		 0x3d, 0x02, 0x01, 0x06, 0x05, 0x2b, 0x81, 0x04, 0x00, 0x22,
+		 0x03, 0x62, 0x00, 0x04, 0x03, 0xf3, 0x07, 0x9e, 0x00, 0xb0,
+		 0x18, 0x1c, 0x33, 0x03, 0xd4, 0xa2, 0x60, 0xba, 0x3c, 0xbe,
+		 0xa3, 0xc1, 0x9b, 0x10, 0xdc, 0x94, 0x00, 0x15, 0x15, 0xe4,
+		 0x37, 0x17, 0xc6, 0x0d, 0x6b, 0x71, 0x05, 0x76, 0x1e, 0xb3,
+		 0x0b, 0x76, 0x37, 0x8d, 0xe2, 0x22, 0x54, 0x52, 0x63, 0xc2,
+		 0xce, 0x25, 0x1f, 0x52, 0x3f, 0x6a, 0xeb, 0xf5, 0x94, 0xdb,
+		 0x97, 0x6f, 0x43, 0x71, 0x51, 0x7d, 0x93, 0x3d, 0xc5, 0xf9,
+		 0xa3, 0x5c, 0x8d, 0xab, 0xdb, 0x1b, 0xf3, 0xcc, 0x2f, 0xdb,
+		 0x06, 0x13, 0x1d, 0xec, 0x3f, 0x45, 0x20, 0x47, 0xf9, 0xfc,
+		 0xd9, 0x90, 0x0c, 0x37, 0xd4, 0x02, 0xd9, 0x18, 0xd9, 0xb5 ),
+	PLAINTEXT ( 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c,
+		    0x64, 0x0a ),
+	&sha384_algorithm,
+	SIGNATURE ( 0x30, 0x65, 0x02, 0x30, 0x50, 0x00, 0x8a, 0x51, 0x4c, 0x53,
+		    0xa6, 0x9c, 0x18, 0x64, 0xce, 0x94, 0xbe, 0x31, 0xa7, 0x20,
+		    0xfb, 0xd7, 0x73, 0x11, 0xbf, 0x04, 0x3a, 0x45, 0x55, 0x89,
+		    0xf4, 0x75, 0x31, 0x6e, 0x85, 0x63, 0xd0, 0x8e, 0x5b, 0xff,
+		    0xc3, 0x66, 0x74, 0x87, 0x09, 0x6b, 0xf9, 0x11, 0xf6, 0x6f,
+		    0x8e, 0x77, 0x02, 0x31, 0x00, 0xa8, 0x20, 0xdf, 0xe5, 0x5a,
+		    0x78, 0xde, 0x8b, 0x18, 0x5d, 0x6f, 0x5e, 0x4b, 0x30, 0x9e,
+		    0x09, 0x3b, 0x3d, 0xbd, 0xda, 0x36, 0x3a, 0x5e, 0x25, 0x0b,
+		    0x11, 0xab, 0xdd, 0xea, 0x2e, 0xd9, 0xc0, 0xe3, 0x57, 0x68,
+		    0x6b, 0x48, 0xd2, 0x89, 0x6f, 0xee, 0x1d, 0x28, 0x6a, 0x6c,
+		    0x86, 0xf6, 0x09 ) );
+
+/** "Hello world" P-384 with SHA-512 (truncated digest) signature test */
+PUBKEY_VERIFY_TEST ( p384_sha512_test, &ecdsa_algorithm,
+	PUBLIC ( 0x30, 0x76, 0x30, 0x10, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce,
+		 0x3d, 0x02, 0x01, 0x06, 0x05, 0x2b, 0x81, 0x04, 0x00, 0x22,
+		 0x03, 0x62, 0x00, 0x04, 0x50, 0x5f, 0x9c, 0x7c, 0x56, 0xc7,
+		 0xa0, 0xab, 0x28, 0x61, 0x0a, 0x69, 0xb0, 0x6e, 0xc2, 0x4d,
+		 0x8b, 0x41, 0x22, 0x85, 0xd6, 0xff, 0xe4, 0x68, 0xe8, 0xda,
+		 0x41, 0x96, 0x35, 0x84, 0xa4, 0x6b, 0x60, 0xe4, 0xef, 0x9f,
+		 0x48, 0x9d, 0xa0, 0x80, 0xf6, 0x22, 0xc2, 0xe2, 0x1d, 0xc8,
+		 0x01, 0xb9, 0x25, 0xcf, 0x1c, 0x42, 0x47, 0x90, 0x09, 0x63,
+		 0x79, 0x5b, 0xc5, 0xee, 0x65, 0xb6, 0xcb, 0xee, 0xf2, 0x5c,
+		 0xd0, 0x2b, 0x56, 0x60, 0xd0, 0x01, 0x83, 0xf1, 0x08, 0x67,
+		 0xf4, 0xc0, 0x84, 0xdd, 0x80, 0xb0, 0xb0, 0x3c, 0x81, 0x28,
+		 0xf0, 0x69, 0xc5, 0xe1, 0x08, 0x18, 0x7a, 0xff, 0x6a, 0x2c ),
+	PLAINTEXT ( 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c,
+		    0x64, 0x0a ),
+	&sha512_algorithm,
+	SIGNATURE ( 0x30, 0x65, 0x02, 0x30, 0x05, 0x13, 0xf3, 0xa9, 0xf2, 0x63,
+		    0xde, 0xda, 0x11, 0x00, 0xb3, 0xff, 0x67, 0x3e, 0x5f, 0xb3,
+		    0x4f, 0x8a, 0x1e, 0xff, 0x3b, 0x08, 0x3b, 0x5b, 0x90, 0xc4,
+		    0xbc, 0x7b, 0xbc, 0x9b, 0xfe, 0x41, 0x23, 0xcc, 0x66, 0x2a,
+		    0x9c, 0x1a, 0xbb, 0x24, 0x01, 0x2f, 0x4e, 0x1a, 0x85, 0xdf,
+		    0x51, 0x8c, 0x02, 0x31, 0x00, 0xf4, 0x98, 0x8e, 0x94, 0x2a,
+		    0xe3, 0xdb, 0x7e, 0xa3, 0xf6, 0x22, 0xf6, 0xb9, 0x29, 0xdd,
+		    0x01, 0xb1, 0x9f, 0xa5, 0x1b, 0x76, 0xc9, 0x60, 0xdd, 0x3c,
+		    0x84, 0xb5, 0xc1, 0x94, 0x52, 0x6b, 0x65, 0xe8, 0x8d, 0x8a,
+		    0x6a, 0x52, 0x93, 0x24, 0x68, 0x03, 0xad, 0x06, 0xba, 0xb0,
+		    0x96, 0x8c, 0x1d ) );
+
+/**
+ * Perform ECDSA self-tests
+ *
+ */
+static void ecdsa_test_exec ( void ) {
+
+	pubkey_verify_ok ( &p256_sha256_test );
+	pubkey_verify_ok ( &p256_sha1_test );
+	pubkey_verify_ok ( &p384_sha384_test );
+	pubkey_verify_ok ( &p384_sha512_test );
+}
+
+/** ECDSA self-test */
+struct self_test ecdsa_test __self_test = {
+	.name = "ecdsa",
+	.exec = ecdsa_test_exec,
+};
+
+/* Drag in required ASN.1 OID-identified algorithms */
+REQUIRING_SYMBOL ( ecdsa_test );
+REQUIRE_OBJECT ( oid_p256 );
+REQUIRE_OBJECT ( oid_p384 );
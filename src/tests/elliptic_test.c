@@ -33,12 +33,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef NDEBUG
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <ipxe/crypto.h>
+#include <ipxe/profile.h>
 #include <ipxe/test.h>
 #include "elliptic_test.h"
 
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
 /**
  * Report elliptic curve point multiplication test result
  *
@@ -73,4 +78,43 @@ void elliptic_okx ( struct elliptic_test *test, const char *file,
 	/* Check expected result */
 	okx ( memcmp ( actual, test->expected, test->expected_len ) == 0,
 	      file, line );
+
+	/* Check that fixed-base and variable-base results agree */
+	if ( curve->base && test->expected_len && ( ! test->base_len ) ) {
+		memset ( actual, 0, sizeof ( actual ) );
+		rc = elliptic_multiply ( curve, curve->base, test->scalar,
+					 actual );
+		okx ( rc == 0, file, line );
+		okx ( memcmp ( actual, test->expected,
+			       test->expected_len ) == 0, file, line );
+	}
+}
+
+/**
+ * Calculate elliptic curve point multiplication cost
+ *
+ * @v curve		Elliptic curve
+ * @v base		Base point (or NULL to use generator)
+ * @ret cost		Cost (in cycles per multiplication)
+ */
+unsigned long elliptic_cost ( struct elliptic_curve *curve,
+			      const void *base ) {
+	uint8_t scalar[curve->keysize];
+	uint8_t result[curve->pointsize];
+	struct profiler profiler;
+	unsigned int i;
+	unsigned int j;
+
+	/* Profile point multiplication using pseudo-random scalars */
+	srand ( 0x1234568 );
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		for ( j = 0 ; j < sizeof ( scalar ) ; j++ )
+			scalar[j] = rand();
+		profile_start ( &profiler );
+		elliptic_multiply ( curve, base, scalar, result );
+		profile_stop ( &profiler );
+	}
+
+	return profile_mean ( &profiler );
 }
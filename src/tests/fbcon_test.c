@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Frame buffer console self-tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/timer.h>
+#include <ipxe/console.h>
+#include <ipxe/fbcon.h>
+#include <ipxe/test.h>
+
+/** Test font height */
+#define FBCON_TEST_FONT_HEIGHT 8
+
+/** Number of characters printed for speed test */
+#define FBCON_TEST_SPEED_COUNT 65536
+
+/** Test font glyph */
+static uint8_t fbcon_test_glyph_rows[FBCON_TEST_FONT_HEIGHT];
+
+/**
+ * Get test font glyph
+ *
+ * @v character		Unicode character
+ * @ret glyph		Character glyph
+ */
+static const uint8_t * fbcon_test_glyph ( unsigned int character ) {
+	unsigned int row;
+
+	/* Generate an arbitrary but deterministic glyph */
+	for ( row = 0 ; row < FBCON_TEST_FONT_HEIGHT ; row++ ) {
+		fbcon_test_glyph_rows[row] =
+			( ( character == ' ' ) ? 0 :
+			  ( ( character * 0x1d ) ^ ( row * 0x45 ) ) );
+	}
+	return fbcon_test_glyph_rows;
+}
+
+/** Test font */
+static struct fbcon_font fbcon_test_font = {
+	.height = FBCON_TEST_FONT_HEIGHT,
+	.glyph = fbcon_test_glyph,
+};
+
+/** Test colour mapping (32-bit xRGB) */
+static struct fbcon_colour_map fbcon_test_map = {
+	.red_lsb = 16,
+	.green_lsb = 8,
+	.blue_lsb = 0,
+};
+
+/** A frame buffer console test */
+struct fbcon_test {
+	/** Pixel geometry */
+	struct fbcon_geometry pixel;
+	/** Frame buffer console */
+	struct fbcon fbcon;
+	/** Frame buffer */
+	void *start;
+};
+
+/**
+ * Initialise frame buffer console test
+ *
+ * @v test		Frame buffer console test
+ * @v width		Width (in pixels)
+ * @v height		Height (in pixels)
+ * @v stride		Stride (in bytes)
+ */
+static void fbcon_test_init ( struct fbcon_test *test, unsigned int width,
+			      unsigned int height, size_t stride ) {
+	struct console_configuration config;
+
+	memset ( &config, 0, sizeof ( config ) );
+	test->pixel.width = width;
+	test->pixel.height = height;
+	test->pixel.len = sizeof ( uint32_t );
+	test->pixel.stride = stride;
+	test->start = umalloc ( height * stride );
+	assert ( test->start != NULL );
+	ok ( fbcon_init ( &test->fbcon, test->start, &test->pixel,
+			  &fbcon_test_map, &fbcon_test_font, &config ) == 0 );
+}
+
+/**
+ * Finalise frame buffer console test
+ *
+ * @v test		Frame buffer console test
+ */
+static void fbcon_test_fini ( struct fbcon_test *test ) {
+
+	fbcon_fini ( &test->fbcon );
+	ufree ( test->start );
+}
+
+/**
+ * Print string to frame buffer console
+ *
+ * @v test		Frame buffer console test
+ * @v string		String
+ */
+static void fbcon_test_print ( struct fbcon_test *test, const char *string ) {
+
+	while ( *string )
+		fbcon_putchar ( &test->fbcon, *(string++) );
+}
+
+/**
+ * Check frame buffer contents against stored text
+ *
+ * @v test		Frame buffer console test
+ * @v file		Test code file
+ * @v line		Test code line
+ *
+ * The cursor must be hidden, and no background picture may be used.
+ */
+static void fbcon_test_okx ( struct fbcon_test *test, const char *file,
+			     unsigned int line ) {
+	struct fbcon *fbcon = &test->fbcon;
+	struct fbcon_text_cell *cell = fbcon->text.cells;
+	const uint8_t *glyph;
+	const uint32_t *pixel;
+	uint32_t expected;
+	unsigned int xpos;
+	unsigned int ypos;
+	unsigned int row;
+	unsigned int column;
+	unsigned int mismatches = 0;
+	size_t offset;
+
+	for ( ypos = 0 ; ypos < fbcon->character.height ; ypos++ ) {
+		for ( xpos = 0 ; xpos < fbcon->character.width ; xpos++ ) {
+			glyph = fbcon_test_glyph ( cell->character );
+			offset = ( fbcon->indent +
+				   ( ypos * fbcon->character.stride ) +
+				   ( xpos * fbcon->character.len ) );
+			for ( row = 0 ; row < FBCON_TEST_FONT_HEIGHT ; row++ ) {
+				pixel = ( test->start + offset +
+					  ( row * test->pixel.stride ) );
+				for ( column = 0 ; column < FBCON_CHAR_WIDTH ;
+				      column++ ) {
+					if ( ( column < 8 ) &&
+					     ( glyph[row] & ( 0x80 >> column ) ) ) {
+						expected = cell->foreground;
+					} else if ( cell->background ==
+						    FBCON_TRANSPARENT ) {
+						expected = 0;
+					} else {
+						expected = cell->background;
+					}
+					if ( pixel[column] != expected )
+						mismatches++;
+				}
+			}
+			cell++;
+		}
+	}
+	okx ( mismatches == 0, file, line );
+}
+#define fbcon_test_ok( test ) fbcon_test_okx ( test, __FILE__, __LINE__ )
+
+/**
+ * Check stored text at a given position
+ *
+ * @v test		Frame buffer console test
+ * @v xpos		X position
+ * @v ypos		Y position
+ * @v string		Expected text
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void fbcon_text_okx ( struct fbcon_test *test, unsigned int xpos,
+			     unsigned int ypos, const char *string,
+			     const char *file, unsigned int line ) {
+	struct fbcon *fbcon = &test->fbcon;
+	struct fbcon_text_cell *cell;
+
+	cell = &fbcon->text.cells[ ( ypos * fbcon->character.width ) + xpos ];
+	while ( *string ) {
+		okx ( cell->character == ( ( unsigned char ) *string ),
+		      file, line );
+		cell++;
+		string++;
+	}
+}
+#define fbcon_text_ok( test, xpos, ypos, string ) \
+	fbcon_text_okx ( test, xpos, ypos, string, __FILE__, __LINE__ )
+
+/**
+ * Measure frame buffer console speed
+ *
+ * @v width		Width (in pixels)
+ * @v height		Height (in pixels)
+ * @v scroll		Force frequent scrolling
+ */
+static void fbcon_test_speed ( unsigned int width, unsigned int height,
+			       int scroll ) {
+	struct fbcon_test test;
+	unsigned long start;
+	unsigned long elapsed;
+	unsigned int i;
+
+	/* Print lines of text, scrolling or overwriting as applicable */
+	fbcon_test_init ( &test, width, height,
+			  ( width * sizeof ( uint32_t ) ) );
+	fbcon_test_print ( &test, "\033[?25l" );
+	start = currticks();
+	for ( i = 0 ; i < FBCON_TEST_SPEED_COUNT ; i++ ) {
+		fbcon_putchar ( &test.fbcon,
+				( ( ( i % 80 ) == 79 ) ?
+				  ( scroll ? '\n' : '\r' ) :
+				  ( 'A' + ( i % 26 ) ) ) );
+	}
+	elapsed = ( currticks() - start );
+	fbcon_test_ok ( &test );
+	fbcon_test_fini ( &test );
+
+	DBG ( "FBCON %dx%d %s %d characters in %ld ticks (%ld "
+	      "characters/s)\n", width, height,
+	      ( scroll ? "scrolled" : "overwrote" ), FBCON_TEST_SPEED_COUNT,
+	      elapsed, ( elapsed ? ( ( FBCON_TEST_SPEED_COUNT *
+				       TICKS_PER_SEC ) / elapsed ) : 0 ) );
+}
+
+/**
+ * Perform frame buffer console self-tests
+ *
+ */
+static void fbcon_test_exec ( void ) {
+	unsigned int console_width_orig = console_width;
+	unsigned int console_height_orig = console_height;
+	struct fbcon_test test;
+
+	/* Use an odd size and stride to exercise margins */
+	fbcon_test_init ( &test, 160, 68, 704 );
+	ok ( test.fbcon.character.width == 17 );
+	ok ( test.fbcon.character.height == 8 );
+
+	/* Hide cursor and print text */
+	fbcon_test_print ( &test, "\033[?25l" );
+	fbcon_test_print ( &test, "Hello world\n" );
+	fbcon_text_ok ( &test, 0, 0, "Hello world" );
+	fbcon_test_ok ( &test );
+
+	/* Print coloured text */
+	fbcon_test_print ( &test, "\033[31;44mRed\033[0m\033[1mBold\033[0m\n" );
+	fbcon_text_ok ( &test, 0, 1, "RedBold" );
+	fbcon_test_ok ( &test );
+
+	/* Print text using more colour pairs than are cached */
+	fbcon_test_print ( &test, "\033[31;40mA\033[32;41mB\033[33;42mC"
+			   "\033[34;43mD\033[35;44mE\033[36;45mF"
+			   "\033[31;40mA\033[0m\r" );
+	fbcon_text_ok ( &test, 0, 2, "ABCDEFA" );
+	fbcon_test_ok ( &test );
+
+	/* Overwrite text */
+	fbcon_test_print ( &test, "Overwritten\rOver\n" );
+	fbcon_text_ok ( &test, 0, 2, "Overwritten" );
+	fbcon_test_ok ( &test );
+
+	/* Wrap and scroll */
+	fbcon_test_print ( &test, "0123456789abcdefghij\n1\n2\n3\n" );
+	fbcon_text_ok ( &test, 0, 1, "Overwritten" );
+	fbcon_text_ok ( &test, 0, 2, "0123456789abcdefg" );
+	fbcon_text_ok ( &test, 0, 3, "hij" );
+	fbcon_text_ok ( &test, 0, 6, "3" );
+	fbcon_test_ok ( &test );
+
+	/* Clear screen */
+	fbcon_test_print ( &test, "\033[2J\033[44mBlue\n" );
+	fbcon_text_ok ( &test, 0, 0, "Blue" );
+	fbcon_test_ok ( &test );
+	fbcon_test_fini ( &test );
+
+	/* Measure speed */
+	fbcon_test_speed ( 1024, 768, 1 );
+	fbcon_test_speed ( 1024, 768, 0 );
+
+	/* Restore console size */
+	console_set_size ( console_width_orig, console_height_orig );
+}
+
+/** Frame buffer console self-test */
+struct self_test fbcon_test __self_test = {
+	.name = "fbcon",
+	.exec = fbcon_test_exec,
+};
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Software segmentation offload self-tests
+ *
+ * These tests construct TCP/IPv4 and TCP/IPv6 large sends (in the
+ * form produced by the network layer) and transmit them via a test
+ * network device that does not support segmentation offload.  Each
+ * transmitted segment is then checked for correct lengths, sequence
+ * number, flags, and checksums, both with and without transmit
+ * checksum offload.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <byteswap.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/device.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/ethernet.h>
+#include <ipxe/if_ether.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/tcp.h>
+#include <ipxe/ip.h>
+#include <ipxe/ipv6.h>
+#include <ipxe/test.h>
+
+/** Maximum number of segments */
+#define GSO_TEST_MAX_SEGMENTS 8
+
+/** Initial sequence number */
+#define GSO_TEST_SEQ 0x12345678UL
+
+/** Initial IPv4 datagram identifier */
+#define GSO_TEST_IDENT 0x2a05
+
+/** A segmentation offload test */
+struct gso_test {
+	/** Segmentation offload type */
+	unsigned int gso;
+	/** Length of transport-layer payload */
+	size_t len;
+	/** Maximum segment payload length */
+	size_t mss;
+	/** TCP flags */
+	uint8_t flags;
+};
+
+/** Define a segmentation offload test */
+#define GSO_TEST( name, GSO, LEN, MSS, FLAGS )				\
+	static struct gso_test name = {					\
+		.gso = GSO,						\
+		.len = LEN,						\
+		.mss = MSS,						\
+		.flags = FLAGS,						\
+	}
+
+/** Transmitted segments */
+static struct io_buffer *gso_test_segments[GSO_TEST_MAX_SEGMENTS];
+
+/** Number of transmitted segments */
+static unsigned int gso_test_count;
+
+/** Test IPv4 source address */
+static const struct in_addr gso_test_src = { htonl ( 0xc0a80001UL ) };
+
+/** Test IPv4 destination address */
+static const struct in_addr gso_test_dest = { htonl ( 0xc0a80002UL ) };
+
+/** Test IPv6 source address */
+static const struct in6_addr gso_test_src6 = {
+	.s6_addr = { 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		     0x02, 0x11, 0x22, 0xff, 0xfe, 0x33, 0x44, 0x55 },
+};
+
+/** Test IPv6 destination address */
+static const struct in6_addr gso_test_dest6 = {
+	.s6_addr = { 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		     0x02, 0x66, 0x77, 0xff, 0xfe, 0x88, 0x99, 0xaa },
+};
+
+/**
+ * Open network device
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int gso_test_open ( struct net_device *netdev __unused ) {
+
+	/* Do nothing, successfully */
+	return 0;
+}
+
+/**
+ * Close network device
+ *
+ * @v netdev		Network device
+ */
+static void gso_test_close ( struct net_device *netdev __unused ) {
+
+	/* Do nothing */
+}
+
+/**
+ * Transmit packet
+ *
+ * @v netdev		Network device
+ * @v iobuf		I/O buffer
+ * @ret rc		Return status code
+ */
+static int gso_test_transmit ( struct net_device *netdev __unused,
+			       struct io_buffer *iobuf ) {
+
+	/* Record segment (to be completed once checked) */
+	assert ( gso_test_count < GSO_TEST_MAX_SEGMENTS );
+	gso_test_segments[ gso_test_count++ ] = iobuf;
+	return 0;
+}
+
+/**
+ * Poll for completed and received packets
+ *
+ * @v netdev		Network device
+ */
+static void gso_test_poll ( struct net_device *netdev __unused ) {
+
+	/* Do nothing */
+}
+
+/** Test network device operations */
+static struct net_device_operations gso_test_operations = {
+	.open		= gso_test_open,
+	.close		= gso_test_close,
+	.transmit	= gso_test_transmit,
+	.poll		= gso_test_poll,
+};
+
+/** Dummy physical device */
+static struct device gso_test_dev = {
+	.name = "gsotest",
+	.driver_name = "gsotest",
+	.siblings = LIST_HEAD_INIT ( gso_test_dev.siblings ),
+	.children = LIST_HEAD_INIT ( gso_test_dev.children ),
+};
+
+/**
+ * Calculate pseudo-header checksum
+ *
+ * @v test		Segmentation offload test
+ * @v trans_len		Length of transport-layer data
+ * @ret csum		Pseudo-header checksum
+ */
+static uint16_t gso_test_pshdr_chksum ( struct gso_test *test,
+					size_t trans_len ) {
+	struct ipv4_pseudo_header pshdr;
+	struct ipv6_pseudo_header pshdr6;
+
+	if ( test->gso == IOB_GSO_TCPV4 ) {
+		pshdr.src = gso_test_src;
+		pshdr.dest = gso_test_dest;
+		pshdr.zero_padding = 0;
+		pshdr.protocol = IP_TCP;
+		pshdr.len = htons ( trans_len );
+		return tcpip_chksum ( &pshdr, sizeof ( pshdr ) );
+	} else {
+		memset ( &pshdr6, 0, sizeof ( pshdr6 ) );
+		memcpy ( &pshdr6.src, &gso_test_src6, sizeof ( pshdr6.src ) );
+		memcpy ( &pshdr6.dest, &gso_test_dest6,
+			 sizeof ( pshdr6.dest ) );
+		pshdr6.len = htonl ( trans_len );
+		pshdr6.next_header = IP_TCP;
+		return tcpip_chksum ( &pshdr6, sizeof ( pshdr6 ) );
+	}
+}
+
+/**
+ * Construct large send
+ *
+ * @v test		Segmentation offload test
+ * @ret iobuf		I/O buffer
+ */
+static struct io_buffer * gso_test_large_send ( struct gso_test *test ) {
+	struct io_buffer *iobuf;
+	struct ethhdr *ethhdr;
+	struct iphdr *iphdr;
+	struct ipv6_header *ip6hdr;
+	struct tcp_header *tcphdr;
+	uint8_t *payload;
+	size_t net_len;
+	size_t trans_len;
+	unsigned int i;
+
+	/* Allocate I/O buffer */
+	net_len = ( ( test->gso == IOB_GSO_TCPV4 ) ?
+		    sizeof ( *iphdr ) : sizeof ( *ip6hdr ) );
+	trans_len = ( sizeof ( *tcphdr ) + test->len );
+	iobuf = alloc_iob ( sizeof ( *ethhdr ) + net_len + trans_len );
+	if ( ! iobuf )
+		return NULL;
+
+	/* Construct link-layer header */
+	ethhdr = iob_put ( iobuf, sizeof ( *ethhdr ) );
+	memset ( ethhdr, 0, sizeof ( *ethhdr ) );
+	ethhdr->h_protocol = ( ( test->gso == IOB_GSO_TCPV4 ) ?
+			       htons ( ETH_P_IP ) : htons ( ETH_P_IPV6 ) );
+
+	/* Construct network-layer header */
+	if ( test->gso == IOB_GSO_TCPV4 ) {
+		iphdr = iob_put ( iobuf, sizeof ( *iphdr ) );
+		memset ( iphdr, 0, sizeof ( *iphdr ) );
+		iphdr->verhdrlen = ( IP_VER | ( sizeof ( *iphdr ) / 4 ) );
+		iphdr->len = htons ( net_len + trans_len );
+		iphdr->ident = htons ( GSO_TEST_IDENT );
+		iphdr->ttl = IP_TTL;
+		iphdr->protocol = IP_TCP;
+		iphdr->src = gso_test_src;
+		iphdr->dest = gso_test_dest;
+		iphdr->chksum = tcpip_chksum ( iphdr, sizeof ( *iphdr ) );
+		iobuf->gso_start = iphdr;
+	} else {
+		ip6hdr = iob_put ( iobuf, sizeof ( *ip6hdr ) );
+		memset ( ip6hdr, 0, sizeof ( *ip6hdr ) );
+		ip6hdr->ver_tc_label = htonl ( IPV6_VER );
+		ip6hdr->len = htons ( trans_len );
+		ip6hdr->next_header = IP_TCP;
+		ip6hdr->hop_limit = IPV6_HOP_LIMIT;
+		memcpy ( &ip6hdr->src, &gso_test_src6, sizeof ( ip6hdr->src ) );
+		memcpy ( &ip6hdr->dest, &gso_test_dest6,
+			 sizeof ( ip6hdr->dest ) );
+		iobuf->gso_start = ip6hdr;
+	}
+
+	/* Construct transport-layer header */
+	tcphdr = iob_put ( iobuf, sizeof ( *tcphdr ) );
+	memset ( tcphdr, 0, sizeof ( *tcphdr ) );
+	tcphdr->src = htons ( 49152 );
+	tcphdr->dest = htons ( 80 );
+	tcphdr->seq = htonl ( GSO_TEST_SEQ );
+	tcphdr->ack = htonl ( 0x87654321UL );
+	tcphdr->hlen = ( ( sizeof ( *tcphdr ) / 4 ) << 4 );
+	tcphdr->flags = test->flags;
+	tcphdr->win = htons ( 65535 );
+
+	/* Construct payload */
+	payload = iob_put ( iobuf, test->len );
+	for ( i = 0 ; i < test->len ; i++ )
+		payload[i] = ( i * 7 );
+
+	/* Defer checksum and segmentation, leaving the uncomplemented
+	 * pseudo-header checksum in place as done by the network layer.
+	 */
+	iobuf->csum = IOB_CSUM_PARTIAL;
+	iobuf->csum_start = tcphdr;
+	iobuf->csum_offset = offsetof ( typeof ( *tcphdr ), csum );
+	iob_gso_defer ( iobuf, test->gso, test->mss );
+	tcphdr->csum = ~gso_test_pshdr_chksum ( test, trans_len );
+
+	return iobuf;
+}
+
+/**
+ * Report segmentation offload test result
+ *
+ * @v test		Segmentation offload test
+ * @v tx_csum		Network device supports transmit checksum offload
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void gso_okx ( struct gso_test *test, int tx_csum, const char *file,
+		      unsigned int line ) {
+	struct net_device *netdev;
+	struct io_buffer *iobuf;
+	struct io_buffer *segment;
+	struct iphdr *iphdr;
+	struct ipv6_header *ip6hdr;
+	struct tcp_header *tcphdr;
+	size_t hdr_len;
+	size_t net_len;
+	size_t trans_len;
+	size_t offset;
+	size_t len;
+	unsigned int expected;
+	unsigned int i;
+	unsigned int j;
+	uint8_t *payload;
+	uint16_t pshdr_csum;
+
+	/* Create test network device */
+	netdev = alloc_etherdev ( 0 );
+	okx ( netdev != NULL, file, line );
+	netdev_init ( netdev, &gso_test_operations );
+	netdev->dev = &gso_test_dev;
+	okx ( register_netdev ( netdev ) == 0, file, line );
+	okx ( netdev_open ( netdev ) == 0, file, line );
+	netdev->state &= ~( NETDEV_TX_CSUM | NETDEV_TX_TSO );
+	if ( tx_csum )
+		netdev->state |= NETDEV_TX_CSUM;
+
+	/* Construct and transmit large send */
+	iobuf = gso_test_large_send ( test );
+	okx ( iobuf != NULL, file, line );
+	net_len = ( ( test->gso == IOB_GSO_TCPV4 ) ?
+		    sizeof ( *iphdr ) : sizeof ( *ip6hdr ) );
+	hdr_len = ( sizeof ( struct ethhdr ) + net_len + sizeof ( *tcphdr ) );
+	gso_test_count = 0;
+	okx ( netdev_tx ( netdev, iobuf ) == 0, file, line );
+
+	/* Check number of segments */
+	expected = ( ( test->len + test->mss - 1 ) / test->mss );
+	okx ( gso_test_count == expected, file, line );
+
+	/* Check each segment */
+	for ( i = 0, offset = 0 ; i < gso_test_count ; i++, offset += len ) {
+		segment = gso_test_segments[i];
+		len = ( test->len - offset );
+		if ( len > test->mss )
+			len = test->mss;
+		trans_len = ( sizeof ( *tcphdr ) + len );
+		okx ( iob_len ( segment ) == ( hdr_len + len ), file, line );
+
+		/* Check network-layer header */
+		if ( test->gso == IOB_GSO_TCPV4 ) {
+			iphdr = ( segment->data + sizeof ( struct ethhdr ) );
+			tcphdr = ( ( ( void * ) iphdr ) + sizeof ( *iphdr ) );
+			okx ( ntohs ( iphdr->len ) == ( net_len + trans_len ),
+			      file, line );
+			okx ( ntohs ( iphdr->ident ) ==
+			      ( ( GSO_TEST_IDENT + ( i << 8 ) ) & 0xffff ),
+			      file, line );
+			okx ( tcpip_chksum ( iphdr, sizeof ( *iphdr ) ) == 0,
+			      file, line );
+		} else {
+			ip6hdr = ( segment->data + sizeof ( struct ethhdr ) );
+			tcphdr = ( ( ( void * ) ip6hdr ) + sizeof ( *ip6hdr ) );
+			okx ( ntohs ( ip6hdr->len ) == trans_len, file, line );
+		}
+
+		/* Check transport-layer header and payload */
+		okx ( ntohl ( tcphdr->seq ) == ( GSO_TEST_SEQ + offset ),
+		      file, line );
+		okx ( ( tcphdr->flags & ( TCP_FIN | TCP_PSH ) ) ==
+		      ( ( ( i + 1 ) == gso_test_count ) ?
+			( test->flags & ( TCP_FIN | TCP_PSH ) ) : 0 ),
+		      file, line );
+		okx ( ( ( tcphdr->flags ^ test->flags ) &
+			~( TCP_FIN | TCP_PSH ) ) == 0, file, line );
+		payload = ( ( ( void * ) tcphdr ) + sizeof ( *tcphdr ) );
+		for ( j = 0 ; j < len ; j++ ) {
+			if ( payload[j] != ( uint8_t ) ( ( offset + j ) * 7 ) )
+				break;
+		}
+		okx ( j == len, file, line );
+
+		/* Check checksum.  If the device is to complete the
+		 * checksum, check the (uncomplemented) pseudo-header
+		 * checksum seed and then complete the checksum as the
+		 * hardware would.
+		 */
+		pshdr_csum = gso_test_pshdr_chksum ( test, trans_len );
+		if ( tx_csum ) {
+			okx ( segment->csum == IOB_CSUM_PARTIAL, file, line );
+			okx ( segment->csum_start == tcphdr, file, line );
+			okx ( segment->csum_offset ==
+			      offsetof ( typeof ( *tcphdr ), csum ),
+			      file, line );
+			okx ( ( tcphdr->csum ^ pshdr_csum ) == 0xffff,
+			      file, line );
+			tcphdr->csum = tcpip_chksum ( tcphdr, trans_len );
+		} else {
+			okx ( segment->csum != IOB_CSUM_PARTIAL, file, line );
+		}
+		okx ( tcpip_continue_chksum ( pshdr_csum, tcphdr,
+					      trans_len ) == 0, file, line );
+	}
+
+	/* Complete segments and remove test network device */
+	for ( i = 0 ; i < gso_test_count ; i++ )
+		netdev_tx_complete ( netdev, gso_test_segments[i] );
+	unregister_netdev ( netdev );
+	netdev_nullify ( netdev );
+	netdev_put ( netdev );
+}
+#define gso_ok( test, tx_csum ) \
+	gso_okx ( test, tx_csum, __FILE__, __LINE__ )
+
+/** IPv4 large send with a short final segment */
+GSO_TEST ( gso_ipv4, IOB_GSO_TCPV4, 3000, 1200, ( TCP_ACK | TCP_PSH ) );
+
+/** IPv4 large send ending with FIN */
+GSO_TEST ( gso_ipv4_fin, IOB_GSO_TCPV4, 2920, 1460,
+	   ( TCP_ACK | TCP_PSH | TCP_FIN ) );
+
+/** IPv6 large send with a short final segment */
+GSO_TEST ( gso_ipv6, IOB_GSO_TCPV6, 4001, 1440,
+	   ( TCP_ACK | TCP_PSH | TCP_FIN ) );
+
+/**
+ * Perform segmentation offload self-tests
+ *
+ */
+static void gso_test_exec ( void ) {
+
+	gso_ok ( &gso_ipv4, 0 );
+	gso_ok ( &gso_ipv4, 1 );
+	gso_ok ( &gso_ipv4_fin, 0 );
+	gso_ok ( &gso_ipv4_fin, 1 );
+	gso_ok ( &gso_ipv6, 0 );
+	gso_ok ( &gso_ipv6, 1 );
+}
+
+/** Segmentation offload self-test */
+struct self_test gso_test __self_test = {
+	.name = "gso",
+	.exec = gso_test_exec,
+};
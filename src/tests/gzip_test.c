@@ -33,10 +33,16 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef NDEBUG
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ipxe/image.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/inflate.h>
 #include <ipxe/gzip.h>
 #include <ipxe/test.h>
+#include "inflate_test.h"
 
 /** A gzip test */
 struct gzip_test {
@@ -102,6 +108,99 @@ GZIP ( hello_headers,
 	      0x72, 0x74, 0x65, 0x64, 0x20, 0x68, 0x65, 0x61, 0x64, 0x65,
 	      0x72, 0x73 ) );
 
+/**
+ * Deliver fragment to streaming decompressor
+ *
+ * @v inflater		Streaming decompressor
+ * @v xferbuf		Data transfer buffer
+ * @v data		Data
+ * @v offset		Absolute offset of fragment
+ * @v len		Length of fragment
+ * @v file		Test code file
+ * @v line		Test code line
+ * @ret rc		Return status code
+ */
+static int gzip_inflate_fragment ( struct inflater *inflater,
+				   struct xfer_buffer *xferbuf,
+				   const void *data, size_t offset,
+				   size_t len, const char *file,
+				   unsigned int line ) {
+	struct xfer_metadata meta;
+	struct io_buffer *iobuf;
+
+	/* Construct fragment */
+	iobuf = alloc_iob ( len );
+	okx ( iobuf != NULL, file, line );
+	if ( ! iobuf )
+		return 0;
+	memcpy ( iob_put ( iobuf, len ), ( data + offset ), len );
+	memset ( &meta, 0, sizeof ( meta ) );
+	meta.flags = XFER_FL_ABS_OFFSET;
+	meta.offset = offset;
+
+	/* Deliver fragment */
+	return inflater_deliver ( inflater, xferbuf, iobuf, &meta );
+}
+
+/**
+ * Report streaming decompression result with repeated blocks
+ *
+ * @v data		Data to deliver
+ * @v len		Length of data to deliver
+ * @v expected		Expected stored data
+ * @v expected_len	Length of expected stored data
+ * @v file		Test code file
+ * @v line		Test code line
+ *
+ * Data is delivered using absolute offsets in overlapping blocks,
+ * with each block delivered twice (as would happen with a
+ * retransmitted TFTP block).
+ */
+static void gzip_inflate_repeat_okx ( const void *data, size_t len,
+				      const void *expected,
+				      size_t expected_len,
+				      const char *file, unsigned int line ) {
+	struct xfer_buffer xferbuf;
+	struct inflater *inflater;
+	size_t frag_len;
+	size_t i;
+
+	/* Allocate streaming decompressor */
+	inflater = alloc_inflater();
+	okx ( inflater != NULL, file, line );
+	memset ( &xferbuf, 0, sizeof ( xferbuf ) );
+	xferbuf_malloc_init ( &xferbuf );
+
+	/* Check that data following a gap is rejected */
+	if ( len > 1 ) {
+		okx ( gzip_inflate_fragment ( inflater, &xferbuf, data, 1,
+					      1, file, line ) != 0, file, line );
+	}
+
+	/* Deliver overlapping blocks, each repeated */
+	for ( i = 0 ; i < len ; i += 2 ) {
+		frag_len = ( len - i );
+		if ( frag_len > 4 )
+			frag_len = 4;
+		okx ( gzip_inflate_fragment ( inflater, &xferbuf, data, i,
+					      frag_len, file, line ) == 0,
+		      file, line );
+		okx ( gzip_inflate_fragment ( inflater, &xferbuf, data, i,
+					      frag_len, file, line ) == 0,
+		      file, line );
+	}
+	okx ( inflater_finish ( inflater, &xferbuf ) == 0, file, line );
+
+	/* Verify stored data */
+	okx ( xferbuf.len == expected_len, file, line );
+	okx ( memcmp ( xferbuf.data, expected, expected_len ) == 0,
+	      file, line );
+
+	/* Free data */
+	xferbuf_free ( &xferbuf );
+	free ( inflater );
+}
+
 /**
  * Report gzip test result
  *
@@ -138,6 +237,19 @@ static void gzip_okx ( struct gzip_test *test, const char *file,
 	/* Unregister images */
 	unregister_image ( extracted );
 	unregister_image ( image );
+
+	/* Decompress as a stream */
+	inflate_okx ( test->compressed, test->compressed_len,
+		      test->expected, test->expected_len, file, line );
+
+	/* Decompress with duplicate and overlapping blocks */
+	gzip_inflate_repeat_okx ( test->compressed, test->compressed_len,
+				  test->expected, test->expected_len,
+				  file, line );
+
+	/* Store uncompressed data unmodified */
+	inflate_okx ( test->expected, test->expected_len,
+		      test->expected, test->expected_len, file, line );
 }
 #define gzip_ok( test ) gzip_okx ( test, __FILE__, __LINE__ )
 
@@ -0,0 +1,565 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * HTTP pipelining self-tests
+ *
+ * These tests register a dummy URI scheme whose connections are
+ * attached to in-memory test servers rather than to real sockets,
+ * and then drive pipelined HTTP transactions through responses that
+ * are split across (or packed into) received I/O buffers.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/uri.h>
+#include <ipxe/http.h>
+#include <ipxe/test.h>
+
+/** Maximum number of test servers */
+#define HTTP_TEST_MAX_SERVERS 8
+
+/** Maximum length of received data */
+#define HTTP_TEST_MAX_LEN 1024
+
+/** Number of scheduler steps used to quiesce all processes */
+#define HTTP_TEST_STEPS 16
+
+/** A test server connection */
+struct http_test_server {
+	/** Socket interface */
+	struct interface socket;
+	/** Received requests (NUL-terminated) */
+	char rx[HTTP_TEST_MAX_LEN];
+	/** Length of received requests */
+	size_t rx_len;
+	/** Connection has been closed */
+	int closed;
+};
+
+/** A test client transaction */
+struct http_test_client {
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Received content (NUL-terminated) */
+	char rx[HTTP_TEST_MAX_LEN];
+	/** Length of received content */
+	size_t rx_len;
+	/** Transaction has been closed */
+	int closed;
+	/** Reason for close */
+	int rc;
+};
+
+/** Test servers */
+static struct http_test_server http_test_servers[HTTP_TEST_MAX_SERVERS];
+
+/** Number of test servers opened */
+static unsigned int http_test_server_count;
+
+/** Test clients */
+static struct http_test_client http_test_a;
+static struct http_test_client http_test_b;
+static struct http_test_client http_test_c;
+static struct http_test_client http_test_d;
+
+/**
+ * Append received data to buffer
+ *
+ * @v buf		Buffer
+ * @v buf_len		Length of data already in buffer
+ * @v iobuf		I/O buffer
+ */
+static void http_test_append ( char *buf, size_t *buf_len,
+			       struct io_buffer *iobuf ) {
+	size_t len = iob_len ( iobuf );
+
+	assert ( ( *buf_len + len ) < HTTP_TEST_MAX_LEN );
+	memcpy ( ( buf + *buf_len ), iobuf->data, len );
+	*buf_len += len;
+	buf[*buf_len] = '\0';
+	free_iob ( iobuf );
+}
+
+/**
+ * Receive request data at test server
+ *
+ * @v server		Test server
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_test_server_deliver ( struct http_test_server *server,
+				      struct io_buffer *iobuf,
+				      struct xfer_metadata *meta __unused ) {
+
+	http_test_append ( server->rx, &server->rx_len, iobuf );
+	return 0;
+}
+
+/**
+ * Check test server flow control window
+ *
+ * @v server		Test server
+ * @ret len		Length of window
+ */
+static size_t http_test_server_window ( struct http_test_server *server
+					__unused ) {
+
+	return HTTP_TEST_MAX_LEN;
+}
+
+/**
+ * Close test server connection
+ *
+ * @v server		Test server
+ * @v rc		Reason for close
+ */
+static void http_test_server_close ( struct http_test_server *server,
+				     int rc __unused ) {
+
+	server->closed = 1;
+	intf_restart ( &server->socket, 0 );
+}
+
+/** Test server socket interface operations */
+static struct interface_operation http_test_server_ops[] = {
+	INTF_OP ( xfer_deliver, struct http_test_server *,
+		  http_test_server_deliver ),
+	INTF_OP ( xfer_window, struct http_test_server *,
+		  http_test_server_window ),
+	INTF_OP ( intf_close, struct http_test_server *,
+		  http_test_server_close ),
+};
+
+/** Test server socket interface descriptor */
+static struct interface_descriptor http_test_server_desc =
+	INTF_DESC ( struct http_test_server, socket, http_test_server_ops );
+
+/**
+ * Receive content at test client
+ *
+ * @v client		Test client
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_test_client_deliver ( struct http_test_client *client,
+				      struct io_buffer *iobuf,
+				      struct xfer_metadata *meta __unused ) {
+
+	http_test_append ( client->rx, &client->rx_len, iobuf );
+	return 0;
+}
+
+/**
+ * Check test client flow control window
+ *
+ * @v client		Test client
+ * @ret len		Length of window
+ */
+static size_t http_test_client_window ( struct http_test_client *client
+					__unused ) {
+
+	return HTTP_TEST_MAX_LEN;
+}
+
+/**
+ * Close test client transaction
+ *
+ * @v client		Test client
+ * @v rc		Reason for close
+ */
+static void http_test_client_close ( struct http_test_client *client,
+				     int rc ) {
+
+	client->closed = 1;
+	client->rc = rc;
+	intf_restart ( &client->xfer, rc );
+}
+
+/** Test client data transfer interface operations */
+static struct interface_operation http_test_client_ops[] = {
+	INTF_OP ( xfer_deliver, struct http_test_client *,
+		  http_test_client_deliver ),
+	INTF_OP ( xfer_window, struct http_test_client *,
+		  http_test_client_window ),
+	INTF_OP ( intf_close, struct http_test_client *,
+		  http_test_client_close ),
+};
+
+/** Test client data transfer interface descriptor */
+static struct interface_descriptor http_test_client_desc =
+	INTF_DESC ( struct http_test_client, xfer, http_test_client_ops );
+
+/**
+ * Attach HTTP connection to next test server
+ *
+ * @v conn		HTTP connection
+ * @ret rc		Return status code
+ */
+static int http_test_filter ( struct http_connection *conn ) {
+	struct http_test_server *server;
+
+	/* Allocate test server */
+	if ( http_test_server_count >= HTTP_TEST_MAX_SERVERS )
+		return -ENOBUFS;
+	server = &http_test_servers[ http_test_server_count++ ];
+	memset ( server, 0, sizeof ( *server ) );
+	intf_init ( &server->socket, &http_test_server_desc, NULL );
+
+	/* Replace real socket with test server */
+	intf_restart ( &conn->socket, 0 );
+	intf_plug_plug ( &conn->socket, &server->socket );
+
+	return 0;
+}
+
+/** Test URI scheme */
+struct http_scheme http_test_scheme __http_scheme = {
+	.name = "httptest",
+	.port = HTTP_PORT,
+	.filter = http_test_filter,
+};
+
+/**
+ * Run scheduler until idle
+ *
+ */
+static void http_test_step ( void ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < HTTP_TEST_STEPS ; i++ )
+		step();
+}
+
+/**
+ * Open test client transaction
+ *
+ * @v client		Test client
+ * @v uri_string	URI string
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void http_test_open_okx ( struct http_test_client *client,
+				 const char *uri_string, const char *file,
+				 unsigned int line ) {
+	struct uri *uri;
+
+	/* Initialise client */
+	memset ( client, 0, sizeof ( *client ) );
+	intf_init ( &client->xfer, &http_test_client_desc, NULL );
+
+	/* Open transaction */
+	uri = parse_uri ( uri_string );
+	okx ( uri != NULL, file, line );
+	okx ( http_open ( &client->xfer, &http_get, uri, NULL,
+			  NULL ) == 0, file, line );
+	uri_put ( uri );
+
+	/* Allow request to be transmitted */
+	http_test_step();
+}
+#define http_test_open_ok( client, uri_string ) \
+	http_test_open_okx ( client, uri_string, __FILE__, __LINE__ )
+
+/**
+ * Send response data from test server
+ *
+ * @v server		Test server
+ * @v data		Response data
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void http_test_respond_okx ( struct http_test_server *server,
+				    const char *data, const char *file,
+				    unsigned int line ) {
+
+	okx ( ! server->closed, file, line );
+	okx ( xfer_deliver_raw ( &server->socket, data,
+				 strlen ( data ) ) == 0, file, line );
+	http_test_step();
+}
+#define http_test_respond_ok( server, data ) \
+	http_test_respond_okx ( server, data, __FILE__, __LINE__ )
+
+/**
+ * Check that test client completed successfully
+ *
+ * @v client		Test client
+ * @v expected		Expected content
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void http_test_complete_okx ( struct http_test_client *client,
+				     const char *expected, const char *file,
+				     unsigned int line ) {
+
+	okx ( client->closed, file, line );
+	okx ( client->rc == 0, file, line );
+	okx ( strcmp ( client->rx, expected ) == 0, file, line );
+}
+#define http_test_complete_ok( client, expected ) \
+	http_test_complete_okx ( client, expected, __FILE__, __LINE__ )
+
+/**
+ * Close all remaining test server connections
+ *
+ */
+static void http_test_shutdown ( void ) {
+	struct http_test_server *server;
+	unsigned int i;
+
+	for ( i = 0 ; i < http_test_server_count ; i++ ) {
+		server = &http_test_servers[i];
+		if ( ! server->closed )
+			intf_restart ( &server->socket, 0 );
+		server->closed = 1;
+	}
+	http_test_step();
+}
+
+/**
+ * Locate request within test server's received data
+ *
+ * @v server		Test server
+ * @v request		Request line prefix
+ * @ret offset		Offset of request, or negative if not found
+ */
+static int http_test_request ( struct http_test_server *server,
+			       const char *request ) {
+	char *found;
+
+	found = strstr ( server->rx, request );
+	return ( found ? ( found - server->rx ) : -1 );
+}
+
+/**
+ * Test response split across and packed into received buffers
+ *
+ */
+static void http_test_split ( void ) {
+	struct http_test_server *server;
+	unsigned int first = http_test_server_count;
+
+	/* Complete a keepalive transaction to enable pipelining */
+	http_test_open_ok ( &http_test_a, "httptest://192.168.0.1/a" );
+	ok ( http_test_server_count == ( first + 1 ) );
+	server = &http_test_servers[first];
+	ok ( http_test_request ( server, "GET /a " ) == 0 );
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 3\r\n\r\n"
+			       "aaa" );
+	http_test_complete_ok ( &http_test_a, "aaa" );
+	ok ( ! server->closed );
+
+	/* Reuse pooled connection and pipeline two further requests */
+	http_test_open_ok ( &http_test_b, "httptest://192.168.0.1/b" );
+	http_test_open_ok ( &http_test_c, "httptest://192.168.0.1/c" );
+	http_test_open_ok ( &http_test_d, "httptest://192.168.0.1/d" );
+	ok ( http_test_server_count == ( first + 1 ) );
+	ok ( http_test_request ( server, "GET /b " ) > 0 );
+	ok ( http_test_request ( server, "GET /c " ) >
+	     http_test_request ( server, "GET /b " ) );
+	ok ( http_test_request ( server, "GET /d " ) >
+	     http_test_request ( server, "GET /c " ) );
+
+	/* End of first response plus start of second response */
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 4\r\n\r\n"
+			       "bbbb"
+			       "HTTP/1.1 200 OK\r\n"
+			       "Conn" );
+	http_test_complete_ok ( &http_test_b, "bbbb" );
+	ok ( ! http_test_c.closed );
+
+	/* End of second response plus all of third response */
+	http_test_respond_ok ( server, "ection: keep-alive\r\n"
+			       "Content-Length: 5\r\n\r\n"
+			       "ccccc"
+			       "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 2\r\n\r\n"
+			       "dd" );
+	http_test_complete_ok ( &http_test_c, "ccccc" );
+	http_test_complete_ok ( &http_test_d, "dd" );
+
+	/* Connection should have been returned to the pool */
+	ok ( ! server->closed );
+	http_test_open_ok ( &http_test_a, "httptest://192.168.0.1/e" );
+	ok ( http_test_server_count == ( first + 1 ) );
+	ok ( http_test_request ( server, "GET /e " ) > 0 );
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 1\r\n\r\n"
+			       "e" );
+	http_test_complete_ok ( &http_test_a, "e" );
+
+	http_test_shutdown();
+}
+
+/**
+ * Test connection closure with pipelined requests outstanding
+ *
+ */
+static void http_test_closed ( void ) {
+	struct http_test_server *server;
+	struct http_test_server *retry;
+	unsigned int first = http_test_server_count;
+
+	/* Complete a keepalive transaction to enable pipelining */
+	http_test_open_ok ( &http_test_a, "httptest://192.168.0.2/a" );
+	server = &http_test_servers[first];
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 3\r\n\r\n"
+			       "aaa" );
+	http_test_complete_ok ( &http_test_a, "aaa" );
+
+	/* Reuse pooled connection and pipeline a further request */
+	http_test_open_ok ( &http_test_b, "httptest://192.168.0.2/b" );
+	http_test_open_ok ( &http_test_c, "httptest://192.168.0.2/c" );
+	ok ( http_test_server_count == ( first + 1 ) );
+	ok ( http_test_request ( server, "GET /c " ) >
+	     http_test_request ( server, "GET /b " ) );
+
+	/* Close connection part way through first response */
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 10\r\n\r\n"
+			       "bbb" );
+	ok ( ! http_test_b.closed );
+	intf_restart ( &server->socket, 0 );
+	server->closed = 1;
+	http_test_step();
+
+	/* First transaction should fail */
+	ok ( http_test_b.closed );
+	ok ( http_test_b.rc != 0 );
+
+	/* Pipelined transaction should be reissued on a new connection */
+	ok ( ! http_test_c.closed );
+	ok ( http_test_server_count == ( first + 2 ) );
+	retry = &http_test_servers[ first + 1 ];
+	ok ( http_test_request ( retry, "GET /c " ) == 0 );
+	http_test_respond_ok ( retry, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 3\r\n\r\n"
+			       "ccc" );
+	http_test_complete_ok ( &http_test_c, "ccc" );
+
+	http_test_shutdown();
+}
+
+/**
+ * Test failed transaction with pipelined requests outstanding
+ *
+ */
+static void http_test_failed ( void ) {
+	struct http_test_server *server;
+	struct http_test_server *retry;
+	unsigned int first = http_test_server_count;
+
+	/* Complete a keepalive transaction to enable pipelining */
+	http_test_open_ok ( &http_test_a, "httptest://192.168.0.3/a" );
+	server = &http_test_servers[first];
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 3\r\n\r\n"
+			       "aaa" );
+	http_test_complete_ok ( &http_test_a, "aaa" );
+
+	/* Reuse pooled connection and pipeline a further request */
+	http_test_open_ok ( &http_test_b, "httptest://192.168.0.3/b" );
+	http_test_open_ok ( &http_test_c, "httptest://192.168.0.3/c" );
+	ok ( http_test_server_count == ( first + 1 ) );
+
+	/* Abort first transaction part way through its response */
+	http_test_respond_ok ( server, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 10\r\n\r\n"
+			       "bbb" );
+	intf_restart ( &http_test_b.xfer, -ECANCELED );
+	http_test_step();
+
+	/* Connection must not be reused, since the remainder of the
+	 * aborted response would be misinterpreted.
+	 */
+	ok ( server->closed );
+	ok ( ! http_test_c.closed );
+	ok ( http_test_server_count == ( first + 2 ) );
+	retry = &http_test_servers[ first + 1 ];
+	ok ( http_test_request ( retry, "GET /c " ) == 0 );
+	http_test_respond_ok ( retry, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 3\r\n\r\n"
+			       "ccc" );
+	http_test_complete_ok ( &http_test_c, "ccc" );
+
+	/* A new transaction must use only the replacement connection */
+	http_test_open_ok ( &http_test_d, "httptest://192.168.0.3/d" );
+	ok ( http_test_server_count == ( first + 2 ) );
+	ok ( http_test_request ( retry, "GET /d " ) > 0 );
+	ok ( http_test_request ( server, "GET /d " ) < 0 );
+	http_test_respond_ok ( retry, "HTTP/1.1 200 OK\r\n"
+			       "Connection: keep-alive\r\n"
+			       "Content-Length: 1\r\n\r\n"
+			       "d" );
+	http_test_complete_ok ( &http_test_d, "d" );
+
+	http_test_shutdown();
+}
+
+/**
+ * Perform HTTP pipelining self-tests
+ *
+ */
+static void http_test_exec ( void ) {
+
+	http_test_split();
+	http_test_closed();
+	http_test_failed();
+}
+
+/** HTTP pipelining self-test */
+struct self_test http_test __self_test = {
+	.name = "http",
+	.exec = http_test_exec,
+};
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Streaming decompression self-test helpers
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <string.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/inflate.h>
+#include <ipxe/test.h>
+#include "inflate_test.h"
+
+/**
+ * Report streaming decompression test result
+ *
+ * @v data		Downloaded data
+ * @v len		Length of downloaded data
+ * @v expected		Expected stored data
+ * @v expected_len	Length of expected stored data
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+void inflate_okx ( const void *data, size_t len, const void *expected,
+		   size_t expected_len, const char *file,
+		   unsigned int line ) {
+	struct xfer_metadata meta;
+	struct xfer_buffer xferbuf;
+	struct inflater *inflater;
+	struct io_buffer *iobuf;
+	size_t i;
+
+	/* Allocate streaming decompressor */
+	inflater = alloc_inflater();
+	okx ( inflater != NULL, file, line );
+	memset ( &xferbuf, 0, sizeof ( xferbuf ) );
+	xferbuf_malloc_init ( &xferbuf );
+
+	/* Deliver data one byte at a time */
+	for ( i = 0 ; i < len ; i++ ) {
+		iobuf = alloc_iob ( 1 );
+		okx ( iobuf != NULL, file, line );
+		memcpy ( iob_put ( iobuf, 1 ), ( data + i ), 1 );
+		memset ( &meta, 0, sizeof ( meta ) );
+		okx ( inflater_deliver ( inflater, &xferbuf, iobuf,
+					 &meta ) == 0, file, line );
+	}
+	okx ( inflater_finish ( inflater, &xferbuf ) == 0, file, line );
+
+	/* Verify stored data */
+	okx ( xferbuf.len == expected_len, file, line );
+	okx ( memcmp ( xferbuf.data, expected, expected_len ) == 0,
+	      file, line );
+
+	/* Free data */
+	xferbuf_free ( &xferbuf );
+	free ( inflater );
+}
@@ -0,0 +1,24 @@
+#ifndef _INFLATE_TEST_H
+#define _INFLATE_TEST_H
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stddef.h>
+#include <ipxe/test.h>
+
+extern void inflate_okx ( const void *data, size_t len,
+			  const void *expected, size_t expected_len,
+			  const char *file, unsigned int line );
+
+/**
+ * Report a streaming decompression test result
+ *
+ * @v data		Downloaded data
+ * @v len		Length of downloaded data
+ * @v expected		Expected stored data
+ * @v expected_len	Length of expected stored data
+ */
+#define inflate_ok( data, len, expected, expected_len ) \
+	inflate_okx ( data, len, expected, expected_len, __FILE__, __LINE__ )
+
+#endif /* _INFLATE_TEST_H */
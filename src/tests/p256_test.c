@@ -167,6 +167,12 @@ static void p256_test_exec ( void ) {
 	/* Invalid point tests */
 	elliptic_ok ( &invalid_zero );
 	elliptic_ok ( &invalid_one );
+
+	/* Speed tests */
+	DBG ( "P-256 fixed-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &p256_curve, NULL ) );
+	DBG ( "P-256 variable-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &p256_curve, p256_curve.base ) );
 }
 
 /** P-256 self-test */
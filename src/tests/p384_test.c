@@ -213,6 +213,12 @@ static void p384_test_exec ( void ) {
 	/* Invalid point tests */
 	elliptic_ok ( &invalid_zero );
 	elliptic_ok ( &invalid_one );
+
+	/* Speed tests */
+	DBG ( "P-384 fixed-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &p384_curve, NULL ) );
+	DBG ( "P-384 variable-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &p384_curve, p384_curve.base ) );
 }
 
 /** P-384 self-test */
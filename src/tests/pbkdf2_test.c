@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * PBKDF2-HMAC-SHA1 self-tests
+ *
+ * Test vectors are taken from RFC 6070 and from IEEE Std 802.11i-2004
+ * Annex H.4.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/sha1.h>
+#include <ipxe/profile.h>
+#include <ipxe/test.h>
+
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 4
+
+/** Define inline passphrase */
+#define PASSPHRASE(...) { __VA_ARGS__ }
+
+/** Define inline salt */
+#define SALT(...) { __VA_ARGS__ }
+
+/** Define inline expected key */
+#define EXPECTED(...) { __VA_ARGS__ }
+
+/** A PBKDF2 test */
+struct pbkdf2_test {
+	/** Passphrase */
+	const void *passphrase;
+	/** Length of passphrase */
+	size_t pass_len;
+	/** Salt */
+	const void *salt;
+	/** Length of salt */
+	size_t salt_len;
+	/** Number of iterations */
+	int iterations;
+	/** Expected key */
+	const void *expected;
+	/** Length of expected key */
+	size_t expected_len;
+};
+
+/**
+ * Define a PBKDF2 test
+ *
+ * @v name		Test name
+ * @v PASSPHRASE	Passphrase
+ * @v SALT		Salt
+ * @v ITERATIONS	Number of iterations
+ * @v EXPECTED		Expected key
+ * @ret test		PBKDF2 test
+ */
+#define PBKDF2_TEST( name, PASSPHRASE, SALT, ITERATIONS, EXPECTED )	\
+	static const uint8_t name ## _passphrase[] = PASSPHRASE;	\
+	static const uint8_t name ## _salt[] = SALT;			\
+	static const uint8_t name ## _expected[] = EXPECTED;		\
+	static struct pbkdf2_test name = {				\
+		.passphrase = name ## _passphrase,			\
+		.pass_len = sizeof ( name ## _passphrase ),		\
+		.salt = name ## _salt,					\
+		.salt_len = sizeof ( name ## _salt ),			\
+		.iterations = ITERATIONS,				\
+		.expected = name ## _expected,				\
+		.expected_len = sizeof ( name ## _expected ),		\
+	}
+
+/**
+ * Report a PBKDF2 test result
+ *
+ * @v test		PBKDF2 test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void pbkdf2_okx ( struct pbkdf2_test *test, const char *file,
+			 unsigned int line ) {
+	uint8_t key[test->expected_len];
+
+	/* Derive key */
+	pbkdf2_sha1 ( test->passphrase, test->pass_len, test->salt,
+		      test->salt_len, test->iterations, key, sizeof ( key ) );
+	DBGC ( test, "PBKDF2-SHA1 (%d iterations) result:\n",
+	       test->iterations );
+	DBGC_HDA ( test, 0, key, sizeof ( key ) );
+
+	/* Compare against expected result */
+	okx ( memcmp ( key, test->expected, sizeof ( key ) ) == 0,
+	      file, line );
+}
+#define pbkdf2_ok( test ) pbkdf2_okx ( test, __FILE__, __LINE__ )
+
+/**
+ * Calculate PBKDF2 cost
+ *
+ * @v test		PBKDF2 test
+ * @ret cost		Cost (in cycles per iteration)
+ */
+static unsigned long pbkdf2_cost ( struct pbkdf2_test *test ) {
+	uint8_t key[test->expected_len];
+	struct profiler profiler;
+	unsigned int blocks;
+	unsigned int i;
+
+	/* Profile key derivation */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		profile_start ( &profiler );
+		pbkdf2_sha1 ( test->passphrase, test->pass_len, test->salt,
+			      test->salt_len, test->iterations, key,
+			      sizeof ( key ) );
+		profile_stop ( &profiler );
+	}
+
+	/* Round to nearest whole number of cycles per iteration */
+	blocks = ( ( sizeof ( key ) + SHA1_DIGEST_SIZE - 1 ) /
+		   SHA1_DIGEST_SIZE );
+	return ( ( profile_mean ( &profiler ) +
+		   ( ( blocks * test->iterations ) / 2 ) ) /
+		 ( blocks * test->iterations ) );
+}
+
+/* RFC 6070 test case 1 */
+PBKDF2_TEST ( pbkdf2_rfc6070_1,
+	PASSPHRASE ( 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' ),
+	SALT ( 's', 'a', 'l', 't' ), 1,
+	EXPECTED ( 0x0c, 0x60, 0xc8, 0x0f, 0x96, 0x1f, 0x0e, 0x71, 0xf3,
+		   0xa9, 0xb5, 0x24, 0xaf, 0x60, 0x12, 0x06, 0x2f, 0xe0,
+		   0x37, 0xa6 ) );
+
+/* RFC 6070 test case 2 */
+PBKDF2_TEST ( pbkdf2_rfc6070_2,
+	PASSPHRASE ( 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' ),
+	SALT ( 's', 'a', 'l', 't' ), 2,
+	EXPECTED ( 0xea, 0x6c, 0x01, 0x4d, 0xc7, 0x2d, 0x6f, 0x8c, 0xcd,
+		   0x1e, 0xd9, 0x2a, 0xce, 0x1d, 0x41, 0xf0, 0xd8, 0xde,
+		   0x89, 0x57 ) );
+
+/* RFC 6070 test case 3 */
+PBKDF2_TEST ( pbkdf2_rfc6070_3,
+	PASSPHRASE ( 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' ),
+	SALT ( 's', 'a', 'l', 't' ), 4096,
+	EXPECTED ( 0x4b, 0x00, 0x79, 0x01, 0xb7, 0x65, 0x48, 0x9a, 0xbe,
+		   0xad, 0x49, 0xd9, 0x26, 0xf7, 0x21, 0xd0, 0x65, 0xa4,
+		   0x29, 0xc1 ) );
+
+/* RFC 6070 test case 5 */
+PBKDF2_TEST ( pbkdf2_rfc6070_5,
+	PASSPHRASE ( 'p', 'a', 's', 's', 'w', 'o', 'r', 'd', 'P', 'A',
+		     'S', 'S', 'W', 'O', 'R', 'D', 'p', 'a', 's', 's',
+		     'w', 'o', 'r', 'd' ),
+	SALT ( 's', 'a', 'l', 't', 'S', 'A', 'L', 'T', 's', 'a', 'l', 't',
+	       'S', 'A', 'L', 'T', 's', 'a', 'l', 't', 'S', 'A', 'L', 'T',
+	       's', 'a', 'l', 't', 'S', 'A', 'L', 'T', 's', 'a', 'l', 't' ),
+	4096,
+	EXPECTED ( 0x3d, 0x2e, 0xec, 0x4f, 0xe4, 0x1c, 0x84, 0x9b, 0x80,
+		   0xc8, 0xd8, 0x36, 0x62, 0xc0, 0xe4, 0x4a, 0x8b, 0x29,
+		   0x1a, 0x96, 0x4c, 0xf2, 0xf0, 0x70, 0x38 ) );
+
+/* RFC 6070 test case 6 */
+PBKDF2_TEST ( pbkdf2_rfc6070_6,
+	PASSPHRASE ( 'p', 'a', 's', 's', '\0', 'w', 'o', 'r', 'd' ),
+	SALT ( 's', 'a', '\0', 'l', 't' ), 4096,
+	EXPECTED ( 0x56, 0xfa, 0x6a, 0xa7, 0x55, 0x48, 0x09, 0x9d, 0xcc,
+		   0x37, 0xd7, 0xf0, 0x34, 0x25, 0xe0, 0xc3 ) );
+
+/* IEEE 802.11i WPA-PSK test case 1 */
+PBKDF2_TEST ( pbkdf2_wpa_1,
+	PASSPHRASE ( 'p', 'a', 's', 's', 'w', 'o', 'r', 'd' ),
+	SALT ( 'I', 'E', 'E', 'E' ), 4096,
+	EXPECTED ( 0xf4, 0x2c, 0x6f, 0xc5, 0x2d, 0xf0, 0xeb, 0xef, 0x9e,
+		   0xbb, 0x4b, 0x90, 0xb3, 0x8a, 0x5f, 0x90, 0x2e, 0x83,
+		   0xfe, 0x1b, 0x13, 0x5a, 0x70, 0xe2, 0x3a, 0xed, 0x76,
+		   0x2e, 0x97, 0x10, 0xa1, 0x2e ) );
+
+/* IEEE 802.11i WPA-PSK test case 2 */
+PBKDF2_TEST ( pbkdf2_wpa_2,
+	PASSPHRASE ( 'T', 'h', 'i', 's', 'I', 's', 'A', 'P', 'a', 's',
+		     's', 'w', 'o', 'r', 'd' ),
+	SALT ( 'T', 'h', 'i', 's', 'I', 's', 'A', 'S', 'S', 'I', 'D' ),
+	4096,
+	EXPECTED ( 0x0d, 0xc0, 0xd6, 0xeb, 0x90, 0x55, 0x5e, 0xd6, 0x41,
+		   0x97, 0x56, 0xb9, 0xa1, 0x5e, 0xc3, 0xe3, 0x20, 0x9b,
+		   0x63, 0xdf, 0x70, 0x7d, 0xd5, 0x08, 0xd1, 0x45, 0x81,
+		   0xf8, 0x98, 0x27, 0x21, 0xaf ) );
+
+/* IEEE 802.11i WPA-PSK test case 3 */
+PBKDF2_TEST ( pbkdf2_wpa_3,
+	PASSPHRASE ( 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a',
+		     'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a',
+		     'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a',
+		     'a', 'a' ),
+	SALT ( 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z',
+	       'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z',
+	       'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z', 'Z' ), 4096,
+	EXPECTED ( 0xbe, 0xcb, 0x93, 0x86, 0x6b, 0xb8, 0xc3, 0x83, 0x2c,
+		   0xb7, 0x77, 0xc2, 0xf5, 0x59, 0x80, 0x7c, 0x8c, 0x59,
+		   0xaf, 0xcb, 0x6e, 0xae, 0x73, 0x48, 0x85, 0x00, 0x13,
+		   0x00, 0xa9, 0x81, 0xcc, 0x62 ) );
+
+/**
+ * Perform PBKDF2 self-test
+ *
+ */
+static void pbkdf2_test_exec ( void ) {
+
+	/* Correctness tests */
+	pbkdf2_ok ( &pbkdf2_rfc6070_1 );
+	pbkdf2_ok ( &pbkdf2_rfc6070_2 );
+	pbkdf2_ok ( &pbkdf2_rfc6070_3 );
+	pbkdf2_ok ( &pbkdf2_rfc6070_5 );
+	pbkdf2_ok ( &pbkdf2_rfc6070_6 );
+	pbkdf2_ok ( &pbkdf2_wpa_1 );
+	pbkdf2_ok ( &pbkdf2_wpa_2 );
+	pbkdf2_ok ( &pbkdf2_wpa_3 );
+
+	/* Speed tests */
+	DBG ( "PBKDF2-SHA1 required %ld cycles per iteration\n",
+	      pbkdf2_cost ( &pbkdf2_wpa_1 ) );
+}
+
+/** PBKDF2 self-test */
+struct self_test pbkdf2_test __self_test = {
+	.name = "pbkdf2",
+	.exec = pbkdf2_test_exec,
+};
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Peer Content Caching and Retrieval: Discovery Protocol [MS-PCCRD] tests
+ *
+ * Also includes tests for parsing of requests received by the
+ * PeerDist content server.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <string.h>
+#include <ipxe/pccrd.h>
+#include <ipxe/pccrr.h>
+#include <ipxe/peerserv.h>
+#include <ipxe/test.h>
+
+/** Example message UUID */
+#define UUID "2a9cb3f2-1a4a-4a7d-a1ed-e08a2b4e1f3c"
+
+/** Example endpoint UUID */
+#define ENDPOINT "7f1d3c55-95b6-4a6b-9c1e-12fd5b86d104"
+
+/** Example segment ID */
+#define ID1 "F1C9E0D7A1B2C3D4E5F60718293A4B5C6D7E8F90A1B2C3D4E5F6071829304152"
+
+/** Another example segment ID */
+#define ID2 "0A1B2C3D4E5F60718293A4B5C6D7E8F90A1B2C3D4E5F60718293A4B5C6D7E8F9"
+
+/** Example peer location */
+#define LOCATION "192.168.0.10:80"
+
+/** Example discovery reply (with arbitrary whitespace) */
+static const char reply_example[] =
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+	"<soap:Envelope>\n"
+	"  <soap:Body>\n"
+	"    <wsd:ProbeMatches>\n"
+	"      <wsd:ProbeMatch>\n"
+	"        <wsd:Scopes>\n"
+	"          " ID1 "\n"
+	"          " ID2 "\n"
+	"        </wsd:Scopes>\n"
+	"        <wsd:XAddrs> 10.0.0.1:80 10.0.0.2:80 </wsd:XAddrs>\n"
+	"        <PeerDist:PeerDistData>\n"
+	"          <PeerDist:BlockCount>0000000000000010</PeerDist:BlockCount>\n"
+	"        </PeerDist:PeerDistData>\n"
+	"      </wsd:ProbeMatch>\n"
+	"    </wsd:ProbeMatches>\n"
+	"  </soap:Body>\n"
+	"</soap:Envelope>\n";
+
+/** Example non-PeerDist discovery request */
+static const char probe_other[] =
+	"<soap:Envelope><soap:Header>"
+	"<wsa:MessageID>urn:uuid:" UUID "</wsa:MessageID>"
+	"</soap:Header><soap:Body><wsd:Probe>"
+	"<wsd:Types>wsdp:Device</wsd:Types>"
+	"</wsd:Probe></soap:Body></soap:Envelope>";
+
+/**
+ * Check NUL-separated string list
+ *
+ * @v list		String list
+ * @v expected		Expected strings
+ * @v count		Number of expected strings
+ * @ret ok		List matches
+ */
+static int pccrd_list_ok ( const char *list, const char **expected,
+			   unsigned int count ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < count ; i++ ) {
+		if ( strcmp ( list, expected[i] ) != 0 )
+			return 0;
+		list += ( strlen ( list ) + 1 /* NUL */ );
+	}
+	return ( *list == '\0' );
+}
+
+/**
+ * Check parsing of content server request headers
+ *
+ * @v request		Request (may contain NULs)
+ * @v len		Length of request
+ * @v expected_hdr_len	Expected length of headers, or zero if invalid
+ * @v expected_content_len	Expected length of content
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void peerserv_headers_okx ( const char *request, size_t len,
+				   size_t expected_hdr_len,
+				   size_t expected_content_len,
+				   const char *file, unsigned int line ) {
+	size_t hdr_len = 0;
+	size_t content_len = 0;
+	char *data;
+	int rc;
+
+	/* Parse a modifiable copy of the request */
+	data = malloc ( len );
+	okx ( data != NULL, file, line );
+	if ( ! data )
+		return;
+	memcpy ( data, request, len );
+	rc = peerserv_parse_headers ( data, len, &hdr_len, &content_len );
+	if ( expected_hdr_len ) {
+		okx ( rc == 0, file, line );
+		okx ( hdr_len == expected_hdr_len, file, line );
+		okx ( content_len == expected_content_len, file, line );
+	} else {
+		okx ( rc != 0, file, line );
+	}
+	free ( data );
+}
+#define peerserv_headers_ok( request, hdr_len, content_len )		\
+	peerserv_headers_okx ( request, ( sizeof ( request ) - 1 /* NUL */ ),\
+			       hdr_len, content_len, __FILE__, __LINE__ )
+
+/** Example content server request line */
+#define REQUEST_LINE "POST " PEERDIST_MAGIC_PATH " HTTP/1.1\r\n"
+
+/** Example content server request headers */
+#define REQUEST_HEADERS "Host: 10.0.0.1\r\nContent-Length: 42\r\n\r\n"
+
+/**
+ * Perform content server request parsing self-tests
+ *
+ */
+static void peerserv_headers_test ( void ) {
+
+	/* Valid request */
+	peerserv_headers_ok ( REQUEST_LINE REQUEST_HEADERS,
+			      strlen ( REQUEST_LINE REQUEST_HEADERS ), 42 );
+
+	/* Valid request followed by (partial) content */
+	peerserv_headers_ok ( REQUEST_LINE REQUEST_HEADERS "content",
+			      strlen ( REQUEST_LINE REQUEST_HEADERS ), 42 );
+
+	/* Incomplete headers */
+	peerserv_headers_ok ( REQUEST_LINE "Host: 10.0.0.1\r\n", 0, 0 );
+
+	/* Unknown path */
+	peerserv_headers_ok ( "POST /other HTTP/1.1\r\n\r\n", 0, 0 );
+
+	/* Malformed request line */
+	peerserv_headers_ok ( "POST\r\n\r\n", 0, 0 );
+
+	/* NUL within request line */
+	peerserv_headers_ok ( "POST\0 " PEERDIST_MAGIC_PATH " HTTP/1.1\r\n"
+			      REQUEST_HEADERS, 0, 0 );
+
+	/* NUL within header */
+	peerserv_headers_ok ( REQUEST_LINE "Host: 10.0\0.0.1\r\n"
+			      "Content-Length: 42\r\n\r\n", 0, 0 );
+
+	/* Overlength content */
+	peerserv_headers_ok ( REQUEST_LINE "Content-Length: 1000000\r\n\r\n",
+			      0, 0 );
+}
+
+/**
+ * Perform discovery protocol self-tests
+ *
+ */
+static void pccrd_test_exec ( void ) {
+	static const char *expected_ids[] = { ID2 };
+	static const char *expected_locations[] = { "10.0.0.1:80",
+						    "10.0.0.2:80" };
+	static const char *expected_location[] = { LOCATION };
+	static const char ids[] = ID1 "\0" ID2 "\0";
+	static const unsigned int counts[] = { 0, 3 };
+	struct peerdist_discovery_reply reply;
+	struct peerdist_discovery_probe probe;
+	char *request;
+	char *response;
+	char *data;
+
+	/* Parse reply with a zero block count for the first segment */
+	data = strdup ( reply_example );
+	ok ( data != NULL );
+	ok ( peerdist_discovery_reply ( data, strlen ( data ), &reply ) == 0 );
+	ok ( pccrd_list_ok ( reply.ids, expected_ids, 1 ) );
+	ok ( pccrd_list_ok ( reply.locations, expected_locations, 2 ) );
+	free ( data );
+
+	/* Parse our own discovery request */
+	request = peerdist_discovery_request ( UUID, ID1 );
+	ok ( request != NULL );
+	ok ( peerdist_discovery_probe ( request, strlen ( request ),
+					&probe ) == 0 );
+	ok ( strcmp ( probe.id, "urn:uuid:" UUID ) == 0 );
+	ok ( strcmp ( probe.ids, ID1 ) == 0 );
+	free ( request );
+
+	/* Reject non-PeerDist discovery request */
+	data = strdup ( probe_other );
+	ok ( data != NULL );
+	ok ( peerdist_discovery_probe ( data, strlen ( data ),
+					&probe ) != 0 );
+	free ( data );
+
+	/* Construct response and parse it as a reply */
+	response = peerdist_discovery_response ( UUID, "urn:uuid:" UUID,
+						 ENDPOINT, ids, counts,
+						 LOCATION );
+	ok ( response != NULL );
+	ok ( strstr ( response, "<wsa:RelatesTo>urn:uuid:" UUID
+			       "</wsa:RelatesTo>" ) != NULL );
+	ok ( strstr ( response, "0000000000000003" ) != NULL );
+	ok ( peerdist_discovery_reply ( response, strlen ( response ),
+					&reply ) == 0 );
+	ok ( strcmp ( reply.ids, ID2 ) == 0 );
+	ok ( reply.ids[ strlen ( ID2 ) + 1 ] == '\0' );
+	ok ( pccrd_list_ok ( reply.locations, expected_location, 1 ) );
+	free ( response );
+
+	/* Construct response with no segments */
+	ok ( peerdist_discovery_response ( UUID, "urn:uuid:" UUID, ENDPOINT,
+					   "", counts, LOCATION ) == NULL );
+
+	/* Content server request parsing */
+	peerserv_headers_test();
+}
+
+/** Discovery protocol self-test */
+struct self_test pccrd_test __self_test = {
+	.name = "pccrd",
+	.exec = pccrd_test_exec,
+};
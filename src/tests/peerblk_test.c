@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * PeerDist peer selection and concurrency self-tests
+ *
+ * These tests attach a PeerDist block download to a download
+ * multiplexer, report fabricated download attempt outcomes, and
+ * check the resulting peer selection order and concurrency limits.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/interface.h>
+#include <ipxe/uri.h>
+#include <ipxe/timer.h>
+#include <ipxe/peerdisc.h>
+#include <ipxe/peerblk.h>
+#include <ipxe/peermux.h>
+#include <ipxe/test.h>
+
+/** Length of a fabricated block download */
+#define PEERBLK_TEST_LEN 65536
+
+/** Test peer locations (in discovery order) */
+static const char *peerblk_test_locations[] = {
+	"192.168.0.1", "192.168.0.2", "192.168.0.3", "192.168.0.4",
+};
+
+/** Number of test peers */
+#define PEERBLK_TEST_PEERS \
+	( sizeof ( peerblk_test_locations ) / \
+	  sizeof ( peerblk_test_locations[0] ) )
+
+/** Data transfer interface for download multiplexer */
+static struct interface peerblk_test_xfer =
+	INTF_INIT ( null_intf_desc );
+
+/** Content information interface for download multiplexer */
+static struct interface peerblk_test_info =
+	INTF_INIT ( null_intf_desc );
+
+/** Discovery segment */
+static struct peerdisc_segment peerblk_test_segment;
+
+/** Block download */
+static struct peerdist_block peerblk_test_block;
+
+/**
+ * Report fabricated download attempt outcome
+ *
+ * @v index		Peer index, or -1 for the origin server
+ * @v elapsed		Time taken by download attempt (in ticks)
+ * @v rc		Download attempt status code
+ */
+static void peerblk_test_report ( int index, unsigned long elapsed, int rc ) {
+	const char *location =
+		( ( index < 0 ) ? NULL : peerblk_test_locations[index] );
+
+	peerdisc_report ( &peerblk_test_block.xfer, location,
+			  PEERBLK_TEST_LEN, elapsed, rc );
+}
+
+/**
+ * Get rank of test peer
+ *
+ * @v index		Peer index
+ * @ret rank		Peer rank
+ */
+static unsigned long peerblk_test_rank ( unsigned int index ) {
+
+	return peerdisc_rank ( &peerblk_test_block.xfer,
+			       peerblk_test_locations[index] );
+}
+
+/**
+ * Check next selected peer
+ *
+ * @v index		Expected peer index, or -1 for no peer
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void peerblk_select_okx ( int index, const char *file,
+				 unsigned int line ) {
+	struct peerdisc_peer *peer;
+
+	peer = peerblk_select ( &peerblk_test_block );
+	if ( index < 0 ) {
+		okx ( peer == NULL, file, line );
+	} else {
+		okx ( peer != NULL, file, line );
+		okx ( ( peer != NULL ) &&
+		      ( strcmp ( peer->location,
+				 peerblk_test_locations[index] ) == 0 ),
+		      file, line );
+	}
+}
+#define peerblk_select_ok( index ) \
+	peerblk_select_okx ( index, __FILE__, __LINE__ )
+
+/**
+ * Test block download concurrency window
+ *
+ * @v peermux		PeerDist download multiplexer
+ */
+static void peerblk_test_window ( struct peerdist_multiplexer *peermux ) {
+	unsigned int expected;
+	unsigned int i;
+
+	/* Check initial window */
+	ok ( peermux->window == PEERMUX_INITIAL_BLOCKS );
+
+	/* Check additive increase up to (and not beyond) maximum */
+	expected = PEERMUX_INITIAL_BLOCKS;
+	for ( i = 0 ; i < ( 2 * PEERMUX_MAX_BLOCKS ) ; i++ ) {
+		peerblk_test_report ( -1, 1, 0 );
+		if ( expected < PEERMUX_MAX_BLOCKS )
+			expected++;
+		ok ( peermux->window == expected );
+	}
+	ok ( peermux->window == PEERMUX_MAX_BLOCKS );
+
+	/* Check multiplicative decrease down to (and not below) minimum */
+	for ( i = 0 ; i < 8 ; i++ ) {
+		peerblk_test_report ( -1, 1, -ETIMEDOUT );
+		expected /= 2;
+		if ( expected < PEERMUX_MIN_BLOCKS )
+			expected = PEERMUX_MIN_BLOCKS;
+		ok ( peermux->window == expected );
+	}
+	ok ( peermux->window == PEERMUX_MIN_BLOCKS );
+
+	/* Check recovery after a success */
+	peerblk_test_report ( -1, 1, 0 );
+	ok ( peermux->window == ( PEERMUX_MIN_BLOCKS + 1 ) );
+}
+
+/**
+ * Test peer ranking and selection
+ *
+ */
+static void peerblk_test_select ( void ) {
+	unsigned int i;
+
+	/* Untested peers are ranked equally, and so are selected in
+	 * discovery order, each at most once per cycle.
+	 */
+	for ( i = 0 ; i < PEERBLK_TEST_PEERS ; i++ )
+		ok ( peerblk_test_rank ( i ) == peerblk_test_rank ( 0 ) );
+	peerblk_test_block.tried = 0;
+	peerblk_select_ok ( 0 );
+	peerblk_select_ok ( 1 );
+	peerblk_select_ok ( 2 );
+	peerblk_select_ok ( 3 );
+	peerblk_select_ok ( -1 );
+	ok ( peerblk_test_block.tried == 0x0f );
+
+	/* Peer 2 is fast, peer 0 is slow, peer 1 has failed repeatedly,
+	 * and peer 3 remains untested.
+	 */
+	peerblk_test_report ( 2, 1, 0 );
+	peerblk_test_report ( 0, 100, 0 );
+	peerblk_test_report ( 1, 1, -ETIMEDOUT );
+	ok ( peerblk_test_rank ( 1 ) > peerblk_test_rank ( 3 ) );
+	peerblk_test_report ( 1, 1, -ETIMEDOUT );
+	ok ( peerblk_test_rank ( 2 ) > peerblk_test_rank ( 0 ) );
+	ok ( peerblk_test_rank ( 0 ) > peerblk_test_rank ( 3 ) );
+	ok ( peerblk_test_rank ( 3 ) > peerblk_test_rank ( 1 ) );
+	peerblk_test_block.tried = 0;
+	peerblk_select_ok ( 2 );
+	peerblk_select_ok ( 0 );
+	peerblk_select_ok ( 3 );
+	peerblk_select_ok ( 1 );
+	peerblk_select_ok ( -1 );
+
+	/* Peers already attempted within this cycle are skipped,
+	 * regardless of rank.
+	 */
+	peerblk_test_block.tried = ( 1 << 2 );
+	peerblk_select_ok ( 0 );
+	ok ( peerblk_test_block.tried == ( ( 1 << 2 ) | ( 1 << 0 ) ) );
+	peerblk_test_block.tried = ( ( 1 << 0 ) | ( 1 << 2 ) | ( 1 << 3 ) );
+	peerblk_select_ok ( 1 );
+	peerblk_select_ok ( -1 );
+
+	/* A single success rehabilitates a demoted peer */
+	peerblk_test_report ( 1, 10, 0 );
+	ok ( peerblk_test_rank ( 1 ) > peerblk_test_rank ( 3 ) );
+	ok ( peerblk_test_rank ( 2 ) > peerblk_test_rank ( 1 ) );
+	ok ( peerblk_test_rank ( 1 ) > peerblk_test_rank ( 0 ) );
+	peerblk_test_block.tried = 0;
+	peerblk_select_ok ( 2 );
+	peerblk_select_ok ( 1 );
+	peerblk_select_ok ( 0 );
+	peerblk_select_ok ( 3 );
+	peerblk_select_ok ( -1 );
+}
+
+/**
+ * Test raw block download concurrency limit
+ *
+ */
+static void peerblk_test_raw ( void ) {
+	struct peerdist_block_queue queue;
+	unsigned int expected;
+	unsigned int i;
+
+	/* Check additive increase up to (and not beyond) maximum */
+	memset ( &queue, 0, sizeof ( queue ) );
+	queue.max = PEERBLK_RAW_INITIAL;
+	expected = PEERBLK_RAW_INITIAL;
+	for ( i = 0 ; i < ( 2 * PEERBLK_RAW_MAX ) ; i++ ) {
+		peerblk_queue_report ( &queue, 0 );
+		if ( expected < PEERBLK_RAW_MAX )
+			expected++;
+		ok ( queue.max == expected );
+	}
+	ok ( queue.max == PEERBLK_RAW_MAX );
+
+	/* Check multiplicative decrease down to (and not below) the
+	 * initial limit.
+	 */
+	for ( i = 0 ; i < 8 ; i++ ) {
+		peerblk_queue_report ( &queue, -ETIMEDOUT );
+		expected /= 2;
+		if ( expected < PEERBLK_RAW_INITIAL )
+			expected = PEERBLK_RAW_INITIAL;
+		ok ( queue.max == expected );
+		ok ( queue.max >= PEERBLK_RAW_INITIAL );
+		ok ( queue.max <= PEERBLK_RAW_MAX );
+	}
+	ok ( queue.max == PEERBLK_RAW_INITIAL );
+
+	/* Check alternating outcomes remain within range */
+	for ( i = 0 ; i < ( 4 * PEERBLK_RAW_MAX ) ; i++ ) {
+		peerblk_queue_report ( &queue, ( ( i % 3 ) ? 0 : -EIO ) );
+		ok ( queue.max >= PEERBLK_RAW_INITIAL );
+		ok ( queue.max <= PEERBLK_RAW_MAX );
+	}
+}
+
+/**
+ * Perform PeerDist peer selection and concurrency self-tests
+ *
+ */
+static void peerblk_test_exec ( void ) {
+	struct peerdist_multiplexer *peermux;
+	struct peerdisc_peer *peer;
+	struct peerdisc_peer *tmp;
+	struct uri *uri;
+	unsigned int i;
+
+	/* Create download multiplexer */
+	uri = parse_uri ( "http://example.com/peerblk" );
+	ok ( uri != NULL );
+	if ( ! uri )
+		return;
+	ok ( peermux_filter ( &peerblk_test_xfer, &peerblk_test_info,
+			      uri ) == 0 );
+	peermux = container_of ( peerblk_test_xfer.dest,
+				 struct peerdist_multiplexer, xfer );
+
+	/* Create discovery segment with test peers */
+	memset ( &peerblk_test_segment, 0, sizeof ( peerblk_test_segment ) );
+	INIT_LIST_HEAD ( &peerblk_test_segment.peers );
+	for ( i = 0 ; i < PEERBLK_TEST_PEERS ; i++ ) {
+		peer = zalloc ( sizeof ( *peer ) +
+				strlen ( peerblk_test_locations[i] ) +
+				1 /* NUL */ );
+		ok ( peer != NULL );
+		if ( ! peer )
+			goto err_peer;
+		strcpy ( peer->location, peerblk_test_locations[i] );
+		list_add_tail ( &peer->list, &peerblk_test_segment.peers );
+	}
+
+	/* Attach block download to multiplexed block download */
+	memset ( &peerblk_test_block, 0, sizeof ( peerblk_test_block ) );
+	intf_init ( &peerblk_test_block.xfer, &null_intf_desc, NULL );
+	peerblk_test_block.discovery.segment = &peerblk_test_segment;
+	intf_plug_plug ( &peerblk_test_block.xfer, &peermux->block[0].xfer );
+
+	/* Run tests */
+	peerblk_test_window ( peermux );
+	peerblk_test_select();
+	peerblk_test_raw();
+
+	/* Detach block download and close multiplexer */
+	intf_unplug ( &peerblk_test_block.xfer );
+ err_peer:
+	list_for_each_entry_safe ( peer, tmp, &peerblk_test_segment.peers,
+				   list ) {
+		list_del ( &peer->list );
+		free ( peer );
+	}
+	intf_restart ( &peerblk_test_xfer, 0 );
+	intf_restart ( &peerblk_test_info, 0 );
+	uri_put ( uri );
+}
+
+/** PeerDist peer selection and concurrency self-test */
+struct self_test peerblk_test __self_test = {
+	.name = "peerblk",
+	.exec = peerblk_test_exec,
+};
@@ -32,8 +32,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /* Forcibly enable assertions */
 #undef NDEBUG
 
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <byteswap.h>
+#include <ipxe/image.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/timer.h>
 #include <ipxe/pixbuf.h>
 #include <ipxe/png.h>
 #include <ipxe/test.h>
@@ -42,6 +47,15 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Define inline pixel data */
 #define DATA(...) { __VA_ARGS__ }
 
+/** Speed test image width */
+#define PNG_SPEED_WIDTH 1024
+
+/** Speed test image height */
+#define PNG_SPEED_HEIGHT 768
+
+/** Maximum length of a stored deflate block */
+#define PNG_SPEED_BLOCK_LEN 0xffff
+
 /* Non-opaque alpha channel */
 PIX ( alpha, &png_image_type,
       DATA ( 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00,
@@ -1939,6 +1953,230 @@ PIX ( original, &png_image_type,
 	     0x5fa7ff, 0x4e9ffe, 0x4596f4, 0x4fa7ff, 0x62beff, 0x59b8ff,
 	     0x2e8de9, 0x4faeff, 0x4aa9ff, 0x4a9ff7, 0x77bbff, 0x78b7fe ) );
 
+/**
+ * Calculate filter predictor for speed test image
+ *
+ * @v type		Filter type
+ * @v a			Left byte
+ * @v b			Above byte
+ * @v c			Above-left byte
+ * @ret predictor	Predictor byte
+ */
+static unsigned int png_speed_predictor ( unsigned int type, int a, int b,
+					  int c ) {
+	int p = ( a + b - c );
+
+	switch ( type ) {
+	case PNG_FILTER_BASIC_SUB:
+		return a;
+	case PNG_FILTER_BASIC_UP:
+		return b;
+	case PNG_FILTER_BASIC_AVERAGE:
+		return ( ( a + b ) >> 1 );
+	case PNG_FILTER_BASIC_PAETH:
+		if ( ( abs ( p - a ) <= abs ( p - b ) ) &&
+		     ( abs ( p - a ) <= abs ( p - c ) ) ) {
+			return a;
+		} else if ( abs ( p - b ) <= abs ( p - c ) ) {
+			return b;
+		} else {
+			return c;
+		}
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Measure PNG decoding speed
+ *
+ * @v colour_type	Colour type (8-bit RGB or RGBA)
+ *
+ * Construct a large 8-bit truecolour PNG image using all basic filter
+ * types and uncompressed deflate blocks, and measure the time taken
+ * to convert it to a pixel buffer.
+ */
+static void png_speed ( unsigned int colour_type ) {
+	static struct png_signature signature = PNG_SIGNATURE;
+	unsigned int channels = ( ( colour_type & PNG_COLOUR_TYPE_ALPHA ) ?
+				  4 : 3 );
+	size_t scanline_len = ( 1 + ( PNG_SPEED_WIDTH * channels ) );
+	size_t raw_len = ( PNG_SPEED_HEIGHT * scanline_len );
+	size_t blocks = ( ( raw_len + PNG_SPEED_BLOCK_LEN - 1 ) /
+			  PNG_SPEED_BLOCK_LEN );
+	size_t zlib_len = ( 2 /* header */ + ( blocks * 5 ) + raw_len +
+			    4 /* checksum */ );
+	size_t len = ( sizeof ( signature ) +
+		       sizeof ( struct png_chunk_header ) +
+		       sizeof ( struct png_image_header ) +
+		       sizeof ( struct png_chunk_footer ) +
+		       sizeof ( struct png_chunk_header ) + zlib_len +
+		       sizeof ( struct png_chunk_footer ) +
+		       sizeof ( struct png_chunk_header ) +
+		       sizeof ( struct png_chunk_footer ) );
+	struct png_chunk_header *header;
+	struct png_image_header *ihdr;
+	struct pixel_buffer *pixbuf;
+	struct image *image;
+	uint32_t *expected;
+	uint8_t *unfiltered;
+	uint8_t *file;
+	uint8_t *pos;
+	uint8_t *current;
+	uint8_t *above;
+	unsigned long start;
+	unsigned long elapsed;
+	unsigned int seed = 1;
+	unsigned int type;
+	unsigned int alpha;
+	unsigned int value;
+	unsigned int c;
+	size_t remaining;
+	size_t offset;
+	size_t pixel;
+	size_t y;
+	size_t i;
+	int rc;
+
+	/* Allocate buffers */
+	expected = umalloc ( PNG_SPEED_WIDTH * PNG_SPEED_HEIGHT *
+			     sizeof ( expected[0] ) );
+	unfiltered = umalloc ( raw_len );
+	file = umalloc ( len );
+	ok ( expected != NULL );
+	ok ( unfiltered != NULL );
+	ok ( file != NULL );
+	if ( ! ( expected && unfiltered && file ) )
+		goto err_alloc;
+
+	/* Construct pseudo-random pixels and expected pixel buffer */
+	for ( pixel = 0 ; pixel < ( PNG_SPEED_WIDTH * PNG_SPEED_HEIGHT ) ;
+	      pixel++ ) {
+		current = ( unfiltered + 1 +
+			    ( ( pixel / PNG_SPEED_WIDTH ) * scanline_len ) +
+			    ( ( pixel % PNG_SPEED_WIDTH ) * channels ) );
+		for ( c = 0 ; c < channels ; c++ ) {
+			seed = ( ( seed * 1103515245 ) + 12345 );
+			current[c] = ( seed >> 16 );
+		}
+		alpha = 0xff;
+		if ( ( channels == 4 ) && ! ( current[3] & 0x80 ) )
+			alpha = current[3];
+		if ( channels == 4 )
+			current[3] = alpha;
+		expected[pixel] = 0;
+		for ( c = 0 ; c < 3 ; c++ ) {
+			value = ( ( ( ( ( 0xff00 * current[c] * alpha ) /
+					0xff ) / 0xff ) + 0x80 ) >> 8 );
+			expected[pixel] = ( ( expected[pixel] << 8 ) | value );
+		}
+	}
+
+	/* Construct image header */
+	pos = file;
+	memcpy ( pos, &signature, sizeof ( signature ) );
+	pos += sizeof ( signature );
+	header = ( ( void * ) pos );
+	header->len = htonl ( sizeof ( *ihdr ) );
+	header->type = htonl ( PNG_TYPE_IHDR );
+	ihdr = ( ( void * ) ( header + 1 ) );
+	memset ( ihdr, 0, sizeof ( *ihdr ) );
+	ihdr->width = htonl ( PNG_SPEED_WIDTH );
+	ihdr->height = htonl ( PNG_SPEED_HEIGHT );
+	ihdr->depth = 8;
+	ihdr->colour_type = colour_type;
+	pos = ( ( void * ) ( ihdr + 1 ) );
+	memset ( pos, 0, sizeof ( struct png_chunk_footer ) );
+	pos += sizeof ( struct png_chunk_footer );
+
+	/* Construct image data as a zlib stream of stored blocks */
+	header = ( ( void * ) pos );
+	header->len = htonl ( zlib_len );
+	header->type = htonl ( PNG_TYPE_IDAT );
+	pos = ( ( void * ) ( header + 1 ) );
+	*(pos++) = 0x78;
+	*(pos++) = 0x01;
+	remaining = 0;
+	for ( i = 0 ; i < raw_len ; i++ ) {
+
+		/* Start a new stored block, if applicable */
+		if ( ! remaining ) {
+			remaining = ( raw_len - i );
+			if ( remaining > PNG_SPEED_BLOCK_LEN )
+				remaining = PNG_SPEED_BLOCK_LEN;
+			*(pos++) = ( ( remaining == ( raw_len - i ) ) ?
+				     0x01 : 0x00 );
+			*(pos++) = ( remaining & 0xff );
+			*(pos++) = ( remaining >> 8 );
+			*(pos++) = ( ~remaining & 0xff );
+			*(pos++) = ( ~remaining >> 8 );
+		}
+		remaining--;
+
+		/* Filter byte using a filter type chosen per scanline */
+		y = ( i / scanline_len );
+		offset = ( i % scanline_len );
+		type = ( y % 5 );
+		current = ( unfiltered + i );
+		above = ( current - scanline_len );
+		if ( offset == 0 ) {
+			*(pos++) = type;
+			continue;
+		}
+		*(pos++) = ( *current -
+			     png_speed_predictor ( type,
+				( ( offset > channels ) ?
+				  *( current - channels ) : 0 ),
+				( y ? *above : 0 ),
+				( ( y && ( offset > channels ) ) ?
+				  *( above - channels ) : 0 ) ) );
+	}
+	memset ( pos, 0, 4 /* checksum (not verified) */ );
+	pos += 4;
+	memset ( pos, 0, sizeof ( struct png_chunk_footer ) );
+	pos += sizeof ( struct png_chunk_footer );
+
+	/* Construct image end */
+	header = ( ( void * ) pos );
+	header->len = 0;
+	header->type = htonl ( PNG_TYPE_IEND );
+	pos = ( ( void * ) ( header + 1 ) );
+	memset ( pos, 0, sizeof ( struct png_chunk_footer ) );
+	pos += sizeof ( struct png_chunk_footer );
+	assert ( pos == ( file + len ) );
+
+	/* Register image */
+	image = image_memory ( "speed.png", file, len );
+	ok ( image != NULL );
+	if ( ! image )
+		goto err_image;
+	ok ( image->type == &png_image_type );
+
+	/* Convert to pixel buffer */
+	start = currticks();
+	rc = image_pixbuf ( image, &pixbuf );
+	elapsed = ( currticks() - start );
+	ok ( rc == 0 );
+	if ( rc == 0 ) {
+		ok ( pixbuf->width == PNG_SPEED_WIDTH );
+		ok ( pixbuf->height == PNG_SPEED_HEIGHT );
+		ok ( memcmp ( pixbuf->data, expected, pixbuf->len ) == 0 );
+		pixbuf_put ( pixbuf );
+	}
+	DBG ( "PNG %dx%d %s decoded in %ld ticks (%ld pixels/s)\n",
+	      PNG_SPEED_WIDTH, PNG_SPEED_HEIGHT,
+	      ( ( channels == 4 ) ? "RGBA" : "RGB" ), elapsed,
+	      ( elapsed ? ( ( PNG_SPEED_WIDTH * PNG_SPEED_HEIGHT *
+			      TICKS_PER_SEC ) / elapsed ) : 0 ) );
+
+	unregister_image ( image );
+ err_image:
+ err_alloc:
+	ufree ( file );
+	ufree ( unfiltered );
+	ufree ( expected );
+}
+
 /**
  * Perform PNG self-test
  *
@@ -1988,6 +2226,10 @@ static void png_test_exec ( void ) {
 
 	/* Alpha channel */
 	pixbuf_ok ( &alpha );
+
+	/* Speed tests */
+	png_speed ( PNG_COLOUR_TYPE_RGB );
+	png_speed ( PNG_COLOUR_TYPE_RGB | PNG_COLOUR_TYPE_ALPHA );
 }
 
 /** PNG self-test */
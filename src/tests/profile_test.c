@@ -47,13 +47,24 @@ struct profile_test {
 	unsigned long mean;
 	/** Expected standard deviation */
 	unsigned long stddev;
+	/** Expected minimum sample value */
+	unsigned long min;
+	/** Expected median sample value */
+	unsigned long p50;
+	/** Expected 90th percentile sample value */
+	unsigned long p90;
+	/** Expected 99th percentile sample value */
+	unsigned long p99;
+	/** Expected maximum sample value */
+	unsigned long max;
 };
 
 /** Define inline data */
 #define DATA(...) { __VA_ARGS__ }
 
 /** Define a profiling test */
-#define PROFILE_TEST( name, MEAN, STDDEV, SAMPLES )			\
+#define PROFILE_TEST( name, MEAN, STDDEV, MIN, P50, P90, P99, MAX,	\
+		       SAMPLES )					\
 	static const unsigned long name ## _samples[] = SAMPLES;	\
 	static struct profile_test name = {				\
 		.samples = name ## _samples,				\
@@ -61,31 +72,38 @@ struct profile_test {
 			   sizeof ( name ## _samples [0] ) ),		\
 		.mean = MEAN,						\
 		.stddev = STDDEV,					\
+		.min = MIN,						\
+		.p50 = P50,						\
+		.p90 = P90,						\
+		.p99 = P99,						\
+		.max = MAX,						\
 	}
 
 /** Empty data set */
-PROFILE_TEST ( empty, 0, 0, DATA() );
+PROFILE_TEST ( empty, 0, 0, 0, 0, 0, 0, 0, DATA() );
 
 /** Single-element data set (zero) */
-PROFILE_TEST ( zero, 0, 0, DATA ( 0 ) );
+PROFILE_TEST ( zero, 0, 0, 0, 0, 0, 0, 0, DATA ( 0 ) );
 
 /** Single-element data set (non-zero) */
-PROFILE_TEST ( single, 42, 0, DATA ( 42 ) );
+PROFILE_TEST ( single, 42, 0, 42, 42, 42, 42, 42, DATA ( 42 ) );
 
 /** Multiple identical element data set */
-PROFILE_TEST ( identical, 69, 0, DATA ( 69, 69, 69, 69, 69, 69, 69 ) );
+PROFILE_TEST ( identical, 69, 0, 69, 69, 69, 69, 69,
+	       DATA ( 69, 69, 69, 69, 69, 69, 69 ) );
 
 /** Small element data set */
-PROFILE_TEST ( small, 5, 2, DATA ( 3, 5, 9, 4, 3, 2, 5, 7 ) );
+PROFILE_TEST ( small, 5, 2, 2, 4, 9, 9, 9, DATA ( 3, 5, 9, 4, 3, 2, 5, 7 ) );
 
 /** Random data set */
-PROFILE_TEST ( random, 70198, 394,
+PROFILE_TEST ( random, 70198, 394, 69600, 70382, 70991, 71078, 71078,
 	       DATA ( 69772, 70068, 70769, 69653, 70663, 71078, 70101, 70341,
 		      70215, 69600, 70020, 70456, 70421, 69972, 70267, 69999,
 		      69972 ) );
 
 /** Large-valued random data set */
-PROFILE_TEST ( large, 93533894UL, 25538UL,
+PROFILE_TEST ( large, 93533894UL, 25538UL, 93492361UL, 93542692UL,
+	       93580440UL, 93586731UL, 93586731UL,
 	       DATA ( 93510333UL, 93561169UL, 93492361UL, 93528647UL,
 		      93557566UL, 93503465UL, 93540126UL, 93549020UL,
 		      93502307UL, 93527320UL, 93537152UL, 93540125UL,
@@ -118,9 +136,93 @@ static void profile_okx ( struct profile_test *test, const char *file,
 	DBGC ( test, "PROFILE calculated mean %ld stddev %ld\n", mean, stddev );
 	okx ( mean == test->mean, file, line );
 	okx ( stddev == test->stddev, file, line );
+	okx ( profiler.min == test->min, file, line );
+	okx ( profile_percentile ( &profiler, 50 ) == test->p50, file, line );
+	okx ( profile_percentile ( &profiler, 90 ) == test->p90, file, line );
+	okx ( profile_percentile ( &profiler, 99 ) == test->p99, file, line );
+	okx ( profiler.max == test->max, file, line );
+
+	/* Check reset */
+	profile_reset ( &profiler );
+	okx ( profiler.count == 0, file, line );
+	okx ( profile_mean ( &profiler ) == 0, file, line );
+	okx ( profile_percentile ( &profiler, 50 ) == 0, file, line );
 }
 #define profile_ok( test ) profile_okx ( test, __FILE__, __LINE__ )
 
+/**
+ * Perform long-tailed distribution test
+ *
+ */
+static void profile_tail_test ( void ) {
+	struct profiler profiler;
+	unsigned int i;
+
+	/* Record 98 fast samples and two slow samples */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < 98 ; i++ )
+		profile_update ( &profiler, 10 );
+	profile_update ( &profiler, 100 );
+	profile_update ( &profiler, 1000 );
+
+	/* Check that the tail is visible despite a misleading mean */
+	ok ( profile_mean ( &profiler ) == 21 );
+	ok ( profiler.min == 10 );
+	ok ( profile_percentile ( &profiler, 50 ) == 10 );
+	ok ( profile_percentile ( &profiler, 90 ) == 10 );
+	ok ( profile_percentile ( &profiler, 99 ) == 103 );
+	ok ( profile_percentile ( &profiler, 100 ) == 1000 );
+	ok ( profiler.max == 1000 );
+}
+
+/**
+ * Perform uniform distribution test
+ *
+ */
+static void profile_uniform_test ( void ) {
+	struct profiler profiler;
+	unsigned int i;
+
+	/* Record samples 1 to 1000 */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 1 ; i <= 1000 ; i++ )
+		profile_update ( &profiler, i );
+
+	/* Check that percentiles within a single power of two are
+	 * distinguishable
+	 */
+	ok ( profile_percentile ( &profiler, 50 ) == 500 );
+	ok ( profile_percentile ( &profiler, 90 ) == 900 );
+	ok ( profile_percentile ( &profiler, 99 ) == 990 );
+	ok ( profile_percentile ( &profiler, 100 ) == 1000 );
+}
+
+/**
+ * Perform machine-readable format test
+ *
+ */
+static void profile_format_test ( void ) {
+	struct profiler profiler;
+	char buf[64];
+	unsigned int i;
+
+	/* Record sample values */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	profiler.name = "test.small";
+	for ( i = 0 ; i < small.count ; i++ )
+		profile_update ( &profiler, small.samples[i] );
+
+	/* Check formatted statistics */
+	ok ( profile_format ( &profiler, buf, sizeof ( buf ) ) ==
+	     ( int ) strlen ( "test.small 8 2 4 9 9 9 5 2" ) );
+	ok ( strcmp ( buf, "test.small 8 2 4 9 9 9 5 2" ) == 0 );
+
+	/* Check formatted statistics after reset */
+	profile_reset ( &profiler );
+	profile_format ( &profiler, buf, sizeof ( buf ) );
+	ok ( strcmp ( buf, "test.small 0 0 0 0 0 0 0 0" ) == 0 );
+}
+
 /**
  * Perform profiling self-tests
  *
@@ -135,6 +237,11 @@ static void profile_test_exec ( void ) {
 	profile_ok ( &small );
 	profile_ok ( &random );
 	profile_ok ( &large );
+
+	/* Perform histogram and formatting tests */
+	profile_tail_test();
+	profile_uniform_test();
+	profile_format_test();
 }
 
 /** Profiling self-test */
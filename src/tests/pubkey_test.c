@@ -37,9 +37,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <string.h>
 #include <assert.h>
 #include <ipxe/crypto.h>
+#include <ipxe/profile.h>
 #include <ipxe/test.h>
 #include "pubkey_test.h"
 
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
 /**
  * Report public key encryption and decryption test result
  *
@@ -129,3 +133,72 @@ void pubkey_sign_okx ( struct pubkey_sign_test *test, const char *file,
 	okx ( pubkey_verify ( pubkey, &test->public, digest, digestout,
 			      bad, sizeof ( bad ) ) != 0, file, line );
 }
+
+/**
+ * Report public key signature verification test result
+ *
+ * @v test		Public key signature verification test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+void pubkey_verify_okx ( struct pubkey_verify_test *test, const char *file,
+			 unsigned int line ) {
+	struct pubkey_algorithm *pubkey = test->pubkey;
+	struct digest_algorithm *digest = test->digest;
+	uint8_t bad[test->signature_len];
+	uint8_t digestctx[digest->ctxsize];
+	uint8_t digestout[digest->digestsize];
+
+	/* Construct digest over plaintext */
+	digest_init ( digest, digestctx );
+	digest_update ( digest, digestctx, test->plaintext,
+			test->plaintext_len );
+	digest_final ( digest, digestctx, digestout );
+
+	/* Test verification using public key */
+	okx ( pubkey_verify ( pubkey, &test->public, digest, digestout,
+			      test->signature, test->signature_len ) == 0,
+	      file, line );
+
+	/* Test verification failure of modified signature */
+	memcpy ( bad, test->signature, test->signature_len );
+	bad[ test->signature_len / 2 ] ^= 0x40;
+	okx ( pubkey_verify ( pubkey, &test->public, digest, digestout,
+			      bad, sizeof ( bad ) ) != 0, file, line );
+
+	/* Test verification failure of modified digest */
+	digestout[0] ^= 0x01;
+	okx ( pubkey_verify ( pubkey, &test->public, digest, digestout,
+			      test->signature, test->signature_len ) != 0,
+	      file, line );
+}
+
+/**
+ * Calculate public-key signature cost
+ *
+ * @v test		Public key signature test
+ * @ret cost		Cost (in cycles per signature)
+ */
+unsigned long pubkey_sign_cost ( struct pubkey_sign_test *test ) {
+	struct pubkey_algorithm *pubkey = test->pubkey;
+	struct digest_algorithm *digest = test->digest;
+	uint8_t value[digest->digestsize];
+	uint8_t signature[test->signature_len];
+	struct profiler profiler;
+	unsigned int i;
+	unsigned int j;
+
+	/* Profile signing using pseudo-random digest values */
+	srand ( 0x52534121 );
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		for ( j = 0 ; j < sizeof ( value ) ; j++ )
+			value[j] = rand();
+		profile_start ( &profiler );
+		pubkey_sign ( pubkey, &test->private, digest, value,
+			      signature );
+		profile_stop ( &profiler );
+	}
+
+	return profile_mean ( &profiler );
+}
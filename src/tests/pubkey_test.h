@@ -50,6 +50,24 @@ struct pubkey_sign_test {
 	size_t signature_len;
 };
 
+/** A public-key signature verification test */
+struct pubkey_verify_test {
+	/** Public-key algorithm */
+	struct pubkey_algorithm *pubkey;
+	/** Public key */
+	const struct asn1_cursor public;
+	/** Plaintext */
+	const void *plaintext;
+	/** Plaintext length */
+	size_t plaintext_len;
+	/** Signature algorithm */
+	struct digest_algorithm *digest;
+	/** Signature */
+	const void *signature;
+	/** Signature length */
+	size_t signature_len;
+};
+
 /** Define inline private key data */
 #define PRIVATE(...) { __VA_ARGS__ }
 
@@ -133,10 +151,42 @@ struct pubkey_sign_test {
 		.signature_len = sizeof ( name ## _signature ),		\
 	}
 
+/**
+ * Define a public-key signature verification test
+ *
+ * @v name		Test name
+ * @v PUBKEY		Public-key algorithm
+ * @v PUBLIC		Public key
+ * @v PLAINTEXT		Plaintext
+ * @v DIGEST		Digest algorithm
+ * @v SIGNATURE		Signature
+ * @ret test		Signature verification test
+ */
+#define PUBKEY_VERIFY_TEST( name, PUBKEY, PUBLIC, PLAINTEXT, DIGEST,	\
+			    SIGNATURE )					\
+	static const uint8_t name ## _public[] = PUBLIC;		\
+	static const uint8_t name ## _plaintext[] = PLAINTEXT;		\
+	static const uint8_t name ## _signature[] = SIGNATURE;		\
+	static struct pubkey_verify_test name = {			\
+		.pubkey = PUBKEY,					\
+		.public = {						\
+			.data = name ## _public,			\
+			.len = sizeof ( name ## _public ),		\
+		},							\
+		.plaintext = name ## _plaintext,			\
+		.plaintext_len = sizeof ( name ## _plaintext ),		\
+		.digest = DIGEST,					\
+		.signature = name ## _signature,			\
+		.signature_len = sizeof ( name ## _signature ),		\
+	}
+
 extern void pubkey_okx ( struct pubkey_test *test,
 			 const char *file, unsigned int line );
 extern void pubkey_sign_okx ( struct pubkey_sign_test *test,
 			      const char *file, unsigned int line );
+extern void pubkey_verify_okx ( struct pubkey_verify_test *test,
+				const char *file, unsigned int line );
+extern unsigned long pubkey_sign_cost ( struct pubkey_sign_test *test );
 
 /**
  * Report a public key encryption and decryption test result
@@ -154,4 +204,12 @@ extern void pubkey_sign_okx ( struct pubkey_sign_test *test,
 #define pubkey_sign_ok( test ) \
 	pubkey_sign_okx ( test, __FILE__, __LINE__ )
 
+/**
+ * Report a public key signature verification test result
+ *
+ * @v test		Public key signature verification test
+ */
+#define pubkey_verify_ok( test ) \
+	pubkey_verify_okx ( test, __FILE__, __LINE__ )
+
 #endif /* _PUBKEY_TEST_H */
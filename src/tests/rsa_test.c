@@ -373,6 +373,314 @@ PUBKEY_SIGN_TEST ( sha256_test, &rsa_algorithm,
 		    0x7d, 0x38, 0x37, 0xc4, 0xea, 0xdd, 0x3a, 0x6f, 0xa8, 0x65,
 		    0x60, 0x73, 0x77, 0x3c ) );
 
+/** 2048-bit random message SHA-256 signature test */
+PUBKEY_SIGN_TEST ( sha256_2048_test, &rsa_algorithm,
+	PRIVATE ( 0x30, 0x82, 0x04, 0xa4, 0x02, 0x01, 0x00, 0x02, 0x82, 0x01,
+		  0x01, 0x00, 0x9b, 0x2e, 0x97, 0x95, 0x15, 0xb1, 0xc0, 0x16,
+		  0x34, 0xa6, 0xe9, 0xd3, 0xbc, 0x8b, 0xc7, 0xd3, 0x99, 0x17,
+		  0x0b, 0xf1, 0x37, 0x32, 0x89, 0xcd, 0x15, 0x9c, 0xbd, 0xb8,
+		  0xf7, 0x25, 0x86, 0x8c, 0x63, 0xa0, 0x2d, 0x4f, 0x28, 0x77,
+		  0xb0, 0x95, 0xb0, 0x77, 0x71, 0xd6, 0x87, 0x98, 0xe1, 0xd2,
+		  0xb3, 0x47, 0x34, 0x2a, 0x82, 0x11, 0xa9, 0x92, 0xe2, 0xf7,
+		  0xa5, 0x91, 0x32, 0x7e, 0xd6, 0xf2, 0x8e, 0x9c, 0x85, 0x5e,
+		  0x80, 0x7f, 0xf3, 0x66, 0x9e, 0x82, 0xdc, 0xc0, 0x28, 0x35,
+		  0xec, 0x48, 0x0e, 0xeb, 0xa2, 0x6b, 0xac, 0xee, 0x71, 0xb3,
+		  0x10, 0x6c, 0x24, 0x6e, 0x62, 0x64, 0x4f, 0x8b, 0xe2, 0x2a,
+		  0x98, 0xad, 0x2e, 0xd2, 0x52, 0x77, 0x5a, 0xea, 0xec, 0x8e,
+		  0x4d, 0x41, 0x8b, 0x30, 0x5c, 0x05, 0x19, 0xbb, 0xb1, 0x89,
+		  0x0f, 0x66, 0x07, 0x89, 0xf5, 0xf4, 0xe1, 0x6b, 0x27, 0x2a,
+		  0xe4, 0xd7, 0xe9, 0x77, 0xdb, 0x39, 0xfa, 0xba, 0xb8, 0x95,
+		  0xba, 0x81, 0x4f, 0x70, 0x44, 0x11, 0xf7, 0x99, 0x05, 0x44,
+		  0x96, 0xda, 0x57, 0xb5, 0x25, 0x9b, 0xd3, 0xa6, 0xfd, 0x8d,
+		  0x88, 0x07, 0xff, 0xd6, 0xc9, 0xa3, 0x6e, 0x53, 0xf4, 0x7c,
+		  0x66, 0x7d, 0xa5, 0x4b, 0x13, 0x82, 0x3b, 0x0e, 0xcd, 0xb4,
+		  0x3e, 0x84, 0x7c, 0x2d, 0xfe, 0x79, 0x4a, 0xcf, 0xb3, 0x25,
+		  0x26, 0xbb, 0x41, 0x24, 0x83, 0xe3, 0x90, 0xc9, 0xc8, 0x6f,
+		  0x43, 0xe5, 0x11, 0x0e, 0x88, 0x9f, 0x03, 0x4e, 0xcb, 0x14,
+		  0x65, 0x5f, 0x8c, 0x39, 0x44, 0xb8, 0xd7, 0xe3, 0xd1, 0xbe,
+		  0xc5, 0x56, 0x56, 0xdb, 0xa8, 0x55, 0x83, 0x2e, 0x30, 0x36,
+		  0x50, 0x43, 0x08, 0x3c, 0x70, 0xff, 0x70, 0x90, 0x14, 0xec,
+		  0xd9, 0xca, 0x5d, 0xac, 0x4e, 0x15, 0xb7, 0x40, 0x29, 0x58,
+		  0xe0, 0x99, 0x9f, 0xea, 0xd2, 0xa3, 0x08, 0x9b, 0x02, 0x03,
+		  0x01, 0x00, 0x01, 0x02, 0x82, 0x01, 0x00, 0x02, 0x5f, 0xfd,
+		  0x2b, 0xe7, 0xf0, 0x17, 0x7b, 0x7f, 0x84, 0xca, 0x71, 0x56,
+		  0x22, 0x61, 0x85, 0x88, 0x83, 0x44, 0xc8, 0x85, 0x4a, 0xbd,
+		  0xb7, 0x28, 0xcc, 0x84, 0x4e, 0xcf, 0x61, 0x80, 0xa4, 0xa7,
+		  0x65, 0xad, 0x2b, 0xd7, 0xf7, 0xb4, 0xf9, 0x25, 0x81, 0x3e,
+		  0x79, 0xc5, 0x0b, 0x7e, 0xf1, 0x45, 0x93, 0x22, 0x66, 0x40,
+		  0x25, 0x5b, 0x0e, 0x07, 0x71, 0x38, 0xd4, 0x77, 0x0c, 0x5f,
+		  0xe7, 0xc8, 0x6c, 0xf6, 0xd1, 0x92, 0x6f, 0xe2, 0xde, 0xc0,
+		  0x30, 0x4a, 0x86, 0x9a, 0x56, 0xf0, 0xed, 0xcd, 0x64, 0xa7,
+		  0xd0, 0xb4, 0x0d, 0xd6, 0x29, 0xa2, 0x67, 0xb5, 0x4b, 0x07,
+		  0x30, 0x77, 0xd3, 0x31, 0x3b, 0xeb, 0xa8, 0x42, 0xde, 0x2f,
+		  0x2a, 0xea, 0x76, 0x4b, 0xf6, 0x85, 0x92, 0x2a, 0x3a, 0x2c,
+		  0x3e, 0x5b, 0xbd, 0x76, 0xa3, 0x1d, 0x5c, 0x37, 0x63, 0x52,
+		  0x23, 0x54, 0x4b, 0xda, 0x86, 0x94, 0x6b, 0xba, 0x35, 0x2e,
+		  0xaf, 0xd3, 0x14, 0x9c, 0xb3, 0x32, 0x02, 0x1f, 0x24, 0x66,
+		  0x33, 0x9b, 0x80, 0xab, 0x34, 0xbc, 0xb9, 0xad, 0xb2, 0x77,
+		  0xac, 0xbe, 0x72, 0x86, 0x5d, 0x35, 0x08, 0x39, 0xed, 0x5c,
+		  0xc2, 0xf9, 0x8b, 0xf4, 0xa0, 0x7d, 0x38, 0x8d, 0x27, 0xdf,
+		  0xba, 0x79, 0xa9, 0x16, 0xfa, 0xd4, 0xd0, 0xda, 0x9a, 0x0f,
+		  0xde, 0xde, 0x4b, 0x69, 0x42, 0xc2, 0xf0, 0xeb, 0x74, 0x51,
+		  0x6e, 0xe6, 0x3c, 0xb9, 0xec, 0xe9, 0x14, 0xea, 0x85, 0x7b,
+		  0xf7, 0x2c, 0x37, 0x96, 0x23, 0x7f, 0xd3, 0x4a, 0x1d, 0x56,
+		  0x71, 0x7b, 0x26, 0x0f, 0x1d, 0x86, 0x56, 0x0a, 0x3b, 0x4d,
+		  0xee, 0x26, 0xff, 0x9e, 0xa9, 0xdb, 0x00, 0x51, 0xdc, 0x91,
+		  0x18, 0xb1, 0xaf, 0xa1, 0xa6, 0xd9, 0x9f, 0x2a, 0x68, 0x3d,
+		  0x6b, 0xdb, 0xf6, 0x14, 0xf3, 0x79, 0x00, 0x88, 0x5a, 0xe4,
+		  0xfb, 0x3b, 0x79, 0x02, 0x81, 0x81, 0x00, 0xd2, 0xd9, 0x58,
+		  0x13, 0x4f, 0x04, 0xfc, 0xdc, 0xc7, 0x1a, 0x3e, 0x02, 0xed,
+		  0xc4, 0xaf, 0xae, 0xf3, 0xa4, 0x28, 0xad, 0x5b, 0x34, 0x52,
+		  0xfd, 0xee, 0xe1, 0xcf, 0x8f, 0x6d, 0x7c, 0x31, 0x9f, 0xd5,
+		  0xe4, 0xda, 0x77, 0xf3, 0xe5, 0xf7, 0x20, 0xeb, 0x0b, 0x29,
+		  0xdc, 0x20, 0x59, 0xe8, 0xd3, 0x64, 0x74, 0x4c, 0xf4, 0x6c,
+		  0x83, 0xa5, 0x5b, 0x90, 0x88, 0xb6, 0x7a, 0xff, 0xf0, 0x69,
+		  0xbe, 0x9c, 0xe4, 0xaf, 0xcc, 0xd6, 0x2f, 0x8c, 0x6b, 0xfd,
+		  0xb6, 0xff, 0xb7, 0x60, 0xbc, 0x68, 0x63, 0x37, 0x46, 0x25,
+		  0x03, 0xfa, 0x0a, 0xcb, 0x4d, 0xbc, 0x42, 0xfe, 0x72, 0xc0,
+		  0x90, 0x75, 0x17, 0xe7, 0x77, 0x47, 0x7d, 0xd5, 0x2a, 0x40,
+		  0x01, 0x15, 0xa6, 0x65, 0x2a, 0x4f, 0x89, 0x10, 0x4d, 0x26,
+		  0x1f, 0x85, 0x63, 0xfe, 0x4f, 0xcd, 0xc8, 0x5f, 0x77, 0xb3,
+		  0x67, 0x3c, 0xe0, 0xeb, 0x17, 0x02, 0x81, 0x81, 0x00, 0xbc,
+		  0x69, 0x9b, 0x1d, 0x5d, 0x3d, 0xfb, 0xf8, 0x08, 0x80, 0xaa,
+		  0x5a, 0xdd, 0x94, 0xc6, 0xaa, 0x8e, 0x7a, 0x6c, 0x70, 0x74,
+		  0x75, 0xab, 0xdb, 0x5c, 0xb3, 0xdb, 0xf3, 0x9f, 0x73, 0x3f,
+		  0x11, 0xe7, 0xb0, 0x6b, 0x20, 0xae, 0x01, 0x37, 0x2e, 0x99,
+		  0x8d, 0xf3, 0x8a, 0x4a, 0x1a, 0x70, 0x75, 0xf3, 0x9b, 0x5e,
+		  0xa0, 0xcc, 0xd0, 0xc4, 0x96, 0x69, 0x4b, 0xf3, 0x2d, 0x4a,
+		  0x59, 0xed, 0x49, 0x99, 0x9a, 0xa7, 0xe9, 0x40, 0x71, 0x7c,
+		  0x4d, 0x88, 0x23, 0x16, 0x64, 0x65, 0xe3, 0x34, 0x37, 0xb2,
+		  0x9e, 0xa6, 0x99, 0xf7, 0x85, 0x0f, 0x82, 0xdf, 0xbc, 0x3c,
+		  0x68, 0x6b, 0x53, 0x94, 0xe0, 0xf9, 0xf4, 0x40, 0x66, 0x61,
+		  0x87, 0x55, 0x67, 0xc7, 0x3e, 0xcf, 0x96, 0xf1, 0xee, 0xd1,
+		  0xe8, 0x68, 0x73, 0x8f, 0x3d, 0xbf, 0x97, 0x0c, 0x4c, 0xe1,
+		  0x19, 0x68, 0xf5, 0x96, 0xbf, 0x31, 0x1d, 0x02, 0x81, 0x81,
+		  0x00, 0xaa, 0x4d, 0x4e, 0xac, 0x59, 0xd8, 0xc7, 0x7c, 0x73,
+		  0x7c, 0xa8, 0xb5, 0xa8, 0xe2, 0x82, 0x9c, 0x26, 0xc2, 0x62,
+		  0xf0, 0x92, 0x88, 0x12, 0xb8, 0x73, 0xe8, 0x03, 0xc3, 0xef,
+		  0x44, 0xae, 0xb8, 0x51, 0x05, 0x45, 0xc8, 0x39, 0x41, 0x77,
+		  0x78, 0x29, 0x20, 0x9d, 0x30, 0xe5, 0x18, 0x79, 0xcb, 0xb4,
+		  0x89, 0x93, 0x56, 0xa1, 0x07, 0x3b, 0xda, 0x57, 0x45, 0x75,
+		  0x4e, 0xa7, 0xc6, 0xc1, 0x42, 0x6a, 0x6a, 0xf3, 0xeb, 0xd8,
+		  0xdc, 0x12, 0xe9, 0x6e, 0xc6, 0x0e, 0x89, 0x49, 0x23, 0x24,
+		  0x95, 0x6e, 0xa1, 0xc3, 0x68, 0x10, 0xe0, 0x03, 0x11, 0xc8,
+		  0x8b, 0xbc, 0x05, 0x67, 0xaf, 0xc6, 0x44, 0x06, 0x7a, 0xfb,
+		  0x4d, 0x91, 0x8d, 0x4c, 0xa1, 0x13, 0xa1, 0x90, 0x78, 0xba,
+		  0x41, 0x14, 0xdf, 0x9b, 0x79, 0x3e, 0x3e, 0x63, 0xbc, 0x85,
+		  0x93, 0xe0, 0x38, 0x48, 0xb9, 0x8c, 0x1c, 0x87, 0x05, 0x02,
+		  0x81, 0x80, 0x10, 0x34, 0xb1, 0x2f, 0xdc, 0x66, 0x49, 0x76,
+		  0xf3, 0x1c, 0x46, 0x0a, 0xdc, 0xc6, 0x40, 0x34, 0x49, 0x5f,
+		  0x04, 0x56, 0xc3, 0xdd, 0x9f, 0x33, 0x96, 0x0c, 0xae, 0x5d,
+		  0x8d, 0x18, 0x77, 0x93, 0x4d, 0xaf, 0x61, 0xf7, 0x84, 0x9f,
+		  0xfc, 0x24, 0x18, 0xf7, 0x19, 0xbc, 0x8a, 0x55, 0x2d, 0xd9,
+		  0x27, 0x63, 0xf4, 0xc6, 0xb5, 0xf7, 0x3b, 0x01, 0x88, 0xfb,
+		  0x0c, 0x66, 0x97, 0xdf, 0x96, 0x46, 0x5f, 0x5c, 0xeb, 0x16,
+		  0x68, 0x01, 0x9a, 0xe4, 0x7c, 0x52, 0x30, 0x49, 0xe0, 0x6d,
+		  0xa3, 0x7f, 0x2a, 0xf0, 0xf4, 0x79, 0x87, 0xcd, 0xbd, 0x20,
+		  0xcf, 0xa7, 0xbc, 0x36, 0x6b, 0x0c, 0xdc, 0x60, 0x61, 0x7f,
+		  0x7d, 0xce, 0x90, 0x92, 0xf8, 0x68, 0x9d, 0xbd, 0xac, 0x53,
+		  0x5a, 0x69, 0xe5, 0x4a, 0x2d, 0x39, 0xcb, 0x57, 0x4f, 0x54,
+		  0x69, 0xad, 0x6f, 0x2b, 0x25, 0x59, 0x02, 0x67, 0x5d, 0x8d,
+		  0x02, 0x81, 0x81, 0x00, 0xad, 0x97, 0x0e, 0x2b, 0x91, 0xd3,
+		  0x4a, 0xe5, 0x57, 0xb7, 0x54, 0xf3, 0xea, 0xcd, 0x51, 0xa1,
+		  0x52, 0x0b, 0x8e, 0xfe, 0x74, 0x62, 0x09, 0xcd, 0xff, 0x73,
+		  0x49, 0x11, 0x53, 0xc3, 0x5e, 0xf4, 0xb2, 0xe3, 0x45, 0xe6,
+		  0x99, 0xa0, 0x4e, 0x2b, 0xae, 0x26, 0x01, 0xc7, 0x50, 0x97,
+		  0xe6, 0x68, 0xa2, 0x84, 0x7d, 0xd0, 0xea, 0xa7, 0x3a, 0x9c,
+		  0xeb, 0x6f, 0xdb, 0x84, 0x58, 0xd7, 0xa2, 0xcf, 0x99, 0x81,
+		  0x0b, 0x61, 0x02, 0x2f, 0x7a, 0x3b, 0x6f, 0x77, 0x45, 0x38,
+		  0x8b, 0xc5, 0xe3, 0xd7, 0x46, 0xae, 0x68, 0x40, 0x05, 0x15,
+		  0x7c, 0x6b, 0x87, 0x76, 0xd0, 0x67, 0x08, 0x6b, 0xcb, 0xec,
+		  0xd6, 0x37, 0xd1, 0x81, 0xbe, 0xc4, 0xfe, 0x5d, 0x8f, 0x75,
+		  0xd5, 0x4a, 0x93, 0x13, 0x5a, 0x4d, 0x95, 0xd2, 0x71, 0x77,
+		  0x4d, 0x18, 0x2b, 0x95, 0xfc, 0xa9, 0x2d, 0x55, 0xc8, 0x35,
+		  0x6c, 0x27 ),
+	PUBLIC ( 0x30, 0x82, 0x01, 0x22, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86,
+		 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03,
+		 0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82,
+		 0x01, 0x01, 0x00, 0x9b, 0x2e, 0x97, 0x95, 0x15, 0xb1, 0xc0,
+		 0x16, 0x34, 0xa6, 0xe9, 0xd3, 0xbc, 0x8b, 0xc7, 0xd3, 0x99,
+		 0x17, 0x0b, 0xf1, 0x37, 0x32, 0x89, 0xcd, 0x15, 0x9c, 0xbd,
+		 0xb8, 0xf7, 0x25, 0x86, 0x8c, 0x63, 0xa0, 0x2d, 0x4f, 0x28,
+		 0x77, 0xb0, 0x95, 0xb0, 0x77, 0x71, 0xd6, 0x87, 0x98, 0xe1,
+		 0xd2, 0xb3, 0x47, 0x34, 0x2a, 0x82, 0x11, 0xa9, 0x92, 0xe2,
+		 0xf7, 0xa5, 0x91, 0x32, 0x7e, 0xd6, 0xf2, 0x8e, 0x9c, 0x85,
+		 0x5e, 0x80, 0x7f, 0xf3, 0x66, 0x9e, 0x82, 0xdc, 0xc0, 0x28,
+		 0x35, 0xec, 0x48, 0x0e, 0xeb, 0xa2, 0x6b, 0xac, 0xee, 0x71,
+		 0xb3, 0x10, 0x6c, 0x24, 0x6e, 0x62, 0x64, 0x4f, 0x8b, 0xe2,
+		 0x2a, 0x98, 0xad, 0x2e, 0xd2, 0x52, 0x77, 0x5a, 0xea, 0xec,
+		 0x8e, 0x4d, 0x41, 0x8b, 0x30, 0x5c, 0x05, 0x19, 0xbb, 0xb1,
+		 0x89, 0x0f, 0x66, 0x07, 0x89, 0xf5, 0xf4, 0xe1, 0x6b, 0x27,
+		 0x2a, 0xe4, 0xd7, 0xe9, 0x77, 0xdb, 0x39, 0xfa, 0xba, 0xb8,
+		 0x95, 0xba, 0x81, 0x4f, 0x70, 0x44, 0x11, 0xf7, 0x99, 0x05,
+		 0x44, 0x96, 0xda, 0x57, 0xb5, 0x25, 0x9b, 0xd3, 0xa6, 0xfd,
+		 0x8d, 0x88, 0x07, 0xff, 0xd6, 0xc9, 0xa3, 0x6e, 0x53, 0xf4,
+		 0x7c, 0x66, 0x7d, 0xa5, 0x4b, 0x13, 0x82, 0x3b, 0x0e, 0xcd,
+		 0xb4, 0x3e, 0x84, 0x7c, 0x2d, 0xfe, 0x79, 0x4a, 0xcf, 0xb3,
+		 0x25, 0x26, 0xbb, 0x41, 0x24, 0x83, 0xe3, 0x90, 0xc9, 0xc8,
+		 0x6f, 0x43, 0xe5, 0x11, 0x0e, 0x88, 0x9f, 0x03, 0x4e, 0xcb,
+		 0x14, 0x65, 0x5f, 0x8c, 0x39, 0x44, 0xb8, 0xd7, 0xe3, 0xd1,
+		 0xbe, 0xc5, 0x56, 0x56, 0xdb, 0xa8, 0x55, 0x83, 0x2e, 0x30,
+		 0x36, 0x50, 0x43, 0x08, 0x3c, 0x70, 0xff, 0x70, 0x90, 0x14,
+		 0xec, 0xd9, 0xca, 0x5d, 0xac, 0x4e, 0x15, 0xb7, 0x40, 0x29,
+		 0x58, 0xe0, 0x99, 0x9f, 0xea, 0xd2, 0xa3, 0x08, 0x9b, 0x02,
+		 0x03, 0x01, 0x00, 0x01 ),
+	PLAINTEXT ( 0x94, 0xbe, 0xd1, 0x76, 0x37, 0xfa, 0x4d, 0xfb, 0x62, 0xf5,
+		    0xb6, 0x32, 0x88, 0x46, 0xe3, 0x1d, 0x41, 0x2b, 0x32, 0x9a,
+		    0x2d, 0x1e, 0x94, 0x6b, 0xfb, 0xc9, 0x05, 0xec, 0x2b, 0x39,
+		    0xbc, 0xe1, 0x3e, 0xb6, 0xca, 0x27, 0x94, 0xee, 0xbc, 0x1c,
+		    0x07, 0xc4, 0xe6, 0x1a, 0x4c, 0x1f, 0x14, 0xa9, 0x60, 0x48,
+		    0x23, 0x24, 0xd5, 0xd8, 0x2f, 0x1a, 0x53, 0x86, 0x52, 0x6b,
+		    0x64, 0x0e, 0xe2, 0xad ),
+	&sha256_algorithm,
+	SIGNATURE ( 0x0b, 0x66, 0x58, 0xaa, 0x19, 0x87, 0x8d, 0x6b, 0x9c, 0xc5,
+		    0x70, 0x0e, 0x9f, 0xba, 0xbb, 0x3f, 0x26, 0xb1, 0x7b, 0xcd,
+		    0x64, 0x38, 0x46, 0x6c, 0xb8, 0x11, 0x7d, 0x56, 0xc7, 0x67,
+		    0x98, 0xac, 0x4b, 0x78, 0xe9, 0x29, 0x75, 0x07, 0xba, 0x81,
+		    0x3b, 0xe8, 0x0e, 0x88, 0xc1, 0x7d, 0x65, 0x92, 0xb2, 0xa8,
+		    0xe0, 0x29, 0x32, 0xa2, 0xe3, 0x65, 0xa1, 0x59, 0xec, 0x09,
+		    0x2a, 0xd8, 0x0e, 0xcc, 0x7a, 0x89, 0xb8, 0xc5, 0xfd, 0x93,
+		    0xd9, 0xe4, 0x3a, 0xa4, 0xdb, 0x01, 0xd4, 0xd5, 0x3f, 0x0e,
+		    0xf6, 0x40, 0xa5, 0xda, 0x5e, 0xf0, 0xd4, 0xb8, 0x7e, 0x1d,
+		    0xfd, 0x02, 0xf2, 0x6d, 0xe0, 0x1a, 0x9b, 0x21, 0x6c, 0x4a,
+		    0xcf, 0x92, 0xd4, 0x83, 0xbc, 0x1d, 0x34, 0x7f, 0x93, 0x16,
+		    0x59, 0xf0, 0xeb, 0x5c, 0x7f, 0xf4, 0x1f, 0x61, 0x68, 0x47,
+		    0xae, 0xb9, 0x65, 0x3c, 0x9c, 0xbe, 0xa4, 0x67, 0x7d, 0xd7,
+		    0x80, 0xd2, 0xe2, 0x77, 0x95, 0x33, 0x3d, 0x0e, 0x27, 0xc7,
+		    0xe8, 0xb4, 0xde, 0x6e, 0x21, 0x24, 0x07, 0x97, 0x25, 0xfe,
+		    0xe2, 0x81, 0x49, 0x0e, 0xdd, 0x24, 0x42, 0xa0, 0x8c, 0x31,
+		    0xe8, 0x74, 0x65, 0x3f, 0x64, 0xde, 0xeb, 0xe0, 0x55, 0xfd,
+		    0x2b, 0x3e, 0x5d, 0x5d, 0xc3, 0x5e, 0x98, 0x44, 0xa4, 0x53,
+		    0x11, 0xda, 0x6b, 0xe2, 0x5a, 0x45, 0x2e, 0x99, 0x23, 0x06,
+		    0xe4, 0xe4, 0x02, 0xc0, 0xb5, 0x43, 0x29, 0xa0, 0xfa, 0x39,
+		    0x38, 0x8e, 0x39, 0x3c, 0x37, 0xb3, 0x54, 0x0b, 0x32, 0xb6,
+		    0x87, 0x5a, 0xaf, 0x3b, 0xeb, 0x6c, 0xd7, 0x60, 0xab, 0x0e,
+		    0x83, 0x07, 0x61, 0x5a, 0x45, 0x57, 0x5a, 0x2d, 0x90, 0xd0,
+		    0x47, 0xb2, 0xdc, 0x15, 0xe3, 0x41, 0x38, 0xda, 0xe0, 0x01,
+		    0xc4, 0x17, 0x46, 0x71, 0x4f, 0x7b, 0x9c, 0x41, 0xd8, 0x1a,
+		    0x24, 0x7a, 0x98, 0x15, 0x56, 0xe4 ) );
+
+/** 2048-bit random message SHA-256 signature test (without CRT) */
+PUBKEY_SIGN_TEST ( sha256_2048_nocrt_test, &rsa_algorithm,
+	PRIVATE ( 0x30, 0x82, 0x02, 0x11, 0x02, 0x01, 0x00, 0x02, 0x82, 0x01,
+		  0x01, 0x00, 0x9b, 0x2e, 0x97, 0x95, 0x15, 0xb1, 0xc0, 0x16,
+		  0x34, 0xa6, 0xe9, 0xd3, 0xbc, 0x8b, 0xc7, 0xd3, 0x99, 0x17,
+		  0x0b, 0xf1, 0x37, 0x32, 0x89, 0xcd, 0x15, 0x9c, 0xbd, 0xb8,
+		  0xf7, 0x25, 0x86, 0x8c, 0x63, 0xa0, 0x2d, 0x4f, 0x28, 0x77,
+		  0xb0, 0x95, 0xb0, 0x77, 0x71, 0xd6, 0x87, 0x98, 0xe1, 0xd2,
+		  0xb3, 0x47, 0x34, 0x2a, 0x82, 0x11, 0xa9, 0x92, 0xe2, 0xf7,
+		  0xa5, 0x91, 0x32, 0x7e, 0xd6, 0xf2, 0x8e, 0x9c, 0x85, 0x5e,
+		  0x80, 0x7f, 0xf3, 0x66, 0x9e, 0x82, 0xdc, 0xc0, 0x28, 0x35,
+		  0xec, 0x48, 0x0e, 0xeb, 0xa2, 0x6b, 0xac, 0xee, 0x71, 0xb3,
+		  0x10, 0x6c, 0x24, 0x6e, 0x62, 0x64, 0x4f, 0x8b, 0xe2, 0x2a,
+		  0x98, 0xad, 0x2e, 0xd2, 0x52, 0x77, 0x5a, 0xea, 0xec, 0x8e,
+		  0x4d, 0x41, 0x8b, 0x30, 0x5c, 0x05, 0x19, 0xbb, 0xb1, 0x89,
+		  0x0f, 0x66, 0x07, 0x89, 0xf5, 0xf4, 0xe1, 0x6b, 0x27, 0x2a,
+		  0xe4, 0xd7, 0xe9, 0x77, 0xdb, 0x39, 0xfa, 0xba, 0xb8, 0x95,
+		  0xba, 0x81, 0x4f, 0x70, 0x44, 0x11, 0xf7, 0x99, 0x05, 0x44,
+		  0x96, 0xda, 0x57, 0xb5, 0x25, 0x9b, 0xd3, 0xa6, 0xfd, 0x8d,
+		  0x88, 0x07, 0xff, 0xd6, 0xc9, 0xa3, 0x6e, 0x53, 0xf4, 0x7c,
+		  0x66, 0x7d, 0xa5, 0x4b, 0x13, 0x82, 0x3b, 0x0e, 0xcd, 0xb4,
+		  0x3e, 0x84, 0x7c, 0x2d, 0xfe, 0x79, 0x4a, 0xcf, 0xb3, 0x25,
+		  0x26, 0xbb, 0x41, 0x24, 0x83, 0xe3, 0x90, 0xc9, 0xc8, 0x6f,
+		  0x43, 0xe5, 0x11, 0x0e, 0x88, 0x9f, 0x03, 0x4e, 0xcb, 0x14,
+		  0x65, 0x5f, 0x8c, 0x39, 0x44, 0xb8, 0xd7, 0xe3, 0xd1, 0xbe,
+		  0xc5, 0x56, 0x56, 0xdb, 0xa8, 0x55, 0x83, 0x2e, 0x30, 0x36,
+		  0x50, 0x43, 0x08, 0x3c, 0x70, 0xff, 0x70, 0x90, 0x14, 0xec,
+		  0xd9, 0xca, 0x5d, 0xac, 0x4e, 0x15, 0xb7, 0x40, 0x29, 0x58,
+		  0xe0, 0x99, 0x9f, 0xea, 0xd2, 0xa3, 0x08, 0x9b, 0x02, 0x03,
+		  0x01, 0x00, 0x01, 0x02, 0x82, 0x01, 0x00, 0x02, 0x5f, 0xfd,
+		  0x2b, 0xe7, 0xf0, 0x17, 0x7b, 0x7f, 0x84, 0xca, 0x71, 0x56,
+		  0x22, 0x61, 0x85, 0x88, 0x83, 0x44, 0xc8, 0x85, 0x4a, 0xbd,
+		  0xb7, 0x28, 0xcc, 0x84, 0x4e, 0xcf, 0x61, 0x80, 0xa4, 0xa7,
+		  0x65, 0xad, 0x2b, 0xd7, 0xf7, 0xb4, 0xf9, 0x25, 0x81, 0x3e,
+		  0x79, 0xc5, 0x0b, 0x7e, 0xf1, 0x45, 0x93, 0x22, 0x66, 0x40,
+		  0x25, 0x5b, 0x0e, 0x07, 0x71, 0x38, 0xd4, 0x77, 0x0c, 0x5f,
+		  0xe7, 0xc8, 0x6c, 0xf6, 0xd1, 0x92, 0x6f, 0xe2, 0xde, 0xc0,
+		  0x30, 0x4a, 0x86, 0x9a, 0x56, 0xf0, 0xed, 0xcd, 0x64, 0xa7,
+		  0xd0, 0xb4, 0x0d, 0xd6, 0x29, 0xa2, 0x67, 0xb5, 0x4b, 0x07,
+		  0x30, 0x77, 0xd3, 0x31, 0x3b, 0xeb, 0xa8, 0x42, 0xde, 0x2f,
+		  0x2a, 0xea, 0x76, 0x4b, 0xf6, 0x85, 0x92, 0x2a, 0x3a, 0x2c,
+		  0x3e, 0x5b, 0xbd, 0x76, 0xa3, 0x1d, 0x5c, 0x37, 0x63, 0x52,
+		  0x23, 0x54, 0x4b, 0xda, 0x86, 0x94, 0x6b, 0xba, 0x35, 0x2e,
+		  0xaf, 0xd3, 0x14, 0x9c, 0xb3, 0x32, 0x02, 0x1f, 0x24, 0x66,
+		  0x33, 0x9b, 0x80, 0xab, 0x34, 0xbc, 0xb9, 0xad, 0xb2, 0x77,
+		  0xac, 0xbe, 0x72, 0x86, 0x5d, 0x35, 0x08, 0x39, 0xed, 0x5c,
+		  0xc2, 0xf9, 0x8b, 0xf4, 0xa0, 0x7d, 0x38, 0x8d, 0x27, 0xdf,
+		  0xba, 0x79, 0xa9, 0x16, 0xfa, 0xd4, 0xd0, 0xda, 0x9a, 0x0f,
+		  0xde, 0xde, 0x4b, 0x69, 0x42, 0xc2, 0xf0, 0xeb, 0x74, 0x51,
+		  0x6e, 0xe6, 0x3c, 0xb9, 0xec, 0xe9, 0x14, 0xea, 0x85, 0x7b,
+		  0xf7, 0x2c, 0x37, 0x96, 0x23, 0x7f, 0xd3, 0x4a, 0x1d, 0x56,
+		  0x71, 0x7b, 0x26, 0x0f, 0x1d, 0x86, 0x56, 0x0a, 0x3b, 0x4d,
+		  0xee, 0x26, 0xff, 0x9e, 0xa9, 0xdb, 0x00, 0x51, 0xdc, 0x91,
+		  0x18, 0xb1, 0xaf, 0xa1, 0xa6, 0xd9, 0x9f, 0x2a, 0x68, 0x3d,
+		  0x6b, 0xdb, 0xf6, 0x14, 0xf3, 0x79, 0x00, 0x88, 0x5a, 0xe4,
+		  0xfb, 0x3b, 0x79 ),
+	PUBLIC ( 0x30, 0x82, 0x01, 0x22, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86,
+		 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03,
+		 0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82,
+		 0x01, 0x01, 0x00, 0x9b, 0x2e, 0x97, 0x95, 0x15, 0xb1, 0xc0,
+		 0x16, 0x34, 0xa6, 0xe9, 0xd3, 0xbc, 0x8b, 0xc7, 0xd3, 0x99,
+		 0x17, 0x0b, 0xf1, 0x37, 0x32, 0x89, 0xcd, 0x15, 0x9c, 0xbd,
+		 0xb8, 0xf7, 0x25, 0x86, 0x8c, 0x63, 0xa0, 0x2d, 0x4f, 0x28,
+		 0x77, 0xb0, 0x95, 0xb0, 0x77, 0x71, 0xd6, 0x87, 0x98, 0xe1,
+		 0xd2, 0xb3, 0x47, 0x34, 0x2a, 0x82, 0x11, 0xa9, 0x92, 0xe2,
+		 0xf7, 0xa5, 0x91, 0x32, 0x7e, 0xd6, 0xf2, 0x8e, 0x9c, 0x85,
+		 0x5e, 0x80, 0x7f, 0xf3, 0x66, 0x9e, 0x82, 0xdc, 0xc0, 0x28,
+		 0x35, 0xec, 0x48, 0x0e, 0xeb, 0xa2, 0x6b, 0xac, 0xee, 0x71,
+		 0xb3, 0x10, 0x6c, 0x24, 0x6e, 0x62, 0x64, 0x4f, 0x8b, 0xe2,
+		 0x2a, 0x98, 0xad, 0x2e, 0xd2, 0x52, 0x77, 0x5a, 0xea, 0xec,
+		 0x8e, 0x4d, 0x41, 0x8b, 0x30, 0x5c, 0x05, 0x19, 0xbb, 0xb1,
+		 0x89, 0x0f, 0x66, 0x07, 0x89, 0xf5, 0xf4, 0xe1, 0x6b, 0x27,
+		 0x2a, 0xe4, 0xd7, 0xe9, 0x77, 0xdb, 0x39, 0xfa, 0xba, 0xb8,
+		 0x95, 0xba, 0x81, 0x4f, 0x70, 0x44, 0x11, 0xf7, 0x99, 0x05,
+		 0x44, 0x96, 0xda, 0x57, 0xb5, 0x25, 0x9b, 0xd3, 0xa6, 0xfd,
+		 0x8d, 0x88, 0x07, 0xff, 0xd6, 0xc9, 0xa3, 0x6e, 0x53, 0xf4,
+		 0x7c, 0x66, 0x7d, 0xa5, 0x4b, 0x13, 0x82, 0x3b, 0x0e, 0xcd,
+		 0xb4, 0x3e, 0x84, 0x7c, 0x2d, 0xfe, 0x79, 0x4a, 0xcf, 0xb3,
+		 0x25, 0x26, 0xbb, 0x41, 0x24, 0x83, 0xe3, 0x90, 0xc9, 0xc8,
+		 0x6f, 0x43, 0xe5, 0x11, 0x0e, 0x88, 0x9f, 0x03, 0x4e, 0xcb,
+		 0x14, 0x65, 0x5f, 0x8c, 0x39, 0x44, 0xb8, 0xd7, 0xe3, 0xd1,
+		 0xbe, 0xc5, 0x56, 0x56, 0xdb, 0xa8, 0x55, 0x83, 0x2e, 0x30,
+		 0x36, 0x50, 0x43, 0x08, 0x3c, 0x70, 0xff, 0x70, 0x90, 0x14,
+		 0xec, 0xd9, 0xca, 0x5d, 0xac, 0x4e, 0x15, 0xb7, 0x40, 0x29,
+		 0x58, 0xe0, 0x99, 0x9f, 0xea, 0xd2, 0xa3, 0x08, 0x9b, 0x02,
+		 0x03, 0x01, 0x00, 0x01 ),
+	PLAINTEXT ( 0x94, 0xbe, 0xd1, 0x76, 0x37, 0xfa, 0x4d, 0xfb, 0x62, 0xf5,
+		    0xb6, 0x32, 0x88, 0x46, 0xe3, 0x1d, 0x41, 0x2b, 0x32, 0x9a,
+		    0x2d, 0x1e, 0x94, 0x6b, 0xfb, 0xc9, 0x05, 0xec, 0x2b, 0x39,
+		    0xbc, 0xe1, 0x3e, 0xb6, 0xca, 0x27, 0x94, 0xee, 0xbc, 0x1c,
+		    0x07, 0xc4, 0xe6, 0x1a, 0x4c, 0x1f, 0x14, 0xa9, 0x60, 0x48,
+		    0x23, 0x24, 0xd5, 0xd8, 0x2f, 0x1a, 0x53, 0x86, 0x52, 0x6b,
+		    0x64, 0x0e, 0xe2, 0xad ),
+	&sha256_algorithm,
+	SIGNATURE ( 0x0b, 0x66, 0x58, 0xaa, 0x19, 0x87, 0x8d, 0x6b, 0x9c, 0xc5,
+		    0x70, 0x0e, 0x9f, 0xba, 0xbb, 0x3f, 0x26, 0xb1, 0x7b, 0xcd,
+		    0x64, 0x38, 0x46, 0x6c, 0xb8, 0x11, 0x7d, 0x56, 0xc7, 0x67,
+		    0x98, 0xac, 0x4b, 0x78, 0xe9, 0x29, 0x75, 0x07, 0xba, 0x81,
+		    0x3b, 0xe8, 0x0e, 0x88, 0xc1, 0x7d, 0x65, 0x92, 0xb2, 0xa8,
+		    0xe0, 0x29, 0x32, 0xa2, 0xe3, 0x65, 0xa1, 0x59, 0xec, 0x09,
+		    0x2a, 0xd8, 0x0e, 0xcc, 0x7a, 0x89, 0xb8, 0xc5, 0xfd, 0x93,
+		    0xd9, 0xe4, 0x3a, 0xa4, 0xdb, 0x01, 0xd4, 0xd5, 0x3f, 0x0e,
+		    0xf6, 0x40, 0xa5, 0xda, 0x5e, 0xf0, 0xd4, 0xb8, 0x7e, 0x1d,
+		    0xfd, 0x02, 0xf2, 0x6d, 0xe0, 0x1a, 0x9b, 0x21, 0x6c, 0x4a,
+		    0xcf, 0x92, 0xd4, 0x83, 0xbc, 0x1d, 0x34, 0x7f, 0x93, 0x16,
+		    0x59, 0xf0, 0xeb, 0x5c, 0x7f, 0xf4, 0x1f, 0x61, 0x68, 0x47,
+		    0xae, 0xb9, 0x65, 0x3c, 0x9c, 0xbe, 0xa4, 0x67, 0x7d, 0xd7,
+		    0x80, 0xd2, 0xe2, 0x77, 0x95, 0x33, 0x3d, 0x0e, 0x27, 0xc7,
+		    0xe8, 0xb4, 0xde, 0x6e, 0x21, 0x24, 0x07, 0x97, 0x25, 0xfe,
+		    0xe2, 0x81, 0x49, 0x0e, 0xdd, 0x24, 0x42, 0xa0, 0x8c, 0x31,
+		    0xe8, 0x74, 0x65, 0x3f, 0x64, 0xde, 0xeb, 0xe0, 0x55, 0xfd,
+		    0x2b, 0x3e, 0x5d, 0x5d, 0xc3, 0x5e, 0x98, 0x44, 0xa4, 0x53,
+		    0x11, 0xda, 0x6b, 0xe2, 0x5a, 0x45, 0x2e, 0x99, 0x23, 0x06,
+		    0xe4, 0xe4, 0x02, 0xc0, 0xb5, 0x43, 0x29, 0xa0, 0xfa, 0x39,
+		    0x38, 0x8e, 0x39, 0x3c, 0x37, 0xb3, 0x54, 0x0b, 0x32, 0xb6,
+		    0x87, 0x5a, 0xaf, 0x3b, 0xeb, 0x6c, 0xd7, 0x60, 0xab, 0x0e,
+		    0x83, 0x07, 0x61, 0x5a, 0x45, 0x57, 0x5a, 0x2d, 0x90, 0xd0,
+		    0x47, 0xb2, 0xdc, 0x15, 0xe3, 0x41, 0x38, 0xda, 0xe0, 0x01,
+		    0xc4, 0x17, 0x46, 0x71, 0x4f, 0x7b, 0x9c, 0x41, 0xd8, 0x1a,
+		    0x24, 0x7a, 0x98, 0x15, 0x56, 0xe4 ) );
+
 /**
  * Perform RSA self-tests
  *
@@ -384,6 +692,14 @@ static void rsa_test_exec ( void ) {
 	pubkey_sign_ok ( &md5_test );
 	pubkey_sign_ok ( &sha1_test );
 	pubkey_sign_ok ( &sha256_test );
+	pubkey_sign_ok ( &sha256_2048_test );
+	pubkey_sign_ok ( &sha256_2048_nocrt_test );
+
+	/* Speed tests */
+	DBG ( "RSA-2048 signature (with CRT) required %ld cycles\n",
+	      pubkey_sign_cost ( &sha256_2048_test ) );
+	DBG ( "RSA-2048 signature (without CRT) required %ld cycles\n",
+	      pubkey_sign_cost ( &sha256_2048_nocrt_test ) );
 }
 
 /** RSA self-test */
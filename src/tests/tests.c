@@ -67,6 +67,7 @@ REQUIRE_OBJECT ( uri_test );
 REQUIRE_OBJECT ( profile_test );
 REQUIRE_OBJECT ( setjmp_test );
 REQUIRE_OBJECT ( pccrc_test );
+REQUIRE_OBJECT ( pccrd_test );
 REQUIRE_OBJECT ( linebuf_test );
 REQUIRE_OBJECT ( iobuf_test );
 REQUIRE_OBJECT ( bitops_test );
@@ -88,6 +89,14 @@ REQUIRE_OBJECT ( uuid_test );
 REQUIRE_OBJECT ( editstring_test );
 REQUIRE_OBJECT ( p256_test );
 REQUIRE_OBJECT ( p384_test );
+REQUIRE_OBJECT ( ecdsa_test );
 REQUIRE_OBJECT ( efi_siglist_test );
 REQUIRE_OBJECT ( cpio_test );
 REQUIRE_OBJECT ( fdt_test );
+REQUIRE_OBJECT ( fbcon_test );
+REQUIRE_OBJECT ( pbkdf2_test );
+REQUIRE_OBJECT ( tls_test );
+REQUIRE_OBJECT ( http_test );
+REQUIRE_OBJECT ( gso_test );
+REQUIRE_OBJECT ( peerblk_test );
+REQUIRE_OBJECT ( trace_test );
@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * TLS record reception self-tests
+ *
+ * These tests construct a TLS connection, mark it as having completed
+ * negotiation, install a known AES-GCM receive cipher, and then feed
+ * in a stream of encrypted application data records split into
+ * received I/O buffers at various boundaries.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <byteswap.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/interface.h>
+#include <ipxe/pending.h>
+#include <ipxe/malloc.h>
+#include <ipxe/aes.h>
+#include <ipxe/tls.h>
+#include <ipxe/test.h>
+
+/** Maximum length of test ciphertext stream */
+#define TLS_TEST_MAX_LEN 16384
+
+/** Length of TLS record header, explicit IV, and authentication tag */
+#define TLS_TEST_OVERHEAD ( sizeof ( struct tls_header ) + 8 + 16 )
+
+/** A TLS record reception test */
+struct tls_record_test {
+	/** Record payload lengths */
+	const size_t *records;
+	/** Number of records */
+	unsigned int count;
+	/** Received I/O buffer lengths (excluding final buffer) */
+	const size_t *frags;
+	/** Number of received I/O buffer lengths */
+	unsigned int frag_count;
+};
+
+/** Define inline record payload lengths */
+#define RECORDS(...) { __VA_ARGS__ }
+
+/** Define inline received I/O buffer lengths */
+#define FRAGMENTS(...) { __VA_ARGS__ }
+
+/** Define a TLS record reception test */
+#define TLS_RECORD_TEST( name, RECORDS, FRAGMENTS )			\
+	static const size_t name ## _records[] = RECORDS;		\
+	static const size_t name ## _frags[] = FRAGMENTS;		\
+	static struct tls_record_test name = {				\
+		.records = name ## _records,				\
+		.count = ( sizeof ( name ## _records ) /		\
+			   sizeof ( name ## _records[0] ) ),		\
+		.frags = name ## _frags,				\
+		.frag_count = ( sizeof ( name ## _frags ) /		\
+				sizeof ( name ## _frags[0] ) ),		\
+	}
+
+/** A TLS test connection endpoint */
+struct tls_test_endpoint {
+	/** Plaintext interface */
+	struct interface plain;
+	/** Ciphertext interface */
+	struct interface cipher;
+	/** Received plaintext */
+	uint8_t rx[TLS_TEST_MAX_LEN];
+	/** Length of received plaintext */
+	size_t rx_len;
+	/** Connection has been closed */
+	int closed;
+};
+
+/** Test receive key */
+static const uint8_t tls_test_key[16] = {
+	0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+	0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01,
+};
+
+/** Test receive fixed IV */
+static const uint8_t tls_test_fixed_iv[4] = { 0xca, 0xfe, 0xf0, 0x0d };
+
+/** Ciphertext stream */
+static uint8_t tls_test_stream[TLS_TEST_MAX_LEN];
+
+/** Expected plaintext */
+static uint8_t tls_test_expected[TLS_TEST_MAX_LEN];
+
+/** Test connection endpoint */
+static struct tls_test_endpoint tls_test_endpoint;
+
+/**
+ * Receive plaintext data
+ *
+ * @v endpoint		Test connection endpoint
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int tls_test_deliver ( struct tls_test_endpoint *endpoint,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta __unused ) {
+	size_t len = iob_len ( iobuf );
+
+	assert ( ( endpoint->rx_len + len ) <= sizeof ( endpoint->rx ) );
+	memcpy ( ( endpoint->rx + endpoint->rx_len ), iobuf->data, len );
+	endpoint->rx_len += len;
+	free_iob ( iobuf );
+	return 0;
+}
+
+/**
+ * Close test connection endpoint
+ *
+ * @v endpoint		Test connection endpoint
+ * @v rc		Reason for close
+ */
+static void tls_test_close ( struct tls_test_endpoint *endpoint,
+			     int rc __unused ) {
+
+	endpoint->closed = 1;
+	intf_restart ( &endpoint->plain, 0 );
+}
+
+/**
+ * Discard transmitted ciphertext
+ *
+ * @v endpoint		Test connection endpoint
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int tls_test_discard ( struct tls_test_endpoint *endpoint __unused,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta __unused ) {
+
+	free_iob ( iobuf );
+	return 0;
+}
+
+/** Test plaintext interface operations */
+static struct interface_operation tls_test_plain_ops[] = {
+	INTF_OP ( xfer_deliver, struct tls_test_endpoint *, tls_test_deliver ),
+	INTF_OP ( intf_close, struct tls_test_endpoint *, tls_test_close ),
+};
+
+/** Test plaintext interface descriptor */
+static struct interface_descriptor tls_test_plain_desc =
+	INTF_DESC ( struct tls_test_endpoint, plain, tls_test_plain_ops );
+
+/** Test ciphertext interface operations */
+static struct interface_operation tls_test_cipher_ops[] = {
+	INTF_OP ( xfer_deliver, struct tls_test_endpoint *, tls_test_discard ),
+};
+
+/** Test ciphertext interface descriptor */
+static struct interface_descriptor tls_test_cipher_desc =
+	INTF_DESC ( struct tls_test_endpoint, cipher, tls_test_cipher_ops );
+
+/**
+ * Construct encrypted application data record
+ *
+ * @v data		Record buffer to fill in
+ * @v seq		Record sequence number
+ * @v plaintext		Plaintext
+ * @v len		Length of plaintext
+ * @ret record_len	Length of record
+ */
+static size_t tls_test_record ( void *data, uint64_t seq,
+				const void *plaintext, size_t len ) {
+	struct cipher_algorithm *cipher = &aes_gcm_algorithm;
+	uint8_t ctx[cipher->ctxsize];
+	struct tls_header *tlshdr = data;
+	struct tls_auth_header authhdr;
+	struct {
+		uint8_t fixed[sizeof ( tls_test_fixed_iv )];
+		uint64_t record;
+	} __attribute__ (( packed )) iv;
+	uint8_t *record_iv = ( data + sizeof ( *tlshdr ) );
+	uint8_t *ciphertext = ( record_iv + sizeof ( iv.record ) );
+	uint8_t *auth = ( ciphertext + len );
+
+	/* Construct header */
+	tlshdr->type = TLS_TYPE_DATA;
+	tlshdr->version = htons ( TLS_VERSION_TLS_1_2 );
+	tlshdr->length = htons ( sizeof ( iv.record ) + len +
+				 cipher->authsize );
+
+	/* Construct initialisation vector */
+	memcpy ( iv.fixed, tls_test_fixed_iv, sizeof ( iv.fixed ) );
+	iv.record = cpu_to_be64 ( seq );
+	memcpy ( record_iv, &iv.record, sizeof ( iv.record ) );
+
+	/* Construct authentication data */
+	authhdr.seq = cpu_to_be64 ( seq );
+	authhdr.header.type = tlshdr->type;
+	authhdr.header.version = tlshdr->version;
+	authhdr.header.length = htons ( len );
+
+	/* Encrypt payload */
+	cipher_setkey ( cipher, ctx, tls_test_key, sizeof ( tls_test_key ) );
+	cipher_setiv ( cipher, ctx, &iv, sizeof ( iv ) );
+	cipher_encrypt ( cipher, ctx, &authhdr, NULL, sizeof ( authhdr ) );
+	cipher_encrypt ( cipher, ctx, plaintext, ciphertext, len );
+	cipher_auth ( cipher, ctx, auth );
+
+	return ( sizeof ( *tlshdr ) + sizeof ( iv.record ) + len +
+		 cipher->authsize );
+}
+
+/**
+ * Deliver received ciphertext
+ *
+ * @v endpoint		Test connection endpoint
+ * @v data		Ciphertext
+ * @v len		Length of ciphertext
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void tls_test_receive ( struct tls_test_endpoint *endpoint,
+			       const void *data, size_t len,
+			       const char *file, unsigned int line ) {
+	struct io_buffer *iobuf;
+
+	iobuf = alloc_iob ( len );
+	okx ( iobuf != NULL, file, line );
+	if ( ! iobuf )
+		return;
+	memcpy ( iob_put ( iobuf, len ), data, len );
+	okx ( xfer_deliver_iob ( &endpoint->cipher, iobuf ) == 0, file, line );
+}
+
+/**
+ * Report TLS record reception test result
+ *
+ * @v test		TLS record reception test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void tls_record_okx ( struct tls_record_test *test, const char *file,
+			     unsigned int line ) {
+	struct tls_test_endpoint *endpoint = &tls_test_endpoint;
+	struct tls_cipherspec *cipherspec;
+	struct tls_cipher_suite *suite;
+	struct tls_connection *tls;
+	struct cipher_algorithm *cipher;
+	size_t stream_len = 0;
+	size_t expected_len = 0;
+	size_t offset;
+	size_t len;
+	unsigned int i;
+
+	/* Construct ciphertext stream and expected plaintext */
+	srand ( test->count );
+	for ( i = 0 ; i < test->count ; i++ ) {
+		len = test->records[i];
+		assert ( ( expected_len + len ) <=
+			 sizeof ( tls_test_expected ) );
+		assert ( ( stream_len + len + TLS_TEST_OVERHEAD ) <=
+			 sizeof ( tls_test_stream ) );
+		for ( offset = 0 ; offset < len ; offset++ )
+			tls_test_expected[ expected_len + offset ] = rand();
+		stream_len += tls_test_record ( ( tls_test_stream +
+						  stream_len ), i,
+						( tls_test_expected +
+						  expected_len ), len );
+		expected_len += len;
+	}
+
+	/* Create TLS connection */
+	memset ( endpoint, 0, sizeof ( *endpoint ) );
+	intf_init ( &endpoint->plain, &tls_test_plain_desc, NULL );
+	intf_init ( &endpoint->cipher, &tls_test_cipher_desc, NULL );
+	intf_plug_plug ( &endpoint->plain, &endpoint->cipher );
+	okx ( add_tls ( &endpoint->plain, "tls.test.ipxe.org",
+			NULL, NULL ) == 0, file, line );
+	tls = container_of ( endpoint->cipher.dest, struct tls_connection,
+			     cipherstream );
+
+	/* Mark negotiation as complete */
+	pending_put ( &tls->client.negotiation );
+	pending_put ( &tls->server.negotiation );
+
+	/* Install receive cipher */
+	for_each_table_entry ( suite, TLS_CIPHER_SUITES ) {
+		if ( suite->code == htons ( TLS_RSA_WITH_AES_128_GCM_SHA256 ) )
+			break;
+	}
+	okx ( suite != table_end ( TLS_CIPHER_SUITES ), file, line );
+	cipher = suite->cipher;
+	cipherspec = &tls->rx.cipherspec.active;
+	assert ( cipherspec->dynamic == NULL );
+	cipherspec->dynamic = zalloc ( cipher->ctxsize + suite->fixed_iv_len );
+	okx ( cipherspec->dynamic != NULL, file, line );
+	cipherspec->cipher_ctx = cipherspec->dynamic;
+	cipherspec->fixed_iv = ( cipherspec->dynamic + cipher->ctxsize );
+	cipherspec->suite = suite;
+	okx ( cipher_setkey ( cipher, cipherspec->cipher_ctx, tls_test_key,
+			      sizeof ( tls_test_key ) ) == 0, file, line );
+	memcpy ( cipherspec->fixed_iv, tls_test_fixed_iv,
+		 sizeof ( tls_test_fixed_iv ) );
+
+	/* Deliver ciphertext stream */
+	offset = 0;
+	for ( i = 0 ; i < test->frag_count ; i++ ) {
+		len = test->frags[i];
+		assert ( ( offset + len ) <= stream_len );
+		tls_test_receive ( endpoint, ( tls_test_stream + offset ),
+				   len, file, line );
+		offset += len;
+	}
+	if ( offset < stream_len ) {
+		tls_test_receive ( endpoint, ( tls_test_stream + offset ),
+				   ( stream_len - offset ), file, line );
+	}
+
+	/* Verify decrypted plaintext */
+	okx ( ! endpoint->closed, file, line );
+	okx ( endpoint->rx_len == expected_len, file, line );
+	okx ( memcmp ( endpoint->rx, tls_test_expected,
+		       expected_len ) == 0, file, line );
+
+	/* Close connection */
+	intf_shutdown ( &endpoint->cipher, 0 );
+	okx ( endpoint->closed, file, line );
+}
+#define tls_record_ok( test ) tls_record_okx ( test, __FILE__, __LINE__ )
+
+/** Single record within a single received buffer */
+TLS_RECORD_TEST ( single,
+	RECORDS ( 100 ),
+	FRAGMENTS ( 100 + TLS_TEST_OVERHEAD ) );
+
+/** Single record split across several received buffers */
+TLS_RECORD_TEST ( split,
+	RECORDS ( 6000 ),
+	FRAGMENTS ( 1, 4, 7, 700, 2000, 1 ) );
+
+/** Records each within a single received buffer */
+TLS_RECORD_TEST ( aligned,
+	RECORDS ( 300, 1, 4096 ),
+	FRAGMENTS ( 300 + TLS_TEST_OVERHEAD, 1 + TLS_TEST_OVERHEAD ) );
+
+/** Received buffer containing a record and the start of the next */
+TLS_RECORD_TEST ( trailing,
+	RECORDS ( 1000, 50, 200 ),
+	FRAGMENTS ( 1000 + TLS_TEST_OVERHEAD + 50 + TLS_TEST_OVERHEAD + 10 ) );
+
+/** Received buffer containing a record and a larger following record */
+TLS_RECORD_TEST ( overtaken,
+	RECORDS ( 10, 3000, 20 ),
+	FRAGMENTS ( 10 + TLS_TEST_OVERHEAD + 3000 + TLS_TEST_OVERHEAD ) );
+
+/**
+ * Perform TLS self-test
+ *
+ */
+static void tls_test_exec ( void ) {
+
+	tls_record_ok ( &single );
+	tls_record_ok ( &split );
+	tls_record_ok ( &aligned );
+	tls_record_ok ( &trailing );
+	tls_record_ok ( &overtaken );
+}
+
+/** TLS self-test */
+struct self_test tls_test __self_test = {
+	.name = "tls",
+	.exec = tls_test_exec,
+};
+
+/* Drag in required cipher suite */
+REQUIRING_SYMBOL ( tls_test );
+REQUIRE_OBJECT ( rsa_aes_gcm_sha256 );
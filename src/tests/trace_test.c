@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Boot phase timeline tracing self-tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ipxe/timer.h>
+#include <ipxe/trace.h>
+#include <ipxe/test.h>
+
+/** Test event names */
+static const char *trace_test_names[] = {
+	"alpha", "bravo", "charlie", "delta", "echo",
+};
+
+/** Number of test event names */
+#define TRACE_TEST_NAMES \
+	( sizeof ( trace_test_names ) / sizeof ( trace_test_names[0] ) )
+
+/** Number of events recorded so far */
+static unsigned int trace_test_recorded;
+
+/**
+ * Record test events
+ *
+ * @v count		Number of events to record
+ *
+ * Each event's status code is its overall sequence number, and its
+ * name is chosen cyclically from the list of test event names.
+ */
+static void trace_test_record ( unsigned int count ) {
+	unsigned int seq;
+
+	while ( count-- ) {
+		seq = trace_test_recorded++;
+		trace_record ( trace_test_names[ seq % TRACE_TEST_NAMES ],
+			       seq );
+	}
+}
+
+/**
+ * Parse unsigned decimal field
+ *
+ * @v line		Current position within line (updated)
+ * @ret value		Field value
+ */
+static unsigned long trace_test_field ( const char **line ) {
+	char *end;
+	unsigned long value;
+
+	value = strtoul ( *line, &end, 10 );
+	*line = end;
+	return value;
+}
+
+/**
+ * Report a trace formatting test result
+ *
+ * @v count		Expected number of retained events
+ * @v dropped		Expected number of dropped events
+ * @v first		Expected sequence number of first retained event
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void trace_format_okx ( unsigned int count, unsigned int dropped,
+			       unsigned int first, const char *file,
+			       unsigned int line ) {
+	const char *pos;
+	const char *name;
+	unsigned long prev_ticks = 0;
+	unsigned long ticks;
+	size_t name_len;
+	size_t len;
+	unsigned int seq;
+	unsigned int i;
+	char *buf;
+
+	/* Format trace */
+	len = trace_format ( NULL, 0 );
+	buf = malloc ( len + 1 /* NUL */ );
+	okx ( buf != NULL, file, line );
+	if ( ! buf )
+		return;
+	okx ( trace_format ( buf, ( len + 1 ) ) == len, file, line );
+	okx ( strlen ( buf ) == len, file, line );
+
+	/* Check header line */
+	pos = buf;
+	okx ( strncmp ( pos, "trace 1 ", 8 ) == 0, file, line );
+	pos += 8;
+	okx ( trace_test_field ( &pos ) == count, file, line );
+	okx ( trace_test_field ( &pos ) == dropped, file, line );
+	okx ( trace_test_field ( &pos ) == TICKS_PER_SEC, file, line );
+	okx ( *(pos++) == '\n', file, line );
+
+	/* Check event lines */
+	for ( i = 0 ; i < count ; i++ ) {
+		seq = ( first + i );
+		name = trace_test_names[ seq % TRACE_TEST_NAMES ];
+		name_len = strlen ( name );
+		okx ( strncmp ( pos, "trace ", 6 ) == 0, file, line );
+		pos += 6;
+		okx ( strncmp ( pos, name, name_len ) == 0, file, line );
+		pos += name_len;
+		okx ( *(pos++) == ' ', file, line );
+		ticks = trace_test_field ( &pos );
+		okx ( ticks >= prev_ticks, file, line );
+		prev_ticks = ticks;
+		okx ( *(pos++) == ' ', file, line );
+		okx ( ( ( *pos >= '0' ) && ( *pos <= '9' ) ), file, line );
+		trace_test_field ( &pos );
+		okx ( *(pos++) == ' ', file, line );
+		okx ( trace_test_field ( &pos ) == seq, file, line );
+		okx ( *(pos++) == '\n', file, line );
+	}
+
+	/* Check that nothing follows the final event */
+	okx ( *pos == '\0', file, line );
+
+	free ( buf );
+}
+#define trace_format_ok( count, dropped, first ) \
+	trace_format_okx ( count, dropped, first, __FILE__, __LINE__ )
+
+/**
+ * Perform trace self-tests
+ *
+ */
+static void trace_test_exec ( void ) {
+
+	/* Partially filled ring */
+	trace_test_record ( 3 );
+	trace_format_ok ( 3, 0, 0 );
+
+	/* Exactly full ring */
+	trace_test_record ( TRACE_EVENTS - 3 );
+	trace_format_ok ( TRACE_EVENTS, 0, 0 );
+
+	/* Overflowed ring retains only the most recent events */
+	trace_test_record ( 1 );
+	trace_format_ok ( TRACE_EVENTS, 1, 1 );
+	trace_test_record ( TRACE_EVENTS + 5 );
+	trace_format_ok ( TRACE_EVENTS, ( TRACE_EVENTS + 6 ),
+			  ( TRACE_EVENTS + 6 ) );
+}
+
+/** Trace self-test */
+struct self_test trace_test __self_test = {
+	.name = "trace",
+	.exec = trace_test_exec,
+};
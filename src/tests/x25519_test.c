@@ -38,6 +38,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <string.h>
 #include <ipxe/x25519.h>
 #include <ipxe/test.h>
+#include "elliptic_test.h"
 
 /** Define inline multiplicand */
 #define MULTIPLICAND(...) { __VA_ARGS__ }
@@ -48,15 +49,6 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Define inline invertend */
 #define INVERTEND(...) { __VA_ARGS__ }
 
-/** Define inline base point */
-#define BASE(...) { __VA_ARGS__ }
-
-/** Define inline scalar multiple */
-#define SCALAR(...) { __VA_ARGS__ }
-
-/** Define inline expected result */
-#define EXPECTED(...) { __VA_ARGS__ }
-
 /** An X25519 multiplication self-test */
 struct x25519_multiply_test {
 	/** Multiplicand */
@@ -563,6 +555,28 @@ X25519_KEY_TEST ( malicious, 1, 1,
 		   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		   0x00, 0x00 ) );
 
+/* RFC7748 section 6.1 Alice's public key (generator multiplication) */
+ELLIPTIC_TEST ( rfc7748_alice, &x25519_curve, BASE_GENERATOR,
+	SCALAR ( 0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d,
+		 0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+		 0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a,
+		 0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a ),
+	EXPECTED ( 0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54,
+		   0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+		   0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4,
+		   0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a ) );
+
+/* RFC7748 section 6.1 Bob's public key (generator multiplication) */
+ELLIPTIC_TEST ( rfc7748_bob, &x25519_curve, BASE_GENERATOR,
+	SCALAR ( 0x5d, 0xab, 0x08, 0x7e, 0x62, 0x4a, 0x8a, 0x4b,
+		 0x79, 0xe1, 0x7f, 0x8b, 0x83, 0x80, 0x0e, 0xe6,
+		 0x6f, 0x3b, 0xb1, 0x29, 0x26, 0x18, 0xb6, 0xfd,
+		 0x1c, 0x2f, 0x8b, 0x27, 0xff, 0x88, 0xe0, 0xeb ),
+	EXPECTED ( 0xde, 0x9e, 0xdb, 0x7d, 0x7b, 0x7d, 0xc1, 0xb4,
+		   0xd3, 0x5b, 0x61, 0xc2, 0xec, 0xe4, 0x35, 0x37,
+		   0x3f, 0x83, 0x43, 0xc8, 0x5b, 0x78, 0x67, 0x4d,
+		   0xad, 0xfc, 0x7e, 0x14, 0x6f, 0x88, 0x2b, 0x4f ) );
+
 /**
  * Perform X25519 self-tests
  *
@@ -591,6 +605,16 @@ static void x25519_test_exec ( void ) {
 	x25519_key_ok ( &rfc7748_3 );
 	x25519_key_ok ( &rfc7748_4_100 );
 	x25519_key_ok ( &malicious );
+
+	/* Perform generator multiplication tests */
+	elliptic_ok ( &rfc7748_alice );
+	elliptic_ok ( &rfc7748_bob );
+
+	/* Speed tests */
+	DBG ( "X25519 fixed-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &x25519_curve, NULL ) );
+	DBG ( "X25519 variable-base multiplication required %ld cycles\n",
+	      elliptic_cost ( &x25519_curve, x25519_curve.base ) );
 }
 
 /** X25519 self-test */
@@ -666,6 +666,238 @@ CHAIN ( useless_chain, &useless_crt, &leaf_crt,	&intermediate_crt, &root_crt );
 CHAIN ( bad_path_len_chain, &bad_path_len_crt, &useless_crt, &leaf_crt,
 	&intermediate_crt, &root_crt );
 
+/*
+ * subject	iPXE self-test ECDSA root CA
+ * issuer	iPXE self-test ECDSA root CA
+ */
+CERTIFICATE ( ecdsa_root_crt,
+	DATA ( 0x30, 0x82, 0x02, 0x50, 0x30, 0x82, 0x01, 0xf5, 0xa0, 0x03,
+	       0x02, 0x01, 0x02, 0x02, 0x01, 0x01, 0x30, 0x0a, 0x06, 0x08,
+	       0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x81,
+	       0x8e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06,
+	       0x13, 0x02, 0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03,
+	       0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72,
+	       0x69, 0x64, 0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31,
+	       0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09,
+	       0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31,
+	       0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10,
+	       0x46, 0x65, 0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d,
+	       0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e,
+	       0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73,
+	       0x74, 0x69, 0x6e, 0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03,
+	       0x55, 0x04, 0x03, 0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20,
+	       0x73, 0x65, 0x6c, 0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20,
+	       0x45, 0x43, 0x44, 0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74,
+	       0x20, 0x43, 0x41, 0x30, 0x1e, 0x17, 0x0d, 0x31, 0x32, 0x30,
+	       0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a,
+	       0x17, 0x0d, 0x33, 0x38, 0x31, 0x32, 0x33, 0x31, 0x30, 0x30,
+	       0x30, 0x30, 0x30, 0x30, 0x5a, 0x30, 0x81, 0x8e, 0x31, 0x0b,
+	       0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x47,
+	       0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x08,
+	       0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67,
+	       0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31, 0x12, 0x30, 0x10,
+	       0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09, 0x43, 0x61, 0x6d,
+	       0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31, 0x19, 0x30, 0x17,
+	       0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65, 0x6e,
+	       0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x73, 0x20, 0x4c,
+	       0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55,
+	       0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x69, 0x6e,
+	       0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03, 0x55, 0x04, 0x03,
+	       0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20, 0x73, 0x65, 0x6c,
+	       0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20, 0x45, 0x43, 0x44,
+	       0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x20, 0x43, 0x41,
+	       0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce,
+	       0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d,
+	       0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0xed, 0x87, 0x51,
+	       0xc4, 0x9b, 0x32, 0xf0, 0x09, 0xe1, 0x55, 0x17, 0xcf, 0x18,
+	       0x12, 0x72, 0x61, 0x66, 0xba, 0x6e, 0x66, 0xd6, 0xdd, 0x86,
+	       0x6a, 0x45, 0xfb, 0x75, 0xb4, 0x9e, 0x9b, 0x01, 0x87, 0x94,
+	       0xb8, 0x1e, 0x0b, 0xb1, 0x51, 0xa1, 0x57, 0x78, 0x7e, 0x50,
+	       0x3d, 0x7e, 0x65, 0xab, 0x76, 0x9e, 0xce, 0x89, 0x9d, 0x5e,
+	       0x28, 0x30, 0x6a, 0xce, 0x7d, 0x75, 0x29, 0x3a, 0x34, 0xff,
+	       0xea, 0xa3, 0x42, 0x30, 0x40, 0x30, 0x0f, 0x06, 0x03, 0x55,
+	       0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x05, 0x30, 0x03, 0x01,
+	       0x01, 0xff, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01,
+	       0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x01, 0x06, 0x30, 0x1d,
+	       0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x4a,
+	       0x39, 0xc3, 0x32, 0x11, 0x91, 0x6f, 0x12, 0x86, 0x76, 0x78,
+	       0x2c, 0x4c, 0xef, 0xd4, 0x06, 0xcf, 0xe4, 0x73, 0x1e, 0x30,
+	       0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03,
+	       0x02, 0x03, 0x49, 0x00, 0x30, 0x46, 0x02, 0x21, 0x00, 0xce,
+	       0x99, 0xba, 0xa6, 0xcc, 0x22, 0x0e, 0x42, 0x02, 0x70, 0xd4,
+	       0x01, 0x7a, 0xf2, 0x65, 0x26, 0x70, 0x84, 0x5c, 0x6c, 0x41,
+	       0xf8, 0xca, 0x50, 0xe5, 0xda, 0x06, 0xbb, 0x95, 0xa9, 0xab,
+	       0xde, 0x02, 0x21, 0x00, 0xe7, 0xbc, 0x66, 0x46, 0x08, 0x78,
+	       0xc8, 0x9f, 0xf7, 0xad, 0xc9, 0xd1, 0xd2, 0x76, 0x4e, 0x91,
+	       0xf5, 0x18, 0x19, 0x3b, 0x85, 0x02, 0xc8, 0x39, 0x5a, 0xac,
+	       0x7e, 0x68, 0x3b, 0xe6, 0x44, 0x20 ),
+	FINGERPRINT ( 0x1a, 0x51, 0x82, 0xd4, 0x70, 0x8d, 0x76, 0xc3,
+		      0xbd, 0x2a, 0xfb, 0x6b, 0xd8, 0xe0, 0x12, 0x25,
+		      0x2c, 0xe9, 0x13, 0x3c, 0x3c, 0x1b, 0xfc, 0x1a,
+		      0xf2, 0xb5, 0xef, 0x24, 0x59, 0x94, 0xdf, 0xe1 ) );
+
+/*
+ * subject	ecdsa.test.ipxe.org
+ * issuer	iPXE self-test ECDSA root CA
+ */
+CERTIFICATE ( ecdsa_leaf_crt,
+	DATA ( 0x30, 0x82, 0x02, 0x9b, 0x30, 0x82, 0x02, 0x41, 0xa0, 0x03,
+	       0x02, 0x01, 0x02, 0x02, 0x01, 0x02, 0x30, 0x0a, 0x06, 0x08,
+	       0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x81,
+	       0x8e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06,
+	       0x13, 0x02, 0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03,
+	       0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72,
+	       0x69, 0x64, 0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31,
+	       0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09,
+	       0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31,
+	       0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10,
+	       0x46, 0x65, 0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d,
+	       0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e,
+	       0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73,
+	       0x74, 0x69, 0x6e, 0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03,
+	       0x55, 0x04, 0x03, 0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20,
+	       0x73, 0x65, 0x6c, 0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20,
+	       0x45, 0x43, 0x44, 0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74,
+	       0x20, 0x43, 0x41, 0x30, 0x1e, 0x17, 0x0d, 0x31, 0x32, 0x30,
+	       0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a,
+	       0x17, 0x0d, 0x31, 0x33, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30,
+	       0x30, 0x30, 0x30, 0x30, 0x5a, 0x30, 0x81, 0x85, 0x31, 0x0b,
+	       0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x47,
+	       0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x08,
+	       0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67,
+	       0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31, 0x12, 0x30, 0x10,
+	       0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09, 0x43, 0x61, 0x6d,
+	       0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31, 0x19, 0x30, 0x17,
+	       0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65, 0x6e,
+	       0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x73, 0x20, 0x4c,
+	       0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55,
+	       0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x69, 0x6e,
+	       0x67, 0x31, 0x1c, 0x30, 0x1a, 0x06, 0x03, 0x55, 0x04, 0x03,
+	       0x0c, 0x13, 0x65, 0x63, 0x64, 0x73, 0x61, 0x2e, 0x74, 0x65,
+	       0x73, 0x74, 0x2e, 0x69, 0x70, 0x78, 0x65, 0x2e, 0x6f, 0x72,
+	       0x67, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48,
+	       0xce, 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce,
+	       0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x87, 0x03,
+	       0x67, 0xef, 0x33, 0xae, 0xa7, 0x95, 0xef, 0x8b, 0x6b, 0x9c,
+	       0x7c, 0xd5, 0xb0, 0xb5, 0x49, 0x01, 0xa0, 0x9c, 0xef, 0x63,
+	       0x5c, 0x85, 0x66, 0x26, 0xaa, 0xf3, 0xb0, 0xb3, 0xa2, 0x44,
+	       0x84, 0x6f, 0x68, 0x07, 0xb6, 0xd0, 0x8f, 0xa6, 0xb4, 0xd3,
+	       0x35, 0x88, 0xd5, 0x69, 0x85, 0x3a, 0x40, 0x41, 0xfc, 0x23,
+	       0xb2, 0x5f, 0x59, 0xf2, 0x98, 0x02, 0xc4, 0x37, 0x9c, 0xab,
+	       0x65, 0x55, 0xa3, 0x81, 0x96, 0x30, 0x81, 0x93, 0x30, 0x0c,
+	       0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x02,
+	       0x30, 0x00, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01,
+	       0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x07, 0x80, 0x30, 0x13,
+	       0x06, 0x03, 0x55, 0x1d, 0x25, 0x04, 0x0c, 0x30, 0x0a, 0x06,
+	       0x08, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x03, 0x03, 0x30,
+	       0x1e, 0x06, 0x03, 0x55, 0x1d, 0x11, 0x04, 0x17, 0x30, 0x15,
+	       0x82, 0x13, 0x65, 0x63, 0x64, 0x73, 0x61, 0x2e, 0x74, 0x65,
+	       0x73, 0x74, 0x2e, 0x69, 0x70, 0x78, 0x65, 0x2e, 0x6f, 0x72,
+	       0x67, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16,
+	       0x04, 0x14, 0xeb, 0x8d, 0x94, 0x8a, 0x51, 0x5e, 0xb1, 0x3b,
+	       0x86, 0x09, 0x9b, 0xbb, 0xa7, 0xcf, 0x0f, 0x45, 0x93, 0x95,
+	       0xde, 0x5e, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04,
+	       0x18, 0x30, 0x16, 0x80, 0x14, 0x4a, 0x39, 0xc3, 0x32, 0x11,
+	       0x91, 0x6f, 0x12, 0x86, 0x76, 0x78, 0x2c, 0x4c, 0xef, 0xd4,
+	       0x06, 0xcf, 0xe4, 0x73, 0x1e, 0x30, 0x0a, 0x06, 0x08, 0x2a,
+	       0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x48, 0x00,
+	       0x30, 0x45, 0x02, 0x20, 0x0c, 0x72, 0x5d, 0x48, 0x2f, 0xa5,
+	       0x31, 0x9e, 0x18, 0x9e, 0x1b, 0x02, 0x26, 0x4b, 0x89, 0x71,
+	       0xd1, 0x82, 0x77, 0x0c, 0xfb, 0xf3, 0xb5, 0xac, 0x1a, 0x53,
+	       0x26, 0xa1, 0xfa, 0x72, 0xa6, 0x6f, 0x02, 0x21, 0x00, 0xae,
+	       0x31, 0x9b, 0xd9, 0x39, 0x63, 0xf2, 0xbf, 0x3e, 0x23, 0x70,
+	       0xe4, 0x78, 0xeb, 0x7c, 0x19, 0x6f, 0x1b, 0x1e, 0xa7, 0x35,
+	       0x50, 0x08, 0x6d, 0x0d, 0x07, 0x98, 0xe7, 0xa4, 0x41, 0x6e,
+	       0x43 ),
+	FINGERPRINT ( 0x20, 0x1f, 0xe3, 0xea, 0x5f, 0xaa, 0xbe, 0x60,
+		      0x73, 0x4b, 0x12, 0xaf, 0xe5, 0xc0, 0x0d, 0x61,
+		      0xe6, 0x5f, 0xed, 0xab, 0x5f, 0x60, 0xbd, 0xc0,
+		      0x12, 0x94, 0x04, 0x5d, 0xab, 0x02, 0xc8, 0xf8 ) );
+
+/*
+ * subject	forged.test.ipxe.org
+ * issuer	iPXE self-test ECDSA root CA (forged key)
+ */
+CERTIFICATE ( ecdsa_forged_crt,
+	DATA ( 0x30, 0x82, 0x02, 0x9d, 0x30, 0x82, 0x02, 0x43, 0xa0, 0x03,
+	       0x02, 0x01, 0x02, 0x02, 0x01, 0x04, 0x30, 0x0a, 0x06, 0x08,
+	       0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x81,
+	       0x8e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06,
+	       0x13, 0x02, 0x47, 0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03,
+	       0x55, 0x04, 0x08, 0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72,
+	       0x69, 0x64, 0x67, 0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31,
+	       0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09,
+	       0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31,
+	       0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10,
+	       0x46, 0x65, 0x6e, 0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d,
+	       0x73, 0x20, 0x4c, 0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e,
+	       0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73,
+	       0x74, 0x69, 0x6e, 0x67, 0x31, 0x25, 0x30, 0x23, 0x06, 0x03,
+	       0x55, 0x04, 0x03, 0x0c, 0x1c, 0x69, 0x50, 0x58, 0x45, 0x20,
+	       0x73, 0x65, 0x6c, 0x66, 0x2d, 0x74, 0x65, 0x73, 0x74, 0x20,
+	       0x45, 0x43, 0x44, 0x53, 0x41, 0x20, 0x72, 0x6f, 0x6f, 0x74,
+	       0x20, 0x43, 0x41, 0x30, 0x1e, 0x17, 0x0d, 0x31, 0x32, 0x30,
+	       0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a,
+	       0x17, 0x0d, 0x31, 0x33, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30,
+	       0x30, 0x30, 0x30, 0x30, 0x5a, 0x30, 0x81, 0x86, 0x31, 0x0b,
+	       0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x47,
+	       0x42, 0x31, 0x17, 0x30, 0x15, 0x06, 0x03, 0x55, 0x04, 0x08,
+	       0x0c, 0x0e, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67,
+	       0x65, 0x73, 0x68, 0x69, 0x72, 0x65, 0x31, 0x12, 0x30, 0x10,
+	       0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x09, 0x43, 0x61, 0x6d,
+	       0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x31, 0x19, 0x30, 0x17,
+	       0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x10, 0x46, 0x65, 0x6e,
+	       0x20, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x73, 0x20, 0x4c,
+	       0x74, 0x64, 0x2e, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55,
+	       0x04, 0x0b, 0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x69, 0x6e,
+	       0x67, 0x31, 0x1d, 0x30, 0x1b, 0x06, 0x03, 0x55, 0x04, 0x03,
+	       0x0c, 0x14, 0x66, 0x6f, 0x72, 0x67, 0x65, 0x64, 0x2e, 0x74,
+	       0x65, 0x73, 0x74, 0x2e, 0x69, 0x70, 0x78, 0x65, 0x2e, 0x6f,
+	       0x72, 0x67, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86,
+	       0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48,
+	       0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x87,
+	       0x03, 0x67, 0xef, 0x33, 0xae, 0xa7, 0x95, 0xef, 0x8b, 0x6b,
+	       0x9c, 0x7c, 0xd5, 0xb0, 0xb5, 0x49, 0x01, 0xa0, 0x9c, 0xef,
+	       0x63, 0x5c, 0x85, 0x66, 0x26, 0xaa, 0xf3, 0xb0, 0xb3, 0xa2,
+	       0x44, 0x84, 0x6f, 0x68, 0x07, 0xb6, 0xd0, 0x8f, 0xa6, 0xb4,
+	       0xd3, 0x35, 0x88, 0xd5, 0x69, 0x85, 0x3a, 0x40, 0x41, 0xfc,
+	       0x23, 0xb2, 0x5f, 0x59, 0xf2, 0x98, 0x02, 0xc4, 0x37, 0x9c,
+	       0xab, 0x65, 0x55, 0xa3, 0x81, 0x97, 0x30, 0x81, 0x94, 0x30,
+	       0x0c, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04,
+	       0x02, 0x30, 0x00, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f,
+	       0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x07, 0x80, 0x30,
+	       0x13, 0x06, 0x03, 0x55, 0x1d, 0x25, 0x04, 0x0c, 0x30, 0x0a,
+	       0x06, 0x08, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07, 0x03, 0x03,
+	       0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x11, 0x04, 0x18, 0x30,
+	       0x16, 0x82, 0x14, 0x66, 0x6f, 0x72, 0x67, 0x65, 0x64, 0x2e,
+	       0x74, 0x65, 0x73, 0x74, 0x2e, 0x69, 0x70, 0x78, 0x65, 0x2e,
+	       0x6f, 0x72, 0x67, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e,
+	       0x04, 0x16, 0x04, 0x14, 0xeb, 0x8d, 0x94, 0x8a, 0x51, 0x5e,
+	       0xb1, 0x3b, 0x86, 0x09, 0x9b, 0xbb, 0xa7, 0xcf, 0x0f, 0x45,
+	       0x93, 0x95, 0xde, 0x5e, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d,
+	       0x23, 0x04, 0x18, 0x30, 0x16, 0x80, 0x14, 0xf7, 0x4d, 0xcd,
+	       0xb1, 0xc8, 0x50, 0xf5, 0x7a, 0x3e, 0x43, 0xd6, 0xd2, 0xbe,
+	       0x92, 0xdf, 0x06, 0x19, 0xd5, 0xed, 0xd0, 0x30, 0x0a, 0x06,
+	       0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03,
+	       0x48, 0x00, 0x30, 0x45, 0x02, 0x20, 0x52, 0x37, 0xed, 0x38,
+	       0x0f, 0x96, 0xab, 0x2e, 0x5b, 0x95, 0x90, 0x77, 0x2f, 0x1d,
+	       0xe2, 0x1a, 0x43, 0xb7, 0x76, 0xb3, 0xdb, 0x6e, 0x91, 0xae,
+	       0x02, 0x62, 0xce, 0x41, 0x6a, 0x75, 0xcb, 0x61, 0x02, 0x21,
+	       0x00, 0xdf, 0xbd, 0x6e, 0xfd, 0xc5, 0x71, 0x00, 0xee, 0x54,
+	       0x70, 0xe8, 0xb2, 0xb5, 0x64, 0x31, 0x50, 0xcf, 0xb8, 0x2e,
+	       0x6b, 0x06, 0x05, 0x11, 0x2c, 0x54, 0x9b, 0xd6, 0xda, 0xee,
+	       0xef, 0xcf, 0x21 ),
+	FINGERPRINT ( 0x85, 0x2b, 0xcb, 0x80, 0x97, 0x80, 0x14, 0x03,
+		      0xff, 0x6f, 0xff, 0xa2, 0x0b, 0x6d, 0x08, 0x53,
+		      0x5b, 0x55, 0x4c, 0xa7, 0xed, 0x69, 0xcf, 0xad,
+		      0xcf, 0xba, 0x49, 0x88, 0x01, 0x44, 0x60, 0x41 ) );
+
+/** Valid ECDSA certificate chain up to ecdsa.test.ipxe.org */
+CHAIN ( ecdsa_chain, &ecdsa_leaf_crt, &ecdsa_root_crt );
+
+/** Forged ECDSA certificate chain up to forged.test.ipxe.org */
+CHAIN ( ecdsa_forged_chain, &ecdsa_forged_crt, &ecdsa_root_crt );
+
 /** Empty certificate store */
 static struct x509_chain empty_store = {
 	.refcnt = REF_INIT ( ref_no_free ),
@@ -688,6 +920,14 @@ static struct x509_root intermediate_root = {
 	.fingerprints = intermediate_crt_fingerprint,
 };
 
+/** Root certificate list containing the iPXE self-test ECDSA root CA */
+static struct x509_root ecdsa_root = {
+	.refcnt = REF_INIT ( ref_no_free ),
+	.digest = &x509_test_algorithm,
+	.count = 1,
+	.fingerprints = ecdsa_root_crt_fingerprint,
+};
+
 /** Dummy fingerprint (not matching any certificates) */
 static uint8_t dummy_fingerprint[] =
 	FINGERPRINT ( 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
@@ -994,6 +1234,9 @@ static void x509_test_exec ( void ) {
 	x509_certificate_ok ( &server_crt );
 	x509_certificate_ok ( &not_ca_crt );
 	x509_certificate_ok ( &bad_path_len_crt );
+	x509_certificate_ok ( &ecdsa_root_crt );
+	x509_certificate_ok ( &ecdsa_leaf_crt );
+	x509_certificate_ok ( &ecdsa_forged_crt );
 
 	/* Check cache functionality */
 	x509_cached_ok ( &root_crt );
@@ -1003,6 +1246,9 @@ static void x509_test_exec ( void ) {
 	x509_cached_ok ( &server_crt );
 	x509_cached_ok ( &not_ca_crt );
 	x509_cached_ok ( &bad_path_len_crt );
+	x509_cached_ok ( &ecdsa_root_crt );
+	x509_cached_ok ( &ecdsa_leaf_crt );
+	x509_cached_ok ( &ecdsa_forged_crt );
 
 	/* Check all certificate fingerprints */
 	x509_fingerprint_ok ( &root_crt );
@@ -1012,6 +1258,9 @@ static void x509_test_exec ( void ) {
 	x509_fingerprint_ok ( &server_crt );
 	x509_fingerprint_ok ( &not_ca_crt );
 	x509_fingerprint_ok ( &bad_path_len_crt );
+	x509_fingerprint_ok ( &ecdsa_root_crt );
+	x509_fingerprint_ok ( &ecdsa_leaf_crt );
+	x509_fingerprint_ok ( &ecdsa_forged_crt );
 
 	/* Check pairwise issuing */
 	x509_check_issuer_ok ( &intermediate_crt, &root_crt );
@@ -1020,6 +1269,10 @@ static void x509_test_exec ( void ) {
 	x509_check_issuer_ok ( &server_crt, &leaf_crt );
 	x509_check_issuer_fail_ok ( &not_ca_crt, &server_crt );
 	x509_check_issuer_ok ( &bad_path_len_crt, &useless_crt );
+	x509_check_issuer_ok ( &ecdsa_root_crt, &ecdsa_root_crt );
+	x509_check_issuer_ok ( &ecdsa_leaf_crt, &ecdsa_root_crt );
+	x509_check_issuer_fail_ok ( &ecdsa_forged_crt, &ecdsa_root_crt );
+	x509_check_issuer_fail_ok ( &ecdsa_leaf_crt, &root_crt );
 
 	/* Check root certificate stores */
 	x509_check_root_ok ( &root_crt, &test_root );
@@ -1027,6 +1280,8 @@ static void x509_test_exec ( void ) {
 	x509_check_root_ok ( &intermediate_crt, &intermediate_root );
 	x509_check_root_fail_ok ( &root_crt, &intermediate_root );
 	x509_check_root_fail_ok ( &root_crt, &dummy_root );
+	x509_check_root_ok ( &ecdsa_root_crt, &ecdsa_root );
+	x509_check_root_fail_ok ( &ecdsa_root_crt, &test_root );
 
 	/* Check certificate validity periods */
 	x509_check_time_ok ( &server_crt, test_time );
@@ -1053,6 +1308,8 @@ static void x509_test_exec ( void ) {
 	x509_check_name_ok ( &server_crt, "fe80::69ff:fe50:5845" );
 	x509_check_name_ok ( &server_crt, "FE80:0:0:0:0:69FF:FE50:5845" );
 	x509_check_name_fail_ok ( &server_crt, "fe80::69ff:fe50:5846" );
+	x509_check_name_ok ( &ecdsa_leaf_crt, "ecdsa.test.ipxe.org" );
+	x509_check_name_fail_ok ( &ecdsa_leaf_crt, "boot.test.ipxe.org" );
 
 	/* Parse all certificate chains */
 	x509_chain_ok ( &server_chain );
@@ -1061,6 +1318,8 @@ static void x509_test_exec ( void ) {
 	x509_chain_ok ( &not_ca_chain );
 	x509_chain_ok ( &useless_chain );
 	x509_chain_ok ( &bad_path_len_chain );
+	x509_chain_ok ( &ecdsa_chain );
+	x509_chain_ok ( &ecdsa_forged_chain );
 
 	/* Check certificate chains */
 	x509_validate_chain_ok ( &server_chain, test_time,
@@ -1081,6 +1340,12 @@ static void x509_test_exec ( void ) {
 				 &empty_store, &test_root );
 	x509_validate_chain_fail_ok ( &bad_path_len_chain, test_time,
 				      &empty_store, &test_root );
+	x509_validate_chain_ok ( &ecdsa_chain, test_time,
+				 &empty_store, &ecdsa_root );
+	x509_validate_chain_fail_ok ( &ecdsa_chain, test_time,
+				      &empty_store, &test_root );
+	x509_validate_chain_fail_ok ( &ecdsa_forged_chain, test_time,
+				      &empty_store, &ecdsa_root );
 
 	/* Check certificate chain expiry times */
 	x509_validate_chain_fail_ok ( &server_chain, test_expired,
@@ -1089,6 +1354,8 @@ static void x509_test_exec ( void ) {
 				 &empty_store, &test_root );
 	x509_validate_chain_fail_ok ( &useless_chain, test_ca_expired,
 				      &empty_store, &test_root );
+	x509_validate_chain_fail_ok ( &ecdsa_chain, test_expired,
+				      &empty_store, &ecdsa_root );
 
 	/* Check chain truncation */
 	link = list_last_entry ( &server_chain.chain->links,
@@ -1110,6 +1377,8 @@ static void x509_test_exec ( void ) {
 	assert ( list_empty ( &empty_store.links ) );
 
 	/* Drop chain references */
+	x509_chain_put ( ecdsa_forged_chain.chain );
+	x509_chain_put ( ecdsa_chain.chain );
 	x509_chain_put ( bad_path_len_chain.chain );
 	x509_chain_put ( useless_chain.chain );
 	x509_chain_put ( not_ca_chain.chain );
@@ -1118,6 +1387,9 @@ static void x509_test_exec ( void ) {
 	x509_chain_put ( server_chain.chain );
 
 	/* Drop certificate references */
+	x509_put ( ecdsa_forged_crt.cert );
+	x509_put ( ecdsa_leaf_crt.cert );
+	x509_put ( ecdsa_root_crt.cert );
 	x509_put ( bad_path_len_crt.cert );
 	x509_put ( not_ca_crt.cert );
 	x509_put ( server_crt.cert );
@@ -1136,6 +1408,8 @@ struct self_test x509_test __self_test = {
 /* Drag in algorithms required for tests */
 REQUIRING_SYMBOL ( x509_test );
 REQUIRE_OBJECT ( rsa );
+REQUIRE_OBJECT ( ecdsa );
+REQUIRE_OBJECT ( oid_p256 );
 REQUIRE_OBJECT ( sha1 );
 REQUIRE_OBJECT ( sha256 );
 REQUIRE_OBJECT ( ipv4 );
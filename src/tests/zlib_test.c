@@ -33,9 +33,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef NDEBUG
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <ipxe/image.h>
 #include <ipxe/zlib.h>
 #include <ipxe/test.h>
+#include "inflate_test.h"
 
 /** A zlib test */
 struct zlib_test {
@@ -112,6 +115,14 @@ static void zlib_okx ( struct zlib_test *test, const char *file,
 	/* Unregister images */
 	unregister_image ( extracted );
 	unregister_image ( image );
+
+	/* Decompress as a stream */
+	inflate_okx ( test->compressed, test->compressed_len,
+		      test->expected, test->expected_len, file, line );
+
+	/* Store uncompressed data unmodified */
+	inflate_okx ( test->expected, test->expected_len,
+		      test->expected, test->expected_len, file, line );
 }
 #define zlib_ok( test ) zlib_okx ( test, __FILE__, __LINE__ )
 
@@ -122,6 +122,13 @@ void ifstat ( struct net_device *netdev ) {
 		printf ( "  [Link status: %s]\n",
 			 strerror ( netdev->link_rc ) );
 	}
+	if ( netdev->rx_dropped )
+		printf ( "  [RX dropped: %d]\n", netdev->rx_dropped );
+	if ( netdev->poll_stats.polls ) {
+		printf ( "  [Poll:%d Skip:%d Busy:%d]\n",
+			 netdev->poll_stats.polls, netdev->poll_stats.skipped,
+			 netdev->poll_stats.exhausted );
+	}
 	ifstat_errors ( &netdev->tx_stats, "TXE" );
 	ifstat_errors ( &netdev->rx_stats, "RXE" );
 }
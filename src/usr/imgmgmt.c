@@ -46,10 +46,11 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * @v uri		URI
  * @v timeout		Download timeout
+ * @v flags		Download flags
  * @v image		Image to fill in
  * @ret rc		Return status code
  */
-int imgdownload ( struct uri *uri, unsigned long timeout,
+int imgdownload ( struct uri *uri, unsigned long timeout, unsigned int flags,
 		  struct image **image ) {
 	struct uri uri_redacted;
 	char *uri_string_redacted;
@@ -82,7 +83,7 @@ int imgdownload ( struct uri *uri, unsigned long timeout,
 	}
 
 	/* Create downloader */
-	if ( ( rc = create_downloader ( &monojob, *image ) ) != 0 ) {
+	if ( ( rc = create_downloader ( &monojob, *image, flags ) ) != 0 ) {
 		printf ( "Could not start download: %s\n", strerror ( rc ) );
 		goto err_create_downloader;
 	}
@@ -114,18 +115,19 @@ int imgdownload ( struct uri *uri, unsigned long timeout,
  *
  * @v uri_string	URI string
  * @v timeout		Download timeout
+ * @v flags		Download flags
  * @v image		Image to fill in
  * @ret rc		Return status code
  */
 int imgdownload_string ( const char *uri_string, unsigned long timeout,
-			 struct image **image ) {
+			 unsigned int flags, struct image **image ) {
 	struct uri *uri;
 	int rc;
 
 	if ( ! ( uri = parse_uri ( uri_string ) ) )
 		return -ENOMEM;
 
-	rc = imgdownload ( uri, timeout, image );
+	rc = imgdownload ( uri, timeout, flags, image );
 
 	uri_put ( uri );
 	return rc;
@@ -148,7 +150,7 @@ int imgacquire ( const char *name_uri, unsigned long timeout,
 		return 0;
 
 	/* Otherwise, download a new image */
-	return imgdownload_string ( name_uri, timeout, image );
+	return imgdownload_string ( name_uri, timeout, 0, image );
 }
 
 /**
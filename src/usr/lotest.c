@@ -34,6 +34,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/if_ether.h>
 #include <ipxe/keys.h>
 #include <ipxe/console.h>
+#include <ipxe/timer.h>
 #include <usr/ifmgmt.h>
 #include <usr/lotest.h>
 
@@ -182,6 +183,28 @@ static int loopback_wait ( void *data, size_t len ) {
 	}
 }
 
+/**
+ * Report loopback test throughput
+ *
+ * @v count		Number of packets received
+ * @v mtu		Packet size (excluding link-layer headers)
+ * @v elapsed		Elapsed time (in ticks)
+ */
+static void loopback_report ( unsigned int count, size_t mtu,
+			      unsigned long elapsed ) {
+	unsigned long long bytes = ( ( ( unsigned long long ) count ) * mtu );
+	unsigned long msecs = ( ( elapsed * 1000 ) / TICKS_PER_SEC );
+
+	/* Avoid division by zero */
+	if ( ! elapsed )
+		elapsed = 1;
+
+	printf ( "Received %d packets in %ld.%03lds (%lld packets/s, "
+		 "%lld kB/s)\n", count, ( msecs / 1000 ), ( msecs % 1000 ),
+		 ( ( count * ( unsigned long long ) TICKS_PER_SEC ) / elapsed ),
+		 ( ( bytes * TICKS_PER_SEC ) / ( elapsed * 1024 ) ) );
+}
+
 /**
  * Perform loopback test between two network devices
  *
@@ -189,15 +212,32 @@ static int loopback_wait ( void *data, size_t len ) {
  * @v receiver		Received network device
  * @v mtu		Packet size (excluding link-layer headers)
  * @v broadcast		Use broadcast link-layer address
+ * @v count		Number of packets to send, or zero to run forever
+ * @v window		Maximum number of packets in flight
+ * @v fixed		Use fixed payload
  * @ret rc		Return status code
+ *
+ * Up to @c window packets may be transmitted before the first is
+ * received, allowing the test to measure throughput rather than
+ * round-trip latency.  Packets must be received in the order in
+ * which they were sent.
+ *
+ * A fixed payload (generated once, with only the sequence number
+ * varying between packets) may be used to exclude the cost of
+ * payload generation from throughput measurements.
  */
 int loopback_test ( struct net_device *sender, struct net_device *receiver,
-		    size_t mtu, int broadcast ) {
+		    size_t mtu, int broadcast, unsigned int count,
+		    unsigned int window, int fixed ) {
+	uint8_t *bufs;
 	uint8_t *buf;
 	uint32_t *seq;
 	struct io_buffer *iobuf;
 	const void *ll_dest;
+	unsigned long start;
+	unsigned long shown;
 	unsigned int i;
+	unsigned int sent;
 	unsigned int successes;
 	int rc;
 
@@ -213,13 +253,20 @@ int loopback_test ( struct net_device *sender, struct net_device *receiver,
 	if ( ( rc = iflinkwait ( receiver, 0, 0 ) ) != 0 )
 		return rc;
 
-	/* Allocate data buffer */
+	/* Allocate data buffers (one per packet in flight) */
 	if ( mtu < sizeof ( *seq ) )
 		mtu = sizeof ( *seq );
-	buf = malloc ( mtu );
-	if ( ! buf )
+	if ( ! window )
+		window = 1;
+	bufs = malloc ( window * mtu );
+	if ( ! bufs )
 		return -ENOMEM;
-	seq = ( ( void * ) buf );
+
+	/* Generate fixed payload, if applicable */
+	if ( fixed ) {
+		for ( i = 0 ; i < ( window * mtu ) ; i++ )
+			bufs[i] = random();
+	}
 
 	/* Determine destination address */
 	ll_dest = ( broadcast ? sender->ll_broadcast : receiver->ll_addr );
@@ -234,42 +281,67 @@ int loopback_test ( struct net_device *sender, struct net_device *receiver,
 	/* Start loopback test */
 	lotest_flush();
 	lotest_receiver = receiver;
+	start = shown = currticks();
 
 	/* Perform loopback test */
-	for ( successes = 0 ; ; successes++ ) {
-
-		/* Print running total */
-		printf ( "\r%d", successes );
-
-		/* Generate random packet */
-		*seq = htonl ( successes );
-		for ( i = sizeof ( *seq ) ; i < mtu ; i++ )
-			buf[i] = random();
-		iobuf = alloc_iob ( MAX_LL_HEADER_LEN + mtu );
-		if ( ! iobuf ) {
-			printf ( "\nFailed to allocate I/O buffer" );
-			rc = -ENOMEM;
-			break;
+	for ( sent = successes = 0 ; ( ! count ) || ( successes < count ) ;
+	      successes++ ) {
+
+		/* Print running total (at a rate the console can
+		 * sustain without limiting the test)
+		 */
+		if ( ( window == 1 ) ||
+		     ( ( currticks() - shown ) >= ( TICKS_PER_SEC / 8 ) ) ) {
+			printf ( "\r%d", successes );
+			shown = currticks();
 		}
-		iob_reserve ( iobuf, MAX_LL_HEADER_LEN );
-		memcpy ( iob_put ( iobuf, mtu ), buf, mtu );
-
-		/* Transmit packet */
-		if ( ( rc = net_tx ( iob_disown ( iobuf ), sender,
-				     &lotest_protocol, ll_dest,
-				     sender->ll_addr ) ) != 0 ) {
-			printf ( "\nFailed to transmit packet: %s",
-				 strerror ( rc ) );
-			break;
+
+		/* Transmit packets until window is full */
+		while ( ( ( sent - successes ) < window ) &&
+			( ( ! count ) || ( sent < count ) ) ) {
+
+			/* Generate random packet (or reuse fixed payload) */
+			buf = ( bufs + ( ( sent % window ) * mtu ) );
+			seq = ( ( void * ) buf );
+			*seq = htonl ( sent );
+			if ( ! fixed ) {
+				for ( i = sizeof ( *seq ) ; i < mtu ; i++ )
+					buf[i] = random();
+			}
+			iobuf = alloc_iob ( MAX_LL_HEADER_LEN + mtu );
+			if ( ! iobuf ) {
+				printf ( "\nFailed to allocate I/O buffer" );
+				rc = -ENOMEM;
+				goto done;
+			}
+			iob_reserve ( iobuf, MAX_LL_HEADER_LEN );
+			memcpy ( iob_put ( iobuf, mtu ), buf, mtu );
+
+			/* Transmit packet */
+			if ( ( rc = net_tx ( iob_disown ( iobuf ), sender,
+					     &lotest_protocol, ll_dest,
+					     sender->ll_addr ) ) != 0 ) {
+				printf ( "\nFailed to transmit packet: %s",
+					 strerror ( rc ) );
+				goto done;
+			}
+			sent++;
 		}
 
 		/* Wait for received packet */
+		buf = ( bufs + ( ( successes % window ) * mtu ) );
 		if ( ( rc = loopback_wait ( buf, mtu ) ) != 0 )
-			break;
+			goto done;
 	}
+	printf ( "\r%d", successes );
 
+ done:
 	printf ( "\n");
 
+	/* Report throughput, if applicable */
+	if ( count )
+		loopback_report ( successes, mtu, ( currticks() - start ) );
+
 	/* Stop loopback testing */
 	lotest_receiver = NULL;
 	lotest_flush();
@@ -278,8 +350,9 @@ int loopback_test ( struct net_device *sender, struct net_device *receiver,
 	ifstat ( sender );
 	ifstat ( receiver );
 
-	/* Free buffer */
-	free ( buf );
+	/* Free buffers */
+	free ( bufs );
 
-	return 0;
+	/* A test without a packet count runs until it fails */
+	return ( count ? rc : 0 );
 }
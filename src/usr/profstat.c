@@ -33,16 +33,47 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/**
+ * Print profiling statistics for a single profiler
+ *
+ * @v profiler		Profiler
+ * @v flags		Flags
+ */
+static void profstat_profiler ( struct profiler *profiler,
+				unsigned int flags ) {
+	char buf[128];
+
+	/* Print statistics */
+	if ( flags & PROFSTAT_DUMP ) {
+		profile_format ( profiler, buf, sizeof ( buf ) );
+		printf ( "%s\n", buf );
+	} else if ( profiler->count ) {
+		printf ( "%s: %ld +/- %ld ticks (%d samples) min %ld p50 %ld "
+			 "p90 %ld p99 %ld max %ld\n", profiler->name,
+			 profile_mean ( profiler ), profile_stddev ( profiler ),
+			 profiler->count, profiler->min,
+			 profile_percentile ( profiler, 50 ),
+			 profile_percentile ( profiler, 90 ),
+			 profile_percentile ( profiler, 99 ), profiler->max );
+	} else {
+		printf ( "%s: no samples\n", profiler->name );
+	}
+
+	/* Reset statistics, if applicable */
+	if ( flags & PROFSTAT_RESET )
+		profile_reset ( profiler );
+}
+
 /**
  * Print profiling statistics
  *
+ * @v flags		Flags
  */
-void profstat ( void ) {
+void profstat_flags ( unsigned int flags ) {
 	struct profiler *profiler;
 
-	for_each_table_entry ( profiler, PROFILERS ) {
-		printf ( "%s: %ld +/- %ld ticks (%d samples)\n",
-			 profiler->name, profile_mean ( profiler ),
-			 profile_stddev ( profiler ), profiler->count );
-	}
+	for_each_table_entry ( profiler, PROFILERS )
+		profstat_profiler ( profiler, flags );
+	list_for_each_entry ( profiler, &profilers, list )
+		profstat_profiler ( profiler, flags );
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <string.h>
+#include <ipxe/uri.h>
+#include <ipxe/timer.h>
+#include <ipxe/sanboot.h>
+#include <usr/sanmgmt.h>
+
+/** @file
+ *
+ * SAN device management
+ *
+ */
+
+/**
+ * Convert SAN path latency to milliseconds
+ *
+ * @v ticks		Latency (in ticks)
+ * @ret ms		Latency (in milliseconds)
+ */
+static unsigned long sanstat_ms ( unsigned long ticks ) {
+
+	return ( ( ticks * 1000 ) / TICKS_PER_SEC );
+}
+
+/**
+ * Print status of SAN path
+ *
+ * @v sanpath		SAN path
+ */
+static void sanstat_path ( struct san_path *sanpath ) {
+	struct san_device *sandev = sanpath->sandev;
+	struct san_path_stats *stats = &sanpath->stats;
+	size_t len = format_uri ( sanpath->uri, NULL, 0 );
+	char buf[ len + 1 /* NUL */ ];
+	const char *status;
+
+	/* Describe path status */
+	format_uri ( sanpath->uri, buf, sizeof ( buf ) );
+	if ( sanpath == sandev->active ) {
+		status = "active";
+	} else if ( sanpath->path_rc == 0 ) {
+		status = ( ( sandev->policy == SAN_POLICY_FAILOVER ) ?
+			   "standby" : "available" );
+	} else {
+		status = strerror ( sanpath->path_rc );
+	}
+
+	printf ( "  [%d] %s (%s)\n"
+		 "    [Cmd:%d Err:%d Out:%d Avg:%ldms Max:%ldms]\n",
+		 sanpath->index, buf, status, stats->commands, stats->errors,
+		 stats->outstanding,
+		 sanstat_ms ( stats->commands ?
+			      ( stats->ticks / stats->commands ) : 0 ),
+		 sanstat_ms ( stats->max_ticks ) );
+}
+
+/**
+ * Print status of SAN device
+ *
+ * @v sandev		SAN device
+ */
+void sanstat ( struct san_device *sandev ) {
+	unsigned int i;
+
+	printf ( "SAN %#02x: %d path%s using %s policy\n",
+		 sandev->drive, sandev->paths,
+		 ( ( sandev->paths == 1 ) ? "" : "s" ),
+		 san_policy_name ( sandev->policy ) );
+	for ( i = 0 ; i < sandev->paths ; i++ )
+		sanstat_path ( &sandev->path[i] );
+}